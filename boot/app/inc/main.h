@@ -30,6 +30,11 @@ do {                    \
     }                   \
 } while (0)
 
+/* 置 1 时启动过程中运行基准并经日志输出，由 CMake 选项 BOOT_BENCH 打开 */
+#ifndef BOOT_BENCH
+#define BOOT_BENCH  0
+#endif
+
 
 void bl_delay_init(void);
 void bl_delay_ms(uint32_t ms);
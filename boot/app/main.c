@@ -1,14 +1,77 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
+#include "stm32f4xx.h"
 #include "main.h"
+#include "os.h"
+#include "log.h"
 #include "led.h"
+#include "console.h"
+#include "flash.h"
+#include "clock.h"
+#include "handoff.h"
+#include "slot.h"
+#include "power.h"
+#include "verify.h"
+#include "aes.h"
 int main(void)
 {
+    // 之后主栈和中断用到的深度都能由 os_stack_peak() 查到
+    os_stack_paint();
+    // 第一条日志之前初始化日志缓冲
+    log_init();
+
+#if LAYOUT_IMAGE == LAYOUT_IMAGE_BOOT
+    handoff_begin();
+#endif
+
+    // printf 经 _putchar 写入控制台缓冲，由 DMA 发出；节拍用于超时刷新
+    bl_delay_init();
+    console_init(CONSOLE_FULL_DROP);
+
+#if LAYOUT_IMAGE == LAYOUT_IMAGE_BOOT
+    // SystemInit 按编译时的器件宏配置时钟，这里按实际器件切到启动档位
+    bl_clock_set_profile(BL_CLOCK_BOOT);
+#endif
+    // SystemInit 只按编译时的频率写了 ACR，这里按实际 HCLK 和供电电压重新设置并打开全部 ART 功能，
+    // 之后的镜像校验就已经在缓存下运行
+    bl_flash_art_config(SystemCoreClock, BL_FLASH_ART_ALL);
+
+    // 唤醒引脚的 EXTI 和 NVIC 与其他外设一起在 slot_boot 之前配置，跳转前由 handoff 复位
+    power_init();
+
+    // 镜像校验使用 DMA2 Stream0 和 CRC 外设，slot_boot 之前就绪
+    verify_init();
+
+#if BOOT_BENCH
+    bl_flash_art_bench();
+    verify_bench((const void *)LAYOUT_SLOT_A_ORIGIN, LAYOUT_SLOT_SIZE);
+    sha256_bench((const void *)LAYOUT_SLOT_A_ORIGIN, LAYOUT_SLOT_SIZE);
+    ed25519_bench();
+    aes_bench((const void *)LAYOUT_SLOT_A_ORIGIN, LAYOUT_SLOT_SIZE);
+#endif
+
+#if LAYOUT_IMAGE == LAYOUT_IMAGE_BOOT
+    // 有可启动的镜像时不再返回
+    slot_boot();
+#endif
+
+#if BOOT_BENCH
+    uint32_t idle_wakes = 0;
+#endif
+
 while(1){
 bl_led_init();
 bl_led_on();
-
+// 没有事件时睡到下一个中断，中断在 __enable_irq 之后执行
+__disable_irq();
+power_idle(0);
+__enable_irq();
+#if BOOT_BENCH
+// 节拍每次都会唤醒，约每 4096 个节拍报告一次睡眠次数和醒着的比例
+if ((++idle_wakes & 4095U) == 0)
+    power_report();
+#endif
 }
 
     return 0;
@@ -32,6 +32,7 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "_printf_.h"
 
@@ -76,10 +77,11 @@
 #define PRINTF_DEFAULT_FLOAT_PRECISION  6U
 #endif
 
-// define the largest float suitable to print with %f
-// default: 1e9
-#ifndef PRINTF_MAX_FLOAT
-#define PRINTF_MAX_FLOAT  1e9
+// 'ftoa' limb count, the exact float conversion keeps 9 decimal digits per limb (on stack)
+// every %f integer part fits, fraction and %e digits beyond about 9 * (limbs - 3) print as zeros
+// default: 40 limbs (160 byte), minimum 36
+#ifndef PRINTF_FTOA_LIMBS
+#define PRINTF_FTOA_LIMBS  40U
 #endif
 
 // support for the long long types (%llu or %p)
@@ -110,12 +112,9 @@
 #define FLAGS_LONG_LONG (1U <<  9U)
 #define FLAGS_PRECISION (1U << 10U)
 #define FLAGS_ADAPT_EXP (1U << 11U)
-
-
-// import float.h for DBL_MAX
-#if defined(PRINTF_SUPPORT_FLOAT)
-#include <float.h>
-#endif
+#define FLAGS_ROUNDTRIP (1U << 12U)
+#define FLAGS_WIDTH_ARG (1U << 13U)
+#define FLAGS_PREC_ARG  (1U << 14U)
 
 
 // output function type
@@ -129,6 +128,22 @@ typedef struct {
 } out_fct_wrap_type;
 
 
+// wrapper (used as buffer) for span output function type
+typedef struct {
+  void  (*fct)(const char* data, size_t len, void* arg);
+  void* arg;
+} out_span_wrap_type;
+
+
+// default span output for printf(), override it to take whole runs at once
+__attribute__((weak)) void _putchars(const char* data, size_t len)
+{
+  while (len--) {
+    _putchar(*data++);
+  }
+}
+
+
 // internal buffer output
 static inline void _out_buffer(char character, void* buffer, size_t idx, size_t maxlen)
 {
@@ -166,6 +181,62 @@ static inline void _out_fct(char character, void* buffer, size_t idx, size_t max
 }
 
 
+// internal span output function wrapper, only ever used through _out_span()
+static inline void _out_span_fct(char character, void* buffer, size_t idx, size_t maxlen)
+{
+  (void)idx; (void)maxlen;
+  if (character) {
+    ((out_span_wrap_type*)buffer)->fct(&character, 1U, ((out_span_wrap_type*)buffer)->arg);
+  }
+}
+
+
+// output a (pointer, length) run in one go instead of one out() call per character
+// \return The new index
+static size_t _out_span(out_fct_type out, char* buffer, size_t idx, size_t maxlen, const char* data, size_t len)
+{
+  if (out == _out_buffer) {
+    if (idx < maxlen) {
+      memcpy(&buffer[idx], data, (len < maxlen - idx) ? len : maxlen - idx);
+    }
+  }
+  else if (out == _out_char) {
+    _putchars(data, len);
+  }
+  else if (out == _out_span_fct) {
+    ((out_span_wrap_type*)buffer)->fct(data, len, ((out_span_wrap_type*)buffer)->arg);
+  }
+  else if (out != _out_null) {
+    for (size_t i = 0U; i < len; i++) {
+      out(data[i], buffer, idx + i, maxlen);
+    }
+  }
+  return idx + len;
+}
+
+
+// output 'count' copies of 'character' (padding), in spans of up to 16 characters
+// \return The new index
+static size_t _out_fill(out_fct_type out, char* buffer, size_t idx, size_t maxlen, char character, size_t count)
+{
+  if (out == _out_buffer) {
+    if (idx < maxlen) {
+      memset(&buffer[idx], character, (count < maxlen - idx) ? count : maxlen - idx);
+    }
+    return idx + count;
+  }
+
+  char fill[16];
+  memset(fill, character, sizeof(fill));
+  while (count) {
+    const size_t n = (count < sizeof(fill)) ? count : sizeof(fill);
+    idx = _out_span(out, buffer, idx, maxlen, fill, n);
+    count -= n;
+  }
+  return idx;
+}
+
+
 // internal secure strlen
 // \return The length of the string (excluding the terminating 0) limited by 'maxsize'
 static inline unsigned int _strnlen_s(const char* str, size_t maxsize)
@@ -199,24 +270,22 @@ static unsigned int _atoi(const char** str)
 static size_t _out_rev(out_fct_type out, char* buffer, size_t idx, size_t maxlen, const char* buf, size_t len, unsigned int width, unsigned int flags)
 {
   const size_t start_idx = idx;
+  char fwd[(PRINTF_FTOA_BUFFER_SIZE > PRINTF_NTOA_BUFFER_SIZE) ? PRINTF_FTOA_BUFFER_SIZE : PRINTF_NTOA_BUFFER_SIZE];
 
   // pad spaces up to given width
-  if (!(flags & FLAGS_LEFT) && !(flags & FLAGS_ZEROPAD)) {
-    for (size_t i = len; i < width; i++) {
-      out(' ', buffer, idx++, maxlen);
-    }
+  if (!(flags & FLAGS_LEFT) && !(flags & FLAGS_ZEROPAD) && (len < width)) {
+    idx = _out_fill(out, buffer, idx, maxlen, ' ', width - len);
   }
 
-  // reverse string
-  while (len) {
-    out(buf[--len], buffer, idx++, maxlen);
+  // reverse string into a forward run
+  for (size_t i = 0U; i < len; i++) {
+    fwd[i] = buf[len - 1U - i];
   }
+  idx = _out_span(out, buffer, idx, maxlen, fwd, len);
 
   // append pad spaces up to given width
-  if (flags & FLAGS_LEFT) {
-    while (idx - start_idx < width) {
-      out(' ', buffer, idx++, maxlen);
-    }
+  if ((flags & FLAGS_LEFT) && (idx - start_idx < width)) {
+    idx = _out_fill(out, buffer, idx, maxlen, ' ', width - (idx - start_idx));
   }
 
   return idx;
@@ -277,11 +346,71 @@ static size_t _ntoa_format(out_fct_type out, char* buffer, size_t idx, size_t ma
 }
 
 
+// digit tables for the division-free converters below
+static const char _digits_lower[16] = "0123456789abcdef";
+static const char _digits_upper[16] = "0123456789ABCDEF";
+static const char _digits_pair[200] =
+  "0001020304050607080910111213141516171819"
+  "2021222324252627282930313233343536373839"
+  "4041424344454647484950515253545556575859"
+  "6061626364656667686970717273747576777879"
+  "8081828384858687888990919293949596979899";
+
+
+// shift amount for the power of two bases, 0 for any other base
+static inline unsigned int _base_shift(unsigned int base)
+{
+  return (base == 16U) ? 4U : (base == 8U) ? 3U : (base == 2U) ? 1U : 0U;
+}
+
+
+// internal decimal conversion, two digits per step (reversed into buf)
+// value / 100U is compiled to a multiply-high, so no division instruction or library call is used
+static size_t _dtoa_rev_u32(char* buf, size_t len, uint32_t value)
+{
+  while (value >= 100U) {
+    const uint32_t q = value / 100U;
+    const uint32_t r = (value - q * 100U) * 2U;
+    buf[len++] = _digits_pair[r + 1U];
+    buf[len++] = _digits_pair[r];
+    value = q;
+  }
+  if (value >= 10U) {
+    buf[len++] = _digits_pair[value * 2U + 1U];
+    buf[len++] = _digits_pair[value * 2U];
+  }
+  else {
+    buf[len++] = (char)('0' + value);
+  }
+  return len;
+}
+
+
+// high 64 bits of a 64x64 bit product, built from 32x32->64 multiplies (UMULL on Cortex-M)
+static inline uint64_t _umulh64(uint64_t a, uint64_t b)
+{
+  const uint64_t a_lo = (uint32_t)a, a_hi = a >> 32U;
+  const uint64_t b_lo = (uint32_t)b, b_hi = b >> 32U;
+  const uint64_t p0 = a_lo * b_lo, p1 = a_lo * b_hi, p2 = a_hi * b_lo, p3 = a_hi * b_hi;
+  const uint64_t mid = (p0 >> 32U) + (uint32_t)p1 + (uint32_t)p2;
+  return p3 + (p1 >> 32U) + (p2 >> 32U) + (mid >> 32U);
+}
+
+
+// value / 1e9 without __aeabi_uldivmod: 1e9 = 2^9 * 1953125, and for (value >> 9) < 2^55
+// the reciprocal ceil(2^76 / 1953125) is exact over the whole 64 bit range
+static inline uint64_t _udiv1e9(uint64_t value)
+{
+  return _umulh64(value >> 9U, 0x89705F4136B4A6ULL) >> 12U;
+}
+
+
 // internal itoa for 'long' type
 static size_t _ntoa_long(out_fct_type out, char* buffer, size_t idx, size_t maxlen, unsigned long value, bool negative, unsigned long base, unsigned int prec, unsigned int width, unsigned int flags)
 {
   char buf[PRINTF_NTOA_BUFFER_SIZE];
   size_t len = 0U;
+  const unsigned int shift = _base_shift((unsigned int)base);
 
   // no hash for 0 values
   if (!value) {
@@ -290,11 +419,23 @@ static size_t _ntoa_long(out_fct_type out, char* buffer, size_t idx, size_t maxl
 
   // write if precision != 0 and value is != 0
   if (!(flags & FLAGS_PRECISION) || value) {
-    do {
-      const char digit = (char)(value % base);
-      buf[len++] = digit < 10 ? '0' + digit : (flags & FLAGS_UPPERCASE ? 'A' : 'a') + digit - 10;
-      value /= base;
-    } while (value && (len < PRINTF_NTOA_BUFFER_SIZE));
+    if ((base == 10U) && (value <= 0xFFFFFFFFUL)) {
+      len = _dtoa_rev_u32(buf, len, (uint32_t)value);
+    }
+    else if (shift) {
+      const char* digits = (flags & FLAGS_UPPERCASE) ? _digits_upper : _digits_lower;
+      do {
+        buf[len++] = digits[value & (base - 1U)];
+        value >>= shift;
+      } while (value && (len < PRINTF_NTOA_BUFFER_SIZE));
+    }
+    else {
+      do {
+        const char digit = (char)(value % base);
+        buf[len++] = digit < 10 ? '0' + digit : (flags & FLAGS_UPPERCASE ? 'A' : 'a') + digit - 10;
+        value /= base;
+      } while (value && (len < PRINTF_NTOA_BUFFER_SIZE));
+    }
   }
 
   return _ntoa_format(out, buffer, idx, maxlen, buf, len, negative, (unsigned int)base, prec, width, flags);
@@ -307,6 +448,7 @@ static size_t _ntoa_long_long(out_fct_type out, char* buffer, size_t idx, size_t
 {
   char buf[PRINTF_NTOA_BUFFER_SIZE];
   size_t len = 0U;
+  const unsigned int shift = _base_shift((unsigned int)base);
 
   // no hash for 0 values
   if (!value) {
@@ -315,11 +457,37 @@ static size_t _ntoa_long_long(out_fct_type out, char* buffer, size_t idx, size_t
 
   // write if precision != 0 and value is != 0
   if (!(flags & FLAGS_PRECISION) || value) {
-    do {
-      const char digit = (char)(value % base);
-      buf[len++] = digit < 10 ? '0' + digit : (flags & FLAGS_UPPERCASE ? 'A' : 'a') + digit - 10;
-      value /= base;
-    } while (value && (len < PRINTF_NTOA_BUFFER_SIZE));
+    if (base == 10U) {
+      // peel off 9 digit groups until the rest fits the 32 bit converter
+      while (value > 0xFFFFFFFFULL) {
+        const uint64_t q = _udiv1e9(value);
+        uint32_t r = (uint32_t)(value - q * 1000000000ULL);
+        for (unsigned int i = 0U; i < 4U; i++) {
+          const uint32_t rq = r / 100U;
+          const uint32_t d  = (r - rq * 100U) * 2U;
+          buf[len++] = _digits_pair[d + 1U];
+          buf[len++] = _digits_pair[d];
+          r = rq;
+        }
+        buf[len++] = (char)('0' + r);
+        value = q;
+      }
+      len = _dtoa_rev_u32(buf, len, (uint32_t)value);
+    }
+    else if (shift) {
+      const char* digits = (flags & FLAGS_UPPERCASE) ? _digits_upper : _digits_lower;
+      do {
+        buf[len++] = digits[(uint32_t)value & (base - 1U)];
+        value >>= shift;
+      } while (value && (len < PRINTF_NTOA_BUFFER_SIZE));
+    }
+    else {
+      do {
+        const char digit = (char)(value % base);
+        buf[len++] = digit < 10 ? '0' + digit : (flags & FLAGS_UPPERCASE ? 'A' : 'a') + digit - 10;
+        value /= base;
+      } while (value && (len < PRINTF_NTOA_BUFFER_SIZE));
+    }
   }
 
   return _ntoa_format(out, buffer, idx, maxlen, buf, len, negative, (unsigned int)base, prec, width, flags);
@@ -329,525 +497,1081 @@ static size_t _ntoa_long_long(out_fct_type out, char* buffer, size_t idx, size_t
 
 #if defined(PRINTF_SUPPORT_FLOAT)
 
-#if defined(PRINTF_SUPPORT_EXPONENTIAL)
-// forward declaration so that _ftoa can switch to exp notation for values > PRINTF_MAX_FLOAT
-static size_t _etoa(out_fct_type out, char* buffer, size_t idx, size_t maxlen, double value, unsigned int prec, unsigned int width, unsigned int flags);
+// The float conversions below are exact: the double is split into m * 2^e2 and turned into
+// base 1e9 limbs with integer arithmetic only, then rounded half-to-even on the decimal digits
+// like glibc does. No double arithmetic is used, so nothing is pulled in from the soft-float
+// library on FPU-less parts or on the single-precision M4F FPU.
+// Values that fit a float (every promoted float argument) take the short path: their mantissa
+// has at most 24 significant bits, so the fraction is converted with one 64 bit multiply per
+// 9 digits. Other values walk a small binary bignum, with a cost bounded by their exponent.
+
+// binary scratch words for the bignum paths: 2^1024 and 2^-1074 both fit in 34 words
+#define FTOA_SCRATCH_WORDS  36U
+
+#if (PRINTF_FTOA_LIMBS < 36U)
+#error "PRINTF_FTOA_LIMBS must be at least 36 to hold the integer part of DBL_MAX"
 #endif
 
 
-// internal ftoa for fixed decimal floating point
-static size_t _ftoa(out_fct_type out, char* buffer, size_t idx, size_t maxlen, double value, unsigned int prec, unsigned int width, unsigned int flags)
+static const uint32_t _pow10_u32[10] = { 1U, 10U, 100U, 1000U, 10000U, 100000U, 1000000U, 10000000U, 100000000U, 1000000000U };
+
+
+// exact decimal expansion of a double, in base 1e9 limbs
+typedef struct {
+  uint32_t limb[PRINTF_FTOA_LIMBS];  // most significant first
+  int      n;                        // limbs in use
+  int      ip;                       // limbs in front of the decimal point, negative if leading zero limbs were skipped
+  bool     sticky;                   // non-zero digits follow limb[n - 1] but were not generated
+} _fp_dec_t;
+
+
+// splits the double into its raw mantissa and binary exponent, returns the sign bit
+// a finite value is m * 2^e2, e2 == 1024 marks inf (m == 0) and nan (m != 0)
+static bool _fp_split(double value, uint64_t* m, int* e2)
 {
-  char buf[PRINTF_FTOA_BUFFER_SIZE];
-  size_t len  = 0U;
-  double diff = 0.0;
+  union {
+    uint64_t U;
+    double   F;
+  } conv;
 
-  // powers of 10
-  static const double pow10[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000 };
+  conv.F = value;
+  const int exp = (int)((conv.U >> 52U) & 0x07FFU);
+  *m = conv.U & ((1ULL << 52U) - 1U);
+  if (exp == 0x07FF) {
+    *e2 = 1024;
+  }
+  else if (exp) {
+    *m |= 1ULL << 52U;
+    *e2 = exp - 1075;
+  }
+  else {
+    *e2 = -1074;
+  }
+  return (conv.U >> 63U) != 0U;
+}
 
-  // test for special values
-  if (value != value)
-    return _out_rev(out, buffer, idx, maxlen, "nan", 3, width, flags);
-  if (value < -DBL_MAX)
-    return _out_rev(out, buffer, idx, maxlen, "fni-", 4, width, flags);
-  if (value > DBL_MAX)
-    return _out_rev(out, buffer, idx, maxlen, (flags & FLAGS_PLUS) ? "fni+" : "fni", (flags & FLAGS_PLUS) ? 4U : 3U, width, flags);
 
-  // test for very large values
-  // standard printf behavior is to print EVERY whole number digit -- which could be 100s of characters overflowing your buffers == bad
-  if ((value > PRINTF_MAX_FLOAT) || (value < -PRINTF_MAX_FLOAT)) {
-#if defined(PRINTF_SUPPORT_EXPONENTIAL)
-    return _etoa(out, buffer, idx, maxlen, value, prec, width, flags);
-#else
-    return 0U;
-#endif
+// number of decimal digits of a limb, 1 for 0
+static int _fp_ndigits(uint32_t v)
+{
+  int n = 1;
+  while ((n < 10) && (v >= _pow10_u32[n])) {
+    n++;
   }
+  return n;
+}
+
+
+// floor(x / 9) for negative x as well
+static inline int _fp_floor9(int x)
+{
+  return (x >= 0) ? (x / 9) : -((8 - x) / 9);
+}
+
+
+// sets dec to the value 0
+static void _fp_zero(_fp_dec_t* dec)
+{
+  dec->limb[0] = 0U;
+  dec->n       = 1;
+  dec->ip      = 1;
+  dec->sticky  = false;
+}
 
-  // test for negative
-  bool negative = false;
-  if (value < 0) {
-    negative = true;
-    value = 0 - value;
+
+// appends one limb, leading zero limbs of values < 1 are only counted
+static inline void _fp_push(_fp_dec_t* dec, uint32_t limb)
+{
+  if (dec->n || limb) {
+    dec->limb[dec->n++] = limb;
   }
+  else {
+    dec->ip--;
+  }
+}
 
-  // set default precision, if not set explicitly
-  if (!(flags & FLAGS_PRECISION)) {
-    prec = PRINTF_DEFAULT_FLOAT_PRECISION;
+
+// appends the (up to three) limbs of an integer below 2^64
+static void _fp_push_u64(_fp_dec_t* dec, uint64_t v)
+{
+  if (v < 1000000000U) {
+    _fp_push(dec, (uint32_t)v);
+    return;
+  }
+  const uint64_t q1 = _udiv1e9(v);
+  const uint64_t q2 = _udiv1e9(q1);
+  if (q2) {
+    _fp_push(dec, (uint32_t)q2);
   }
-  // limit precision to 9, cause a prec >= 10 can lead to overflow errors
-  while ((len < PRINTF_FTOA_BUFFER_SIZE) && (prec > 9U)) {
-    buf[len++] = '0';
-    prec--;
+  if (q1) {
+    _fp_push(dec, (uint32_t)(q1 - q2 * 1000000000ULL));
   }
+  _fp_push(dec, (uint32_t)(v - q1 * 1000000000ULL));
+}
 
-  int whole = (int)value;
-  double tmp = (value - whole) * pow10[prec];
-  unsigned long frac = (unsigned long)tmp;
-  diff = tmp - frac;
 
-  if (diff > 0.5) {
-    ++frac;
-    // handle rollover, e.g. case 0.99 with prec 1 is 1.0
-    if (frac >= pow10[prec]) {
-      frac = 0;
-      ++whole;
-    }
+// generates the exact decimal limbs of m * 2^e2 (m != 0)
+// the integer part is always complete, fraction limbs stop after fmax limbs behind the point
+// or smax stored limbs, whichever comes first; dec->sticky tells if anything was left over
+static void _fp_dec(_fp_dec_t* dec, uint64_t m, int e2, int fmax, int smax)
+{
+  uint32_t w[FTOA_SCRATCH_WORDS];
+
+  dec->n      = 0;
+  dec->ip     = 0;
+  dec->sticky = false;
+  if (smax > (int)PRINTF_FTOA_LIMBS - 1) {
+    smax = (int)PRINTF_FTOA_LIMBS - 1;   // keep one spare limb for the rounding carry
   }
-  else if (diff < 0.5) {
+
+#if defined(__GNUC__)
+  const int tz = __builtin_ctzll(m);
+  m >>= tz;
+  e2 += tz;
+#else
+  while (!(m & 1U)) {
+    m >>= 1U;
+    e2++;
   }
-  else if ((frac == 0U) || (frac & 1U)) {
-    // if halfway, round up if odd OR if last digit is 0
-    ++frac;
+#endif
+
+  if (e2 >= 0) {
+    // integer value
+    if ((e2 < 64) && !(m >> (63 - e2))) {
+      _fp_push_u64(dec, m << e2);
+    }
+    else {
+      // m << e2 in binary words, then repeated division by 1e9 yields the limbs in reverse
+      const unsigned int ws = (unsigned int)e2 / 32U, bs = (unsigned int)e2 % 32U;
+      unsigned int nw = ws + 3U;
+      memset(w, 0, nw * sizeof(uint32_t));
+      w[ws]      = (uint32_t)(m << bs);
+      w[ws + 1U] = (uint32_t)((m << bs) >> 32U);
+      w[ws + 2U] = bs ? (uint32_t)(m >> (64U - bs)) : 0U;
+      while (nw && !w[nw - 1U]) {
+        nw--;
+      }
+      while (nw) {
+        uint64_t rem = 0U;
+        for (unsigned int i = nw; i-- > 0U; ) {
+          const uint64_t cur = (rem << 32U) | w[i];
+          const uint64_t q   = _udiv1e9(cur);
+          w[i] = (uint32_t)q;
+          rem  = cur - q * 1000000000ULL;
+        }
+        dec->limb[dec->n++] = (uint32_t)rem;
+        while (nw && !w[nw - 1U]) {
+          nw--;
+        }
+      }
+      for (int i = 0, j = dec->n - 1; i < j; i++, j--) {
+        const uint32_t t = dec->limb[i];
+        dec->limb[i] = dec->limb[j];
+        dec->limb[j] = t;
+      }
+    }
+    dec->ip = dec->n;
+    return;
   }
 
-  if (prec == 0U) {
-    diff = value - (double)whole;
-    if ((!(diff < 0.5) || (diff > 0.5)) && (whole & 1)) {
-      // exactly 0.5 and ODD, then round up
-      // 1.5 -> 2, but 2.5 -> 2
-      ++whole;
+  // integer part, then fraction f / 2^k
+  const unsigned int k = (unsigned int)-e2;
+  uint64_t f = m;
+  if (k < 64U) {
+    if (m >> k) {
+      _fp_push_u64(dec, m >> k);
     }
+    f = m & ((1ULL << k) - 1U);
+  }
+  dec->ip = dec->n;
+
+  int fl = 0;
+  if (k <= 34U) {
+    // f * 1e9 fits 64 bit, one multiply per limb (every float >= 2^-10 ends up here)
+    const uint64_t mask = (1ULL << k) - 1U;
+    while (f && (fl < fmax) && (dec->n < smax)) {
+      f *= 1000000000ULL;
+      _fp_push(dec, (uint32_t)(f >> k));
+      f &= mask;
+      fl++;
+    }
+    dec->sticky = (f != 0U);
   }
   else {
-    unsigned int count = prec;
-    // now do fractional part, as an unsigned number
-    while (len < PRINTF_FTOA_BUFFER_SIZE) {
-      --count;
-      buf[len++] = (char)(48U + (frac % 10U));
-      if (!(frac /= 10U)) {
-        break;
-      }
+    // f left aligned in nw words, the carry out of each multiply by 1e9 is the next limb
+    const unsigned int nw = (k + 31U) / 32U, sh = nw * 32U - k;
+    unsigned int lo = 0U;
+    memset(w, 0, nw * sizeof(uint32_t));
+    w[0] = (uint32_t)(f << sh);
+    w[1] = (uint32_t)((f << sh) >> 32U);
+    if (nw > 2U) {
+      w[2] = sh ? (uint32_t)(f >> (64U - sh)) : 0U;
     }
-    // add extra 0s
-    while ((len < PRINTF_FTOA_BUFFER_SIZE) && (count-- > 0U)) {
-      buf[len++] = '0';
+    while (!w[lo]) {
+      lo++;
     }
-    if (len < PRINTF_FTOA_BUFFER_SIZE) {
-      // add decimal
-      buf[len++] = '.';
+    while ((lo < nw) && (fl < fmax) && (dec->n < smax)) {
+      uint64_t carry = 0U;
+      for (unsigned int i = lo; i < nw; i++) {
+        const uint64_t t = (uint64_t)w[i] * 1000000000U + carry;
+        w[i]  = (uint32_t)t;
+        carry = t >> 32U;
+      }
+      _fp_push(dec, (uint32_t)carry);
+      while ((lo < nw) && !w[lo]) {
+        lo++;
+      }
+      fl++;
     }
+    dec->sticky = (lo < nw);
   }
+}
 
-  // do whole part, number is reversed
-  while (len < PRINTF_FTOA_BUFFER_SIZE) {
-    buf[len++] = (char)(48 + (whole % 10));
-    if (!(whole /= 10)) {
-      break;
-    }
+
+// digit at position pos, counted from the first (possibly zero) digit of limb[0]
+static unsigned int _fp_digit(const _fp_dec_t* dec, int pos)
+{
+  if ((pos < 0) || (pos >= dec->n * 9)) {
+    return 0U;
   }
+  return (dec->limb[pos / 9] / _pow10_u32[8 - pos % 9]) % 10U;
+}
 
-  // pad leading zeros
-  if (!(flags & FLAGS_LEFT) && (flags & FLAGS_ZEROPAD)) {
-    if (width && (negative || (flags & (FLAGS_PLUS | FLAGS_SPACE)))) {
-      width--;
+
+// classifies everything behind the first keep digits:
+// 0 = nothing, 1 = below half, 2 = exactly half, 3 = above half
+static unsigned int _fp_tail(const _fp_dec_t* dec, int keep)
+{
+  if (keep < 0) {
+    // the value is below 10^(9 * ip) and therefore below half a unit of the kept position
+    for (int i = 0; i < dec->n; i++) {
+      if (dec->limb[i]) {
+        return 1U;
+      }
     }
-    while ((len < width) && (len < PRINTF_FTOA_BUFFER_SIZE)) {
-      buf[len++] = '0';
+    return dec->sticky ? 1U : 0U;
+  }
+  if (keep >= dec->n * 9) {
+    return dec->sticky ? 1U : 0U;
+  }
+  const int li = keep / 9;
+  const uint32_t p10  = _pow10_u32[9 - keep % 9];
+  const uint32_t r    = dec->limb[li] % p10;
+  const uint32_t half = p10 / 2U;
+  bool later = dec->sticky;
+  for (int i = li + 1; !later && (i < dec->n); i++) {
+    later = (dec->limb[i] != 0U);
+  }
+  if ((r > half) || ((r == half) && later)) {
+    return 3U;
+  }
+  if (r == half) {
+    return 2U;
+  }
+  return (r || later) ? 1U : 0U;
+}
+
+
+// rounds half-to-even after the first keep digits
+static void _fp_round(_fp_dec_t* dec, int keep)
+{
+  if (keep < 0) {
+    // only possible for %f, the value is below half a unit of the last fraction digit
+    _fp_zero(dec);
+    return;
+  }
+  if (keep >= dec->n * 9) {
+    return;
+  }
+
+  const unsigned int tail = _fp_tail(dec, keep);
+  const int li = keep / 9;
+  const uint32_t p10 = _pow10_u32[9 - keep % 9];
+  const bool up = (tail == 3U) || ((tail == 2U) && (_fp_digit(dec, keep - 1) & 1U));
+  dec->limb[li] -= dec->limb[li] % p10;
+  dec->n = li + 1;
+  dec->sticky = false;
+  if (up) {
+    int i = li;
+    dec->limb[i] += p10;
+    while (dec->limb[i] >= 1000000000U) {
+      dec->limb[i] -= 1000000000U;
+      if (!i) {
+        memmove(&dec->limb[1], &dec->limb[0], (size_t)dec->n * sizeof(uint32_t));
+        dec->limb[0] = 1U;
+        dec->n++;
+        dec->ip++;
+        break;
+      }
+      dec->limb[--i]++;
     }
   }
+}
 
-  if (len < PRINTF_FTOA_BUFFER_SIZE) {
-    if (negative) {
-      buf[len++] = '-';
+
+// outputs the digits at positions [from, to), positions outside the stored limbs are zeros
+static size_t _fp_out_digits(out_fct_type out, char* buffer, size_t idx, size_t maxlen, const _fp_dec_t* dec, int from, int to)
+{
+  char s[9];
+
+  if ((from < 0) && (from < to)) {
+    const int z = ((to < 0) ? to : 0) - from;
+    idx  = _out_fill(out, buffer, idx, maxlen, '0', (size_t)z);
+    from += z;
+  }
+  while (from < to) {
+    const int li = from / 9, di = from % 9;
+    const int cnt = ((9 - di) < (to - from)) ? (9 - di) : (to - from);
+    if (li >= dec->n) {
+      return _out_fill(out, buffer, idx, maxlen, '0', (size_t)(to - from));
     }
-    else if (flags & FLAGS_PLUS) {
-      buf[len++] = '+';  // ignore the space if the '+' exists
+    // drop the digits right of the run, then convert just cnt digits two at a time
+    uint32_t v = dec->limb[li] / _pow10_u32[9 - di - cnt];
+    int i = cnt;
+    while (i >= 2) {
+      const uint32_t q = v / 100U;
+      const uint32_t r = (v - q * 100U) * 2U;
+      s[--i] = _digits_pair[r + 1U];
+      s[--i] = _digits_pair[r];
+      v = q;
     }
-    else if (flags & FLAGS_SPACE) {
-      buf[len++] = ' ';
+    if (i) {
+      s[0] = (char)('0' + v % 10U);
     }
+    idx  = _out_span(out, buffer, idx, maxlen, s, (size_t)cnt);
+    from += cnt;
   }
-
-  return _out_rev(out, buffer, idx, maxlen, buf, len, width, flags);
+  return idx;
 }
 
 
-#if defined(PRINTF_SUPPORT_EXPONENTIAL)
-// internal ftoa variant for exponential floating-point type, contributed by Martijn Jasperse <m.jasperse@gmail.com>
-static size_t _etoa(out_fct_type out, char* buffer, size_t idx, size_t maxlen, double value, unsigned int prec, unsigned int width, unsigned int flags)
+// outputs a rounded expansion with sign and padding
+// fixed notation prints prec fraction digits, exponential notation prec significant digits
+// in %g mode (FLAGS_ADAPT_EXP without FLAGS_HASH) trailing fraction zeros are dropped
+static size_t _fp_out(out_fct_type out, char* buffer, size_t idx, size_t maxlen, const _fp_dec_t* dec, bool negative, bool exp_style, int prec, unsigned int width, unsigned int flags)
 {
-  // check for NaN and special values
-  if ((value != value) || (value > DBL_MAX) || (value < -DBL_MAX)) {
-    return _ftoa(out, buffer, idx, maxlen, value, prec, width, flags);
+  const int d1   = dec->n ? _fp_ndigits(dec->limb[0]) : 1;
+  const int lead = 9 - d1;
+  const int expv = 9 * (dec->ip - 1) + d1 - 1;
+  const bool strip = (flags & FLAGS_ADAPT_EXP) && !(flags & FLAGS_HASH);
+  const char sign = negative ? '-' : (flags & FLAGS_PLUS) ? '+' : (flags & FLAGS_SPACE) ? ' ' : '\0';
+
+  int frac_from, frac;
+  size_t len;
+  if (exp_style) {
+    frac_from = lead + 1;
+    frac      = prec - 1;
+  }
+  else {
+    frac_from = 9 * dec->ip;
+    frac      = prec;
   }
+  // %#g keeps all prec significant digits, also when rounding carried into the exponent form:
+  // 999999.5 with "%#g" prints "1.00000e+06" as C requires. This intentionally differs from
+  // glibc, which prints "1.e+06" there (see tools/test/test_printf_float.c)
+  while (strip && (frac > 0) && !_fp_digit(dec, frac_from + frac - 1)) {
+    frac--;
+  }
+  const bool point = frac || (flags & FLAGS_HASH);
+  if (exp_style) {
+    len = 1U + ((expv <= -100) || (expv >= 100) ? 5U : 4U);
+  }
+  else {
+    len = (dec->ip >= 1) ? (size_t)(9 * dec->ip - lead) : 1U;
+  }
+  len += (point ? 1U : 0U) + (size_t)frac + (sign ? 1U : 0U);
 
-  // determine the sign
-  const bool negative = value < 0;
-  if (negative) {
-    value = -value;
+  // pre padding and sign
+  if (!(flags & FLAGS_LEFT) && !(flags & FLAGS_ZEROPAD) && (len < width)) {
+    idx = _out_fill(out, buffer, idx, maxlen, ' ', width - len);
+  }
+  if (sign) {
+    out(sign, buffer, idx++, maxlen);
+  }
+  if (!(flags & FLAGS_LEFT) && (flags & FLAGS_ZEROPAD) && (len < width)) {
+    idx = _out_fill(out, buffer, idx, maxlen, '0', width - len);
   }
 
-  // default precision
+  // whole part
+  if (exp_style) {
+    idx = _fp_out_digits(out, buffer, idx, maxlen, dec, lead, lead + 1);
+  }
+  else if (dec->ip >= 1) {
+    idx = _fp_out_digits(out, buffer, idx, maxlen, dec, lead, 9 * dec->ip);
+  }
+  else {
+    out('0', buffer, idx++, maxlen);
+  }
+
+  // fraction
+  if (point) {
+    out('.', buffer, idx++, maxlen);
+  }
+  idx = _fp_out_digits(out, buffer, idx, maxlen, dec, frac_from, frac_from + frac);
+
+  // exponent, at least two digits
+  if (exp_style) {
+    const unsigned int e = (unsigned int)((expv < 0) ? -expv : expv);
+    char s[5];
+    size_t n = 0U;
+    s[n++] = (flags & FLAGS_UPPERCASE) ? 'E' : 'e';
+    s[n++] = (expv < 0) ? '-' : '+';
+    if (e >= 100U) {
+      s[n++] = (char)('0' + e / 100U);
+    }
+    s[n++] = _digits_pair[(e % 100U) * 2U];
+    s[n++] = _digits_pair[(e % 100U) * 2U + 1U];
+    idx = _out_span(out, buffer, idx, maxlen, s, n);
+  }
+
+  // post padding
+  if ((flags & FLAGS_LEFT) && (len < width)) {
+    idx = _out_fill(out, buffer, idx, maxlen, ' ', width - len);
+  }
+  return idx;
+}
+
+
+// outputs inf and nan, zero padding does not apply
+static size_t _fp_out_special(out_fct_type out, char* buffer, size_t idx, size_t maxlen, bool nan, bool negative, unsigned int width, unsigned int flags)
+{
+  const char* s = nan ? ((flags & FLAGS_UPPERCASE) ? "NAN" : "nan") : ((flags & FLAGS_UPPERCASE) ? "INF" : "inf");
+  const char sign = negative ? '-' : (flags & FLAGS_PLUS) ? '+' : (flags & FLAGS_SPACE) ? ' ' : '\0';
+  const size_t len = sign ? 4U : 3U;
+
+  if (!(flags & FLAGS_LEFT) && (len < width)) {
+    idx = _out_fill(out, buffer, idx, maxlen, ' ', width - len);
+  }
+  if (sign) {
+    out(sign, buffer, idx++, maxlen);
+  }
+  idx = _out_span(out, buffer, idx, maxlen, s, 3U);
+  if ((flags & FLAGS_LEFT) && (len < width)) {
+    idx = _out_fill(out, buffer, idx, maxlen, ' ', width - len);
+  }
+  return idx;
+}
+
+
+// internal ftoa for fixed decimal floating point (%f)
+static size_t _ftoa(out_fct_type out, char* buffer, size_t idx, size_t maxlen, double value, unsigned int prec, unsigned int width, unsigned int flags)
+{
+  _fp_dec_t dec;
+  uint64_t m;
+  int e2;
+  const bool negative = _fp_split(value, &m, &e2);
+
+  if (e2 == 1024) {
+    return _fp_out_special(out, buffer, idx, maxlen, m != 0U, negative, width, flags);
+  }
   if (!(flags & FLAGS_PRECISION)) {
     prec = PRINTF_DEFAULT_FLOAT_PRECISION;
   }
 
-  // determine the decimal exponent
-  // based on the algorithm by David Gay (https://www.ampl.com/netlib/fp/dtoa.c)
-  union {
-    uint64_t U;
-    double   F;
-  } conv;
+  if (m) {
+    _fp_dec(&dec, m, e2, ((int)prec + 9) / 9, (int)PRINTF_FTOA_LIMBS);
+    _fp_round(&dec, 9 * dec.ip + (int)prec);
+  }
+  else {
+    _fp_zero(&dec);
+  }
+  return _fp_out(out, buffer, idx, maxlen, &dec, negative, false, (int)prec, width, flags & ~FLAGS_ADAPT_EXP);
+}
 
-  conv.F = value;
-  int exp2 = (int)((conv.U >> 52U) & 0x07FFU) - 1023;           // effectively log2
-  conv.U = (conv.U & ((1ULL << 52U) - 1U)) | (1023ULL << 52U);  // drop the exponent so conv.F is now in [1,2)
-  // now approximate log10 from the log2 integer part and an expansion of ln around 1.5
-  int expval = (int)(0.1760912590558 + exp2 * 0.301029995663981 + (conv.F - 1.5) * 0.289529654602168);
-  // now we want to compute 10^expval but we want to be sure it won't overflow
-  exp2 = (int)(expval * 3.321928094887362 + 0.5);
-  const double z  = expval * 2.302585092994046 - exp2 * 0.6931471805599453;
-  const double z2 = z * z;
-  conv.U = (uint64_t)(exp2 + 1023) << 52U;
-  // compute exp(z) using continued fractions, see https://en.wikipedia.org/wiki/Exponential_function#Continued_fractions_for_ex
-  conv.F *= 1 + 2 * z / (2 - z + (z2 / (6 + (z2 / (10 + z2 / 14)))));
-  // correct for rounding errors
-  if (value < conv.F) {
-    expval--;
-    conv.F /= 10;
-  }
-
-  // the exponent format is "%+03d" and largest value is "307", so set aside 4-5 characters
-  unsigned int minwidth = ((expval < 100) && (expval > -100)) ? 4U : 5U;
-
-  // in "%g" mode, "prec" is the number of *significant figures* not decimals
-  if (flags & FLAGS_ADAPT_EXP) {
-    // do we want to fall-back to "%f" mode?
-    if ((value >= 1e-4) && (value < 1e6)) {
-      if ((int)prec > expval) {
-        prec = (unsigned)((int)prec - expval - 1);
+
+#if defined(PRINTF_SUPPORT_EXPONENTIAL)
+static const uint64_t _pow10_u64[20] = {
+  1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL,
+  10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL, 100000000000000ULL,
+  1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL
+};
+
+
+// floor(m * 2^e2 * 10^q) for results below 2^64, tail classifies the remainder like _fp_tail
+static uint64_t _fp_scaled(_fp_dec_t* dec, uint64_t m, int e2, int q, unsigned int* tail)
+{
+  _fp_dec(dec, m, e2, (q >= 0) ? (q + 9) / 9 : 0, (int)PRINTF_FTOA_LIMBS);
+  const int keep = 9 * dec->ip + q;
+  *tail = _fp_tail(dec, keep);
+
+  uint64_t v = 0U;
+  for (int pos = (keep > 0) ? 0 : keep; pos < keep; ) {
+    const int li = pos / 9;
+    if (li >= dec->n) {
+      v *= _pow10_u64[keep - pos];
+      break;
+    }
+    const int cnt = ((keep - pos) < 9) ? (keep - pos) : 9;
+    v = v * _pow10_u32[cnt] + dec->limb[li] / _pow10_u32[9 - cnt];
+    pos += cnt;
+  }
+  return v;
+}
+
+
+// shortest digits that read back as the same double (or float, when single is set and the value is one)
+// returns the digits in *digits with the decimal exponent of the last digit in *exp10
+static void _fp_shortest(_fp_dec_t* dec, uint64_t m, int e2, bool single, uint64_t* digits, int* exp10)
+{
+  // the value is m * 2^e2 with a normalized type mantissa, its neighbours are one unit of m away
+  bool half_gap = (m == (1ULL << 52U)) && (e2 > -1074);
+  if (single) {
+    const int top = e2 + 52;
+    const int ef  = (top - 23 > -149) ? (top - 23) : -149;
+    m >>= (unsigned int)(ef - e2);
+    e2 = ef;
+    half_gap = (m == (1ULL << 23U)) && (e2 > -149);
+  }
+  const bool even = !(m & 1U);
+
+  // bounds in units of 2^(e2 - 2): value 4m, interval (4m - 2, 4m + 2), only 4m - 1 below a power of two
+  const uint64_t mv = m * 4U, mh = mv + 2U, ml = mv - (half_gap ? 1U : 2U);
+  int top = e2 - 2;
+  for (uint64_t t = mh; t > 1U; t >>= 1U) {
+    top++;
+  }
+  // floor(top * log10(2)), exact for |top| < 1650
+  const int est = (top >= 0) ? (int)(((uint32_t)top * 78913U) >> 18U) : -(int)((((uint32_t)-top * 78913U) + (1U << 18U) - 1U) >> 18U);
+  const int q = 16 - est;   // 10^16 <= nh < 2 * 10^18
+
+  unsigned int tl, tv, th;
+  const uint64_t nl = _fp_scaled(dec, ml, e2 - 2, q, &tl);
+  const uint64_t nv = _fp_scaled(dec, mv, e2 - 2, q, &tv);
+  const uint64_t nh = _fp_scaled(dec, mh, e2 - 2, q, &th);
+
+  int nd = 1;
+  while ((nd < 20) && (nh >= _pow10_u64[nd])) {
+    nd++;
+  }
+
+  // coarsest decimal unit that has a multiple inside the interval, then the one closest to the value
+  for (int s = nd - 1; s >= 0; s--) {
+    const uint64_t u = _pow10_u64[s];
+    uint64_t lo = nl / u;
+    if ((nl % u) || tl || !even) {
+      lo++;
+    }
+    if ((lo * u > nh) || ((lo * u == nh) && !th && !even)) {
+      continue;
+    }
+    uint64_t c = nv / u;
+    const uint64_t r = nv % u;
+    bool up;
+    if (s) {
+      up = (r > u / 2U) || ((r == u / 2U) && (tv || (c & 1U)));
+    }
+    else {
+      up = (tv == 3U) || ((tv == 2U) && (c & 1U));
+    }
+    c += up ? 1U : 0U;
+    if (c < lo) {
+      c = lo;
+    }
+    else if ((c * u > nh) || ((c * u == nh) && !th && !even)) {
+      c--;
+    }
+    int e = s - q;
+    while (!(c % 10U)) {
+      c /= 10U;
+      e++;
+    }
+    *digits = c;
+    *exp10  = e;
+    return;
+  }
+  // not reached, the interval is more than one unit wide at 17 digits
+  *digits = nv;
+  *exp10  = -q;
+}
+
+
+// internal ftoa variant for exponential floating-point type (%e, %g and the shortest round-trip %r)
+static size_t _etoa(out_fct_type out, char* buffer, size_t idx, size_t maxlen, double value, unsigned int prec, unsigned int width, unsigned int flags)
+{
+  _fp_dec_t dec;
+  uint64_t m;
+  int e2;
+  const bool negative = _fp_split(value, &m, &e2);
+
+  if (e2 == 1024) {
+    return _fp_out_special(out, buffer, idx, maxlen, m != 0U, negative, width, flags);
+  }
+
+  if (flags & FLAGS_ROUNDTRIP) {
+    // shortest digits, laid out like %.17g (%.9g for floats)
+    flags |= FLAGS_ADAPT_EXP;
+    uint64_t digits = 0U;
+    int exp10 = 0;
+    int nd = 1;
+    bool single = false;
+    if (m) {
+      // %hr: use the float interval if the value is a float
+      if ((flags & FLAGS_SHORT) && (m >> 52U)) {
+        const int top = e2 + 52;
+        const int ef  = (top - 23 > -149) ? (top - 23) : -149;
+        single = (top <= 127) && (top >= -149) && !(m & ((1ULL << (unsigned int)(ef - e2)) - 1U));
       }
-      else {
-        prec = 0;
+      _fp_shortest(&dec, m, e2, single, &digits, &exp10);
+      while ((nd < 20) && (digits >= _pow10_u64[nd])) {
+        nd++;
       }
-      flags |= FLAGS_PRECISION;   // make sure _ftoa respects precision
-      // no characters in exponent
-      minwidth = 0U;
-      expval   = 0;
+      // place the digits into limbs, the digit of weight 10^w goes to limb ip - 1 - floor(w / 9)
+      const int top = exp10 + nd - 1;
+      dec.ip = _fp_floor9(top) + 1;
+      dec.n  = dec.ip - _fp_floor9(exp10);
+      dec.sticky = false;
+      memset(dec.limb, 0, (size_t)dec.n * sizeof(uint32_t));
+      for (int w = exp10; digits; w++, digits /= 10U) {
+        const int l = _fp_floor9(w);
+        dec.limb[dec.ip - 1 - l] += (uint32_t)(digits % 10U) * _pow10_u32[w - 9 * l];
+      }
+      prec = (unsigned int)nd;
+      exp10 = top;
     }
     else {
-      // we use one sigfig for the whole part
-      if ((prec > 0) && (flags & FLAGS_PRECISION)) {
-        --prec;
-      }
+      _fp_zero(&dec);
+      prec = 1U;
     }
+    const int limit = single ? 9 : 17;
+    if ((exp10 < -4) || (exp10 >= limit)) {
+      return _fp_out(out, buffer, idx, maxlen, &dec, negative, true, (int)prec, width, flags);
+    }
+    return _fp_out(out, buffer, idx, maxlen, &dec, negative, false, ((int)prec - 1 - exp10 > 0) ? (int)prec - 1 - exp10 : 0, width, flags);
   }
 
-  // will everything fit?
-  unsigned int fwidth = width;
-  if (width > minwidth) {
-    // we didn't fall-back so subtract the characters required for the exponent
-    fwidth -= minwidth;
-  } else {
-    // not enough characters, so go back to default sizing
-    fwidth = 0U;
+  // significant digits
+  if (!(flags & FLAGS_PRECISION)) {
+    prec = PRINTF_DEFAULT_FLOAT_PRECISION;
   }
-  if ((flags & FLAGS_LEFT) && minwidth) {
-    // if we're padding on the right, DON'T pad the floating part
-    fwidth = 0U;
+  int sig = (int)prec + 1;
+  if (flags & FLAGS_ADAPT_EXP) {
+    // in "%g" mode, "prec" is the number of *significant figures* not decimals
+    sig = prec ? (int)prec : 1;
   }
 
-  // rescale the float value
-  if (expval) {
-    value /= conv.F;
+  if (m) {
+    _fp_dec(&dec, m, e2, 0x7FFF, (sig + 9) / 9 + 1);
+    _fp_round(&dec, 9 - _fp_ndigits(dec.limb[0]) + sig);
+  }
+  else {
+    _fp_zero(&dec);
   }
 
-  // output the floating part
-  const size_t start_idx = idx;
-  idx = _ftoa(out, buffer, idx, maxlen, negative ? -value : value, prec, fwidth, flags & ~FLAGS_ADAPT_EXP);
-
-  // output the exponent part
-  if (minwidth) {
-    // output the exponential symbol
-    out((flags & FLAGS_UPPERCASE) ? 'E' : 'e', buffer, idx++, maxlen);
-    // output the exponent value
-    idx = _ntoa_long(out, buffer, idx, maxlen, (expval < 0) ? -expval : expval, expval < 0, 10, 0, minwidth-1, FLAGS_ZEROPAD | FLAGS_PLUS);
-    // might need to right-pad spaces
-    if (flags & FLAGS_LEFT) {
-      while (idx - start_idx < width) out(' ', buffer, idx++, maxlen);
+  if (flags & FLAGS_ADAPT_EXP) {
+    // fall back to "%f" style if the exponent is in [-4, sig)
+    const int expv = 9 * (dec.ip - 1) + _fp_ndigits(dec.limb[0]) - 1;
+    if ((expv >= -4) && (expv < sig)) {
+      return _fp_out(out, buffer, idx, maxlen, &dec, negative, false, sig - 1 - expv, width, flags);
     }
   }
-  return idx;
+  return _fp_out(out, buffer, idx, maxlen, &dec, negative, true, sig, width, flags);
 }
 #endif  // PRINTF_SUPPORT_EXPONENTIAL
 #endif  // PRINTF_SUPPORT_FLOAT
 
 
-// internal vsnprintf
-static int _vsnprintf(out_fct_type out, char* buffer, const size_t maxlen, const char* format, va_list va)
+// parse flags, width, precision and length of one specifier, format points behind the '%'
+// returns the position of the conversion character, '*' fields are only marked in the flags
+static const char* _parse_spec(const char* format, unsigned int* pflags, unsigned int* pwidth, unsigned int* pprecision)
 {
   unsigned int flags, width, precision, n;
-  size_t idx = 0U;
-
-  if (!buffer) {
-    // use null output function
-    out = _out_null;
-  }
 
-  while (*format)
-  {
-    // format specifier?  %[flags][width][.precision][length]
-    if (*format != '%') {
-      // no
-      out(*format, buffer, idx++, maxlen);
-      format++;
-      continue;
-    }
-    else {
-      // yes, evaluate it
-      format++;
+  // evaluate flags
+  flags = 0U;
+  do {
+    switch (*format) {
+      case '0': flags |= FLAGS_ZEROPAD; format++; n = 1U; break;
+      case '-': flags |= FLAGS_LEFT;    format++; n = 1U; break;
+      case '+': flags |= FLAGS_PLUS;    format++; n = 1U; break;
+      case ' ': flags |= FLAGS_SPACE;   format++; n = 1U; break;
+      case '#': flags |= FLAGS_HASH;    format++; n = 1U; break;
+      default :                                   n = 0U; break;
     }
+  } while (n);
 
-    // evaluate flags
-    flags = 0U;
-    do {
-      switch (*format) {
-        case '0': flags |= FLAGS_ZEROPAD; format++; n = 1U; break;
-        case '-': flags |= FLAGS_LEFT;    format++; n = 1U; break;
-        case '+': flags |= FLAGS_PLUS;    format++; n = 1U; break;
-        case ' ': flags |= FLAGS_SPACE;   format++; n = 1U; break;
-        case '#': flags |= FLAGS_HASH;    format++; n = 1U; break;
-        default :                                   n = 0U; break;
-      }
-    } while (n);
+  // evaluate width field
+  width = 0U;
+  if (_is_digit(*format)) {
+    width = _atoi(&format);
+  }
+  else if (*format == '*') {
+    flags |= FLAGS_WIDTH_ARG;
+    format++;
+  }
 
-    // evaluate width field
-    width = 0U;
+  // evaluate precision field
+  precision = 0U;
+  if (*format == '.') {
+    flags |= FLAGS_PRECISION;
+    format++;
     if (_is_digit(*format)) {
-      width = _atoi(&format);
+      precision = _atoi(&format);
     }
     else if (*format == '*') {
-      const int w = va_arg(va, int);
-      if (w < 0) {
-        flags |= FLAGS_LEFT;    // reverse padding
-        width = (unsigned int)-w;
-      }
-      else {
-        width = (unsigned int)w;
-      }
+      flags |= FLAGS_PREC_ARG;
       format++;
     }
+  }
 
-    // evaluate precision field
-    precision = 0U;
-    if (*format == '.') {
-      flags |= FLAGS_PRECISION;
+  // evaluate length field
+  switch (*format) {
+    case 'l' :
+      flags |= FLAGS_LONG;
       format++;
-      if (_is_digit(*format)) {
-        precision = _atoi(&format);
-      }
-      else if (*format == '*') {
-        const int prec = (int)va_arg(va, int);
-        precision = prec > 0 ? (unsigned int)prec : 0U;
+      if (*format == 'l') {
+        flags |= FLAGS_LONG_LONG;
         format++;
       }
-    }
-
-    // evaluate length field
-    switch (*format) {
-      case 'l' :
-        flags |= FLAGS_LONG;
-        format++;
-        if (*format == 'l') {
-          flags |= FLAGS_LONG_LONG;
-          format++;
-        }
-        break;
-      case 'h' :
-        flags |= FLAGS_SHORT;
+      break;
+    case 'h' :
+      flags |= FLAGS_SHORT;
+      format++;
+      if (*format == 'h') {
+        flags |= FLAGS_CHAR;
         format++;
-        if (*format == 'h') {
-          flags |= FLAGS_CHAR;
-          format++;
-        }
-        break;
+      }
+      break;
 #if defined(PRINTF_SUPPORT_PTRDIFF_T)
-      case 't' :
-        flags |= (sizeof(ptrdiff_t) == sizeof(long) ? FLAGS_LONG : FLAGS_LONG_LONG);
-        format++;
-        break;
+    case 't' :
+      flags |= (sizeof(ptrdiff_t) == sizeof(long) ? FLAGS_LONG : FLAGS_LONG_LONG);
+      format++;
+      break;
 #endif
-      case 'j' :
-        flags |= (sizeof(intmax_t) == sizeof(long) ? FLAGS_LONG : FLAGS_LONG_LONG);
-        format++;
-        break;
-      case 'z' :
-        flags |= (sizeof(size_t) == sizeof(long) ? FLAGS_LONG : FLAGS_LONG_LONG);
-        format++;
-        break;
-      default :
-        break;
+    case 'j' :
+      flags |= (sizeof(intmax_t) == sizeof(long) ? FLAGS_LONG : FLAGS_LONG_LONG);
+      format++;
+      break;
+    case 'z' :
+      flags |= (sizeof(size_t) == sizeof(long) ? FLAGS_LONG : FLAGS_LONG_LONG);
+      format++;
+      break;
+    default :
+      break;
+  }
+
+  *pflags     = flags;
+  *pwidth     = width;
+  *pprecision = precision;
+  return format;
+}
+
+
+// fetch '*' width and precision from the argument list
+static inline void _spec_args(unsigned int* flags, unsigned int* width, unsigned int* precision, va_list* va)
+{
+  if (*flags & FLAGS_WIDTH_ARG) {
+    const int w = va_arg(*va, int);
+    if (w < 0) {
+      *flags |= FLAGS_LEFT;    // reverse padding
+      *width = (unsigned int)-w;
+    }
+    else {
+      *width = (unsigned int)w;
     }
+  }
+  if (*flags & FLAGS_PREC_ARG) {
+    const int prec = (int)va_arg(*va, int);
+    *precision = prec > 0 ? (unsigned int)prec : 0U;
+  }
+}
 
-    // evaluate specifier
-    switch (*format) {
-      case 'd' :
-      case 'i' :
-      case 'u' :
-      case 'x' :
-      case 'X' :
-      case 'o' :
-      case 'b' : {
-        // set the base
-        unsigned int base;
-        if (*format == 'x' || *format == 'X') {
-          base = 16U;
-        }
-        else if (*format == 'o') {
-          base =  8U;
-        }
-        else if (*format == 'b') {
-          base =  2U;
-        }
-        else {
-          base = 10U;
-          flags &= ~FLAGS_HASH;   // no hash for dec format
-        }
-        // uppercase
-        if (*format == 'X') {
-          flags |= FLAGS_UPPERCASE;
-        }
 
-        // no plus or space flag for u, x, X, o, b
-        if ((*format != 'i') && (*format != 'd')) {
-          flags &= ~(FLAGS_PLUS | FLAGS_SPACE);
-        }
+// format one argument for the conversion character spec
+static size_t _format_arg(out_fct_type out, char* buffer, size_t idx, size_t maxlen, char spec, unsigned int flags, unsigned int width, unsigned int precision, va_list* va)
+{
+  switch (spec) {
+    case 'd' :
+    case 'i' :
+    case 'u' :
+    case 'x' :
+    case 'X' :
+    case 'o' :
+    case 'b' : {
+      // set the base
+      unsigned int base;
+      if (spec == 'x' || spec == 'X') {
+        base = 16U;
+      }
+      else if (spec == 'o') {
+        base =  8U;
+      }
+      else if (spec == 'b') {
+        base =  2U;
+      }
+      else {
+        base = 10U;
+        flags &= ~FLAGS_HASH;   // no hash for dec format
+      }
+      // uppercase
+      if (spec == 'X') {
+        flags |= FLAGS_UPPERCASE;
+      }
 
-        // ignore '0' flag when precision is given
-        if (flags & FLAGS_PRECISION) {
-          flags &= ~FLAGS_ZEROPAD;
-        }
+      // no plus or space flag for u, x, X, o, b
+      if ((spec != 'i') && (spec != 'd')) {
+        flags &= ~(FLAGS_PLUS | FLAGS_SPACE);
+      }
 
-        // convert the integer
-        if ((*format == 'i') || (*format == 'd')) {
-          // signed
-          if (flags & FLAGS_LONG_LONG) {
+      // ignore '0' flag when precision is given
+      if (flags & FLAGS_PRECISION) {
+        flags &= ~FLAGS_ZEROPAD;
+      }
+
+      // convert the integer
+      if ((spec == 'i') || (spec == 'd')) {
+        // signed
+        if (flags & FLAGS_LONG_LONG) {
 #if defined(PRINTF_SUPPORT_LONG_LONG)
-            const long long value = va_arg(va, long long);
-            idx = _ntoa_long_long(out, buffer, idx, maxlen, (unsigned long long)(value > 0 ? value : 0 - value), value < 0, base, precision, width, flags);
+          const long long value = va_arg(*va, long long);
+          idx = _ntoa_long_long(out, buffer, idx, maxlen, (unsigned long long)(value > 0 ? value : 0 - value), value < 0, base, precision, width, flags);
 #endif
-          }
-          else if (flags & FLAGS_LONG) {
-            const long value = va_arg(va, long);
-            idx = _ntoa_long(out, buffer, idx, maxlen, (unsigned long)(value > 0 ? value : 0 - value), value < 0, base, precision, width, flags);
-          }
-          else {
-            const int value = (flags & FLAGS_CHAR) ? (char)va_arg(va, int) : (flags & FLAGS_SHORT) ? (short int)va_arg(va, int) : va_arg(va, int);
-            idx = _ntoa_long(out, buffer, idx, maxlen, (unsigned int)(value > 0 ? value : 0 - value), value < 0, base, precision, width, flags);
-          }
+        }
+        else if (flags & FLAGS_LONG) {
+          const long value = va_arg(*va, long);
+          idx = _ntoa_long(out, buffer, idx, maxlen, (unsigned long)(value > 0 ? value : 0 - value), value < 0, base, precision, width, flags);
         }
         else {
-          // unsigned
-          if (flags & FLAGS_LONG_LONG) {
+          const int value = (flags & FLAGS_CHAR) ? (char)va_arg(*va, int) : (flags & FLAGS_SHORT) ? (short int)va_arg(*va, int) : va_arg(*va, int);
+          idx = _ntoa_long(out, buffer, idx, maxlen, (unsigned int)(value > 0 ? value : 0 - value), value < 0, base, precision, width, flags);
+        }
+      }
+      else {
+        // unsigned
+        if (flags & FLAGS_LONG_LONG) {
 #if defined(PRINTF_SUPPORT_LONG_LONG)
-            idx = _ntoa_long_long(out, buffer, idx, maxlen, va_arg(va, unsigned long long), false, base, precision, width, flags);
+          idx = _ntoa_long_long(out, buffer, idx, maxlen, va_arg(*va, unsigned long long), false, base, precision, width, flags);
 #endif
-          }
-          else if (flags & FLAGS_LONG) {
-            idx = _ntoa_long(out, buffer, idx, maxlen, va_arg(va, unsigned long), false, base, precision, width, flags);
-          }
-          else {
-            const unsigned int value = (flags & FLAGS_CHAR) ? (unsigned char)va_arg(va, unsigned int) : (flags & FLAGS_SHORT) ? (unsigned short int)va_arg(va, unsigned int) : va_arg(va, unsigned int);
-            idx = _ntoa_long(out, buffer, idx, maxlen, value, false, base, precision, width, flags);
-          }
         }
-        format++;
-        break;
+        else if (flags & FLAGS_LONG) {
+          idx = _ntoa_long(out, buffer, idx, maxlen, va_arg(*va, unsigned long), false, base, precision, width, flags);
+        }
+        else {
+          const unsigned int value = (flags & FLAGS_CHAR) ? (unsigned char)va_arg(*va, unsigned int) : (flags & FLAGS_SHORT) ? (unsigned short int)va_arg(*va, unsigned int) : va_arg(*va, unsigned int);
+          idx = _ntoa_long(out, buffer, idx, maxlen, value, false, base, precision, width, flags);
+        }
       }
+      break;
+    }
 #if defined(PRINTF_SUPPORT_FLOAT)
-      case 'f' :
-      case 'F' :
-        if (*format == 'F') flags |= FLAGS_UPPERCASE;
-        idx = _ftoa(out, buffer, idx, maxlen, va_arg(va, double), precision, width, flags);
-        format++;
-        break;
+    case 'f' :
+    case 'F' :
+      if (spec == 'F') flags |= FLAGS_UPPERCASE;
+      idx = _ftoa(out, buffer, idx, maxlen, va_arg(*va, double), precision, width, flags);
+      break;
 #if defined(PRINTF_SUPPORT_EXPONENTIAL)
-      case 'e':
-      case 'E':
-      case 'g':
-      case 'G':
-        if ((*format == 'g')||(*format == 'G')) flags |= FLAGS_ADAPT_EXP;
-        if ((*format == 'E')||(*format == 'G')) flags |= FLAGS_UPPERCASE;
-        idx = _etoa(out, buffer, idx, maxlen, va_arg(va, double), precision, width, flags);
-        format++;
-        break;
+    case 'e':
+    case 'E':
+    case 'g':
+    case 'G':
+      if ((spec == 'g')||(spec == 'G')) flags |= FLAGS_ADAPT_EXP;
+      if ((spec == 'E')||(spec == 'G')) flags |= FLAGS_UPPERCASE;
+      idx = _etoa(out, buffer, idx, maxlen, va_arg(*va, double), precision, width, flags);
+      break;
+    case 'r':
+    case 'R':
+      // shortest round-trip, %hr round-trips through float
+      flags |= FLAGS_ROUNDTRIP;
+      if (spec == 'R') flags |= FLAGS_UPPERCASE;
+      idx = _etoa(out, buffer, idx, maxlen, va_arg(*va, double), precision, width, flags);
+      break;
 #endif  // PRINTF_SUPPORT_EXPONENTIAL
 #endif  // PRINTF_SUPPORT_FLOAT
-      case 'c' : {
-        unsigned int l = 1U;
-        // pre padding
-        if (!(flags & FLAGS_LEFT)) {
-          while (l++ < width) {
-            out(' ', buffer, idx++, maxlen);
-          }
-        }
-        // char output
-        out((char)va_arg(va, int), buffer, idx++, maxlen);
-        // post padding
-        if (flags & FLAGS_LEFT) {
-          while (l++ < width) {
-            out(' ', buffer, idx++, maxlen);
-          }
-        }
-        format++;
-        break;
+    case 'c' : {
+      // pre padding
+      if (!(flags & FLAGS_LEFT) && (width > 1U)) {
+        idx = _out_fill(out, buffer, idx, maxlen, ' ', width - 1U);
       }
+      // char output
+      out((char)va_arg(*va, int), buffer, idx++, maxlen);
+      // post padding
+      if ((flags & FLAGS_LEFT) && (width > 1U)) {
+        idx = _out_fill(out, buffer, idx, maxlen, ' ', width - 1U);
+      }
+      break;
+    }
 
-      case 's' : {
-        const char* p = va_arg(va, char*);
-        unsigned int l = _strnlen_s(p, precision ? precision : (size_t)-1);
-        // pre padding
-        if (flags & FLAGS_PRECISION) {
-          l = (l < precision ? l : precision);
-        }
-        if (!(flags & FLAGS_LEFT)) {
-          while (l++ < width) {
-            out(' ', buffer, idx++, maxlen);
-          }
-        }
-        // string output
-        while ((*p != 0) && (!(flags & FLAGS_PRECISION) || precision--)) {
-          out(*(p++), buffer, idx++, maxlen);
-        }
-        // post padding
-        if (flags & FLAGS_LEFT) {
-          while (l++ < width) {
-            out(' ', buffer, idx++, maxlen);
-          }
-        }
-        format++;
-        break;
+    case 's' : {
+      const char* p = va_arg(*va, char*);
+      unsigned int l = _strnlen_s(p, precision ? precision : (size_t)-1);
+      if (flags & FLAGS_PRECISION) {
+        l = (l < precision ? l : precision);
+      }
+      // pre padding
+      if (!(flags & FLAGS_LEFT) && (l < width)) {
+        idx = _out_fill(out, buffer, idx, maxlen, ' ', width - l);
+      }
+      // string output
+      idx = _out_span(out, buffer, idx, maxlen, p, l);
+      // post padding
+      if ((flags & FLAGS_LEFT) && (l < width)) {
+        idx = _out_fill(out, buffer, idx, maxlen, ' ', width - l);
       }
+      break;
+    }
 
-      case 'p' : {
-        width = sizeof(void*) * 2U;
-        flags |= FLAGS_ZEROPAD | FLAGS_UPPERCASE;
+    case 'p' : {
+      width = sizeof(void*) * 2U;
+      flags |= FLAGS_ZEROPAD | FLAGS_UPPERCASE;
 #if defined(PRINTF_SUPPORT_LONG_LONG)
-        const bool is_ll = sizeof(uintptr_t) == sizeof(long long);
-        if (is_ll) {
-          idx = _ntoa_long_long(out, buffer, idx, maxlen, (uintptr_t)va_arg(va, void*), false, 16U, precision, width, flags);
-        }
-        else {
+      const bool is_ll = sizeof(uintptr_t) == sizeof(long long);
+      if (is_ll) {
+        idx = _ntoa_long_long(out, buffer, idx, maxlen, (uintptr_t)va_arg(*va, void*), false, 16U, precision, width, flags);
+      }
+      else {
 #endif
-          idx = _ntoa_long(out, buffer, idx, maxlen, (unsigned long)((uintptr_t)va_arg(va, void*)), false, 16U, precision, width, flags);
+        idx = _ntoa_long(out, buffer, idx, maxlen, (unsigned long)((uintptr_t)va_arg(*va, void*)), false, 16U, precision, width, flags);
 #if defined(PRINTF_SUPPORT_LONG_LONG)
-        }
+      }
 #endif
+      break;
+    }
+
+    case '%' :
+      out('%', buffer, idx++, maxlen);
+      break;
+
+    default :
+      out(spec, buffer, idx++, maxlen);
+      break;
+  }
+  return idx;
+}
+
+
+// internal vsnprintf
+static int _vsnprintf(out_fct_type out, char* buffer, const size_t maxlen, const char* format, va_list va)
+{
+  unsigned int flags, width, precision;
+  size_t idx = 0U;
+  va_list ap;
+
+  if (!buffer) {
+    // use null output function
+    out = _out_null;
+  }
+
+  va_copy(ap, va);
+  while (*format)
+  {
+    // format specifier?  %[flags][width][.precision][length]
+    if (*format != '%') {
+      // no, emit the whole literal run up to the next specifier
+      const char* run = format;
+      while (*format && (*format != '%')) {
         format++;
-        break;
       }
+      idx = _out_span(out, buffer, idx, maxlen, run, (size_t)(format - run));
+      continue;
+    }
 
-      case '%' :
-        out('%', buffer, idx++, maxlen);
-        format++;
-        break;
+    // yes, evaluate it
+    format = _parse_spec(format + 1, &flags, &width, &precision);
+    if (!*format) {
+      break;    // lone '%' at the end
+    }
+    _spec_args(&flags, &width, &precision, &ap);
+    idx = _format_arg(out, buffer, idx, maxlen, *format++, flags, width, precision, &ap);
+  }
+  va_end(ap);
 
-      default :
-        out(*format, buffer, idx++, maxlen);
+  // termination
+  out((char)0, buffer, idx < maxlen ? idx : maxlen - 1U, maxlen);
+
+  // return written chars without terminating \0
+  return (int)idx;
+}
+
+
+// compiled format states
+#define PRINTF_FMT_NEW       0U   // not parsed yet
+#define PRINTF_FMT_COMPILED  1U   // op[] is valid
+#define PRINTF_FMT_PLAIN     2U   // did not fit op[], always use _vsnprintf
+
+
+// translate fmt->format into opcodes, on first use
+// concurrent first calls write identical opcodes, state is published last
+static void _compile(printf_fmt_t* fmt)
+{
+  const char* format = fmt->format;
+  unsigned int flags, width, precision, n = 0U;
+  uint8_t state = PRINTF_FMT_COMPILED;
+
+  while (*format) {
+    if (n >= PRINTF_COMPILED_MAX_OPS) {
+      state = PRINTF_FMT_PLAIN;
+      break;
+    }
+    printf_op_t* op = &fmt->op[n];
+
+    if (*format != '%') {
+      const char* run = format;
+      while (*format && (*format != '%')) {
         format++;
+      }
+      if (((size_t)(run - fmt->format) > 0xFFFFU) || ((size_t)(format - run) > 0xFFFFU)) {
+        state = PRINTF_FMT_PLAIN;
         break;
+      }
+      op->spec  = '\0';
+      op->flags = 0U;
+      op->arg0  = (uint16_t)(run - fmt->format);
+      op->arg1  = (uint16_t)(format - run);
+      n++;
+      continue;
+    }
+
+    format = _parse_spec(format + 1, &flags, &width, &precision);
+    if (!*format) {
+      break;    // lone '%' at the end
+    }
+    if ((width > 0xFFFFU) || (precision > 0xFFFFU)) {
+      state = PRINTF_FMT_PLAIN;
+      break;
+    }
+    op->spec  = *format++;
+    op->flags = (uint16_t)flags;
+    op->arg0  = (uint16_t)width;
+    op->arg1  = (uint16_t)precision;
+    n++;
+  }
+
+  fmt->count = (uint8_t)n;
+  // op[] and count are plain stores, keep the compiler from sinking them below the publish
+  __asm volatile("" ::: "memory");
+  fmt->state = state;
+}
+
+
+// internal vsnprintf for pre-parsed formats
+static int _vsnprintf_compiled(out_fct_type out, char* buffer, const size_t maxlen, printf_fmt_t* fmt, va_list va)
+{
+  size_t idx = 0U;
+  va_list ap;
+
+  if (fmt->state == PRINTF_FMT_NEW) {
+    _compile(fmt);
+  }
+  if (fmt->state != PRINTF_FMT_COMPILED) {
+    return _vsnprintf(out, buffer, maxlen, fmt->format, va);
+  }
+
+  if (!buffer) {
+    // use null output function
+    out = _out_null;
+  }
+
+  va_copy(ap, va);
+  for (unsigned int i = 0U; i < fmt->count; i++) {
+    const printf_op_t* op = &fmt->op[i];
+    if (!op->spec) {
+      idx = _out_span(out, buffer, idx, maxlen, fmt->format + op->arg0, op->arg1);
+      continue;
     }
+    unsigned int flags = op->flags, width = op->arg0, precision = op->arg1;
+    _spec_args(&flags, &width, &precision, &ap);
+    idx = _format_arg(out, buffer, idx, maxlen, op->spec, flags, width, precision, &ap);
   }
+  va_end(ap);
 
   // termination
   out((char)0, buffer, idx < maxlen ? idx : maxlen - 1U, maxlen);
@@ -912,3 +1636,58 @@ int fctprintf(void (*out)(char character, void* arg), void* arg, const char* for
   va_end(va);
   return ret;
 }
+
+
+int vspanprintf(void (*out)(const char* data, size_t len, void* arg), void* arg, const char* format, va_list va)
+{
+  const out_span_wrap_type out_span_wrap = { out, arg };
+  return _vsnprintf(_out_span_fct, (char*)(uintptr_t)&out_span_wrap, (size_t)-1, format, va);
+}
+
+
+int spanprintf(void (*out)(const char* data, size_t len, void* arg), void* arg, const char* format, ...)
+{
+  va_list va;
+  va_start(va, format);
+  const int ret = vspanprintf(out, arg, format, va);
+  va_end(va);
+  return ret;
+}
+
+
+int printf_compiled(printf_fmt_t* fmt, ...)
+{
+  va_list va;
+  va_start(va, fmt);
+  char buffer[1];
+  const int ret = _vsnprintf_compiled(_out_char, buffer, (size_t)-1, fmt, va);
+  va_end(va);
+  return ret;
+}
+
+
+int snprintf_compiled(char* buffer, size_t count, printf_fmt_t* fmt, ...)
+{
+  va_list va;
+  va_start(va, fmt);
+  const int ret = _vsnprintf_compiled(_out_buffer, buffer, count, fmt, va);
+  va_end(va);
+  return ret;
+}
+
+
+int vsnprintf_compiled(char* buffer, size_t count, printf_fmt_t* fmt, va_list va)
+{
+  return _vsnprintf_compiled(_out_buffer, buffer, count, fmt, va);
+}
+
+
+int spanprintf_compiled(void (*out)(const char* data, size_t len, void* arg), void* arg, printf_fmt_t* fmt, ...)
+{
+  va_list va;
+  va_start(va, fmt);
+  const out_span_wrap_type out_span_wrap = { out, arg };
+  const int ret = _vsnprintf_compiled(_out_span_fct, (char*)(uintptr_t)&out_span_wrap, (size_t)-1, fmt, va);
+  va_end(va);
+  return ret;
+}
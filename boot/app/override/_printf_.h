@@ -34,6 +34,7 @@
 
 #include <stdarg.h>
 #include <stddef.h>
+#include <stdint.h>
 
 
 #ifdef __cplusplus
@@ -49,11 +50,24 @@ extern "C" {
 void _putchar(char character);
 
 
+/**
+ * Output a run of characters, used by the printf() function for literal text, numbers and padding
+ * A weak default calling _putchar() for each character is provided, override it when the device
+ * can take whole runs at once (e.g. a DMA-backed console)
+ * \param data Characters to output, not null terminated
+ * \param len Number of characters
+ */
+void _putchars(const char* data, size_t len);
+
+
 /**
  * Tiny printf implementation
  * You have to implement _putchar if you use printf()
  * To avoid conflicts with the regular printf() API it is overridden by macro defines
  * and internal underscore-appended functions like printf_() are used
+ * %f, %e and %g are exact and rounded like glibc. The extra %r (%R) conversion prints the shortest
+ * digits that read back to the same double, laid out like %.17g; %hr does the same for a float
+ * argument and falls back to %r if the value is not a float
  * \param format A string that specifies the format of the output
  * \return The number of characters that are written into the array, not counting the terminating null character
  */
@@ -109,6 +123,92 @@ int vprintf_(const char* format, va_list va);
 int fctprintf(void (*out)(char character, void* arg), void* arg, const char* format, ...);
 
 
+/**
+ * printf with span output function
+ * Like fctprintf(), but literal text, converted numbers and padding are passed as (pointer, length) runs
+ * \param out An output function which takes a run of characters, its length and an argument pointer
+ * \param arg An argument pointer for user data passed to output function
+ * \param format A string that specifies the format of the output
+ * \return The number of characters that are sent to the output function, not counting the terminating null character
+ */
+int spanprintf(void (*out)(const char* data, size_t len, void* arg), void* arg, const char* format, ...);
+int vspanprintf(void (*out)(const char* data, size_t len, void* arg), void* arg, const char* format, va_list va);
+
+
+// opcodes per pre-parsed format (one per literal run or conversion), longer formats fall back
+// to the plain parser
+// default: 12
+#ifndef PRINTF_COMPILED_MAX_OPS
+#define PRINTF_COMPILED_MAX_OPS  12U
+#endif
+
+/**
+ * One pre-parsed piece of a format string, filled in by the library
+ */
+typedef struct {
+  uint16_t arg0;      // literal offset or width
+  uint16_t arg1;      // literal length or precision
+  uint16_t flags;
+  char     spec;      // conversion character, 0 for a literal run
+  uint8_t  reserved;
+} printf_op_t;
+
+/**
+ * Pre-parsed format string, define one static instance per call site with PRINTF_FMT_INIT()
+ * The format is parsed into op[] on the first call, later calls skip flag/width/precision parsing
+ */
+typedef struct {
+  const char*      format;
+  volatile uint8_t state;
+  uint8_t          count;
+  printf_op_t      op[PRINTF_COMPILED_MAX_OPS];
+} printf_fmt_t;
+
+#define PRINTF_FMT_INIT(format)  { (format), 0U, 0U, { { 0U, 0U, 0U, '\0', 0U } } }
+
+
+/**
+ * printf, sprintf and span output for pre-parsed formats
+ * The descriptor carries the format, so these cannot be checked by the compiler; use the
+ * PRINTF_C() / SNPRINTF_C() macros below which check the arguments with printf_check()
+ * \param fmt Pre-parsed format, see printf_fmt_t
+ * \return The number of characters written, not counting the terminating null character
+ */
+int printf_compiled(printf_fmt_t* fmt, ...);
+int snprintf_compiled(char* buffer, size_t count, printf_fmt_t* fmt, ...);
+int vsnprintf_compiled(char* buffer, size_t count, printf_fmt_t* fmt, va_list va);
+int spanprintf_compiled(void (*out)(const char* data, size_t len, void* arg), void* arg, printf_fmt_t* fmt, ...);
+
+
+/**
+ * Never called, lets the compiler check a format string against its arguments (-Wformat)
+ * Note that the non-standard %r conversion is reported as unknown
+ */
+#if defined(__GNUC__)
+static inline __attribute__((format(printf, 1, 2))) void printf_check(const char* format, ...)
+{
+  (void)format;
+}
+
+/**
+ * printf / snprintf with a per call site pre-parsed format, format must be a string literal
+ */
+#define PRINTF_C(format, ...)                                       \
+  __extension__ ({                                                  \
+    static printf_fmt_t _printf_fmt = PRINTF_FMT_INIT(format);      \
+    if (0) printf_check(format, ##__VA_ARGS__);                     \
+    printf_compiled(&_printf_fmt, ##__VA_ARGS__);                   \
+  })
+
+#define SNPRINTF_C(buffer, count, format, ...)                              \
+  __extension__ ({                                                          \
+    static printf_fmt_t _printf_fmt = PRINTF_FMT_INIT(format);              \
+    if (0) printf_check(format, ##__VA_ARGS__);                             \
+    snprintf_compiled((buffer), (count), &_printf_fmt, ##__VA_ARGS__);      \
+  })
+#endif
+
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,7 +1,14 @@
 #include "main.h"
+#include "_printf_.h"
+#include "console.h"
 
 
 void _putchar(char character)
 {
+    console_putc(character);
+}
 
+void _putchars(const char* data, size_t len)
+{
+    console_write(data, len);
 }
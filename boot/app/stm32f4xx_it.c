@@ -23,6 +23,11 @@
 /* Includes ------------------------------------------------------------------*/
 #include "stm32f4xx_it.h"
 #include "main.h"
+#include "os.h"
+#include "usart.h"
+#include "console.h"
+#include "verify.h"
+#include "power.h"
 
 /** @addtogroup Template_Project
   * @{
@@ -100,14 +105,7 @@ void UsageFault_Handler(void)
   }
 }
 
-/**
-  * @brief  This function handles SVCall exception.
-  * @param  None
-  * @retval None
-  */
-void SVC_Handler(void)
-{
-}
+/* SVC_Handler 由 boot/os 的 RTOS 后端实现 */
 
 /**
   * @brief  This function handles Debug Monitor exception.
@@ -118,14 +116,7 @@ void DebugMon_Handler(void)
 {
 }
 
-/**
-  * @brief  This function handles PendSVC exception.
-  * @param  None
-  * @retval None
-  */
-void PendSV_Handler(void)
-{
-}
+/* PendSV_Handler 由 boot/os 的 RTOS 后端实现 */
 
 /**
   * @brief  This function handles SysTick Handler.
@@ -134,7 +125,8 @@ void PendSV_Handler(void)
   */
 void SysTick_Handler(void)
 {
-  
+  os_tick_handler();
+  console_tick();
 }
 
 /******************************************************************************/
@@ -153,6 +145,71 @@ void SysTick_Handler(void)
 {
 }*/
 
+/**
+  * @brief  USART interrupt handlers, forwarded to the usart driver.
+  * @param  None
+  * @retval None
+  */
+void USART1_IRQHandler(void)
+{
+  usart_IRQHandler(USART_1);
+}
+
+void USART2_IRQHandler(void)
+{
+  usart_IRQHandler(USART_2);
+}
+
+void USART3_IRQHandler(void)
+{
+  usart_IRQHandler(USART_3);
+}
+
+void UART4_IRQHandler(void)
+{
+  usart_IRQHandler(UART_4);
+}
+
+void UART5_IRQHandler(void)
+{
+  usart_IRQHandler(UART_5);
+}
+
+void USART6_IRQHandler(void)
+{
+  usart_IRQHandler(USART_6);
+}
+
+/**
+  * @brief  This function handles DMA2 Stream0 (image CRC) interrupt request.
+  * @param  None
+  * @retval None
+  */
+void DMA2_Stream0_IRQHandler(void)
+{
+  verify_dma_irq();
+}
+
+/**
+  * @brief  This function handles DMA2 Stream7 (USART1 TX) interrupt request.
+  * @param  None
+  * @retval None
+  */
+void DMA2_Stream7_IRQHandler(void)
+{
+  console_dma_tx_irq();
+}
+
+/**
+  * @brief  This function handles EXTI line 10-15 (USART1 RX wakeup) interrupt request.
+  * @param  None
+  * @retval None
+  */
+void EXTI15_10_IRQHandler(void)
+{
+  power_exti_irq();
+}
+
 /**
   * @}
   */ 
@@ -1,8 +1,8 @@
 #include "dma.h"
 void DMA2_USART1_Tx_Init(uint8_t *tx_buffer, uint32_t data_length)
 {
-    /* Enable DMA1 clock */
-    RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_DMA1, ENABLE);
+    /* Enable DMA2 clock */
+    RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_DMA2, ENABLE);
 
     /* Deinitialize DMA2 Stream 7 */
     DMA_DeInit(DMA2_Stream7);
@@ -12,7 +12,7 @@ void DMA2_USART1_Tx_Init(uint8_t *tx_buffer, uint32_t data_length)
     DMA_InitStructure.DMA_Channel = DMA_Channel_4; //
     DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)&(USART1->DR);
     DMA_InitStructure.DMA_Memory0BaseAddr = (uint32_t)tx_buffer;
-    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralToMemory;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_MemoryToPeripheral;
     DMA_InitStructure.DMA_BufferSize = data_length;
     DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
     DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
@@ -35,6 +35,9 @@ void DMA2_USART1_Tx_Start(uint8_t *tx_buffer, uint32_t data_length)
 {
     while (DMA_GetCmdStatus(DMA2_Stream7) != DISABLE)
         ;
+    /* 清除上次传输的标志位，否则TC中断会立即触发 */
+    DMA_ClearFlag(DMA2_Stream7, DMA_FLAG_TCIF7 | DMA_FLAG_HTIF7 | DMA_FLAG_TEIF7 | DMA_FLAG_DMEIF7 | DMA_FLAG_FEIF7);
+
     /* 重新配置内存地址和数据长度 */
     DMA2_Stream7->M0AR = (uint32_t)tx_buffer;
     DMA2_Stream7->NDTR = data_length;
@@ -0,0 +1,256 @@
+#include "stm32f4xx.h"
+#include "os.h"
+#include "log.h"
+#include "flash.h"
+#include "clock.h"
+
+
+#define CLOCK_PLLCFGR(m, n, p, q)   ((m) | ((n) << 6) | ((((p) >> 1) - 1U) << 16) | \
+                                     RCC_PLLCFGR_PLLSRC_HSE | ((q) << 24))
+#define CLOCK_CFGR_DIV              (RCC_CFGR_HPRE | RCC_CFGR_PPRE1 | RCC_CFGR_PPRE2)
+
+// DBGMCU_IDCODE 的 DEV_ID
+#define CLOCK_DEV_ID_F42X           0x419U
+
+// 调压档位：F40x 只有 VOS 一位（1 为 scale 1），F42x 为两位（11 为 scale 1，01 为 scale 3）
+#define CLOCK_VOS_F40X_SCALE1       (1U << 14)
+#define CLOCK_VOS_F40X_SCALE2       0U
+#define CLOCK_VOS_F42X_SCALE1       (3U << 14)
+#define CLOCK_VOS_F42X_SCALE3       (1U << 14)
+
+#define CLOCK_READY_LOOPS           100000U
+
+typedef struct
+{
+    uint32_t hclk;
+    uint32_t pllcfgr;           /* 0 表示不用 PLL，HSE 直接作系统时钟 */
+    uint32_t cfgr;              /* HPRE、PPRE1、PPRE2 */
+    uint32_t vos;               /* PWR_CR 中的 VOS 位 */
+    bool overdrive;
+} clock_config_t;
+
+// 8 MHz / 8 = 1 MHz 进 PLL；Q 只需不超过 48 MHz
+static const clock_config_t clock_f40x[BL_CLOCK_PROFILE_COUNT] = {
+    [BL_CLOCK_BOOT] = {168000000U, CLOCK_PLLCFGR(8U, 336U, 2U, 7U),
+                       RCC_CFGR_HPRE_DIV1 | RCC_CFGR_PPRE1_DIV4 | RCC_CFGR_PPRE2_DIV2, CLOCK_VOS_F40X_SCALE1, false},
+    [BL_CLOCK_UPDATE] = {168000000U, CLOCK_PLLCFGR(8U, 336U, 2U, 7U),
+                         RCC_CFGR_HPRE_DIV1 | RCC_CFGR_PPRE1_DIV4 | RCC_CFGR_PPRE2_DIV2, CLOCK_VOS_F40X_SCALE1, false},
+    [BL_CLOCK_LOW_POWER] = {HSE_VALUE, 0,
+                            RCC_CFGR_HPRE_DIV1 | RCC_CFGR_PPRE1_DIV1 | RCC_CFGR_PPRE2_DIV1, CLOCK_VOS_F40X_SCALE2, false},
+};
+
+static const clock_config_t clock_f42x[BL_CLOCK_PROFILE_COUNT] = {
+    [BL_CLOCK_BOOT] = {168000000U, CLOCK_PLLCFGR(8U, 336U, 2U, 7U),
+                       RCC_CFGR_HPRE_DIV1 | RCC_CFGR_PPRE1_DIV4 | RCC_CFGR_PPRE2_DIV2, CLOCK_VOS_F42X_SCALE1, false},
+    [BL_CLOCK_UPDATE] = {180000000U, CLOCK_PLLCFGR(8U, 360U, 2U, 8U),
+                         RCC_CFGR_HPRE_DIV1 | RCC_CFGR_PPRE1_DIV4 | RCC_CFGR_PPRE2_DIV2, CLOCK_VOS_F42X_SCALE1, true},
+    [BL_CLOCK_LOW_POWER] = {HSE_VALUE, 0,
+                            RCC_CFGR_HPRE_DIV1 | RCC_CFGR_PPRE1_DIV1 | RCC_CFGR_PPRE2_DIV1, CLOCK_VOS_F42X_SCALE3, false},
+};
+
+static bl_clock_profile_t clock_current = BL_CLOCK_PROFILE_COUNT;
+static uint32_t clock_cycles;
+static bl_clock_notify_t clock_notify_list[BL_CLOCK_NOTIFY_MAX];
+
+
+static bool clock_is_f42x(void)
+{
+    // 部分 F40x 版本不接调试器时 IDCODE 读为 0，按 F40x 处理
+    return (DBGMCU->IDCODE & DBGMCU_IDCODE_DEV_ID) == CLOCK_DEV_ID_F42X;
+}
+
+static bool clock_wait(volatile uint32_t *reg, uint32_t mask, uint32_t value)
+{
+    uint32_t n = CLOCK_READY_LOOPS;
+
+    while ((*reg & mask) != value)
+    {
+        if (--n == 0)
+            return false;
+    }
+
+    return true;
+}
+
+static void clock_notify(bl_clock_event_t event)
+{
+    uint32_t i;
+
+    for (i = 0; i < BL_CLOCK_NOTIFY_MAX && clock_notify_list[i] != NULL; i++)
+        clock_notify_list[i](event);
+}
+
+static bool clock_matches(const clock_config_t *cfg, bool f42x)
+{
+    uint32_t sws = cfg->pllcfgr ? RCC_CFGR_SWS_PLL : RCC_CFGR_SWS_HSE;
+    bool od = f42x && (PWR->CSR & PWR_CSR_ODSWRDY);
+
+    return (RCC->CFGR & RCC_CFGR_SWS) == sws &&
+           (RCC->CFGR & CLOCK_CFGR_DIV) == cfg->cfgr &&
+           (cfg->pllcfgr == 0 || RCC->PLLCFGR == cfg->pllcfgr) &&
+           (PWR->CR & PWR_CR_VOS) == cfg->vos &&
+           od == cfg->overdrive;
+}
+
+// 过驱动只能在系统时钟不是 PLL 时关闭，打开时 PLL 须已锁定
+static bool clock_overdrive(bool on)
+{
+    if (!on)
+    {
+        PWR->CR &= ~(PWR_CR_ODEN | PWR_CR_ODSWEN);
+        return true;
+    }
+
+    PWR->CR |= PWR_CR_ODEN;
+    if (!clock_wait(&PWR->CSR, PWR_CSR_ODRDY, PWR_CSR_ODRDY))
+        return false;
+    PWR->CR |= PWR_CR_ODSWEN;
+    return clock_wait(&PWR->CSR, PWR_CSR_ODSWRDY, PWR_CSR_ODSWRDY);
+}
+
+static bool clock_switch(const clock_config_t *cfg, bool f42x)
+{
+    // 先切到 HSE 再改分频，避免 APB 在切换的瞬间超频
+    RCC->CFGR = (RCC->CFGR & ~RCC_CFGR_SW) | RCC_CFGR_SW_HSE;
+    if (!clock_wait(&RCC->CFGR, RCC_CFGR_SWS, RCC_CFGR_SWS_HSE))
+        return false;
+    RCC->CFGR &= ~CLOCK_CFGR_DIV;
+
+    if (f42x)
+        clock_overdrive(false);
+
+    // VOS 只能在 PLL 关闭时修改
+    if (cfg->pllcfgr == 0 || RCC->PLLCFGR != cfg->pllcfgr || (PWR->CR & PWR_CR_VOS) != cfg->vos)
+    {
+        RCC->CR &= ~RCC_CR_PLLON;
+        if (!clock_wait(&RCC->CR, RCC_CR_PLLRDY, 0))
+            return false;
+        PWR->CR = (PWR->CR & ~PWR_CR_VOS) | cfg->vos;
+    }
+
+    if (cfg->pllcfgr)
+    {
+        if (!(RCC->CR & RCC_CR_PLLON))
+        {
+            RCC->PLLCFGR = cfg->pllcfgr;
+            RCC->CR |= RCC_CR_PLLON;
+        }
+        if (!clock_wait(&RCC->CR, RCC_CR_PLLRDY, RCC_CR_PLLRDY))
+            return false;
+
+        if (cfg->overdrive && !clock_overdrive(true))
+        {
+            clock_overdrive(false);
+            return false;
+        }
+    }
+
+    RCC->CFGR |= cfg->cfgr;
+    if (cfg->pllcfgr)
+    {
+        RCC->CFGR = (RCC->CFGR & ~RCC_CFGR_SW) | RCC_CFGR_SW_PLL;
+        return clock_wait(&RCC->CFGR, RCC_CFGR_SWS, RCC_CFGR_SWS_PLL);
+    }
+
+    return true;
+}
+
+static bool clock_hse_ready(void)
+{
+    if (RCC->CR & RCC_CR_HSERDY)
+        return true;
+
+    RCC->CR |= RCC_CR_HSEON;
+    return clock_wait(&RCC->CR, RCC_CR_HSERDY, RCC_CR_HSERDY);
+}
+
+bool bl_clock_set_profile(bl_clock_profile_t profile)
+{
+    bool f42x = clock_is_f42x();
+    const clock_config_t *cfg;
+    uint32_t art = FLASH->ACR & BL_FLASH_ART_ALL;
+    uint32_t latency, start, primask;
+    bool ok;
+
+    if (profile >= BL_CLOCK_PROFILE_COUNT)
+        return false;
+
+    cfg = f42x ? &clock_f42x[profile] : &clock_f40x[profile];
+
+    RCC->APB1ENR |= RCC_APB1ENR_PWREN;
+    if (clock_matches(cfg, f42x))
+    {
+        clock_current = profile;
+        return true;
+    }
+    if (!clock_hse_ready())
+        return false;
+
+    start = DWT->CYCCNT;
+    primask = __get_PRIMASK();
+    __disable_irq();
+    clock_notify(BL_CLOCK_PRE_CHANGE);
+
+    // 切换过程中的任何时刻等待周期都要够用
+    latency = bl_flash_latency(cfg->hclk);
+    if (latency > (FLASH->ACR & FLASH_ACR_LATENCY))
+        bl_flash_art_set(latency, art);
+
+    ok = clock_switch(cfg, f42x);
+    if (!ok)
+    {
+        // 停在 HSE，不分频
+        RCC->CFGR &= ~CLOCK_CFGR_DIV;
+    }
+
+    SystemCoreClockUpdate();
+    bl_flash_art_config(SystemCoreClock, art);
+    clock_current = ok ? profile : BL_CLOCK_PROFILE_COUNT;
+
+    // SysTick 以 HCLK 计数，保持节拍频率不变
+    if (SysTick->CTRL & SysTick_CTRL_ENABLE_Msk)
+    {
+        SysTick->LOAD = SystemCoreClock / OS_TICK_RATE_HZ - 1U;
+        SysTick->VAL = 0;
+    }
+
+    clock_notify(BL_CLOCK_POST_CHANGE);
+    __set_PRIMASK(primask);
+    clock_cycles = DWT->CYCCNT - start;
+
+    if (ok)
+        LOG_I("clock: profile %u, %u Hz, switched in %u cycles", (unsigned)profile, (unsigned)SystemCoreClock,
+              (unsigned)clock_cycles);
+    else
+        LOG_E("clock: profile %u failed, running on HSE", (unsigned)profile);
+
+    return ok;
+}
+
+bl_clock_profile_t bl_clock_profile(void)
+{
+    return clock_current;
+}
+
+uint32_t bl_clock_switch_cycles(void)
+{
+    return clock_cycles;
+}
+
+bool bl_clock_notify_register(bl_clock_notify_t notify)
+{
+    uint32_t i;
+
+    for (i = 0; i < BL_CLOCK_NOTIFY_MAX; i++)
+    {
+        if (clock_notify_list[i] == notify)
+            return true;
+        if (clock_notify_list[i] == NULL)
+        {
+            clock_notify_list[i] = notify;
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,63 @@
+#ifndef __BL_CLOCK_H
+#define __BL_CLOCK_H
+
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/*
+ * 运行时时钟档位，时钟源为 HSE (HSE_VALUE = 8 MHz)：
+ *   BL_CLOCK_BOOT       168 MHz，APB1 42 MHz，APB2 84 MHz，不开过驱动
+ *   BL_CLOCK_UPDATE     F42x/F43x 上 180 MHz（PWR 过驱动，APB1 45 MHz，APB2 90 MHz），
+ *                       其他型号与 BL_CLOCK_BOOT 相同
+ *   BL_CLOCK_LOW_POWER  HSE 直接作系统时钟 8 MHz，PLL 关闭，调压器最低档
+ *
+ * 器件按 DBGMCU_IDCODE 在运行时识别，不依赖编译时的 STM32F4xx 宏。
+ * 切换时依次：按新旧频率中较高者设置 flash 等待周期，切到 HSE，关闭 PLL 和过驱动，
+ * 设置调压档位，重新锁定 PLL，开过驱动，设置分频后切回 PLL，最后按新频率设置 ART。
+ * PLL 配置相同的档位之间只改分频，不重新锁定；重新锁定约需 100-200 us。
+ *
+ * 切换期间关中断，正在收发的串口字节会出错，应在协议的空闲点切换。
+ * 切换后 SystemCoreClock、SysTick 重装值随之更新，依赖 PCLK 的外设通过
+ * bl_clock_notify_register 注册的回调重新计算（如串口 BRR，见 usart.c）。
+ *
+ * 升级时：bl_clock_set_profile(BL_CLOCK_UPDATE) -> update_begin ... update_finish
+ *         -> bl_clock_set_profile(BL_CLOCK_BOOT)；等待主机时可降到 BL_CLOCK_LOW_POWER。
+ */
+
+typedef enum
+{
+    BL_CLOCK_BOOT = 0,
+    BL_CLOCK_UPDATE,
+    BL_CLOCK_LOW_POWER,
+    BL_CLOCK_PROFILE_COUNT,
+} bl_clock_profile_t;
+
+typedef enum
+{
+    BL_CLOCK_PRE_CHANGE,        /* 即将切换，已关中断：等待正在发送的字节发完 */
+    BL_CLOCK_POST_CHANGE,       /* 已切换，仍关中断：按新的 PCLK 重新配置 */
+} bl_clock_event_t;
+
+typedef void (*bl_clock_notify_t)(bl_clock_event_t event);
+
+#ifndef BL_CLOCK_NOTIFY_MAX
+#define BL_CLOCK_NOTIFY_MAX     4U
+#endif
+
+
+/* 切换到 profile；失败时（HSE 或 PLL 未就绪、过驱动不可用）停在 HSE 并返回 false */
+bool bl_clock_set_profile(bl_clock_profile_t profile);
+
+/* 当前档位；时钟不是由 bl_clock_set_profile 设置（如 SystemInit 的配置）时为 BL_CLOCK_PROFILE_COUNT */
+bl_clock_profile_t bl_clock_profile(void);
+
+/* 上次切换所用的 CPU 周期，频率在切换中途改变，只作比较用 */
+uint32_t bl_clock_switch_cycles(void);
+
+/* 注册切换通知，重复注册同一回调只保留一次 */
+bool bl_clock_notify_register(bl_clock_notify_t notify);
+
+
+#endif /* __BL_CLOCK_H */
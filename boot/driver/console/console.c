@@ -0,0 +1,212 @@
+#include <string.h>
+#include "stm32f4xx.h"
+#include "usart.h"
+#include "dma.h"
+#include "os.h"
+#include "console.h"
+
+
+#define CONSOLE_MASK    (CONSOLE_TX_SIZE - 1U)
+
+#if (CONSOLE_TX_SIZE & CONSOLE_MASK) != 0
+#error "CONSOLE_TX_SIZE must be a power of 2"
+#endif
+
+
+// head/tail 为自由增长的计数，取模后才是下标；[tail, tail + dma_len) 正在由 DMA 发送
+static uint8_t console_buf[CONSOLE_TX_SIZE];
+static volatile uint32_t console_head;
+static volatile uint32_t console_tail;
+static volatile uint32_t console_dma_len;
+static volatile uint32_t console_age;
+static volatile uint32_t console_drop_count;
+static console_full_policy_t console_policy;
+static os_sem_t console_space;
+static bool console_ready;
+
+
+// 需在临界区内调用
+static void console_kick(void)
+{
+    uint32_t pending, offset, chunk;
+
+    if (console_dma_len != 0)
+        return;
+
+    pending = console_head - console_tail;
+    if (pending == 0)
+        return;
+
+    // DMA 只能发送连续内存，跨越缓冲区末尾时分两次发送
+    offset = console_tail & CONSOLE_MASK;
+    chunk = CONSOLE_TX_SIZE - offset;
+    if (chunk > pending)
+        chunk = pending;
+
+    console_dma_len = chunk;
+    console_age = 0;
+    DMA2_USART1_Tx_Start(&console_buf[offset], chunk);
+}
+
+void console_init(console_full_policy_t policy)
+{
+    NVIC_InitTypeDef NVIC_InitStruct;
+
+    console_policy = policy;
+    os_sem_init(&console_space, 0, 1);
+
+    usart_Init(&usart1);
+    DMA2_USART1_Tx_Init(console_buf, 0);
+
+    NVIC_InitStruct.NVIC_IRQChannel = DMA2_Stream7_IRQn;
+    NVIC_InitStruct.NVIC_IRQChannelPreemptionPriority = CONSOLE_DMA_IRQ_PRIORITY;
+    NVIC_InitStruct.NVIC_IRQChannelSubPriority = 0;
+    NVIC_InitStruct.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStruct);
+
+    console_ready = true;
+}
+
+void console_set_policy(console_full_policy_t policy)
+{
+    console_policy = policy;
+}
+
+// 缓冲区满时按策略腾出空间，返回 false 表示丢弃当前字符；需在临界区内调用
+static bool console_make_room(uint32_t *state)
+{
+    while (console_head - console_tail >= CONSOLE_TX_SIZE)
+    {
+        switch (console_policy)
+        {
+        case CONSOLE_FULL_OVERWRITE:
+            // 正在发送的部分不能动，丢掉其后全部积压
+            if (console_head - console_tail > console_dma_len)
+            {
+                console_drop_count += console_head - console_tail - console_dma_len;
+                console_head = console_tail + console_dma_len;
+                break;
+            }
+            console_drop_count++;
+            return false;
+
+        case CONSOLE_FULL_BLOCK:
+            if (!os_in_isr() && *state == 0)
+            {
+                console_kick();
+                os_exit_critical(*state);
+                os_sem_take(&console_space, OS_WAIT_FOREVER);
+                *state = os_enter_critical();
+                break;
+            }
+            console_drop_count++;
+            return false;
+
+        default:
+            console_drop_count++;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void console_putc(char c)
+{
+    uint32_t state;
+
+    if (!console_ready)
+        return;
+
+    state = os_enter_critical();
+
+    if (console_make_room(&state))
+    {
+        console_buf[console_head & CONSOLE_MASK] = (uint8_t)c;
+        console_head++;
+
+        if (c == '\n' || console_head - console_tail - console_dma_len >= CONSOLE_FLUSH_THRESHOLD)
+            console_kick();
+    }
+
+    os_exit_critical(state);
+}
+
+void console_write(const char *data, uint32_t len)
+{
+    uint32_t state, room, n, offset, first;
+
+    if (!console_ready)
+        return;
+
+    while (len)
+    {
+        state = os_enter_critical();
+
+        room = CONSOLE_TX_SIZE - (console_head - console_tail);
+        if (room == 0)
+        {
+            // 缓冲区满，交给逐字符路径按策略处理
+            os_exit_critical(state);
+            console_putc(*data++);
+            len--;
+            continue;
+        }
+
+        // 每次最多拷贝 CONSOLE_WRITE_CHUNK 字节，跨越缓冲区末尾时分两段
+        n = len < room ? len : room;
+        if (n > CONSOLE_WRITE_CHUNK)
+            n = CONSOLE_WRITE_CHUNK;
+        offset = console_head & CONSOLE_MASK;
+        first = CONSOLE_TX_SIZE - offset;
+        if (first > n)
+            first = n;
+        memcpy(&console_buf[offset], data, first);
+        memcpy(console_buf, data + first, n - first);
+        console_head += n;
+
+        if (memchr(data, '\n', n) != NULL ||
+            console_head - console_tail - console_dma_len >= CONSOLE_FLUSH_THRESHOLD)
+            console_kick();
+
+        os_exit_critical(state);
+        data += n;
+        len -= n;
+    }
+}
+
+void console_flush(void)
+{
+    uint32_t state = os_enter_critical();
+    console_kick();
+    os_exit_critical(state);
+}
+
+uint32_t console_dropped(void)
+{
+    return console_drop_count;
+}
+
+void console_tick(void)
+{
+    if (!console_ready || console_dma_len != 0 || console_head == console_tail)
+        return;
+
+    if (++console_age >= OS_MS_TO_TICKS(CONSOLE_FLUSH_MS))
+        console_flush();
+}
+
+void console_dma_tx_irq(void)
+{
+    if (DMA_GetITStatus(DMA2_Stream7, DMA_IT_TCIF7) == RESET)
+        return;
+
+    DMA_ClearITPendingBit(DMA2_Stream7, DMA_IT_TCIF7);
+
+    console_tail += console_dma_len;
+    console_dma_len = 0;
+
+    // 已经开始刷新就把剩余数据一并发完
+    console_kick();
+    os_sem_give(&console_space);
+}
@@ -0,0 +1,62 @@
+#ifndef __BL_CONSOLE_H
+#define __BL_CONSOLE_H
+
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/*
+ * printf 控制台后端：_putchar 只把字符追加到发送环形缓冲区，
+ * 由 USART1 TX DMA (DMA2 Stream7) 成块发出。以下任一条件触发发送：
+ *   - 写入换行符；
+ *   - 待发数据达到 CONSOLE_FLUSH_THRESHOLD；
+ *   - 最早的待发数据在 CONSOLE_FLUSH_MS 内没有被发出（由 console_tick 检查）。
+ */
+
+/* 发送缓冲区大小，必须是 2 的幂 */
+#ifndef CONSOLE_TX_SIZE
+#define CONSOLE_TX_SIZE             1024U
+#endif
+
+#ifndef CONSOLE_FLUSH_THRESHOLD
+#define CONSOLE_FLUSH_THRESHOLD     64U
+#endif
+
+#ifndef CONSOLE_FLUSH_MS
+#define CONSOLE_FLUSH_MS            10U
+#endif
+
+/* console_write 每次关中断最多拷贝的字节数，限制长输出时的关中断时间 */
+#ifndef CONSOLE_WRITE_CHUNK
+#define CONSOLE_WRITE_CHUNK         32U
+#endif
+
+#ifndef CONSOLE_DMA_IRQ_PRIORITY
+#define CONSOLE_DMA_IRQ_PRIORITY    3U
+#endif
+
+
+/* 缓冲区满时的处理策略 */
+typedef enum
+{
+    CONSOLE_FULL_DROP = 0,      /* 丢弃新字符（默认，绝不阻塞） */
+    CONSOLE_FULL_BLOCK,         /* 等待 DMA 腾出空间；中断中或关中断时退化为丢弃 */
+    CONSOLE_FULL_OVERWRITE,     /* 丢弃尚未开始发送的旧数据，保留最新输出 */
+} console_full_policy_t;
+
+
+void console_init(console_full_policy_t policy);
+void console_set_policy(console_full_policy_t policy);
+void console_putc(char c);
+void console_write(const char *data, uint32_t len);
+void console_flush(void);
+uint32_t console_dropped(void);
+
+/* 由 SysTick_Handler 每个节拍调用 */
+void console_tick(void);
+/* 由 DMA2_Stream7_IRQHandler 调用 */
+void console_dma_tx_irq(void);
+
+
+#endif /* __BL_CONSOLE_H */
@@ -0,0 +1,216 @@
+#include <string.h>
+#include "stm32f4xx.h"
+#include "stm32f4xx_flash.h"
+#include "flash_layout.h"
+#include "flash.h"
+
+
+#define BL_FLASH_ERR_FLAGS  (FLASH_FLAG_EOP | FLASH_FLAG_OPERR | FLASH_FLAG_WRPERR | \
+                             FLASH_FLAG_PGAERR | FLASH_FLAG_PGPERR | FLASH_FLAG_PGSERR)
+
+typedef struct
+{
+    uint32_t count;
+    uint32_t check;             /* ~count */
+} bl_flash_counter_t;
+
+#define BL_FLASH_COUNTER    ((volatile bl_flash_counter_t *)LAYOUT_BKP_FLASH_COUNT)
+
+
+static void bl_flash_backup_enable(void)
+{
+    RCC_APB1PeriphClockCmd(RCC_APB1Periph_PWR, ENABLE);
+    PWR_BackupAccessCmd(ENABLE);
+    RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_BKPSRAM, ENABLE);
+}
+
+bool bl_flash_write_count(uint32_t *count)
+{
+    volatile bl_flash_counter_t *c = BL_FLASH_COUNTER;
+
+    bl_flash_backup_enable();
+    *count = c->count;
+    return c->check == ~c->count;
+}
+
+// 在擦写之前计数，写到一半掉电也算写过
+static void bl_flash_count(void)
+{
+    volatile bl_flash_counter_t *c = BL_FLASH_COUNTER;
+    uint32_t n;
+
+    if (!bl_flash_write_count(&n))
+        n = 0;
+    n++;
+    c->count = n;
+    c->check = ~n;
+}
+
+#define BL_FLASH_ACR_CACHE  (FLASH_ACR_ICEN | FLASH_ACR_DCEN)
+
+_Static_assert(BL_FLASH_ART_PREFETCH == FLASH_ACR_PRFTEN && BL_FLASH_ART_ICACHE == FLASH_ACR_ICEN &&
+               BL_FLASH_ART_DCACHE == FLASH_ACR_DCEN, "BL_FLASH_ART_xxx must match FLASH_ACR");
+
+
+uint32_t bl_flash_latency(uint32_t hclk)
+{
+    uint32_t step, latency;
+
+    switch (BL_FLASH_VOLTAGE_RANGE)
+    {
+    case VoltageRange_1:
+        step = 20000000U;
+        break;
+    case VoltageRange_2:
+        step = 22000000U;
+        break;
+    default:
+        step = 30000000U;
+        break;
+    }
+
+    latency = hclk ? (hclk - 1U) / step : 0;
+    return latency <= BL_FLASH_LATENCY_MAX ? latency : BL_FLASH_LATENCY_NONE;
+}
+
+void bl_flash_art_set(uint32_t latency, uint32_t art)
+{
+    art &= BL_FLASH_ART_ALL;
+    if (BL_FLASH_VOLTAGE_RANGE == VoltageRange_1)
+        art &= ~BL_FLASH_ART_PREFETCH;
+
+    // 缓存关闭时才能复位；复位位不会自己清零，要写回 0 缓存才能再打开
+    FLASH->ACR = latency | (art & FLASH_ACR_PRFTEN);
+    FLASH->ACR |= FLASH_ACR_ICRST | FLASH_ACR_DCRST;
+    FLASH->ACR &= ~(FLASH_ACR_ICRST | FLASH_ACR_DCRST);
+    FLASH->ACR |= art & BL_FLASH_ACR_CACHE;
+
+    // 新的等待周期读回后才生效
+    while ((FLASH->ACR & FLASH_ACR_LATENCY) != latency)
+        ;
+}
+
+bool bl_flash_art_config(uint32_t hclk, uint32_t art)
+{
+    uint32_t latency = bl_flash_latency(hclk);
+
+    if (latency == BL_FLASH_LATENCY_NONE)
+        return false;
+
+    bl_flash_art_set(latency, art);
+    return true;
+}
+
+void bl_flash_art_reset(void)
+{
+    uint32_t acr = FLASH->ACR;
+
+    FLASH->ACR = acr & ~BL_FLASH_ACR_CACHE;
+    FLASH->ACR = (acr & ~BL_FLASH_ACR_CACHE) | FLASH_ACR_ICRST | FLASH_ACR_DCRST;
+    FLASH->ACR = acr & ~BL_FLASH_ACR_CACHE;
+    FLASH->ACR = acr;
+}
+
+bool bl_flash_sector(uint32_t addr, uint32_t *index, uint32_t *start, uint32_t *size)
+{
+    uint32_t off, i, s, n;
+
+    if (addr < BL_FLASH_BASE || addr - BL_FLASH_BASE >= BL_FLASH_SIZE)
+        return false;
+
+    off = addr - BL_FLASH_BASE;
+    if (off < 0x10000U)
+    {
+        // 扇区 0-3，16 KiB
+        i = off >> 14;
+        s = i << 14;
+        n = 0x4000U;
+    }
+    else if (off < 0x20000U)
+    {
+        i = 4;
+        s = 0x10000U;
+        n = 0x10000U;
+    }
+    else
+    {
+        // 扇区 5 起，128 KiB
+        i = 4U + (off >> 17);
+        s = off & ~0x1FFFFU;
+        n = 0x20000U;
+    }
+
+    if (index)
+        *index = i;
+    if (start)
+        *start = BL_FLASH_BASE + s;
+    if (size)
+        *size = n;
+    return true;
+}
+
+bl_flash_status_t bl_flash_erase(uint32_t addr)
+{
+    uint32_t index;
+    FLASH_Status status;
+
+    if (!bl_flash_sector(addr, &index, NULL, NULL))
+        return BL_FLASH_ERR_ADDR;
+
+    bl_flash_count();
+    FLASH_Unlock();
+    FLASH_ClearFlag(BL_FLASH_ERR_FLAGS);
+    // FLASH_Sector_n 的编码为 n << 3
+    status = FLASH_EraseSector((uint32_t)(index << 3), BL_FLASH_VOLTAGE_RANGE);
+    FLASH_Lock();
+    // 缓存中可能还有擦除前的内容
+    bl_flash_art_reset();
+
+    return status == FLASH_COMPLETE ? BL_FLASH_OK : BL_FLASH_ERR_ERASE;
+}
+
+bl_flash_status_t bl_flash_program(uint32_t addr, const void *data, uint32_t len)
+{
+    const uint8_t *src = (const uint8_t *)data;
+    uint32_t a = addr, end = addr + len, w;
+    FLASH_Status status = FLASH_COMPLETE;
+
+    if (len == 0)
+        return BL_FLASH_OK;
+    if (addr < BL_FLASH_BASE || end < addr || end - BL_FLASH_BASE > BL_FLASH_SIZE)
+        return BL_FLASH_ERR_ADDR;
+
+    bl_flash_count();
+    FLASH_Unlock();
+    FLASH_ClearFlag(BL_FLASH_ERR_FLAGS);
+
+    while (status == FLASH_COMPLETE && a < end)
+    {
+        if ((a & 3U) == 0 && end - a >= 4U)
+        {
+            memcpy(&w, src, sizeof(w));     // 源缓冲区不一定对齐
+            status = FLASH_ProgramWord(a, w);
+            a += 4U;
+            src += 4;
+        }
+        else
+        {
+            status = FLASH_ProgramByte(a, *src);
+            a++;
+            src++;
+        }
+    }
+
+    FLASH_Lock();
+    // 失败时也已写入一部分，读回比较之前先丢弃缓存中的旧内容
+    bl_flash_art_reset();
+
+    if (status != FLASH_COMPLETE)
+        return BL_FLASH_ERR_PROGRAM;
+
+    // 读回比较，发现编程失败或写到了未擦除的位置
+    if (memcmp((const void *)addr, data, len) != 0)
+        return BL_FLASH_ERR_VERIFY;
+
+    return BL_FLASH_OK;
+}
@@ -0,0 +1,88 @@
+#ifndef __BL_FLASH_H
+#define __BL_FLASH_H
+
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/*
+ * 片内 flash 擦写。STM32F407VE：512 KiB，扇区 0-3 为 16 KiB，4 为 64 KiB，5-7 为 128 KiB。
+ * bl_flash_program 写完后逐字节读回比较，不一致返回 BL_FLASH_ERR_VERIFY。
+ */
+
+#define BL_FLASH_BASE           0x08000000U
+
+#ifndef BL_FLASH_SIZE
+#define BL_FLASH_SIZE           (512U * 1024U)
+#endif
+
+/* 供电电压范围，决定擦写并行位宽，见 stm32f4xx_flash.h 中的 VoltageRange_x */
+#ifndef BL_FLASH_VOLTAGE_RANGE
+#define BL_FLASH_VOLTAGE_RANGE  VoltageRange_3
+#endif
+
+/*
+ * ART 加速器。每个等待周期可用的 HCLK 上限由供电电压决定（RM0090 表 10）：
+ *   VoltageRange_1  1.8-2.1 V  20 MHz，不能开预取
+ *   VoltageRange_2  2.1-2.7 V  22 MHz（按 2.1-2.4 V 取保守值）
+ *   VoltageRange_3/4  2.7-3.6 V  30 MHz
+ * 指令缓存和数据缓存不跟踪 flash 内容的变化，bl_flash_erase/bl_flash_program 结束后都会复位缓存，
+ * 其他途径改写 flash 后须调用 bl_flash_art_reset。
+ */
+#define BL_FLASH_ART_PREFETCH   0x0100U         /* FLASH_ACR_PRFTEN */
+#define BL_FLASH_ART_ICACHE     0x0200U         /* FLASH_ACR_ICEN */
+#define BL_FLASH_ART_DCACHE     0x0400U         /* FLASH_ACR_DCEN */
+#define BL_FLASH_ART_ALL        (BL_FLASH_ART_PREFETCH | BL_FLASH_ART_ICACHE | BL_FLASH_ART_DCACHE)
+
+#define BL_FLASH_LATENCY_MAX    7U              /* STM32F40x 的 LATENCY 只有 3 位 */
+#define BL_FLASH_LATENCY_NONE   0xFFFFFFFFU
+
+
+typedef enum
+{
+    BL_FLASH_OK = 0,
+    BL_FLASH_ERR_ADDR,          /* 超出 flash 范围 */
+    BL_FLASH_ERR_ERASE,
+    BL_FLASH_ERR_PROGRAM,
+    BL_FLASH_ERR_VERIFY,        /* 读回内容与写入不符 */
+} bl_flash_status_t;
+
+
+/*
+ * 擦写计数：每次擦除、编程之前加 1，保存在备份 SRAM (LAYOUT_BKP_FLASH_COUNT)，复位后仍在。
+ * bootloader 和应用都经 bl_flash_* 写 flash 时，计数与上次相同就说明期间 flash 没有被写过。
+ * 计数丢失（备份域掉电）时返回 false，下次擦写时从 0 重新开始。
+ * 调用后备份 SRAM 可以访问。
+ */
+bool bl_flash_write_count(uint32_t *count);
+
+/* 查找 addr 所在扇区，返回扇区号，start/size 可为 NULL */
+bool bl_flash_sector(uint32_t addr, uint32_t *index, uint32_t *start, uint32_t *size);
+
+/* 擦除 addr 所在的整个扇区 */
+bl_flash_status_t bl_flash_erase(uint32_t addr);
+
+/* 写入任意长度（已擦除区域），对齐部分按字写，首尾按字节写 */
+bl_flash_status_t bl_flash_program(uint32_t addr, const void *data, uint32_t len);
+
+/* HCLK 为 hclk 时所需的最少等待周期，超出当前电压范围的上限时返回 BL_FLASH_LATENCY_NONE */
+uint32_t bl_flash_latency(uint32_t hclk);
+
+/*
+ * 按 hclk 设置等待周期，打开 art 中的功能（BL_FLASH_ART_xxx），缓存同时复位。
+ * 提高 HCLK 之前以新频率调用，降低 HCLK 之后调用；hclk 超出范围时不改动并返回 false。
+ */
+bool bl_flash_art_config(uint32_t hclk, uint32_t art);
+
+/* 直接指定等待周期，不检查是否足够；供时钟切换和 bl_flash_art_bench 使用 */
+void bl_flash_art_set(uint32_t latency, uint32_t art);
+
+/* 复位指令缓存和数据缓存，丢弃可能过时的行，之后恢复原来的开关状态 */
+void bl_flash_art_reset(void);
+
+/* 在当前 HCLK 下依次以各种 ART 配置运行同一段基准循环，通过 LOG_I 报告每秒迭代数，结束后恢复原配置 */
+void bl_flash_art_bench(void);
+
+
+#endif /* __BL_FLASH_H */
@@ -0,0 +1,238 @@
+#include <stddef.h>
+#include "stm32f4xx.h"
+#include "log.h"
+#include "flash.h"
+
+
+/*
+ * 仿 CoreMark 的基准循环：链表查找与反转、矩阵乘加、状态机解析和 CRC16，
+ * 代码和常量表在 flash 中，工作数据在 SRAM 中，分别体现取指（预取、指令缓存）与
+ * 读常量（数据缓存）的等待。各配置的结果 CRC 应相同，不同说明配置有误。
+ */
+
+#define BENCH_ITERATIONS        200U
+#define BENCH_LIST_SIZE         32U
+#define BENCH_MATRIX_SIZE       8U
+
+typedef struct bench_node
+{
+    struct bench_node *next;
+    int16_t value;
+    uint16_t index;
+} bench_node_t;
+
+typedef struct
+{
+    const char *name;
+    uint32_t extra_latency;     /* 在所需等待周期上再加的周期数 */
+    uint32_t art;
+} bench_config_t;
+
+static const bench_config_t bench_configs[] = {
+    {"off", 0, 0},
+    {"prefetch", 0, BL_FLASH_ART_PREFETCH},
+    {"icache", 0, BL_FLASH_ART_ICACHE},
+    {"icache+dcache", 0, BL_FLASH_ART_ICACHE | BL_FLASH_ART_DCACHE},
+    {"all", 0, BL_FLASH_ART_ALL},
+    {"all, +1 ws", 1, BL_FLASH_ART_ALL},
+};
+
+// 状态机的输入放在 flash 中
+static const char bench_input[] =
+    "5012,1.23,-874,0x1F,+9,3e7,abc,-0.5,77,1024,9.99e-1,,17,-3,0.0,42,1e,--1,65535,8.";
+
+static bench_node_t bench_nodes[BENCH_LIST_SIZE];
+static int16_t bench_a[BENCH_MATRIX_SIZE * BENCH_MATRIX_SIZE];
+static int16_t bench_b[BENCH_MATRIX_SIZE * BENCH_MATRIX_SIZE];
+static int32_t bench_c[BENCH_MATRIX_SIZE * BENCH_MATRIX_SIZE];
+
+
+static uint16_t bench_crc16(uint16_t crc, uint32_t data)
+{
+    uint32_t i;
+
+    for (i = 0; i < 16U; i++)
+    {
+        if ((crc ^ data) & 1U)
+            crc = (uint16_t)((crc >> 1) ^ 0xA001U);
+        else
+            crc >>= 1;
+        data >>= 1;
+    }
+
+    return crc;
+}
+
+static bench_node_t *bench_list_init(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < BENCH_LIST_SIZE; i++)
+    {
+        bench_nodes[i].next = i + 1U < BENCH_LIST_SIZE ? &bench_nodes[i + 1U] : NULL;
+        bench_nodes[i].value = (int16_t)((i * 7919U) & 0x7FFFU);
+        bench_nodes[i].index = (uint16_t)i;
+    }
+
+    return &bench_nodes[0];
+}
+
+static uint16_t bench_list(bench_node_t **head, uint16_t crc)
+{
+    bench_node_t *p, *prev = NULL, *next;
+    int16_t key = (int16_t)(crc & 0x7FFFU);
+    uint32_t hits = 0;
+
+    for (p = *head; p; p = p->next)
+    {
+        if (((p->value ^ key) & 0x0F) == 0)
+            hits++;
+    }
+
+    // 反转，下一次从另一端开始
+    for (p = *head; p; p = next)
+    {
+        next = p->next;
+        p->next = prev;
+        prev = p;
+    }
+    *head = prev;
+
+    return bench_crc16(crc, hits | ((uint32_t)prev->index << 8));
+}
+
+static uint16_t bench_matrix(uint16_t crc)
+{
+    uint32_t i, j, k;
+    int32_t sum;
+
+    for (i = 0; i < BENCH_MATRIX_SIZE * BENCH_MATRIX_SIZE; i++)
+    {
+        bench_a[i] = (int16_t)((i * 31U + crc) & 0xFFU);
+        bench_b[i] = (int16_t)((i * 17U) & 0xFFU) - 128;
+    }
+
+    for (i = 0; i < BENCH_MATRIX_SIZE; i++)
+    {
+        for (j = 0; j < BENCH_MATRIX_SIZE; j++)
+        {
+            sum = 0;
+            for (k = 0; k < BENCH_MATRIX_SIZE; k++)
+                sum += bench_a[i * BENCH_MATRIX_SIZE + k] * bench_b[k * BENCH_MATRIX_SIZE + j];
+            bench_c[i * BENCH_MATRIX_SIZE + j] = sum;
+            crc = bench_crc16(crc, (uint32_t)sum);
+        }
+    }
+
+    return crc;
+}
+
+// 把输入分成整数、小数、科学计数法和非法四类
+static uint16_t bench_state(uint16_t crc)
+{
+    enum { START, SIGN, INT, FRAC, EXP, EXP_SIGN, EXP_INT, INVALID } state = START;
+    uint32_t count[INVALID + 1] = {0};
+    const char *p;
+    char c;
+
+    for (p = bench_input;; p++)
+    {
+        c = *p;
+        if (c == ',' || c == '\0')
+        {
+            count[state]++;
+            state = START;
+            if (c == '\0')
+                break;
+            continue;
+        }
+
+        switch (state)
+        {
+        case START:
+            state = (c == '+' || c == '-') ? SIGN : (c >= '0' && c <= '9') ? INT : INVALID;
+            break;
+        case SIGN:
+            state = (c >= '0' && c <= '9') ? INT : INVALID;
+            break;
+        case INT:
+            state = (c >= '0' && c <= '9') ? INT : (c == '.') ? FRAC : (c == 'e') ? EXP : INVALID;
+            break;
+        case FRAC:
+            state = (c >= '0' && c <= '9') ? FRAC : (c == 'e') ? EXP : INVALID;
+            break;
+        case EXP:
+        case EXP_SIGN:
+            state = (c >= '0' && c <= '9') ? EXP_INT : (state == EXP && c == '-') ? EXP_SIGN : INVALID;
+            break;
+        case EXP_INT:
+            state = (c >= '0' && c <= '9') ? EXP_INT : INVALID;
+            break;
+        default:
+            break;
+        }
+    }
+
+    crc = bench_crc16(crc, count[INT] | (count[FRAC] << 8));
+    return bench_crc16(crc, count[EXP_INT] | (count[INVALID] << 8));
+}
+
+static uint16_t bench_run(uint32_t iterations)
+{
+    bench_node_t *head = bench_list_init();
+    uint16_t crc = 0;
+
+    while (iterations--)
+    {
+        crc = bench_list(&head, crc);
+        crc = bench_matrix(crc);
+        crc = bench_state(crc);
+    }
+
+    return crc;
+}
+
+void bl_flash_art_bench(void)
+{
+    uint32_t acr = FLASH->ACR;
+    uint32_t latency = bl_flash_latency(SystemCoreClock);
+    uint32_t primask, i, t0, cycles, rate;
+    uint16_t crc;
+
+    if (latency == BL_FLASH_LATENCY_NONE)
+    {
+        LOG_W("art: %u Hz is out of range", (unsigned)SystemCoreClock);
+        return;
+    }
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    for (i = 0; i < sizeof(bench_configs) / sizeof(bench_configs[0]); i++)
+    {
+        if (latency + bench_configs[i].extra_latency > BL_FLASH_LATENCY_MAX)
+            continue;
+
+        primask = __get_PRIMASK();
+        __disable_irq();
+        bl_flash_art_set(latency + bench_configs[i].extra_latency, bench_configs[i].art);
+
+        // 先跑一次预热缓存，与 CoreMark 一样只计稳定状态
+        bench_run(1);
+        t0 = DWT->CYCCNT;
+        crc = bench_run(BENCH_ITERATIONS);
+        cycles = DWT->CYCCNT - t0;
+
+        FLASH->ACR = acr;
+        bl_flash_art_reset();
+        __set_PRIMASK(primask);
+
+        // 每秒迭代数，以 0.1 为单位
+        rate = (uint32_t)((uint64_t)BENCH_ITERATIONS * SystemCoreClock * 10U / cycles);
+        LOG_I("art %-14s %u ws: %u cycles/iter, %u.%u iter/s, crc %04x", bench_configs[i].name,
+              (unsigned)(latency + bench_configs[i].extra_latency), (unsigned)(cycles / BENCH_ITERATIONS),
+              (unsigned)(rate / 10U), (unsigned)(rate % 10U), (unsigned)crc);
+        (void)rate;
+        (void)crc;
+    }
+}
@@ -1,4 +1,40 @@
+#include <string.h>
 #include "usart.h"
+#include "os.h"
+#include "clock.h"
+
+usart_t usart1 = {
+    .usart_number = USART_1,
+    .baud_rate = 115200,
+    .data_bits = USART_WordLength_8b ,
+    .stop_bits = USART_StopBits_1,
+    .parity = USART_Parity_No,
+    .mode = USART_Mode_Tx | USART_Mode_Rx,
+    .gpiox = GPIOA,
+    .gpio_pin_rx = GPIO_Pin_10,
+    .gpio_pin_tx = GPIO_Pin_9,
+};
+
+static uint8_t rx_buffer[USART_MAX_LEN];
+
+// 中断模式上下文，按 usart_number - 1 索引
+typedef struct
+{
+    USART_TypeDef *regs;
+    ringbuffer8_t tx_rb;
+    ringbuffer8_t rx_rb;
+    os_sem_t tx_space;  // 发送缓冲区腾出空间或发送完成
+    os_sem_t rx_data;   // 接收缓冲区有新数据
+    volatile uint32_t rx_dropped;
+} usart_it_t;
+
+static usart_it_t usart_it[USART_PORT_NUM];
+
+// 已初始化的串口，时钟切换后按各自的波特率重新计算 BRR
+static usart_t *usart_ports[USART_PORT_NUM];
+static bool usart_notify_registered;
+
+#define USART_DRAIN_LOOPS   100000U
 
 static uint16_t GPIO_Pin_to_PinSource(uint32_t gpio_pin)
 {
@@ -90,10 +126,48 @@ static USART_TypeDef *USART_addr(usart_number_t usart_number)
     }
 }
 
+// USART_Init 按当前的 PCLK 计算 BRR
+static void usart_config(const usart_t *usart)
+{
+    USART_InitTypeDef USART_InitStruct;
+
+    USART_InitStruct.USART_BaudRate = usart->baud_rate;
+    USART_InitStruct.USART_WordLength = usart->data_bits;
+    USART_InitStruct.USART_StopBits = usart->stop_bits;
+    USART_InitStruct.USART_Parity = usart->parity;
+    USART_InitStruct.USART_Mode = usart->mode;
+    USART_InitStruct.USART_HardwareFlowControl = USART_HardwareFlowControl_None;
+    USART_Init(USART_addr(usart->usart_number), &USART_InitStruct);
+}
+
+// 切换前等正在发送的字节发完（已关中断，不会再装入新字节），切换后重新计算 BRR
+static void usart_clock_notify(bl_clock_event_t event)
+{
+    USART_TypeDef *regs;
+    uint32_t i, n;
+
+    for (i = 0; i < USART_PORT_NUM; i++)
+    {
+        if (usart_ports[i] == NULL)
+            continue;
+
+        regs = USART_addr(usart_ports[i]->usart_number);
+        if (event == BL_CLOCK_PRE_CHANGE)
+        {
+            n = USART_DRAIN_LOOPS;
+            while ((regs->CR1 & USART_CR1_UE) && !(regs->SR & USART_SR_TC) && --n)
+                ;
+        }
+        else
+        {
+            usart_config(usart_ports[i]);
+        }
+    }
+}
+
 void usart_Init(usart_t *usart)
 {
     GPIO_InitTypeDef GPIO_InitStruct;
-    USART_InitTypeDef USART_InitStruct;
 
     /* Enable GPIO clock */
     /* check whether gpiox is valid and RCC_AHB1PeriphClockCmd is initial already*/
@@ -171,29 +245,199 @@ void usart_Init(usart_t *usart)
     GPIO_PinAFConfig(usart->gpiox, GPIO_Pin_to_PinSource(usart->gpio_pin_tx), GPIO_AF_NUM(usart->usart_number));
     GPIO_PinAFConfig(usart->gpiox, GPIO_Pin_to_PinSource(usart->gpio_pin_rx), GPIO_AF_NUM(usart->usart_number));
     /* USART configuration */
-    USART_InitStruct.USART_BaudRate = usart->baud_rate;
-    USART_InitStruct.USART_WordLength = usart->data_bits;
-    USART_InitStruct.USART_StopBits = usart->stop_bits;
-    USART_InitStruct.USART_Parity = usart->parity;
-    USART_InitStruct.USART_Mode = usart->mode;
-    USART_InitStruct.USART_HardwareFlowControl = USART_HardwareFlowControl_None;
-    USART_Init(USART_addr(usart->usart_number), &USART_InitStruct);
+    usart_config(usart);
+    if (usart->usart_number >= USART_1 && usart->usart_number <= UART_8)
+    {
+        usart_ports[usart->usart_number - 1] = usart;
+        // 一个回调处理所有串口，只注册一次
+        if (!usart_notify_registered)
+            usart_notify_registered = bl_clock_notify_register(usart_clock_notify);
+    }
 
     /* Enable USART */
     USART_Cmd(USART_addr(usart->usart_number), ENABLE);
 }
 
+static IRQn_Type USART_IRQn(usart_number_t usart_number)
+{
+    switch (usart_number)
+    {
+    case USART_2:
+        return USART2_IRQn;
+    case USART_3:
+        return USART3_IRQn;
+    case UART_4:
+        return UART4_IRQn;
+    case UART_5:
+        return UART5_IRQn;
+    case USART_6:
+        return USART6_IRQn;
+    case UART_7:
+        return UART7_IRQn;
+    case UART_8:
+        return UART8_IRQn;
+    default:
+        return USART1_IRQn;
+    }
+}
+
+static usart_it_t *usart_it_find(USART_TypeDef *USARTx)
+{
+    for (uint32_t i = 0; i < USART_PORT_NUM; i++)
+    {
+        if (usart_it[i].regs == USARTx)
+            return &usart_it[i];
+    }
+    return NULL;
+}
+
+bool usart_IT_Init(usart_t *usart, uint8_t *tx_buf, uint32_t tx_size, uint8_t *rx_buf, uint32_t rx_size, uint8_t priority)
+{
+    NVIC_InitTypeDef NVIC_InitStruct;
+    usart_it_t *ctx;
+    USART_TypeDef *regs;
+
+    if (usart->usart_number < USART_1 || usart->usart_number > UART_8)
+        return false;
+
+    ctx = &usart_it[usart->usart_number - 1];
+    regs = USART_addr(usart->usart_number);
+
+    usart_Init(usart);
+
+    memset(ctx, 0, sizeof(usart_it_t));
+    ctx->tx_rb = tx_buf != NULL ? rb8_new(tx_buf, tx_size) : NULL;
+    ctx->rx_rb = rx_buf != NULL ? rb8_new(rx_buf, rx_size) : NULL;
+    os_sem_init(&ctx->tx_space, 0, 1);
+    os_sem_init(&ctx->rx_data, 0, 1);
+    ctx->regs = regs;
+
+    NVIC_InitStruct.NVIC_IRQChannel = USART_IRQn(usart->usart_number);
+    NVIC_InitStruct.NVIC_IRQChannelPreemptionPriority = priority;
+    NVIC_InitStruct.NVIC_IRQChannelSubPriority = 0;
+    NVIC_InitStruct.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStruct);
+
+    if (ctx->rx_rb != NULL)
+        USART_ITConfig(regs, USART_IT_RXNE, ENABLE);
+
+    return true;
+}
+
 void usart_Transmit(USART_TypeDef *USARTx, uint8_t byte)
 {
-    while (USART_GetFlagStatus(USARTx, USART_FLAG_TXE) == RESET)
-        ;
-    USART_SendData(USARTx, byte);
+    usart_it_t *ctx = usart_it_find(USARTx);
+
+    if (ctx == NULL || ctx->tx_rb == NULL)
+    {
+        while (USART_GetFlagStatus(USARTx, USART_FLAG_TXE) == RESET)
+            ;
+        USART_SendData(USARTx, byte);
+        return;
+    }
+
+    // 缓冲区满时睡眠等待 TXE 中断腾出空间
+    while (!rb8_put(ctx->tx_rb, byte))
+    {
+        if (os_in_isr())
+            return;
+        os_sem_take(&ctx->tx_space, OS_WAIT_FOREVER);
+    }
+    USARTx->CR1 |= USART_CR1_TXEIE;
+}
+
+bool usart_ReceiveTimeout(USART_TypeDef *USARTx, uint8_t *byte, uint32_t timeout)
+{
+    usart_it_t *ctx = usart_it_find(USARTx);
+
+    if (ctx == NULL || ctx->rx_rb == NULL)
+    {
+        const uint32_t start = os_tick_get();
+        while (USART_GetFlagStatus(USARTx, USART_FLAG_RXNE) == RESET)
+        {
+            if (timeout != OS_WAIT_FOREVER && os_tick_get() - start >= timeout)
+                return false;
+        }
+        *byte = (uint8_t)USART_ReceiveData(USARTx);
+        return true;
+    }
+
+    while (!rb8_get(ctx->rx_rb, byte))
+    {
+        if (!os_sem_take(&ctx->rx_data, timeout))
+            return rb8_get(ctx->rx_rb, byte);
+    }
+    return true;
 }
+
 uint8_t usart_Receive(USART_TypeDef *USARTx)
 {
-    while (USART_GetFlagStatus(USARTx, USART_FLAG_RXNE) == RESET)
-        ;
-    return USART_ReceiveData(USARTx);
+    uint8_t byte = 0;
+    usart_ReceiveTimeout(USARTx, &byte, OS_WAIT_FOREVER);
+    return byte;
+}
+
+void usart_Flush(USART_TypeDef *USARTx)
+{
+    usart_it_t *ctx = usart_it_find(USARTx);
+
+    if (ctx == NULL || ctx->tx_rb == NULL)
+    {
+        while (USART_GetFlagStatus(USARTx, USART_FLAG_TC) == RESET)
+            ;
+        return;
+    }
+
+    // 等缓冲区排空且最后一个字节移出移位寄存器
+    while (!rb8_empty(ctx->tx_rb) || (USARTx->SR & USART_SR_TC) == 0)
+    {
+        USARTx->CR1 |= USART_CR1_TCIE;
+        os_sem_take(&ctx->tx_space, OS_WAIT_FOREVER);
+    }
+}
+
+void usart_IRQHandler(usart_number_t usart_number)
+{
+    usart_it_t *ctx = &usart_it[usart_number - 1];
+    USART_TypeDef *regs = USART_addr(usart_number);
+    uint16_t sr = regs->SR;
+    uint8_t byte;
+
+    if (ctx->regs == NULL)
+    {
+        // 非中断模式（如 USART1 的 DMA 接收）：读 SR 后读 DR 清除 IDLE
+        if (sr & USART_SR_IDLE)
+            (void)regs->DR;
+        return;
+    }
+
+    if (sr & (USART_SR_RXNE | USART_SR_ORE))
+    {
+        byte = (uint8_t)regs->DR;
+        if (ctx->rx_rb != NULL && rb8_put(ctx->rx_rb, byte))
+            os_sem_give(&ctx->rx_data);
+        else
+            ctx->rx_dropped++;
+    }
+
+    if ((sr & USART_SR_TXE) && (regs->CR1 & USART_CR1_TXEIE))
+    {
+        if (rb8_get(ctx->tx_rb, &byte))
+        {
+            regs->DR = byte;
+            os_sem_give(&ctx->tx_space);
+        }
+        else
+        {
+            regs->CR1 &= ~USART_CR1_TXEIE;
+        }
+    }
+
+    if ((sr & USART_SR_TC) && (regs->CR1 & USART_CR1_TCIE))
+    {
+        regs->CR1 &= ~USART_CR1_TCIE;
+        os_sem_give(&ctx->tx_space);
+    }
 }
 void usart1_nvic_init(void)
 {
@@ -233,5 +477,5 @@ void usart1_nvic_init(void)
     // 开启串口DMA接收
 
     USART_DMACmd(USART1, USART_DMAReq_Tx, ENABLE);
-    DMA2_USART1_Rx_Init(rx_buffer, RX_BUFFER_SIZE);
+    DMA2_USART1_Rx_Init(rx_buffer, USART_MAX_LEN);
 }
\ No newline at end of file
@@ -20,6 +20,8 @@ typedef enum usart_number{
     UART_8
 }usart_number_t;
 
+#define USART_PORT_NUM  8
+
 typedef struct usart_init_t
 {   usart_number_t usart_number;
     uint32_t baud_rate;
@@ -27,23 +29,27 @@ typedef struct usart_init_t
     uint32_t stop_bits;
     uint32_t parity;
     uint32_t mode;
-    uint32_t gpiox;
+    GPIO_TypeDef *gpiox;
     uint32_t gpio_pin_rx;
     uint32_t gpio_pin_tx;
 }usart_t;
 
-usart_t usart1 = {
-    .usart_number = USART_1,
-    .baud_rate = 115200,
-    .data_bits = USART_WordLength_8b ,
-    .stop_bits = USART_StopBits_1,
-    .parity = USART_Parity_No,
-    .mode = USART_Mode_Tx | USART_Mode_Rx,
-    .gpiox = GPIOA,
-    .gpio_pin_rx = GPIO_Pin_9,
-    .gpio_pin_tx = GPIO_Pin_10,
-};
+extern usart_t usart1;
+
 void usart_Init(usart_t* usart);
 void usart_Transmit(USART_TypeDef* USARTx, uint8_t byte);
 uint8_t usart_Receive(USART_TypeDef* USARTx);
+
+/*
+ * 中断模式：给没有空闲 DMA 流的低速口（调试口、辅助传感器）使用。
+ * tx_buf/rx_buf 作为 ringbuffer8 的存储区（含头部），需 4 字节对齐。
+ * 注册后 usart_Transmit/usart_Receive 改为读写环形缓冲区，
+ * 缓冲区满/空时在 OS 信号量上睡眠（调度器未启动时为 WFI），不再忙等。
+ */
+bool usart_IT_Init(usart_t *usart, uint8_t *tx_buf, uint32_t tx_size, uint8_t *rx_buf, uint32_t rx_size, uint8_t priority);
+bool usart_ReceiveTimeout(USART_TypeDef *USARTx, uint8_t *byte, uint32_t timeout);
+void usart_Flush(USART_TypeDef *USARTx);
+void usart_IRQHandler(usart_number_t usart_number);
+
+void usart1_nvic_init(void);
 #endif
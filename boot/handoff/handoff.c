@@ -0,0 +1,191 @@
+#include <stddef.h>
+#include "stm32f4xx.h"
+#include "flash_layout.h"
+#include "handoff.h"
+
+
+#define HANDOFF_RESET_FLAGS     (RCC_CSR_BORRSTF | RCC_CSR_PADRSTF | RCC_CSR_PORRSTF | RCC_CSR_SFTRSTF | \
+                                 RCC_CSR_WDGRSTF | RCC_CSR_WWDGRSTF | RCC_CSR_LPWRRSTF)
+#define HANDOFF_HEADER_SIZE     offsetof(handoff_t, reset_flags)
+
+_Static_assert(sizeof(handoff_t) <= LAYOUT_NOINIT_SIZE, "handoff_t does not fit in NOINIT");
+
+static handoff_t bl_handoff __attribute__((section(".handoff"), used));
+
+// bootloader 侧
+static bool handoff_started;
+static uint32_t handoff_flags;
+static uint32_t handoff_start;
+
+// bootloader 使能过的中断
+static const IRQn_Type handoff_irqs[] = {
+    USART1_IRQn,
+    DMA2_Stream0_IRQn,
+    DMA2_Stream5_IRQn,
+    DMA2_Stream7_IRQn,
+    EXTI15_10_IRQn,
+};
+
+
+// 与 crc32_sw 同一算法，逐位计算：块只有几十字节，SystemInit 中不值得先生成查找表
+static uint32_t handoff_crc(const handoff_t *h, uint32_t size)
+{
+    const uint32_t *w = (const uint32_t *)((const uint8_t *)h + HANDOFF_HEADER_SIZE);
+    uint32_t n = (size - HANDOFF_HEADER_SIZE) / 4U;
+    uint32_t crc = 0xFFFFFFFFU;
+    uint32_t i;
+
+    while (n--)
+    {
+        crc ^= *w++;
+        for (i = 0; i < 32U; i++)
+            crc = (crc & 0x80000000U) ? (crc << 1) ^ 0x04C11DB7U : crc << 1;
+    }
+
+    return crc;
+}
+
+void handoff_begin(void)
+{
+    // 作废上次留下的交接块，跳转前重新封好
+    bl_handoff.magic = 0;
+
+    handoff_flags = RCC->CSR & HANDOFF_RESET_FLAGS;
+    RCC->CSR |= RCC_CSR_RMVF;
+    handoff_started = true;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    handoff_start = DWT->CYCCNT;
+}
+
+void handoff_set_image(uint32_t slot, uint32_t base, uint32_t size, uint32_t verify_cycles)
+{
+    bl_handoff.slot = slot;
+    bl_handoff.image_base = base;
+    bl_handoff.image_size = size;
+    bl_handoff.image_crc = *(const uint32_t *)(base + size - 4U);
+    bl_handoff.verify_cycles = verify_cycles;
+}
+
+// 正在发送的日志发完再复位串口，超时则放弃
+static void handoff_drain(void)
+{
+    uint32_t n = HANDOFF_DRAIN_LOOPS;
+
+    while ((DMA2_Stream7->CR & DMA_SxCR_EN) && --n)
+        ;
+
+    if (USART1->CR1 & USART_CR1_UE)
+    {
+        while (!(USART1->SR & USART_SR_TC) && --n)
+            ;
+    }
+}
+
+static void handoff_deinit(void)
+{
+    uint32_t i;
+
+    SysTick->CTRL = 0;
+    SysTick->LOAD = 0;
+    SysTick->VAL = 0;
+    SCB->ICSR = SCB_ICSR_PENDSTCLR_Msk | SCB_ICSR_PENDSVCLR_Msk;
+
+    for (i = 0; i < sizeof(handoff_irqs) / sizeof(handoff_irqs[0]); i++)
+    {
+        NVIC_DisableIRQ(handoff_irqs[i]);
+        NVIC_ClearPendingIRQ(handoff_irqs[i]);
+    }
+
+    // 时钟没开过的外设寄存器写不进去，DeInit 前先确认
+    if (RCC->AHB1ENR & RCC_AHB1ENR_DMA2EN)
+    {
+        DMA_DeInit(DMA2_Stream0);
+        DMA_DeInit(DMA2_Stream5);
+        DMA_DeInit(DMA2_Stream7);
+    }
+    USART_DeInit(USART1);
+    EXTI_DeInit();
+}
+
+void bl_jump_to_app(uint32_t base)
+{
+    const uint32_t *vector = (const uint32_t *)base;
+
+    handoff_drain();
+    __disable_irq();
+    handoff_deinit();
+
+    bl_handoff.version = HANDOFF_VERSION;
+    bl_handoff.size = sizeof(handoff_t);
+    bl_handoff.reset_flags = handoff_flags;
+    bl_handoff.sysclk = SystemCoreClock;
+    bl_handoff.rcc_cfgr = RCC->CFGR;
+    bl_handoff.rcc_pllcfgr = RCC->PLLCFGR;
+    bl_handoff.boot_cycles = DWT->CYCCNT - handoff_start;
+    bl_handoff.crc = handoff_crc(&bl_handoff, sizeof(handoff_t));
+    bl_handoff.magic = HANDOFF_MAGIC;
+
+    SCB->VTOR = base;
+    __DSB();
+    __ISB();
+
+    // 可能在任务中调用 (PSP)：CONTROL 清零回到特权级、MSP，并清除 FPU 现场标志。
+    // 切换栈之后不能再访问栈上的变量，栈顶和入口先放在寄存器中
+    __asm volatile(
+        "msr control, %2    \n"
+        "isb                \n"
+        "msr msp, %0        \n"
+        "cpsie i            \n"
+        "bx %1              \n"
+        :
+        : "r"(vector[0]), "r"(vector[1]), "r"(0)
+        : "memory");
+
+    __builtin_unreachable();
+}
+
+uint32_t handoff_reset_flags(void)
+{
+    const handoff_t *h;
+
+    if (handoff_started)
+        return handoff_flags;
+
+    // 不经 bootloader 启动时标志还在 RCC_CSR 中
+    h = handoff_get();
+    return h ? h->reset_flags : RCC->CSR & HANDOFF_RESET_FLAGS;
+}
+
+const handoff_t *handoff_get(void)
+{
+    const handoff_t *h = &bl_handoff;
+
+    // 新版 bootloader 的块可以更长，只校验不读取多出的字段
+    if (h->magic != HANDOFF_MAGIC || h->version != HANDOFF_VERSION ||
+        h->size < sizeof(handoff_t) || h->size > LAYOUT_NOINIT_SIZE || (h->size & 3U) ||
+        h->crc != handoff_crc(h, h->size))
+    {
+        return NULL;
+    }
+
+    return h;
+}
+
+bool handoff_clock_adopt(void)
+{
+    const handoff_t *h = handoff_get();
+
+    if (h == NULL ||
+        !(RCC->CR & RCC_CR_PLLRDY) ||
+        (RCC->CFGR & RCC_CFGR_SWS) != RCC_CFGR_SWS_PLL ||
+        RCC->CFGR != h->rcc_cfgr ||
+        RCC->PLLCFGR != h->rcc_pllcfgr)
+    {
+        return false;
+    }
+
+    SystemCoreClock = h->sysclk;
+    return true;
+}
@@ -0,0 +1,80 @@
+#ifndef __BL_HANDOFF_H
+#define __BL_HANDOFF_H
+
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/*
+ * bootloader 到应用的交接。
+ *
+ * bl_jump_to_app 只把 bootloader 用过的外设恢复到复位状态：USART1、DMA2 Stream5/7
+ * （串口收发）、Stream0（镜像校验）、EXTI（串口唤醒）和 SysTick，并关闭它们在 NVIC 中的中断。
+ * RCC 不动，PLL 保持运行，时钟配置写入交接块。
+ *
+ * 交接块位于 NOINIT 区（见 flash_layout.h），bootloader 与应用链接在同一地址，启动代码不清零，
+ * 跳转和热复位后都还在。内容是 bootloader 已经得到的结果，应用不必重算：
+ *   复位原因   bootloader 读取 RCC_CSR 后清除了标志，应用只能从这里得到；
+ *   镜像       所在槽、地址、长度和末尾 CRC，bootloader 已校验过；
+ *   时钟       SystemCoreClock 与 RCC 配置；
+ *   耗时       bootloader 运行和镜像校验所用的周期数。
+ *
+ * 块头带魔数、版本、长度和 CRC，CRC 覆盖块头之后 size 个字节。新字段只加在末尾，
+ * 应用接受 size 不小于自己所知结构的块；不兼容的改动才增加 HANDOFF_VERSION。
+ * bootloader 每次启动先作废交接块，跳转前才重新封好，热复位后停留在 bootloader 时不会留下旧数据。
+ *
+ * bootloader 侧：handoff_begin -> handoff_set_image -> bl_jump_to_app。
+ * 应用侧：SystemInit 调用 handoff_clock_adopt 沿用时钟，之后用 handoff_get 读取其他内容。
+ */
+
+#define HANDOFF_MAGIC           0x48414E44U     /* "HAND" */
+#define HANDOFF_VERSION         1U
+
+/* 等待串口发完最后一段日志的最长时间，按循环次数计 */
+#ifndef HANDOFF_DRAIN_LOOPS
+#define HANDOFF_DRAIN_LOOPS     200000U
+#endif
+
+
+typedef struct
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;              /* 填写方的 sizeof(handoff_t) */
+    uint32_t crc;               /* 之后 size - 12 字节的 CRC */
+
+    /* version 1 */
+    uint32_t reset_flags;       /* RCC_CSR 中的复位标志 (RCC_CSR_xxxRSTF) */
+    uint32_t slot;              /* 启动的槽，见 slot.h */
+    uint32_t image_base;
+    uint32_t image_size;        /* 含末尾 CRC */
+    uint32_t image_crc;         /* 镜像末尾的 CRC，已由 bootloader 校验 */
+    uint32_t sysclk;            /* SystemCoreClock */
+    uint32_t rcc_cfgr;
+    uint32_t rcc_pllcfgr;
+    uint32_t boot_cycles;       /* handoff_begin 到跳转的 CPU 周期 */
+    uint32_t verify_cycles;     /* 选择槽、校验镜像的 CPU 周期 */
+} handoff_t;
+
+
+/* bootloader：main 开头调用（log_init 会清零 CYCCNT，须在其后），读取并清除复位标志 */
+void handoff_begin(void);
+
+/* bootloader：记录将要启动的镜像 */
+void handoff_set_image(uint32_t slot, uint32_t base, uint32_t size, uint32_t verify_cycles);
+
+/* bootloader：封好交接块后启动 base 处的应用（向量表起点），不返回 */
+void bl_jump_to_app(uint32_t base) __attribute__((noreturn));
+
+/* 两侧：本次启动的复位标志 */
+uint32_t handoff_reset_flags(void);
+
+/* 应用：交接块有效时返回，否则为 NULL（直接烧录、调试器下载等不经 bootloader 的启动） */
+const handoff_t *handoff_get(void);
+
+/* 应用：由 SystemInit 在复位 RCC 之前调用；返回 true 时时钟已可用，SystemCoreClock 已更新 */
+bool handoff_clock_adopt(void);
+
+
+#endif /* __BL_HANDOFF_H */
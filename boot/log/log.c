@@ -0,0 +1,99 @@
+#include "stm32f4xx.h"
+#include "os.h"
+#include "log.h"
+
+#if (LOG_BACKEND == LOG_BACKEND_BINARY)
+
+
+/* 主机通过 ELF 符号 log_ring 定位 */
+log_ring_t log_ring;
+
+/* log_init 之前的记录写到这里丢弃 */
+static uint32_t log_discard[2U + 2U * LOG_MAX_ARGS];
+
+
+// 淘汰最旧的一条记录；需在临界区内调用
+static void log_evict(void)
+{
+    uint32_t hdr = log_ring.data[log_ring.tail];
+    uint32_t len;
+
+    if (hdr == LOG_RING_PAD)
+    {
+        len = log_ring.size - log_ring.tail;
+    }
+    else
+    {
+        len = 2U + LOG_HDR_WORDS(hdr);
+        log_ring.dropped++;
+    }
+
+    log_ring.used -= len;
+    log_ring.tail += len;
+    if (log_ring.tail >= log_ring.size)
+        log_ring.tail = 0;
+}
+
+uint32_t *log_bin_begin(uint32_t hdr, uint32_t *state)
+{
+    const uint32_t n = 2U + LOG_HDR_WORDS(hdr);
+    uint32_t *w;
+
+    *state = os_enter_critical();
+
+    // 还没有 log_init：缓冲区大小为 0，淘汰永远腾不出空间
+    if (log_ring.magic != LOG_RING_MAGIC || log_ring.size < n)
+        return &log_discard[2];
+
+    // 记录不跨越缓冲区末尾：不够连续空间时填充并回绕
+    if (log_ring.head + n > log_ring.size)
+    {
+        while (log_ring.used && log_ring.tail >= log_ring.head)
+            log_evict();
+        log_ring.data[log_ring.head] = LOG_RING_PAD;
+        log_ring.used += log_ring.size - log_ring.head;
+        log_ring.head = 0;
+    }
+
+    while (log_ring.size - log_ring.used < n)
+        log_evict();
+
+    w = &log_ring.data[log_ring.head];
+    w[0] = hdr;
+    w[1] = DWT->CYCCNT;
+
+    log_ring.head += n;
+    if (log_ring.head >= log_ring.size)
+        log_ring.head = 0;
+    log_ring.used += n;
+
+    return &w[2];
+}
+
+void log_bin_end(uint32_t state)
+{
+    os_exit_critical(state);
+}
+
+void log_init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    log_ring.size = LOG_RING_WORDS;
+    log_ring.clock_hz = SystemCoreClock;
+    log_ring.head = 0;
+    log_ring.tail = 0;
+    log_ring.used = 0;
+    log_ring.dropped = 0;
+    log_ring.magic = LOG_RING_MAGIC;
+}
+
+#else
+
+void log_init(void)
+{
+}
+
+#endif /* LOG_BACKEND == LOG_BACKEND_BINARY */
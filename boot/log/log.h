@@ -0,0 +1,197 @@
+#ifndef __BL_LOG_H
+#define __BL_LOG_H
+
+
+#include <stdint.h>
+#include <string.h>
+
+
+/*
+ * 日志后端，由 CMakeLists.txt 中的 LOG_BACKEND 选择：
+ *   LOG_BACKEND_NONE   : 日志调用全部编译为空
+ *   LOG_BACKEND_PRINTF : 在设备上格式化，经 printf_compiled 输出，每条日志的格式串首次调用时预解析
+ *   LOG_BACKEND_BINARY : 只记录格式串地址、时间戳和原始参数字，
+ *                        格式串放在不加载的 .logstr 段，由 tools/log_decode.py 在主机上还原
+ *
+ * 二进制记录中整数和指针占 1 个字，long long 占 2 个字，float/double 统一存为 float（1 个字）。
+ * %s 只记录指针，指向 flash 中常量字符串时主机能从 ELF 还原内容。
+ * 单条日志最多 LOG_MAX_ARGS 个参数。
+ */
+
+#define LOG_BACKEND_NONE    0
+#define LOG_BACKEND_PRINTF  1
+#define LOG_BACKEND_BINARY  2
+
+#ifndef LOG_BACKEND
+#define LOG_BACKEND         LOG_BACKEND_NONE
+#endif
+
+#define LOG_LEVEL_ERROR     1
+#define LOG_LEVEL_WARN      2
+#define LOG_LEVEL_INFO      3
+#define LOG_LEVEL_DEBUG     4
+
+/* 编译期过滤，高于该级别的日志不生成代码 */
+#ifndef LOG_LEVEL
+#define LOG_LEVEL           LOG_LEVEL_DEBUG
+#endif
+
+/* 二进制日志环形缓冲区大小（字） */
+#ifndef LOG_RING_WORDS
+#define LOG_RING_WORDS      1024U
+#endif
+
+#define LOG_MAX_ARGS        8
+
+
+/* 对每个参数展开宏 m，最多 LOG_MAX_ARGS 个 */
+#define LOG_NARGS(...)      LOG_NARGS_(0, ##__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define LOG_NARGS_(_0, _1, _2, _3, _4, _5, _6, _7, _8, N, ...) N
+#define LOG_CAT(a, b)       LOG_CAT_(a, b)
+#define LOG_CAT_(a, b)      a##b
+#define LOG_MAP(m, ...)     LOG_CAT(LOG_MAP_, LOG_NARGS(__VA_ARGS__))(m, ##__VA_ARGS__)
+#define LOG_MAP_0(m)
+#define LOG_MAP_1(m, a)         m(a)
+#define LOG_MAP_2(m, a, ...)    m(a) LOG_MAP_1(m, __VA_ARGS__)
+#define LOG_MAP_3(m, a, ...)    m(a) LOG_MAP_2(m, __VA_ARGS__)
+#define LOG_MAP_4(m, a, ...)    m(a) LOG_MAP_3(m, __VA_ARGS__)
+#define LOG_MAP_5(m, a, ...)    m(a) LOG_MAP_4(m, __VA_ARGS__)
+#define LOG_MAP_6(m, a, ...)    m(a) LOG_MAP_5(m, __VA_ARGS__)
+#define LOG_MAP_7(m, a, ...)    m(a) LOG_MAP_6(m, __VA_ARGS__)
+#define LOG_MAP_8(m, a, ...)    m(a) LOG_MAP_7(m, __VA_ARGS__)
+
+/* 不输出，只让编译器按 printf 规则检查格式串和参数 */
+static inline __attribute__((format(printf, 1, 2))) void log_check_format(const char *fmt, ...)
+{
+    (void)fmt;
+}
+
+
+#if (LOG_BACKEND == LOG_BACKEND_BINARY)
+
+#define LOG_RING_MAGIC      0x474F4C42U     /* "BLOG" */
+#define LOG_RING_PAD        0xFFFFFFFFU     /* 回绕填充，主机遇到后跳到 data[0] */
+
+/* 记录头：bit0-22 格式串地址，bit23-27 参数字数，bit28-31 级别；随后是时间戳和参数字 */
+#define LOG_HDR(level, fmt, nwords) \
+    (((uint32_t)(uintptr_t)(fmt) & 0x007FFFFFU) | ((uint32_t)(nwords) << 23) | ((uint32_t)(level) << 28))
+#define LOG_HDR_WORDS(hdr)  (((hdr) >> 23) & 0x1FU)
+
+typedef struct
+{
+    uint32_t magic;
+    uint32_t size;              /* data[] 字数 */
+    uint32_t clock_hz;          /* 时间戳为 DWT 周期计数，主机据此换算 */
+    volatile uint32_t head;     /* 下一条记录写入位置 */
+    volatile uint32_t tail;     /* 最旧记录位置 */
+    volatile uint32_t used;     /* 已用字数 */
+    volatile uint32_t dropped;  /* 被覆盖的旧记录数 */
+    uint32_t data[LOG_RING_WORDS];
+} log_ring_t;
+
+extern log_ring_t log_ring;
+
+uint32_t *log_bin_begin(uint32_t hdr, uint32_t *state);
+void log_bin_end(uint32_t state);
+
+static inline uint32_t *log_put_u32(uint32_t *w, uint32_t v)
+{
+    *w = v;
+    return w + 1;
+}
+
+static inline uint32_t *log_put_u64(uint32_t *w, uint64_t v)
+{
+    w[0] = (uint32_t)v;
+    w[1] = (uint32_t)(v >> 32);
+    return w + 2;
+}
+
+static inline uint32_t *log_put_f32(uint32_t *w, double v)
+{
+    float f = (float)v;
+    memcpy(w, &f, sizeof(f));
+    return w + 1;
+}
+
+static inline uint32_t *log_put_ptr(uint32_t *w, const void *v)
+{
+    *w = (uint32_t)(uintptr_t)v;
+    return w + 1;
+}
+
+#define LOG_ARG_WORDS(x) _Generic((x), long long: 2, unsigned long long: 2, default: 1)
+
+#define LOG_PUT(x) _log_w = _Generic((x),                           \
+        float: log_put_f32, double: log_put_f32,                    \
+        long long: log_put_u64, unsigned long long: log_put_u64,    \
+        char *: log_put_ptr, const char *: log_put_ptr,             \
+        void *: log_put_ptr, const void *: log_put_ptr,             \
+        default: log_put_u32)(_log_w, (x));
+
+#define LOG_WORDS_PLUS(x)   + LOG_ARG_WORDS(x)
+
+#define LOG_EMIT(level, fmt, ...)                                                       \
+do {                                                                                    \
+    static const char _log_fmt[] __attribute__((section(".logstr"), used)) = fmt;      \
+    uint32_t _log_state;                                                                \
+    if (0)                                                                              \
+        log_check_format(fmt, ##__VA_ARGS__);                                           \
+    uint32_t *_log_w = log_bin_begin(                                                   \
+        LOG_HDR(level, _log_fmt, 0 LOG_MAP(LOG_WORDS_PLUS, ##__VA_ARGS__)), &_log_state); \
+    LOG_MAP(LOG_PUT, ##__VA_ARGS__)                                                     \
+    (void)_log_w;                                                                       \
+    log_bin_end(_log_state);                                                            \
+} while (0)
+
+#elif (LOG_BACKEND == LOG_BACKEND_PRINTF)
+
+#include "_printf_.h"
+
+#define LOG_EMIT(level, fmt, ...)                                           \
+do {                                                                        \
+    static printf_fmt_t _log_fmt = PRINTF_FMT_INIT("%c: " fmt "\n");        \
+    if (0)                                                                  \
+        log_check_format(fmt, ##__VA_ARGS__);                               \
+    printf_compiled(&_log_fmt, "?EWID"[level], ##__VA_ARGS__);              \
+} while (0)
+
+#else
+
+#define LOG_EMIT(level, fmt, ...)                   \
+do {                                                \
+    if (0)                                          \
+        log_check_format(fmt, ##__VA_ARGS__);       \
+} while (0)
+
+#endif
+
+
+void log_init(void);
+
+#if (LOG_LEVEL >= LOG_LEVEL_ERROR)
+#define LOG_E(fmt, ...)     LOG_EMIT(LOG_LEVEL_ERROR, fmt, ##__VA_ARGS__)
+#else
+#define LOG_E(fmt, ...)     do { } while (0)
+#endif
+
+#if (LOG_LEVEL >= LOG_LEVEL_WARN)
+#define LOG_W(fmt, ...)     LOG_EMIT(LOG_LEVEL_WARN, fmt, ##__VA_ARGS__)
+#else
+#define LOG_W(fmt, ...)     do { } while (0)
+#endif
+
+#if (LOG_LEVEL >= LOG_LEVEL_INFO)
+#define LOG_I(fmt, ...)     LOG_EMIT(LOG_LEVEL_INFO, fmt, ##__VA_ARGS__)
+#else
+#define LOG_I(fmt, ...)     do { } while (0)
+#endif
+
+#if (LOG_LEVEL >= LOG_LEVEL_DEBUG)
+#define LOG_D(fmt, ...)     LOG_EMIT(LOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__)
+#else
+#define LOG_D(fmt, ...)     do { } while (0)
+#endif
+
+
+#endif /* __BL_LOG_H */
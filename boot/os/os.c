@@ -0,0 +1,68 @@
+#include "stm32f4xx.h"
+#include "main.h"
+#include "os.h"
+
+
+/* 链接脚本中的主栈范围 */
+extern uint32_t _sstack[];
+extern uint32_t _estack[];
+
+
+__attribute__((weak)) void os_idle_hook(void)
+{
+}
+
+/* 默认实现只睡到下一个中断，节拍照常走，因此不需要补偿 */
+__attribute__((weak)) uint32_t os_tickless_enter(uint32_t idle_ticks)
+{
+    (void)idle_ticks;
+    __WFI();
+    return 0;
+}
+
+void bl_delay_init(void)
+{
+    os_tick_init();
+}
+
+void bl_delay_ms(uint32_t ms)
+{
+    os_delay(OS_MS_TO_TICKS(ms));
+}
+
+void os_stack_paint(void)
+{
+    // volatile 防止编译器换成 memset：memset 的栈帧就在 sp 以下，会被自己覆盖
+    volatile uint32_t *p = _sstack;
+    uint32_t *sp = (uint32_t *)__get_MSP();
+
+    // 本函数的栈帧在 sp 以上，不受影响；填充期间的中断照常压栈，计为实际使用
+    while (p < sp)
+        *p++ = OS_STACK_FILL;
+}
+
+uint32_t os_stack_size(void)
+{
+    return (uint32_t)(_estack - _sstack) * sizeof(uint32_t);
+}
+
+uint32_t os_stack_peak(void)
+{
+    return os_stack_used(_sstack, (uint32_t)(_estack - _sstack), OS_STACK_FILL);
+}
+
+uint32_t os_stack_used(const uint32_t *stack, uint32_t words, uint32_t fill)
+{
+    uint32_t i = 0;
+
+    while (i < words && stack[i] == fill)
+        i++;
+
+    return (words - i) * sizeof(uint32_t);
+}
+
+/* OS_TICK_RATE_HZ 需能整除 1000 */
+uint32_t bl_now(void)
+{
+    return os_tick_get() * (1000U / OS_TICK_RATE_HZ);
+}
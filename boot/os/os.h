@@ -0,0 +1,215 @@
+#ifndef __BL_OS_H
+#define __BL_OS_H
+
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/*
+ * OS 抽象层，由 CMakeLists.txt 中的 USING_RTOS 选择后端：
+ *   USING_NON_RTOS : os_nortos.c   自带的最小抢占式调度器 (PendSV/SVC)
+ *   USING_FREERTOS : os_freertos.c 映射到 FreeRTOS (third_lib/FreeRTOS)
+ *   USING_THREADX  : os_threadx.c  映射到 ThreadX  (third_lib/threadx)
+ *
+ * 所有阻塞接口在调度器启动前也可使用，此时在 WFI 中睡眠等待，
+ * 驱动可以直接用它们代替忙等。
+ */
+
+#ifndef USING_RTOS
+#define USING_NON_RTOS  0
+#define USING_FREERTOS  1
+#define USING_THREADX   2
+#define USING_RTOS      USING_NON_RTOS
+#endif
+
+/* 系统节拍频率 */
+#ifndef OS_TICK_RATE_HZ
+#define OS_TICK_RATE_HZ         1000U
+#endif
+
+/* 最大任务数（不含空闲任务） */
+#ifndef OS_MAX_TASKS
+#define OS_MAX_TASKS            8U
+#endif
+
+/* 空闲任务栈大小（字） */
+#ifndef OS_IDLE_STACK_WORDS
+#define OS_IDLE_STACK_WORDS     128U
+#endif
+
+/* 主栈和自带调度器任务栈的填充值，用于统计栈的峰值 */
+#define OS_STACK_FILL           0xA5A5A5A5U
+
+/* 空闲时是否调用 os_tickless_enter() 进入无节拍睡眠 */
+#ifndef OS_TICKLESS_IDLE
+#define OS_TICKLESS_IDLE        0
+#endif
+
+#define OS_NO_WAIT              0U
+#define OS_WAIT_FOREVER         0xFFFFFFFFU
+
+#define OS_MS_TO_TICKS(ms)      ((uint32_t)(((uint64_t)(ms) * OS_TICK_RATE_HZ) / 1000U))
+
+
+typedef void (*os_task_fn_t)(void *arg);
+
+#if (USING_RTOS == USING_NON_RTOS)
+
+typedef enum
+{
+    OS_TASK_READY = 0,
+    OS_TASK_BLOCKED,
+    OS_TASK_DEAD,
+} os_task_state_t;
+
+typedef struct os_task
+{
+    uint32_t *sp;               /* 必须是第一个成员，PendSV 通过它保存/恢复上下文 */
+    uint32_t *stack;
+    uint32_t stack_words;
+    const char *name;
+    uint8_t prio;               /* 数值越大优先级越高，0 为空闲任务 */
+    volatile uint8_t state;
+    const void *volatile wait_obj;
+    uint32_t wake_tick;
+    bool timed;
+    volatile uint32_t notify;
+} os_task_t;
+
+typedef struct os_sem
+{
+    volatile uint32_t count;
+    uint32_t max;
+} os_sem_t;
+
+typedef struct os_queue
+{
+    uint8_t *buffer;
+    uint32_t item_size;
+    uint32_t capacity;
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    volatile uint32_t count;
+} os_queue_t;
+
+#elif (USING_RTOS == USING_FREERTOS)
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+typedef struct os_task
+{
+    TaskHandle_t handle;
+    StaticTask_t tcb;
+    uint32_t stack_words;
+} os_task_t;
+
+typedef struct os_sem
+{
+    SemaphoreHandle_t handle;
+    StaticSemaphore_t sem;
+} os_sem_t;
+
+typedef struct os_queue
+{
+    QueueHandle_t handle;
+    StaticQueue_t queue;
+} os_queue_t;
+
+#elif (USING_RTOS == USING_THREADX)
+
+#include "tx_api.h"
+
+typedef struct os_task
+{
+    TX_THREAD thread;           /* 必须是第一个成员，os_task_self() 直接转换 */
+    TX_EVENT_FLAGS_GROUP notify;
+    os_task_fn_t fn;
+    void *arg;
+    const char *name;
+    uint8_t prio;
+    uint32_t *stack;
+    uint32_t stack_words;
+} os_task_t;
+
+typedef struct os_sem
+{
+    TX_SEMAPHORE sem;
+    uint32_t max;
+} os_sem_t;
+
+typedef struct os_queue
+{
+    TX_QUEUE queue;
+    uint32_t item_size;
+} os_queue_t;
+
+#else
+#error "USING_RTOS: unknown RTOS backend"
+#endif
+
+
+/* 任务 */
+bool os_task_create(os_task_t *task, const char *name, os_task_fn_t fn, void *arg,
+                    uint8_t prio, uint32_t *stack, uint32_t stack_words);
+os_task_t *os_task_self(void);
+void os_start(void);
+bool os_is_running(void);
+void os_yield(void);
+void os_delay(uint32_t ticks);
+
+/* 信号量 */
+void os_sem_init(os_sem_t *sem, uint32_t initial, uint32_t max);
+bool os_sem_take(os_sem_t *sem, uint32_t timeout);
+void os_sem_give(os_sem_t *sem);
+
+/* 固定长度消息队列，buffer 大小为 item_size * capacity */
+void os_queue_init(os_queue_t *queue, void *buffer, uint32_t item_size, uint32_t capacity);
+bool os_queue_send(os_queue_t *queue, const void *item, uint32_t timeout);
+bool os_queue_recv(os_queue_t *queue, void *item, uint32_t timeout);
+
+/*
+ * 任务通知：按位或到目标任务的通知值，可在中断中调用。
+ * task 为 NULL 表示调度器启动前的主循环上下文。
+ */
+void os_notify(os_task_t *task, uint32_t bits);
+bool os_notify_wait(uint32_t *bits, uint32_t timeout);
+
+/* 临界区，可嵌套，可在中断中使用 */
+uint32_t os_enter_critical(void);
+void os_exit_critical(uint32_t state);
+bool os_in_isr(void);
+
+/*
+ * 栈使用峰值（字节），从栈底找第一个被改写过的字，返回值等于栈大小时栈可能已经溢出。
+ *   os_stack_paint      填充主栈 (MSP) 中当前栈指针以下的部分，在 main 开头调用一次；
+ *                       主栈是 main 在 os_start 之前和所有中断共用的栈，大小和位置见链接脚本
+ *   os_stack_peak       主栈的峰值，未调用 os_stack_paint 时等于 os_stack_size()
+ *   os_task_stack_peak  任务栈的峰值：自带调度器在创建时填充；FreeRTOS 用 uxTaskGetStackHighWaterMark
+ *                       (需 INCLUDE_uxTaskGetStackHighWaterMark)；ThreadX 用它自己的填充值
+ *                       (不能定义 TX_DISABLE_STACK_FILLING)
+ */
+void os_stack_paint(void);
+uint32_t os_stack_size(void);
+uint32_t os_stack_peak(void);
+uint32_t os_task_stack_peak(os_task_t *task);
+uint32_t os_stack_used(const uint32_t *stack, uint32_t words, uint32_t fill);
+
+/* 节拍 */
+void os_tick_init(void);
+void os_tick_handler(void);
+uint32_t os_tick_get(void);
+
+/*
+ * 钩子（弱定义，可由应用覆盖）：
+ *   os_idle_hook       空闲任务每轮调用一次
+ *   os_tickless_enter  空闲且最近唤醒还在 idle_ticks 之后时调用，返回实际睡过的节拍数
+ */
+void os_idle_hook(void);
+uint32_t os_tickless_enter(uint32_t idle_ticks);
+
+
+#endif /* __BL_OS_H */
@@ -0,0 +1,274 @@
+#include "stm32f4xx.h"
+#include "main.h"
+#include "os.h"
+
+#if (USING_RTOS == USING_FREERTOS)
+
+/*
+ * FreeRTOS 后端，要求 FreeRTOSConfig.h 中：
+ *   configSUPPORT_STATIC_ALLOCATION = 1
+ *   configUSE_IDLE_HOOK             = 1
+ *   configUSE_TASK_NOTIFICATIONS    = 1
+ *   configTICK_RATE_HZ              = OS_TICK_RATE_HZ
+ *   configNUM_THREAD_LOCAL_STORAGE_POINTERS >= 1
+ *   #define vPortSVCHandler         SVC_Handler
+ *   #define xPortPendSVHandler      PendSV_Handler
+ * SysTick_Handler 保留在 stm32f4xx_it.c，通过 os_tick_handler() 转发。
+ * 启用 OS_TICKLESS_IDLE 时再定义：
+ *   #define portSUPPRESS_TICKS_AND_SLEEP(x) os_freertos_suppress_ticks(x)
+ */
+
+static volatile uint32_t os_pre_tick;
+static volatile uint32_t os_main_notify;
+static StaticTask_t os_idle_tcb;
+static StackType_t os_idle_stack[OS_IDLE_STACK_WORDS];
+
+
+uint32_t os_enter_critical(void)
+{
+    return portSET_INTERRUPT_MASK_FROM_ISR();
+}
+
+void os_exit_critical(uint32_t state)
+{
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(state);
+}
+
+bool os_in_isr(void)
+{
+    return __get_IPSR() != 0;
+}
+
+bool os_is_running(void)
+{
+    return xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED;
+}
+
+/* 调度器启动前 FreeRTOS 不能阻塞，退化为 WFI 轮询 */
+static bool os_poll(bool (*try_fn)(void *obj), void *obj, uint32_t timeout)
+{
+    const uint32_t start = os_pre_tick;
+
+    for (;;)
+    {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        if (try_fn(obj))
+        {
+            __set_PRIMASK(primask);
+            return true;
+        }
+        if (timeout == OS_NO_WAIT || (timeout != OS_WAIT_FOREVER && os_pre_tick - start >= timeout))
+        {
+            __set_PRIMASK(primask);
+            return false;
+        }
+        __WFI();
+        __set_PRIMASK(primask);
+    }
+}
+
+bool os_task_create(os_task_t *task, const char *name, os_task_fn_t fn, void *arg,
+                    uint8_t prio, uint32_t *stack, uint32_t stack_words)
+{
+    CHECK_RETX(prio < configMAX_PRIORITIES, false);
+
+    task->handle = xTaskCreateStatic(fn, name, stack_words, arg, prio, (StackType_t *)stack, &task->tcb);
+    CHECK_RETX(task->handle != NULL, false);
+    task->stack_words = stack_words;
+
+    vTaskSetThreadLocalStoragePointer(task->handle, 0, task);
+    return true;
+}
+
+/* 高水位是从未用到的最少字数 */
+uint32_t os_task_stack_peak(os_task_t *task)
+{
+    return (task->stack_words - (uint32_t)uxTaskGetStackHighWaterMark(task->handle)) * sizeof(StackType_t);
+}
+
+os_task_t *os_task_self(void)
+{
+    /* FreeRTOS 只返回自己的句柄，os_task_t 存放在 0 号 TLS 指针中 */
+    if (!os_is_running())
+        return NULL;
+    return (os_task_t *)pvTaskGetThreadLocalStoragePointer(NULL, 0);
+}
+
+void os_start(void)
+{
+    vTaskStartScheduler();
+    for (;;)
+        ;
+}
+
+void os_yield(void)
+{
+    if (os_is_running() && !os_in_isr())
+        taskYIELD();
+}
+
+void os_delay(uint32_t ticks)
+{
+    if (os_is_running())
+    {
+        vTaskDelay(ticks);
+        return;
+    }
+
+    const uint32_t start = os_pre_tick;
+    while (os_pre_tick - start < ticks)
+        __WFI();
+}
+
+void os_sem_init(os_sem_t *sem, uint32_t initial, uint32_t max)
+{
+    sem->handle = xSemaphoreCreateCountingStatic(max, initial, &sem->sem);
+}
+
+static bool os_sem_try(void *obj)
+{
+    return xSemaphoreTake(((os_sem_t *)obj)->handle, 0) == pdTRUE;
+}
+
+bool os_sem_take(os_sem_t *sem, uint32_t timeout)
+{
+    if (os_in_isr())
+    {
+        BaseType_t woken = pdFALSE;
+        bool ok = xSemaphoreTakeFromISR(sem->handle, &woken) == pdTRUE;
+        portYIELD_FROM_ISR(woken);
+        return ok;
+    }
+    if (!os_is_running())
+        return os_poll(os_sem_try, sem, timeout);
+    return xSemaphoreTake(sem->handle, timeout) == pdTRUE;
+}
+
+void os_sem_give(os_sem_t *sem)
+{
+    if (os_in_isr())
+    {
+        BaseType_t woken = pdFALSE;
+        xSemaphoreGiveFromISR(sem->handle, &woken);
+        portYIELD_FROM_ISR(woken);
+        return;
+    }
+    xSemaphoreGive(sem->handle);
+}
+
+void os_queue_init(os_queue_t *queue, void *buffer, uint32_t item_size, uint32_t capacity)
+{
+    queue->handle = xQueueCreateStatic(capacity, item_size, buffer, &queue->queue);
+}
+
+bool os_queue_send(os_queue_t *queue, const void *item, uint32_t timeout)
+{
+    if (os_in_isr())
+    {
+        BaseType_t woken = pdFALSE;
+        bool ok = xQueueSendFromISR(queue->handle, item, &woken) == pdTRUE;
+        portYIELD_FROM_ISR(woken);
+        return ok;
+    }
+    return xQueueSend(queue->handle, item, os_is_running() ? timeout : 0) == pdTRUE;
+}
+
+bool os_queue_recv(os_queue_t *queue, void *item, uint32_t timeout)
+{
+    if (os_in_isr())
+    {
+        BaseType_t woken = pdFALSE;
+        bool ok = xQueueReceiveFromISR(queue->handle, item, &woken) == pdTRUE;
+        portYIELD_FROM_ISR(woken);
+        return ok;
+    }
+    return xQueueReceive(queue->handle, item, os_is_running() ? timeout : 0) == pdTRUE;
+}
+
+void os_notify(os_task_t *task, uint32_t bits)
+{
+    if (task == NULL)
+    {
+        uint32_t state = os_enter_critical();
+        os_main_notify |= bits;
+        os_exit_critical(state);
+        return;
+    }
+
+    if (os_in_isr())
+    {
+        BaseType_t woken = pdFALSE;
+        xTaskNotifyFromISR(task->handle, bits, eSetBits, &woken);
+        portYIELD_FROM_ISR(woken);
+        return;
+    }
+    xTaskNotify(task->handle, bits, eSetBits);
+}
+
+static bool os_notify_try(void *obj)
+{
+    if (os_main_notify == 0)
+        return false;
+    *(uint32_t *)obj = os_main_notify;
+    os_main_notify = 0;
+    return true;
+}
+
+bool os_notify_wait(uint32_t *bits, uint32_t timeout)
+{
+    uint32_t value = 0;
+    bool ok;
+
+    if (!os_is_running())
+        ok = os_poll(os_notify_try, &value, timeout);
+    else
+        ok = xTaskNotifyWait(0, 0xFFFFFFFFU, &value, timeout) == pdTRUE;
+
+    if (ok && bits != NULL)
+        *bits = value;
+    return ok;
+}
+
+/* 调度器启动后由 vPortSetupTimerInterrupt 重新配置 SysTick */
+void os_tick_init(void)
+{
+    SysTick_Config(SystemCoreClock / OS_TICK_RATE_HZ);
+}
+
+void os_tick_handler(void)
+{
+    if (os_is_running())
+        xPortSysTickHandler();
+    else
+        os_pre_tick++;
+}
+
+uint32_t os_tick_get(void)
+{
+    if (!os_is_running())
+        return os_pre_tick;
+    return os_in_isr() ? xTaskGetTickCountFromISR() : xTaskGetTickCount();
+}
+
+void vApplicationIdleHook(void)
+{
+    os_idle_hook();
+}
+
+void vApplicationGetIdleTaskMemory(StaticTask_t **tcb, StackType_t **stack, uint32_t *stack_words)
+{
+    *tcb = &os_idle_tcb;
+    *stack = os_idle_stack;
+    *stack_words = OS_IDLE_STACK_WORDS;
+}
+
+void os_freertos_suppress_ticks(TickType_t idle_ticks)
+{
+    uint32_t slept = os_tickless_enter(idle_ticks);
+    if (slept)
+        vTaskStepTick(slept);
+}
+
+
+#endif /* USING_RTOS == USING_FREERTOS */
@@ -0,0 +1,495 @@
+#include <string.h>
+#include "stm32f4xx.h"
+#include "main.h"
+#include "os.h"
+
+#if (USING_RTOS == USING_NON_RTOS)
+
+
+#define OS_INITIAL_XPSR         0x01000000U
+#define OS_INITIAL_EXC_RETURN   0xFFFFFFFDU     /* 返回线程模式，使用 PSP，无 FPU 帧 */
+#define OS_MIN_STACK_WORDS      32U
+
+
+/* PendSV/SVC 汇编中按名字引用，不能是 static */
+os_task_t *volatile os_cur_task;
+
+static os_task_t *os_tasks[OS_MAX_TASKS + 1];
+static uint32_t os_task_count;
+static volatile bool os_running;
+static volatile uint32_t os_tick;
+static volatile uint32_t os_main_notify;
+
+static os_task_t os_idle_task;
+static uint32_t os_idle_stack[OS_IDLE_STACK_WORDS] __attribute__((aligned(8)));
+
+
+uint32_t os_enter_critical(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    return primask;
+}
+
+void os_exit_critical(uint32_t state)
+{
+    __set_PRIMASK(state);
+}
+
+bool os_in_isr(void)
+{
+    return __get_IPSR() != 0;
+}
+
+static inline void os_pend_switch(void)
+{
+    SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+}
+
+/* 唤醒所有等待 obj 的任务，由它们自己重试；需在临界区内调用 */
+static void os_wake_waiters(const void *obj)
+{
+    bool preempt = false;
+
+    if (!os_running)
+        return;
+
+    for (uint32_t i = 0; i < os_task_count; i++)
+    {
+        os_task_t *t = os_tasks[i];
+        if (t->state == OS_TASK_BLOCKED && t->wait_obj == obj)
+        {
+            t->state = OS_TASK_READY;
+            t->wait_obj = NULL;
+            if (t->prio > os_cur_task->prio)
+                preempt = true;
+        }
+    }
+
+    if (preempt)
+        os_pend_switch();
+}
+
+/* 节拍推进并唤醒到期任务；需在临界区或 SysTick 中调用 */
+static void os_tick_advance(uint32_t ticks)
+{
+    bool preempt = false;
+
+    os_tick += ticks;
+    if (!os_running)
+        return;
+
+    for (uint32_t i = 0; i < os_task_count; i++)
+    {
+        os_task_t *t = os_tasks[i];
+        if (t->state == OS_TASK_BLOCKED && t->timed && (int32_t)(os_tick - t->wake_tick) >= 0)
+        {
+            t->state = OS_TASK_READY;
+            t->wait_obj = NULL;
+        }
+        /* 同优先级时间片轮转 */
+        if (t != os_cur_task && t->state == OS_TASK_READY && t->prio >= os_cur_task->prio)
+            preempt = true;
+    }
+
+    if (preempt)
+        os_pend_switch();
+}
+
+/*
+ * 通用阻塞等待：try_fn 在临界区内尝试获取资源，失败则阻塞在 obj 上。
+ * 调度器未启动时在 WFI 中睡眠，关中断状态下执行 WFI 可避免丢失唤醒。
+ */
+static bool os_wait(const void *obj, bool (*try_fn)(void *obj, void *ctx), void *ctx, uint32_t timeout)
+{
+    const uint32_t start = os_tick;
+
+    for (;;)
+    {
+        uint32_t primask = os_enter_critical();
+
+        if (try_fn((void *)obj, ctx))
+        {
+            os_exit_critical(primask);
+            return true;
+        }
+
+        if (timeout == OS_NO_WAIT || os_in_isr() ||
+            (timeout != OS_WAIT_FOREVER && os_tick - start >= timeout))
+        {
+            os_exit_critical(primask);
+            return false;
+        }
+
+        if (os_running)
+        {
+            os_cur_task->wait_obj = obj;
+            os_cur_task->timed = timeout != OS_WAIT_FOREVER;
+            os_cur_task->wake_tick = start + timeout;
+            os_cur_task->state = OS_TASK_BLOCKED;
+            os_pend_switch();
+        }
+        else
+        {
+            __WFI();
+        }
+
+        os_exit_critical(primask);
+    }
+}
+
+static void os_task_exit(void)
+{
+    os_cur_task->state = OS_TASK_DEAD;
+    os_pend_switch();
+    for (;;)
+        ;
+}
+
+bool os_task_create(os_task_t *task, const char *name, os_task_fn_t fn, void *arg,
+                    uint8_t prio, uint32_t *stack, uint32_t stack_words)
+{
+    CHECK_RETX(task != NULL && fn != NULL && stack != NULL, false);
+    CHECK_RETX(stack_words >= OS_MIN_STACK_WORDS, false);
+    CHECK_RETX(os_task_count < OS_MAX_TASKS + 1, false);
+
+    memset(task, 0, sizeof(os_task_t));
+    task->stack = stack;
+    task->stack_words = stack_words;
+    task->name = name;
+    task->prio = prio;
+    task->state = OS_TASK_READY;
+
+    for (uint32_t i = 0; i < stack_words; i++)
+        stack[i] = OS_STACK_FILL;
+
+    /* 栈顶 8 字节对齐，伪造一次异常返回现场：r4-r11, EXC_RETURN, r0-r3, r12, lr, pc, xPSR */
+    uint32_t *sp = (uint32_t *)((uint32_t)(stack + stack_words) & ~7U);
+    *(--sp) = OS_INITIAL_XPSR;
+    *(--sp) = (uint32_t)fn & ~1U;
+    *(--sp) = (uint32_t)os_task_exit;
+    sp -= 4;                                    /* r12, r3, r2, r1 */
+    *(--sp) = (uint32_t)arg;                    /* r0 */
+    *(--sp) = OS_INITIAL_EXC_RETURN;
+    sp -= 8;                                    /* r11-r4 */
+    task->sp = sp;
+
+    uint32_t primask = os_enter_critical();
+    os_tasks[os_task_count++] = task;
+    if (os_running && task->prio > os_cur_task->prio)
+        os_pend_switch();
+    os_exit_critical(primask);
+
+    return true;
+}
+
+uint32_t os_task_stack_peak(os_task_t *task)
+{
+    return os_stack_used(task->stack, task->stack_words, OS_STACK_FILL);
+}
+
+os_task_t *os_task_self(void)
+{
+    return os_running ? os_cur_task : NULL;
+}
+
+bool os_is_running(void)
+{
+    return os_running;
+}
+
+/* 由 PendSV 在关中断时调用：选最高优先级就绪任务，同优先级从当前任务之后轮转 */
+void os_switch_context(void)
+{
+    uint32_t cur = 0;
+    os_task_t *best = NULL;
+
+    while (cur < os_task_count && os_tasks[cur] != os_cur_task)
+        cur++;
+
+    for (uint32_t i = 1; i <= os_task_count; i++)
+    {
+        os_task_t *t = os_tasks[(cur + i) % os_task_count];
+        if (t->state == OS_TASK_READY && (best == NULL || t->prio > best->prio))
+            best = t;
+    }
+
+    os_cur_task = best;
+}
+
+static uint32_t os_next_wake(void)
+{
+    uint32_t next = OS_WAIT_FOREVER;
+
+    for (uint32_t i = 0; i < os_task_count; i++)
+    {
+        os_task_t *t = os_tasks[i];
+        if (t == &os_idle_task)
+            continue;
+        if (t->state == OS_TASK_READY)
+            return 0;
+        if (t->state == OS_TASK_BLOCKED && t->timed)
+        {
+            uint32_t left = t->wake_tick - os_tick;
+            if ((int32_t)left <= 0)
+                return 0;
+            if (left < next)
+                next = left;
+        }
+    }
+
+    return next;
+}
+
+static void os_idle(void *arg)
+{
+    (void)arg;
+
+    for (;;)
+    {
+        os_idle_hook();
+
+#if OS_TICKLESS_IDLE
+        uint32_t primask = os_enter_critical();
+        uint32_t idle_ticks = os_next_wake();
+        if (idle_ticks >= 2U)
+        {
+            uint32_t slept = os_tickless_enter(idle_ticks);
+            if (slept)
+                os_tick_advance(slept);
+        }
+        os_exit_critical(primask);
+#else
+        __WFI();
+#endif
+    }
+}
+
+void os_start(void)
+{
+    os_task_create(&os_idle_task, "idle", os_idle, NULL, 0, os_idle_stack, OS_IDLE_STACK_WORDS);
+
+    /* PendSV 最低优先级，保证只在没有其他中断时切换 */
+    NVIC_SetPriority(PendSV_IRQn, (1U << __NVIC_PRIO_BITS) - 1U);
+    NVIC_SetPriority(SysTick_IRQn, (1U << __NVIC_PRIO_BITS) - 1U);
+    if ((SysTick->CTRL & SysTick_CTRL_ENABLE_Msk) == 0)
+        os_tick_init();
+
+    __disable_irq();
+    os_cur_task = os_tasks[0];
+    os_switch_context();
+    os_running = true;
+
+    __asm volatile(
+        "   cpsie   i       \n"
+        "   cpsie   f       \n"
+        "   dsb             \n"
+        "   isb             \n"
+        "   svc     0       \n"
+        "   nop             \n");
+
+    for (;;)
+        ;
+}
+
+void os_yield(void)
+{
+    if (os_running && !os_in_isr())
+        os_pend_switch();
+}
+
+static bool os_delay_try(void *obj, void *ctx)
+{
+    (void)obj;
+    (void)ctx;
+    return false;
+}
+
+void os_delay(uint32_t ticks)
+{
+    const uint32_t start = os_tick;
+
+    if (ticks == 0)
+    {
+        os_yield();
+        return;
+    }
+
+    /* 等待一个永远不会被唤醒的对象，只能靠超时返回 */
+    while (os_tick - start < ticks)
+        os_wait((const void *)&os_tick, os_delay_try, NULL, ticks - (os_tick - start));
+}
+
+void os_sem_init(os_sem_t *sem, uint32_t initial, uint32_t max)
+{
+    sem->count = initial;
+    sem->max = max;
+}
+
+static bool os_sem_try(void *obj, void *ctx)
+{
+    os_sem_t *sem = obj;
+    (void)ctx;
+
+    if (sem->count == 0)
+        return false;
+    sem->count--;
+    return true;
+}
+
+bool os_sem_take(os_sem_t *sem, uint32_t timeout)
+{
+    return os_wait(sem, os_sem_try, NULL, timeout);
+}
+
+void os_sem_give(os_sem_t *sem)
+{
+    uint32_t primask = os_enter_critical();
+    if (sem->count < sem->max)
+        sem->count++;
+    os_wake_waiters(sem);
+    os_exit_critical(primask);
+}
+
+void os_queue_init(os_queue_t *queue, void *buffer, uint32_t item_size, uint32_t capacity)
+{
+    queue->buffer = buffer;
+    queue->item_size = item_size;
+    queue->capacity = capacity;
+    queue->head = 0;
+    queue->tail = 0;
+    queue->count = 0;
+}
+
+static bool os_queue_send_try(void *obj, void *ctx)
+{
+    os_queue_t *q = obj;
+
+    if (q->count >= q->capacity)
+        return false;
+
+    memcpy(q->buffer + q->head * q->item_size, ctx, q->item_size);
+    q->head = q->head + 1 < q->capacity ? q->head + 1 : 0;
+    q->count++;
+    os_wake_waiters(q);
+    return true;
+}
+
+static bool os_queue_recv_try(void *obj, void *ctx)
+{
+    os_queue_t *q = obj;
+
+    if (q->count == 0)
+        return false;
+
+    memcpy(ctx, q->buffer + q->tail * q->item_size, q->item_size);
+    q->tail = q->tail + 1 < q->capacity ? q->tail + 1 : 0;
+    q->count--;
+    os_wake_waiters(q);
+    return true;
+}
+
+bool os_queue_send(os_queue_t *queue, const void *item, uint32_t timeout)
+{
+    return os_wait(queue, os_queue_send_try, (void *)item, timeout);
+}
+
+bool os_queue_recv(os_queue_t *queue, void *item, uint32_t timeout)
+{
+    return os_wait(queue, os_queue_recv_try, item, timeout);
+}
+
+static volatile uint32_t *os_notify_slot(os_task_t *task)
+{
+    return task != NULL ? &task->notify : &os_main_notify;
+}
+
+void os_notify(os_task_t *task, uint32_t bits)
+{
+    uint32_t primask = os_enter_critical();
+    *os_notify_slot(task) |= bits;
+    os_wake_waiters((const void *)os_notify_slot(task));
+    os_exit_critical(primask);
+}
+
+static bool os_notify_try(void *obj, void *ctx)
+{
+    volatile uint32_t *slot = obj;
+
+    if (*slot == 0)
+        return false;
+    *(uint32_t *)ctx = *slot;
+    *slot = 0;
+    return true;
+}
+
+bool os_notify_wait(uint32_t *bits, uint32_t timeout)
+{
+    uint32_t dummy;
+    return os_wait((const void *)os_notify_slot(os_task_self()), os_notify_try, bits != NULL ? bits : &dummy, timeout);
+}
+
+void os_tick_init(void)
+{
+    SysTick_Config(SystemCoreClock / OS_TICK_RATE_HZ);
+}
+
+void os_tick_handler(void)
+{
+    os_tick_advance(1);
+}
+
+uint32_t os_tick_get(void)
+{
+    return os_tick;
+}
+
+/* 启动第一个任务 */
+__attribute__((naked)) void SVC_Handler(void)
+{
+    __asm volatile(
+        "   ldr     r3, =os_cur_task        \n"
+        "   ldr     r1, [r3]                \n"
+        "   ldr     r0, [r1]                \n"
+        "   ldmia   r0!, {r4-r11, r14}      \n"
+        "   msr     psp, r0                 \n"
+        "   isb                             \n"
+        "   bx      r14                     \n"
+        "   .ltorg                          \n");
+}
+
+/* 上下文切换；EXC_RETURN bit4 为 0 说明任务使用过 FPU，需保存 s16-s31 */
+__attribute__((naked)) void PendSV_Handler(void)
+{
+    __asm volatile(
+        "   mrs     r0, psp                 \n"
+        "   isb                             \n"
+        "   ldr     r3, =os_cur_task        \n"
+        "   ldr     r2, [r3]                \n"
+#if (__FPU_USED == 1)
+        "   tst     r14, #0x10              \n"
+        "   it      eq                      \n"
+        "   vstmdbeq r0!, {s16-s31}         \n"
+#endif
+        "   stmdb   r0!, {r4-r11, r14}      \n"
+        "   str     r0, [r2]                \n"
+        "   cpsid   i                       \n"
+        "   bl      os_switch_context       \n"
+        "   cpsie   i                       \n"
+        "   ldr     r3, =os_cur_task        \n"
+        "   ldr     r1, [r3]                \n"
+        "   ldr     r0, [r1]                \n"
+        "   ldmia   r0!, {r4-r11, r14}      \n"
+#if (__FPU_USED == 1)
+        "   tst     r14, #0x10              \n"
+        "   it      eq                      \n"
+        "   vldmiaeq r0!, {s16-s31}         \n"
+#endif
+        "   msr     psp, r0                 \n"
+        "   isb                             \n"
+        "   bx      r14                     \n"
+        "   .ltorg                          \n");
+}
+
+
+#endif /* USING_RTOS == USING_NON_RTOS */
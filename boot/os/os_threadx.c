@@ -0,0 +1,256 @@
+#include "stm32f4xx.h"
+#include "main.h"
+#include "os.h"
+
+#if (USING_RTOS == USING_THREADX)
+
+/*
+ * ThreadX 后端：
+ *   - tx_kernel_enter() 会重新初始化内核对象，启动前创建的任务先登记，
+ *     在 tx_application_define() 中统一创建；
+ *   - 优先级映射为 TX_MAX_PRIORITIES - 1 - prio（ThreadX 数值越小越高）；
+ *   - 队列元素大小必须是 4 字节的整数倍，且不超过 64 字节；
+ *   - 移植层的 tx_initialize_low_level 不要再定义 SysTick_Handler，
+ *     stm32f4xx_it.c 中的 SysTick_Handler 通过 os_tick_handler() 转发。
+ */
+
+/* 与 tx_thread.h 中的 TX_STACK_FILL 相同 */
+#define OS_TX_STACK_FILL        0xEFEFEFEFU
+
+static os_task_t *os_pending[OS_MAX_TASKS];
+static uint32_t os_pending_count;
+static volatile bool os_running;
+static volatile uint32_t os_pre_tick;
+static volatile uint32_t os_main_notify;
+
+extern VOID _tx_timer_interrupt(VOID);
+
+
+uint32_t os_enter_critical(void)
+{
+    return tx_interrupt_control(TX_INT_DISABLE);
+}
+
+void os_exit_critical(uint32_t state)
+{
+    tx_interrupt_control(state);
+}
+
+bool os_in_isr(void)
+{
+    return __get_IPSR() != 0;
+}
+
+bool os_is_running(void)
+{
+    return os_running;
+}
+
+/* 内核启动前退化为 WFI 轮询 */
+static bool os_poll(bool (*try_fn)(void *obj), void *obj, uint32_t timeout)
+{
+    const uint32_t start = os_pre_tick;
+
+    for (;;)
+    {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        if (try_fn(obj))
+        {
+            __set_PRIMASK(primask);
+            return true;
+        }
+        if (timeout == OS_NO_WAIT || (timeout != OS_WAIT_FOREVER && os_pre_tick - start >= timeout))
+        {
+            __set_PRIMASK(primask);
+            return false;
+        }
+        __WFI();
+        __set_PRIMASK(primask);
+    }
+}
+
+static VOID os_task_entry(ULONG input)
+{
+    os_task_t *task = (os_task_t *)input;
+    task->fn(task->arg);
+}
+
+static bool os_task_spawn(os_task_t *task)
+{
+    CHECK_RETX(tx_event_flags_create(&task->notify, (CHAR *)task->name) == TX_SUCCESS, false);
+
+    UINT prio = TX_MAX_PRIORITIES - 1U - task->prio;
+    return tx_thread_create(&task->thread, (CHAR *)task->name, os_task_entry, (ULONG)task,
+                            task->stack, task->stack_words * sizeof(uint32_t),
+                            prio, prio, TX_NO_TIME_SLICE, TX_AUTO_START) == TX_SUCCESS;
+}
+
+bool os_task_create(os_task_t *task, const char *name, os_task_fn_t fn, void *arg,
+                    uint8_t prio, uint32_t *stack, uint32_t stack_words)
+{
+    CHECK_RETX(prio < TX_MAX_PRIORITIES, false);
+
+    task->fn = fn;
+    task->arg = arg;
+    task->name = name;
+    task->prio = prio;
+    task->stack = stack;
+    task->stack_words = stack_words;
+
+    if (os_running)
+        return os_task_spawn(task);
+
+    CHECK_RETX(os_pending_count < OS_MAX_TASKS, false);
+    os_pending[os_pending_count++] = task;
+    return true;
+}
+
+/* ThreadX 创建线程时用 OS_TX_STACK_FILL 填充栈 */
+uint32_t os_task_stack_peak(os_task_t *task)
+{
+    return os_stack_used(task->stack, task->stack_words, OS_TX_STACK_FILL);
+}
+
+os_task_t *os_task_self(void)
+{
+    return os_running ? (os_task_t *)tx_thread_identify() : NULL;
+}
+
+void tx_application_define(void *first_unused_memory)
+{
+    (void)first_unused_memory;
+
+    for (uint32_t i = 0; i < os_pending_count; i++)
+        os_task_spawn(os_pending[i]);
+    os_pending_count = 0;
+    os_running = true;
+}
+
+void os_start(void)
+{
+    tx_kernel_enter();
+    for (;;)
+        ;
+}
+
+void os_yield(void)
+{
+    if (os_running && !os_in_isr())
+        tx_thread_relinquish();
+}
+
+void os_delay(uint32_t ticks)
+{
+    if (os_running)
+    {
+        tx_thread_sleep(ticks);
+        return;
+    }
+
+    const uint32_t start = os_pre_tick;
+    while (os_pre_tick - start < ticks)
+        __WFI();
+}
+
+void os_sem_init(os_sem_t *sem, uint32_t initial, uint32_t max)
+{
+    tx_semaphore_create(&sem->sem, "os_sem", initial);
+    sem->max = max;
+}
+
+static bool os_sem_try(void *obj)
+{
+    return tx_semaphore_get(&((os_sem_t *)obj)->sem, TX_NO_WAIT) == TX_SUCCESS;
+}
+
+bool os_sem_take(os_sem_t *sem, uint32_t timeout)
+{
+    if (!os_running)
+        return os_poll(os_sem_try, sem, timeout);
+    return tx_semaphore_get(&sem->sem, os_in_isr() ? TX_NO_WAIT : timeout) == TX_SUCCESS;
+}
+
+void os_sem_give(os_sem_t *sem)
+{
+    tx_semaphore_ceiling_put(&sem->sem, sem->max);
+}
+
+void os_queue_init(os_queue_t *queue, void *buffer, uint32_t item_size, uint32_t capacity)
+{
+    queue->item_size = item_size;
+    tx_queue_create(&queue->queue, "os_queue", item_size / sizeof(ULONG), buffer, item_size * capacity);
+}
+
+bool os_queue_send(os_queue_t *queue, const void *item, uint32_t timeout)
+{
+    if (!os_running || os_in_isr())
+        timeout = TX_NO_WAIT;
+    return tx_queue_send(&queue->queue, (VOID *)item, timeout) == TX_SUCCESS;
+}
+
+bool os_queue_recv(os_queue_t *queue, void *item, uint32_t timeout)
+{
+    if (!os_running || os_in_isr())
+        timeout = TX_NO_WAIT;
+    return tx_queue_receive(&queue->queue, item, timeout) == TX_SUCCESS;
+}
+
+void os_notify(os_task_t *task, uint32_t bits)
+{
+    if (task == NULL)
+    {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        os_main_notify |= bits;
+        __set_PRIMASK(primask);
+        return;
+    }
+    tx_event_flags_set(&task->notify, bits, TX_OR);
+}
+
+static bool os_notify_try(void *obj)
+{
+    if (os_main_notify == 0)
+        return false;
+    *(uint32_t *)obj = os_main_notify;
+    os_main_notify = 0;
+    return true;
+}
+
+bool os_notify_wait(uint32_t *bits, uint32_t timeout)
+{
+    ULONG value = 0;
+    bool ok;
+
+    if (!os_running)
+        ok = os_poll(os_notify_try, &value, timeout);
+    else
+        ok = tx_event_flags_get(&os_task_self()->notify, 0xFFFFFFFFU, TX_OR_CLEAR, &value,
+                                os_in_isr() ? TX_NO_WAIT : timeout) == TX_SUCCESS;
+
+    if (ok && bits != NULL)
+        *bits = value;
+    return ok;
+}
+
+void os_tick_init(void)
+{
+    SysTick_Config(SystemCoreClock / OS_TICK_RATE_HZ);
+}
+
+void os_tick_handler(void)
+{
+    if (os_running)
+        _tx_timer_interrupt();
+    else
+        os_pre_tick++;
+}
+
+uint32_t os_tick_get(void)
+{
+    return os_running ? tx_time_get() : os_pre_tick;
+}
+
+
+#endif /* USING_RTOS == USING_THREADX */
@@ -0,0 +1,149 @@
+#include <stddef.h>
+#include "os.h"
+#include "log.h"
+#include "pool.h"
+
+
+void pool_class_init(pool_class_t *cls, void *buffer, uint32_t block_size, uint32_t count)
+{
+    uint8_t *base = buffer;
+    pool_block_t *head = NULL;
+    uint32_t i;
+
+    block_size = POOL_BLOCK_SIZE(block_size);
+
+    // 从后往前串，先分配低地址的块
+    for (i = count; i > 0; i--)
+    {
+        pool_block_t *block = (pool_block_t *)(base + (i - 1U) * block_size);
+
+        block->next = head;
+        head = block;
+    }
+
+    cls->base = base;
+    cls->end = base + count * block_size;
+    cls->free = head;
+    cls->block_size = block_size;
+    cls->count = count;
+    cls->used = 0;
+    cls->peak = 0;
+}
+
+bool pool_init(pool_t *pool, pool_class_t *classes, uint32_t class_count)
+{
+    uint32_t i;
+
+    if (class_count == 0 || class_count > POOL_MAX_CLASSES)
+        return false;
+
+    for (i = 1; i < class_count; i++)
+    {
+        if (classes[i].block_size <= classes[i - 1U].block_size)
+            return false;
+    }
+
+    pool->classes = classes;
+    pool->class_count = class_count;
+    pool->borrows = 0;
+    pool->fails = 0;
+    return true;
+}
+
+static pool_class_t *pool_class_of(const pool_t *pool, const void *ptr)
+{
+    const uint8_t *p = ptr;
+    uint32_t i;
+
+    for (i = 0; i < pool->class_count; i++)
+    {
+        pool_class_t *cls = &pool->classes[i];
+
+        if (p >= cls->base && p < cls->end)
+            return (uint32_t)(p - cls->base) % cls->block_size == 0 ? cls : NULL;
+    }
+
+    return NULL;
+}
+
+void *pool_alloc(pool_t *pool, uint32_t size)
+{
+    pool_class_t *cls = pool->classes;
+    pool_class_t *last = cls + pool->class_count;
+    pool_class_t *first;
+    pool_block_t *block = NULL;
+    uint32_t state;
+
+    while (cls < last && cls->block_size < size)
+        cls++;
+    first = cls;
+
+    state = os_enter_critical();
+    for (; cls < last; cls++)
+    {
+        block = cls->free;
+        if (block != NULL)
+        {
+            cls->free = block->next;
+            if (++cls->used > cls->peak)
+                cls->peak = cls->used;
+            break;
+        }
+    }
+    if (block == NULL)
+        pool->fails++;
+    else if (cls != first)
+        pool->borrows++;
+    os_exit_critical(state);
+
+    return block;
+}
+
+bool pool_free(pool_t *pool, void *ptr)
+{
+    pool_class_t *cls;
+    pool_block_t *block = ptr;
+    uint32_t state;
+
+    if (ptr == NULL)
+        return true;
+
+    cls = pool_class_of(pool, ptr);
+    if (cls == NULL)
+        return false;
+
+    state = os_enter_critical();
+    // 全部空闲时再释放必然是重复释放
+    if (cls->used == 0)
+    {
+        os_exit_critical(state);
+        return false;
+    }
+    block->next = cls->free;
+    cls->free = block;
+    cls->used--;
+    os_exit_critical(state);
+
+    return true;
+}
+
+uint32_t pool_block_size(const pool_t *pool, const void *ptr)
+{
+    const pool_class_t *cls = pool_class_of(pool, ptr);
+
+    return cls != NULL ? cls->block_size : 0;
+}
+
+void pool_report(const pool_t *pool, const char *name)
+{
+    uint32_t i;
+
+    for (i = 0; i < pool->class_count; i++)
+    {
+        const pool_class_t *cls = &pool->classes[i];
+
+        LOG_I("pool %s: %u x %u bytes, %u used, peak %u",
+              name, (unsigned)cls->count, (unsigned)cls->block_size, (unsigned)cls->used, (unsigned)cls->peak);
+    }
+    LOG_I("pool %s: %u borrows, %u fails", name, (unsigned)pool->borrows, (unsigned)pool->fails);
+}
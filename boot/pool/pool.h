@@ -0,0 +1,94 @@
+#ifndef __BL_POOL_H
+#define __BL_POOL_H
+
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/*
+ * 固定块内存池，给协议帧、DMA 和日志缓冲使用，代替 malloc。
+ *
+ * 每个尺寸等级是一段连续的缓冲区，切成相同大小的块，空闲块串成单向链表。
+ * 分配取能放下 size 的最小等级的链表头，该等级用完时依次借用更大的等级；
+ * 释放按地址找到所属等级放回链表头，不需要传大小。等级数不超过 POOL_MAX_CLASSES，
+ * 分配和释放的时间有固定上限，临界区内只有链表操作，可在中断中调用，不产生碎片。
+ *
+ * 缓冲区用 POOL_BUFFER 定义，放在 SRAM (POOL_SRAM) 或 CCMRAM (POOL_CCMRAM)。
+ * CCMRAM 链接到 .ccmbss，不占 flash、启动时不清零；DMA 访问不到 CCMRAM，
+ * 要交给 DMA 的帧缓冲必须来自 SRAM 的池。
+ *
+ *   POOL_BUFFER(pool_small, 64, 16, POOL_CCMRAM);
+ *   POOL_BUFFER(pool_frame, 1024, 4, POOL_SRAM);
+ *   static pool_class_t classes[2];
+ *   static pool_t pool;
+ *
+ *   pool_class_init(&classes[0], pool_small, 64, 16);
+ *   pool_class_init(&classes[1], pool_frame, 1024, 4);
+ *   pool_init(&pool, classes, 2);
+ *   frame = pool_alloc(&pool, len);  ...  pool_free(&pool, frame);
+ *
+ * 块交给另一层（如 DMA 完成中断）时所有权随指针转移，由最后使用者释放。
+ */
+
+#ifndef POOL_MAX_CLASSES
+#define POOL_MAX_CLASSES        8U
+#endif
+
+/* 块按 8 字节对齐，可直接用于 DMA 的字/半字传输和 double */
+#define POOL_ALIGN              8U
+#define POOL_BLOCK_SIZE(size)   (((uint32_t)(size) + POOL_ALIGN - 1U) & ~(POOL_ALIGN - 1U))
+
+#define POOL_SRAM               __attribute__((aligned(POOL_ALIGN)))
+#define POOL_CCMRAM             __attribute__((section(".ccmbss"), aligned(POOL_ALIGN)))
+
+/* 定义 count 个 block_size 字节的块所需的缓冲区，placement 为 POOL_SRAM 或 POOL_CCMRAM */
+#define POOL_BUFFER(name, block_size, count, placement) \
+    static uint8_t name[POOL_BLOCK_SIZE(block_size) * (count)] placement
+
+
+typedef struct pool_block
+{
+    struct pool_block *next;
+} pool_block_t;
+
+typedef struct
+{
+    uint8_t *base;
+    uint8_t *end;
+    pool_block_t *free;
+    uint32_t block_size;
+    uint32_t count;
+    uint32_t used;              /* 正在使用的块数 */
+    uint32_t peak;              /* used 的最大值 */
+} pool_class_t;
+
+typedef struct
+{
+    pool_class_t *classes;      /* 按 block_size 从小到大 */
+    uint32_t class_count;
+    uint32_t borrows;           /* 本等级用完、从更大等级分配的次数 */
+    uint32_t fails;             /* 没有可用块、返回 NULL 的次数 */
+} pool_t;
+
+
+/* 把 buffer 切成 count 个 block_size 字节的块，block_size 向上取整到 POOL_ALIGN */
+void pool_class_init(pool_class_t *cls, void *buffer, uint32_t block_size, uint32_t count);
+
+/* classes 须按 block_size 严格递增，等级数为 1..POOL_MAX_CLASSES，否则返回 false */
+bool pool_init(pool_t *pool, pool_class_t *classes, uint32_t class_count);
+
+/* 分配至少 size 字节的块，没有可用块时返回 NULL；可在中断中调用 */
+void *pool_alloc(pool_t *pool, uint32_t size);
+
+/* 释放 pool_alloc 返回的块，ptr 为 NULL 时什么也不做；不是本池的块返回 false。可在中断中调用 */
+bool pool_free(pool_t *pool, void *ptr);
+
+/* ptr 所在块的大小，不是本池的块返回 0 */
+uint32_t pool_block_size(const pool_t *pool, const void *ptr);
+
+/* 通过 LOG_I 报告每个等级的使用数和高水位 */
+void pool_report(const pool_t *pool, const char *name);
+
+
+#endif /* __BL_POOL_H */
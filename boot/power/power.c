@@ -0,0 +1,214 @@
+#include "stm32f4xx.h"
+#include "stm32f4xx_exti.h"
+#include "stm32f4xx_pwr.h"
+#include "stm32f4xx_syscfg.h"
+#include "os.h"
+#include "log.h"
+#include "clock.h"
+#include "power.h"
+
+
+// 离下一个节拍不足这么多周期时不改 SysTick，直接睡到节拍
+#define POWER_TICK_MARGIN       256U
+#define POWER_SYSTICK_MAX       0x01000000U
+
+static power_stats_t power_stat;
+static uint32_t power_last_wake;
+
+
+void power_init(void)
+{
+    EXTI_InitTypeDef EXTI_InitStruct;
+    NVIC_InitTypeDef NVIC_InitStruct;
+
+    RCC_APB2PeriphClockCmd(RCC_APB2Periph_SYSCFG, ENABLE);
+    SYSCFG_EXTILineConfig(POWER_WAKE_PORT_SOURCE, POWER_WAKE_PIN_SOURCE);
+
+    // 起始位的下降沿，先不打开
+    EXTI_InitStruct.EXTI_Line = POWER_WAKE_EXTI_LINE;
+    EXTI_InitStruct.EXTI_Mode = EXTI_Mode_Interrupt;
+    EXTI_InitStruct.EXTI_Trigger = EXTI_Trigger_Falling;
+    EXTI_InitStruct.EXTI_LineCmd = DISABLE;
+    EXTI_Init(&EXTI_InitStruct);
+    EXTI_ClearITPendingBit(POWER_WAKE_EXTI_LINE);
+
+    NVIC_InitStruct.NVIC_IRQChannel = POWER_WAKE_IRQN;
+    NVIC_InitStruct.NVIC_IRQChannelPreemptionPriority = POWER_WAKE_IRQ_PRIORITY;
+    NVIC_InitStruct.NVIC_IRQChannelSubPriority = 0;
+    NVIC_InitStruct.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStruct);
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    power_last_wake = DWT->CYCCNT;
+}
+
+void power_exti_irq(void)
+{
+    if (EXTI->PR & POWER_WAKE_EXTI_LINE)
+    {
+        // 之后的字节由 DMA 接收，不再每个下降沿进中断
+        EXTI->IMR &= ~POWER_WAKE_EXTI_LINE;
+        EXTI->PR = POWER_WAKE_EXTI_LINE;
+        power_stat.rx_wakes++;
+    }
+}
+
+static void power_wake_done(uint32_t start)
+{
+    uint32_t cycles = DWT->CYCCNT - start;
+
+    power_stat.wake_cycles = cycles;
+    if (cycles > power_stat.wake_cycles_max)
+        power_stat.wake_cycles_max = cycles;
+}
+
+#if POWER_IDLE_STOP
+// 串口还在发送、flash 正在擦写时不能停时钟
+static bool power_stop_allowed(void)
+{
+    return !(DMA2_Stream7->CR & DMA_SxCR_EN) &&
+           (!(USART1->CR1 & USART_CR1_UE) || (USART1->SR & USART_SR_TC)) &&
+           !(FLASH->SR & FLASH_SR_BSY);
+}
+
+static void power_stop(void)
+{
+    bl_clock_profile_t profile = bl_clock_profile();
+    uint32_t systick = SysTick->CTRL;
+    uint32_t start;
+
+    SysTick->CTRL = systick & ~SysTick_CTRL_ENABLE_Msk;
+    EXTI->PR = POWER_WAKE_EXTI_LINE;
+    EXTI->IMR |= POWER_WAKE_EXTI_LINE;
+
+    power_stat.stops++;
+    PWR_EnterSTOPMode(PWR_LowPowerRegulator_ON, PWR_STOPEntry_WFI);
+    start = DWT->CYCCNT;
+
+    // 醒来时运行在 HSI 上；不是由 bl_clock_set_profile 设置的时钟按启动档位恢复
+    bl_clock_set_profile(profile < BL_CLOCK_PROFILE_COUNT ? profile : BL_CLOCK_BOOT);
+    EXTI->IMR &= ~POWER_WAKE_EXTI_LINE;
+    SysTick->VAL = 0;
+    SysTick->CTRL = systick;
+
+    power_wake_done(start);
+}
+#endif
+
+// 把 SysTick 改为一次定时 ticks 个节拍，醒来后恢复每节拍中断，返回需要补计的节拍数
+static uint32_t power_sleep_ticks(uint32_t ticks)
+{
+    uint32_t period = SysTick->LOAD + 1U;
+    uint32_t ctrl = SysTick->CTRL;
+    uint32_t remain, load, total, next, slept, start;
+    bool full;
+
+    SysTick->CTRL = ctrl & ~SysTick_CTRL_ENABLE_Msk;
+    remain = SysTick->VAL;
+    if (remain < POWER_TICK_MARGIN)
+    {
+        SysTick->CTRL = ctrl;
+        __DSB();
+        __WFI();
+        return 0;
+    }
+
+    if (ticks > (POWER_SYSTICK_MAX - remain) / period + 1U)
+        ticks = (POWER_SYSTICK_MAX - remain) / period + 1U;
+    load = remain + (ticks - 1U) * period - 1U;
+
+    SysTick->LOAD = load;
+    SysTick->VAL = 0;
+    SysTick->CTRL = ctrl;
+
+    __DSB();
+    __WFI();
+    start = DWT->CYCCNT;
+
+    // 先停止计数再读 COUNTFLAG，避免读和停之间到期
+    SysTick->CTRL = ctrl & ~SysTick_CTRL_ENABLE_Msk;
+    full = (SysTick->CTRL & SysTick_CTRL_COUNTFLAG_Msk) != 0;
+    if (full)
+    {
+        // 睡满：SysTick 中断已挂起，开中断后由它计入最后一个节拍
+        slept = ticks - 1U;
+        next = period;
+    }
+    else
+    {
+        // 被其他中断提前唤醒：从睡前最后一个节拍边界算起经过的周期
+        total = (period - remain) + (load - SysTick->VAL);
+        slept = total / period;
+        next = period - total % period;
+        if (next < POWER_TICK_MARGIN)
+        {
+            // 边界就在眼前，直接计入，下一个节拍推后一个周期
+            slept++;
+            next += period;
+        }
+    }
+
+    // 下一个节拍落在原来的节拍边界上，之后恢复每节拍重装
+    SysTick->LOAD = next - 1U;
+    SysTick->VAL = 0;
+    SysTick->CTRL = ctrl;
+    SysTick->LOAD = period - 1U;
+
+    power_stat.asleep_ticks += full ? ticks : slept;
+    power_wake_done(start);
+    return slept;
+}
+
+uint32_t power_idle(uint32_t idle_ticks)
+{
+    uint32_t slept = 0;
+
+    power_stat.awake_cycles += DWT->CYCCNT - power_last_wake;
+
+#if POWER_IDLE_STOP
+    if (idle_ticks == OS_WAIT_FOREVER && power_stop_allowed())
+    {
+        power_stop();
+        power_last_wake = DWT->CYCCNT;
+        return 0;
+    }
+#endif
+
+    power_stat.sleeps++;
+    if (idle_ticks >= 2U && (SysTick->CTRL & SysTick_CTRL_ENABLE_Msk))
+    {
+        slept = power_sleep_ticks(idle_ticks);
+    }
+    else
+    {
+        __DSB();
+        __WFI();
+    }
+
+    power_last_wake = DWT->CYCCNT;
+    return slept;
+}
+
+// 替换 os.c 中的弱定义，由 OS 空闲任务在关中断时调用
+uint32_t os_tickless_enter(uint32_t idle_ticks)
+{
+    return power_idle(idle_ticks);
+}
+
+const power_stats_t *power_stats(void)
+{
+    return &power_stat;
+}
+
+void power_report(void)
+{
+    uint64_t asleep = (uint64_t)power_stat.asleep_ticks * (SystemCoreClock / OS_TICK_RATE_HZ);
+    uint64_t total = power_stat.awake_cycles + asleep;
+    uint32_t awake = total ? (uint32_t)(power_stat.awake_cycles * 1000U / total) : 0;
+
+    LOG_I("power: %u sleeps, %u stops, %u rx wakes, wake %u/%u cycles, awake %u.%u%%",
+          (unsigned)power_stat.sleeps, (unsigned)power_stat.stops, (unsigned)power_stat.rx_wakes,
+          (unsigned)power_stat.wake_cycles, (unsigned)power_stat.wake_cycles_max,
+          (unsigned)(awake / 10U), (unsigned)(awake % 10U));
+}
@@ -0,0 +1,77 @@
+#ifndef __BL_POWER_H
+#define __BL_POWER_H
+
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/*
+ * 空闲时的低功耗管理。
+ *
+ * Sleep：内核停止，外设和 DMA 照常运行。串口由 DMA 接收，任何字节都不会丢，
+ *        帧结束的 IDLE 中断或 DMA 中断把内核唤醒，唤醒只需中断响应的时间。
+ *        空闲节拍足够长时 SysTick 改为一次定时到下一个唤醒点，中途不再每节拍唤醒，
+ *        醒来后按实际经过的周期补偿节拍（见 os_tickless_enter，需 OS_TICKLESS_IDLE=1）。
+ *
+ * Stop： HSE、PLL 和外设时钟全部停止，由 RX 引脚下降沿 (EXTI) 唤醒，
+ *        醒来后先运行在 HSI 上，再经 bl_clock_set_profile 恢复原来的档位和串口 BRR。
+ *        串口在 Stop 中没有时钟，唤醒它的那个字节必然丢失，且 Stop 期间节拍停止、
+ *        时间不计入（没有 RTC 唤醒），因此默认关闭。只在主机协议先发唤醒字节、
+ *        并且没有定时等待的任务时打开 POWER_IDLE_STOP。
+ *
+ * 功耗的代用指标：DWT 周期计数只在内核运行时增加，醒着的周期数与睡着的节拍数之比即占空比。
+ */
+
+/* 置 1 时没有定时等待、串口发送和 flash 操作都空闲时进入 Stop */
+#ifndef POWER_IDLE_STOP
+#define POWER_IDLE_STOP             0
+#endif
+
+/* 唤醒引脚，默认为 USART1 RX (PA10) */
+#ifndef POWER_WAKE_GPIO
+#define POWER_WAKE_GPIO             GPIOA
+#define POWER_WAKE_PORT_SOURCE      EXTI_PortSourceGPIOA
+#define POWER_WAKE_PIN_SOURCE       EXTI_PinSource10
+#define POWER_WAKE_EXTI_LINE        EXTI_Line10
+#define POWER_WAKE_IRQN             EXTI15_10_IRQn
+#endif
+
+#ifndef POWER_WAKE_IRQ_PRIORITY
+#define POWER_WAKE_IRQ_PRIORITY     2U
+#endif
+
+
+typedef struct
+{
+    uint32_t sleeps;            /* 进入 Sleep 的次数 */
+    uint32_t stops;             /* 进入 Stop 的次数 */
+    uint32_t rx_wakes;          /* 由 RX 引脚唤醒的次数 */
+    uint32_t asleep_ticks;      /* Sleep 中经过的节拍数，Stop 不计 */
+    uint64_t awake_cycles;      /* 两次空闲之间内核运行的周期数 */
+    uint32_t wake_cycles;       /* 最近一次从唤醒到时钟恢复、可以继续运行的周期数 */
+    uint32_t wake_cycles_max;
+} power_stats_t;
+
+
+/* 配置唤醒引脚的 EXTI 和 NVIC，平时屏蔽，只在进入 Stop 前打开 */
+void power_init(void);
+
+/*
+ * 睡到下一个中断。idle_ticks 为距下一个定时唤醒的节拍数：
+ *   < 2            节拍照常走，只睡到下一个中断（包括 SysTick）
+ *   OS_WAIT_FOREVER  没有定时唤醒，允许时进入 Stop
+ * 须在关中断（PRIMASK）时调用，中断在返回后才执行。返回需要补计的节拍数。
+ */
+uint32_t power_idle(uint32_t idle_ticks);
+
+const power_stats_t *power_stats(void);
+
+/* 通过 LOG_I 报告次数、唤醒周期和醒着的比例 */
+void power_report(void);
+
+/* 由 EXTI15_10_IRQHandler 调用 */
+void power_exti_irq(void);
+
+
+#endif /* __BL_POWER_H */
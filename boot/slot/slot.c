@@ -0,0 +1,306 @@
+#include <stddef.h>
+#include <string.h>
+#include "stm32f4xx.h"
+#include "log.h"
+#include "os.h"
+#include "flash.h"
+#include "verify.h"
+#include "handoff.h"
+#include "slot.h"
+
+
+#define SLOT_RECORD_MAGIC       0x544F4C53U     /* "SLOT" */
+#define SLOT_RECORD_COUNT       (LAYOUT_BOOTSEL_SIZE / sizeof(slot_record_t))
+#define SLOT_CACHE_MAGIC        0x48434C53U     /* "SLCH" */
+
+// 冷启动：上电、掉电复位，备份域之外的状态都不可信
+#define SLOT_COLD_RESET_FLAGS   (RCC_CSR_PORRSTF | RCC_CSR_BORRSTF)
+
+// 已校验镜像缓存，位于备份 SRAM，每槽一项
+typedef struct
+{
+    uint32_t magic;
+    uint32_t slot;
+    uint32_t size;
+    uint32_t image_crc;         /* 校验通过时镜像末尾的 CRC */
+    uint32_t flash_count;       /* 校验通过时的 flash 擦写计数 */
+    uint32_t reserved[2];
+    uint32_t crc;
+} slot_cache_t;
+
+_Static_assert(LAYOUT_BKP_SLOT_CACHE + SLOT_COUNT * sizeof(slot_cache_t) <=
+               LAYOUT_BKPSRAM_ORIGIN + LAYOUT_BKPSRAM_SIZE, "slot cache does not fit in BKPSRAM");
+
+#define SLOT_CACHE              ((volatile slot_cache_t *)LAYOUT_BKP_SLOT_CACHE)
+
+static uint32_t slot_current = SLOT_NONE;
+static uint32_t slot_current_size;
+
+
+static inline const slot_record_t *slot_record_at(uint32_t i)
+{
+    return (const slot_record_t *)LAYOUT_BOOTSEL_ORIGIN + i;
+}
+
+static uint32_t slot_record_crc(const slot_record_t *r)
+{
+    return crc32_sw(r, offsetof(slot_record_t, crc));
+}
+
+static bool slot_record_erased(const slot_record_t *r)
+{
+    const uint32_t *w = (const uint32_t *)r;
+    uint32_t i;
+
+    for (i = 0; i < sizeof(*r) / 4U; i++)
+    {
+        if (w[i] != 0xFFFFFFFFU)
+            return false;
+    }
+
+    return true;
+}
+
+static bool slot_record_valid(const slot_record_t *r)
+{
+    return r->magic == SLOT_RECORD_MAGIC && r->slot < SLOT_COUNT &&
+           r->seq != 0 && r->seq != 0xFFFFFFFFU && r->crc == slot_record_crc(r);
+}
+
+// 扫描记录区，latest 返回各槽序号最大的记录（没有时 seq 为 0），返回下一条记录的位置
+static uint32_t slot_scan(slot_record_t latest[SLOT_COUNT])
+{
+    const slot_record_t *r;
+    uint32_t i, next = 0;
+
+    memset(latest, 0, sizeof(slot_record_t) * SLOT_COUNT);
+
+    for (i = 0; i < SLOT_RECORD_COUNT; i++)
+    {
+        r = slot_record_at(i);
+        if (slot_record_erased(r))
+            continue;
+
+        // 写坏的记录也占位置，新记录只写在最后一条之后
+        next = i + 1U;
+        if (slot_record_valid(r) && r->seq > latest[r->slot].seq)
+            latest[r->slot] = *r;
+    }
+
+    return next;
+}
+
+// 向量表第 0 项为栈顶，第 1 项为复位入口 (Thumb)
+static bool slot_vector_valid(uint32_t base, uint32_t size)
+{
+    const uint32_t *vector = (const uint32_t *)base;
+    uint32_t sp = vector[0];
+    uint32_t pc = vector[1];
+
+    if ((sp & 3U) ||
+        !((sp > LAYOUT_RAM_ORIGIN && sp <= LAYOUT_RAM_ORIGIN + LAYOUT_RAM_SIZE) ||
+          (sp > LAYOUT_CCMRAM_ORIGIN && sp <= LAYOUT_CCMRAM_ORIGIN + LAYOUT_CCMRAM_SIZE)))
+    {
+        return false;
+    }
+
+    return (pc & 1U) && pc > base && pc < base + size;
+}
+
+#if SLOT_VERIFY_CACHE
+static uint32_t slot_cache_crc(const slot_cache_t *c)
+{
+    return crc32_sw(c, offsetof(slot_cache_t, crc));
+}
+
+// 热复位、缓存项与记录一致，且上次校验之后 flash 没有擦写过，才可以跳过校验
+static bool slot_cache_hit(const slot_record_t *r, uint32_t image_crc)
+{
+    slot_cache_t c;
+    uint32_t count;
+    uint32_t flags = handoff_reset_flags();
+
+    if (flags == 0 || (flags & SLOT_COLD_RESET_FLAGS) || !bl_flash_write_count(&count))
+        return false;
+
+    c = SLOT_CACHE[r->slot];
+    return c.magic == SLOT_CACHE_MAGIC && c.crc == slot_cache_crc(&c) &&
+           c.slot == r->slot && c.size == r->size && c.image_crc == image_crc &&
+           c.flash_count == count;
+}
+
+static void slot_cache_store(const slot_record_t *r, uint32_t image_crc, bool valid)
+{
+    slot_cache_t c;
+    uint32_t count;
+
+    memset(&c, 0, sizeof(c));
+    if (valid && bl_flash_write_count(&count))
+    {
+        c.magic = SLOT_CACHE_MAGIC;
+        c.slot = r->slot;
+        c.size = r->size;
+        c.image_crc = image_crc;
+        c.flash_count = count;
+        c.crc = slot_cache_crc(&c);
+    }
+    else
+    {
+        (void)bl_flash_write_count(&count);    // 打开备份 SRAM
+    }
+
+    SLOT_CACHE[r->slot] = c;
+}
+#endif
+
+static bool slot_image_valid(const slot_record_t *r)
+{
+    uint32_t base = slot_base(r->slot);
+    bool valid;
+
+    if (r->size < 8U || r->size > LAYOUT_SLOT_SIZE || !slot_vector_valid(base, r->size))
+        return false;
+
+#if SLOT_VERIFY_CACHE
+    uint32_t image_crc = *(const uint32_t *)(base + r->size - 4U);
+
+    if (slot_cache_hit(r, image_crc))
+    {
+        LOG_I("slot %c: verified before, skip", 'A' + (int)r->slot);
+        return true;
+    }
+#endif
+
+#if SLOT_VERIFY_SIGNED
+    valid = verify_image_signed((const void *)base, r->size) == VERIFY_OK;
+#else
+    valid = verify_image((const void *)base, r->size) == VERIFY_OK;
+#endif
+
+#if SLOT_VERIFY_CACHE
+    slot_cache_store(r, image_crc, valid);
+#endif
+
+    return valid;
+}
+
+uint32_t slot_select(void)
+{
+    slot_record_t latest[SLOT_COUNT];
+    uint32_t first, slot, i;
+
+    slot_scan(latest);
+
+    // 序号大的是最近一次升级写入的，先试；它损坏时回到另一个槽
+    first = latest[SLOT_B].seq > latest[SLOT_A].seq ? SLOT_B : SLOT_A;
+    for (i = 0; i < SLOT_COUNT; i++)
+    {
+        slot = i ? first ^ 1U : first;
+        if (latest[slot].seq == 0)
+            continue;
+        if (slot_image_valid(&latest[slot]))
+        {
+            slot_current = slot;
+            slot_current_size = latest[slot].size;
+            return slot;
+        }
+        LOG_W("slot %c: image invalid (seq %u)", 'A' + (int)slot, (unsigned)latest[slot].seq);
+    }
+
+    slot_current = SLOT_NONE;
+    return SLOT_NONE;
+}
+
+uint32_t slot_active(void)
+{
+    return slot_current;
+}
+
+uint32_t slot_inactive(void)
+{
+    return slot_current == SLOT_A ? SLOT_B : SLOT_A;
+}
+
+uint32_t slot_size(uint32_t slot)
+{
+    slot_record_t latest[SLOT_COUNT];
+
+    if (slot >= SLOT_COUNT)
+        return 0;
+
+    slot_scan(latest);
+    return latest[slot].seq ? latest[slot].size : 0;
+}
+
+static slot_status_t slot_record_write(uint32_t i, const slot_record_t *r)
+{
+    if (bl_flash_program(LAYOUT_BOOTSEL_ORIGIN + i * sizeof(*r), r, sizeof(*r)) != BL_FLASH_OK)
+        return SLOT_ERR_FLASH;
+
+    return SLOT_OK;
+}
+
+slot_status_t slot_commit(uint32_t slot, uint32_t size)
+{
+    slot_record_t latest[SLOT_COUNT];
+    slot_record_t r;
+    uint32_t next, other = slot ^ 1U;
+    slot_status_t status;
+
+    if (slot >= SLOT_COUNT || size < 8U || size > LAYOUT_SLOT_SIZE)
+        return SLOT_ERR_ARG;
+
+    next = slot_scan(latest);
+
+    memset(&r, 0xFF, sizeof(r));
+    r.magic = SLOT_RECORD_MAGIC;
+    r.seq = (latest[SLOT_A].seq > latest[SLOT_B].seq ? latest[SLOT_A].seq : latest[SLOT_B].seq) + 1U;
+    r.slot = slot;
+    r.size = size;
+    r.crc = slot_record_crc(&r);
+
+    // 写满时整理：擦除后先写回另一个槽的记录，再写新记录。
+    // 两次写入之前掉电则没有记录，停在 bootloader 等待重新升级，不会启动错误的镜像。
+    if (next == SLOT_RECORD_COUNT)
+    {
+        if (bl_flash_erase(LAYOUT_BOOTSEL_ORIGIN) != BL_FLASH_OK)
+            return SLOT_ERR_FLASH;
+        next = 0;
+        if (latest[other].seq)
+        {
+            status = slot_record_write(next++, &latest[other]);
+            if (status != SLOT_OK)
+                return status;
+        }
+    }
+
+    status = slot_record_write(next, &r);
+    if (status != SLOT_OK)
+    {
+        LOG_E("slot: record write failed at %u", (unsigned)next);
+        return status;
+    }
+
+    LOG_I("slot %c: committed seq %u, %u bytes", 'A' + (int)slot, (unsigned)r.seq, (unsigned)size);
+    return SLOT_OK;
+}
+
+void slot_boot(void)
+{
+    uint32_t start = DWT->CYCCNT;
+    uint32_t slot = slot_select();
+
+    if (slot == SLOT_NONE)
+    {
+        LOG_W("slot: no bootable image");
+        return;
+    }
+
+    // 校验结果和耗时经交接块交给应用，应用不必再校验一遍
+    handoff_set_image(slot, slot_base(slot), slot_current_size, DWT->CYCCNT - start);
+
+    // 启动路径（校验签名、解压）的主栈峰值，用来确定 STACK_SIZE
+    LOG_I("stack: main peak %u of %u bytes", (unsigned)os_stack_peak(), (unsigned)os_stack_size());
+    LOG_I("slot %c: booting 0x%08x", 'A' + (int)slot, (unsigned)slot_base(slot));
+    bl_jump_to_app(slot_base(slot));
+}
@@ -0,0 +1,91 @@
+#ifndef __BL_SLOT_H
+#define __BL_SLOT_H
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "flash_layout.h"
+
+
+/*
+ * A/B 槽启动选择。分区见 flash_layout.h。
+ *
+ * 启动选择记录区 (BOOTSEL) 只追加写：每次升级完成后为目标槽追加一条记录，
+ * 序号比已有记录都大。一条记录只需一次编程，写到一半掉电时该记录 CRC 不符被忽略，
+ * 之前的记录仍然有效，因此切换是原子的。记录区写满时擦除并只保留两个槽各自最新的记录。
+ *
+ * 启动时按序号从新到旧检查各槽：记录的长度、向量表和镜像校验都通过的第一个槽被原地启动，
+ * 热复位时镜像校验可以用上次的结果（见 SLOT_VERIFY_CACHE）。
+ * 最新的槽损坏时自动回到另一个槽。没有可启动的槽时 slot_boot 返回，停留在 bootloader。
+ *
+ * 升级流程：
+ *   update_begin(&up, slot_base(slot_inactive()), LAYOUT_SLOT_SIZE);
+ *   ... update_write ...
+ *   if (update_finish(&up, NULL) == UPDATE_OK)
+ *       slot_commit(slot_inactive(), up.offset);
+ * 差分升级的旧镜像为 slot_base(slot_active()) 开始的 slot_size(slot_active()) 字节。
+ */
+
+#define SLOT_A                  0U
+#define SLOT_B                  1U
+#define SLOT_COUNT              2U
+#define SLOT_NONE               0xFFFFFFFFU
+
+/* 置 1 时启动前还要验证镜像签名 (verify_image_signed) */
+#ifndef SLOT_VERIFY_SIGNED
+#define SLOT_VERIFY_SIGNED      0
+#endif
+
+
+/*
+ * 置 1 时热复位可以跳过完整校验：校验通过后把槽、长度、末尾 CRC 和 flash 擦写计数
+ * （见 bl_flash_write_count）记入备份 SRAM。之后的复位不是上电、掉电复位，
+ * 且这些都没有变化时只检查向量表。任何一次经 bl_flash_* 的擦写都使缓存失效，
+ * 因此写 flash 必须经过 bl_flash_*；调试器直接烧录后请上电复位或改变镜像 CRC。
+ */
+#ifndef SLOT_VERIFY_CACHE
+#define SLOT_VERIFY_CACHE       1
+#endif
+
+/* 启动选择记录，32 字节 */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t seq;               /* 从 1 开始递增 */
+    uint32_t slot;
+    uint32_t size;              /* 镜像长度，含末尾 CRC（和签名） */
+    uint32_t reserved[3];       /* 保留，写为全 1 */
+    uint32_t crc;               /* 前面各字段的 CRC */
+} slot_record_t;
+
+typedef enum
+{
+    SLOT_OK = 0,
+    SLOT_ERR_ARG,               /* 槽号或长度不合法 */
+    SLOT_ERR_FLASH,             /* 记录区擦写失败 */
+} slot_status_t;
+
+
+static inline uint32_t slot_base(uint32_t slot)
+{
+    return slot == SLOT_B ? LAYOUT_SLOT_B_ORIGIN : LAYOUT_SLOT_A_ORIGIN;
+}
+
+/* 选择要启动的槽，返回 SLOT_NONE 表示没有可启动的镜像 */
+uint32_t slot_select(void);
+
+/* 上次 slot_select 选中的槽；升级写入另一个槽 */
+uint32_t slot_active(void);
+uint32_t slot_inactive(void);
+
+/* 槽最新记录中的镜像长度，没有记录时为 0 */
+uint32_t slot_size(uint32_t slot);
+
+/* 升级完成后调用：之后从 slot 启动 */
+slot_status_t slot_commit(uint32_t slot, uint32_t size);
+
+/* 选择并经 bl_jump_to_app 原地启动，没有可启动的镜像时返回 */
+void slot_boot(void);
+
+
+#endif /* __BL_SLOT_H */
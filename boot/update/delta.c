@@ -0,0 +1,258 @@
+#include "verify.h"
+#include "delta.h"
+
+
+#define DELTA_VERSION           1U
+
+enum
+{
+    DELTA_ST_HEADER = 0,
+    DELTA_ST_DIFF_LEN,
+    DELTA_ST_EXTRA_LEN,
+    DELTA_ST_SEEK,
+    DELTA_ST_ZEROS,             /* 差分段：与旧镜像相同的字节数 */
+    DELTA_ST_COUNT,             /* 差分段：差值字节数 */
+    DELTA_ST_BYTES,
+    DELTA_ST_EXTRA,
+    DELTA_ST_DONE,
+};
+
+
+void delta_init(delta_t *d, const void *old, uint32_t old_max, delta_sink_t sink, void *arg)
+{
+    d->sink = sink;
+    d->arg = arg;
+    d->old = (const uint8_t *)old;
+    d->old_max = old_max;
+    d->status = DELTA_OK;
+    d->state = DELTA_ST_HEADER;
+    d->value = 0;
+    d->shift = 0;
+    d->pos = 0;
+    d->size = 0;
+    d->out = 0;
+    d->buf_len = 0;
+}
+
+static inline uint32_t delta_u32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static bool delta_parse_header(delta_t *d)
+{
+    const uint8_t *h = d->header;
+
+    d->old_size = delta_u32(&h[4]);
+    d->size = delta_u32(&h[12]);
+
+    if (h[0] != 'D' || h[1] != 'P' || h[2] != DELTA_VERSION)
+    {
+        d->status = DELTA_ERR_HEADER;
+        return false;
+    }
+
+    // 旧镜像按字计算 CRC，与 verify_image 相同
+    if (d->old_size > d->old_max || (d->old_size & 3U) ||
+        verify_crc(d->old, d->old_size) != delta_u32(&h[8]))
+    {
+        d->status = DELTA_ERR_BASE;
+        return false;
+    }
+
+    d->state = d->size ? DELTA_ST_DIFF_LEN : DELTA_ST_DONE;
+    return true;
+}
+
+static bool delta_flush(delta_t *d)
+{
+    if (d->buf_len && !d->sink(d->arg, d->buf, d->buf_len))
+    {
+        d->status = DELTA_ERR_SINK;
+        return false;
+    }
+
+    d->buf_len = 0;
+    return true;
+}
+
+// 不经缓冲直接交给 sink：与旧镜像相同的字节直接来自 flash，新增段来自输入
+static bool delta_emit(delta_t *d, const uint8_t *data, uint32_t len)
+{
+    if (len == 0)
+        return true;
+
+    if (!delta_flush(d))
+        return false;
+
+    if (!d->sink(d->arg, data, len))
+    {
+        d->status = DELTA_ERR_SINK;
+        return false;
+    }
+
+    d->out += len;
+    return true;
+}
+
+// 差分段、新增段都处理完后移动读位置，进入下一条记录
+static void delta_next(delta_t *d)
+{
+    if (d->diff_left)
+    {
+        d->state = DELTA_ST_ZEROS;
+    }
+    else if (d->extra_left)
+    {
+        d->state = DELTA_ST_EXTRA;
+    }
+    else
+    {
+        d->pos = (uint32_t)((int32_t)d->pos + d->seek);
+        d->state = d->out == d->size ? DELTA_ST_DONE : DELTA_ST_DIFF_LEN;
+    }
+}
+
+// 一个变长整数收齐，所有长度都先检查边界再使用
+static bool delta_field(delta_t *d, uint32_t v)
+{
+    int64_t target;
+
+    switch (d->state)
+    {
+    case DELTA_ST_DIFF_LEN:
+        if (v > d->old_size - d->pos || v > d->size - d->out)
+            break;
+        d->diff_left = v;
+        d->state = DELTA_ST_EXTRA_LEN;
+        return true;
+
+    case DELTA_ST_EXTRA_LEN:
+        if (v > d->size - d->out - d->diff_left)
+            break;
+        d->extra_left = v;
+        d->state = DELTA_ST_SEEK;
+        return true;
+
+    case DELTA_ST_SEEK:
+        // zigzag 编码
+        d->seek = (v & 1U) ? -(int32_t)(v >> 1) - 1 : (int32_t)(v >> 1);
+        target = (int64_t)d->pos + d->diff_left + d->seek;
+        if (target < 0 || target > (int64_t)d->old_size)
+            break;
+        delta_next(d);
+        return true;
+
+    case DELTA_ST_ZEROS:
+        if (v > d->diff_left || !delta_emit(d, &d->old[d->pos], v))
+            break;
+        d->pos += v;
+        d->diff_left -= v;
+        d->state = DELTA_ST_COUNT;
+        return true;
+
+    default:
+        if (v > d->diff_left)
+            break;
+        d->run = v;
+        if (v)
+            d->state = DELTA_ST_BYTES;
+        else
+            delta_next(d);
+        return true;
+    }
+
+    if (d->status == DELTA_OK)
+        d->status = DELTA_ERR_DATA;
+    return false;
+}
+
+delta_status_t delta_write(delta_t *d, const void *data, uint32_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    const uint8_t *end = p + len;
+    uint32_t n, v;
+    uint8_t b;
+
+    if (d->status != DELTA_OK)
+        return d->status;
+
+    // 头部收齐前 shift 用作头部计数
+    while (d->state == DELTA_ST_HEADER)
+    {
+        if (p == end)
+            return DELTA_OK;
+        d->header[d->shift++] = *p++;
+        if (d->shift == DELTA_HEADER_SIZE)
+        {
+            d->shift = 0;
+            if (!delta_parse_header(d))
+                return d->status;
+        }
+    }
+
+    while (d->state != DELTA_ST_DONE && p != end)
+    {
+        switch (d->state)
+        {
+        case DELTA_ST_BYTES:
+            n = (uint32_t)(end - p);
+            if (n > d->run)
+                n = d->run;
+            d->run -= n;
+            d->diff_left -= n;
+            d->out += n;
+            while (n--)
+            {
+                if (d->buf_len == DELTA_BUF_SIZE && !delta_flush(d))
+                    return d->status;
+                d->buf[d->buf_len++] = (uint8_t)(d->old[d->pos++] + *p++);
+            }
+            if (d->run == 0)
+                delta_next(d);
+            break;
+
+        case DELTA_ST_EXTRA:
+            n = (uint32_t)(end - p);
+            if (n > d->extra_left)
+                n = d->extra_left;
+            if (!delta_emit(d, p, n))
+                return d->status;
+            p += n;
+            d->extra_left -= n;
+            if (d->extra_left == 0)
+                delta_next(d);
+            break;
+
+        default:
+            // LEB128 变长整数，最多 5 字节、不超过 32 位
+            b = *p++;
+            if (d->shift == 28U && (b & 0xF0U))
+            {
+                d->status = DELTA_ERR_DATA;
+                return d->status;
+            }
+            d->value |= (uint32_t)(b & 0x7FU) << d->shift;
+            d->shift += 7U;
+            if (b & 0x80U)
+                break;
+            v = d->value;
+            d->value = 0;
+            d->shift = 0;
+            if (!delta_field(d, v))
+                return d->status;
+            break;
+        }
+    }
+
+    delta_flush(d);
+    return d->status;
+}
+
+delta_status_t delta_finish(delta_t *d)
+{
+    if (d->status == DELTA_OK && d->state != DELTA_ST_DONE)
+        d->status = DELTA_ERR_DATA;
+
+    return d->status;
+}
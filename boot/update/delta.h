@@ -0,0 +1,75 @@
+#ifndef __BL_DELTA_H
+#define __BL_DELTA_H
+
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/*
+ * 流式差分还原：旧镜像直接从 flash 读取，补丁可以按任意长度分块送入，不分配内存。
+ *
+ * 补丁由 tools/image_tool.py diff 生成（格式见 tools/delta.py），头部记录旧镜像的
+ * 长度和 CRC，与 flash 中的旧镜像不符时拒绝。之后是若干条记录：
+ *   差分段：新 = 旧 + d (mod 256)，按 (相同字节数, 差值字节数, 差值) 的游程编码；
+ *   新增段：原样输出；
+ *   最后把旧镜像读位置移动 seek。
+ *
+ * 与旧镜像相同的部分和新增段直接从 flash/输入交给 sink，只有差值字节经过
+ * DELTA_BUF_SIZE 字节的缓冲。
+ */
+
+#ifndef DELTA_BUF_SIZE
+#define DELTA_BUF_SIZE          256U
+#endif
+
+#define DELTA_HEADER_SIZE       16U
+
+
+typedef enum
+{
+    DELTA_OK = 0,
+    DELTA_ERR_HEADER,           /* 魔数或版本不符 */
+    DELTA_ERR_BASE,             /* 补丁不是针对当前旧镜像生成的 */
+    DELTA_ERR_DATA,             /* 记录越界，或数据不完整 */
+    DELTA_ERR_SINK,             /* sink 返回 false */
+} delta_status_t;
+
+/* 接收还原结果；返回 false 时中止 */
+typedef bool (*delta_sink_t)(void *arg, const uint8_t *data, uint32_t len);
+
+typedef struct
+{
+    delta_sink_t sink;
+    void *arg;
+    const uint8_t *old;
+    uint32_t old_max;           /* 旧镜像所在区域的大小 */
+    delta_status_t status;      /* 出错后保持 */
+    uint32_t state;
+    uint32_t value;             /* 正在解析的变长整数 */
+    uint32_t shift;
+    uint32_t diff_left;         /* 本记录差分段剩余字节数 */
+    uint32_t extra_left;        /* 本记录新增段剩余字节数 */
+    uint32_t run;               /* 当前差值游程剩余字节数 */
+    int32_t seek;
+    uint32_t pos;               /* 旧镜像读位置 */
+    uint32_t old_size;
+    uint32_t size;              /* 新镜像长度，头部收齐后有效 */
+    uint32_t out;               /* 已输出的字节数 */
+    uint32_t buf_len;
+    uint8_t header[DELTA_HEADER_SIZE];
+    uint8_t buf[DELTA_BUF_SIZE];
+} delta_t;
+
+
+/* 旧镜像位于 [old, old + old_max) */
+void delta_init(delta_t *d, const void *old, uint32_t old_max, delta_sink_t sink, void *arg);
+
+/* 处理下一块补丁数据 */
+delta_status_t delta_write(delta_t *d, const void *data, uint32_t len);
+
+/* 补丁结束；新镜像不完整时返回 DELTA_ERR_DATA */
+delta_status_t delta_finish(delta_t *d);
+
+
+#endif /* __BL_DELTA_H */
@@ -0,0 +1,180 @@
+#include "lzss.h"
+
+
+#define LZSS_WINDOW_MASK        (LZSS_WINDOW_SIZE - 1U)
+
+enum
+{
+    LZSS_ST_HEADER = 0,
+    LZSS_ST_TAG,
+    LZSS_ST_LITERAL,
+    LZSS_ST_INDEX,
+    LZSS_ST_COUNT,
+    LZSS_ST_DONE,
+};
+
+
+void lzss_init(lzss_t *z, lzss_sink_t sink, void *arg)
+{
+    z->sink = sink;
+    z->arg = arg;
+    z->status = LZSS_OK;
+    z->state = LZSS_ST_HEADER;
+    z->bits = 0;
+    z->nbits = 0;
+    z->index = 0;
+    z->size = 0;
+    z->out = 0;
+    z->head = 0;
+    z->flushed = 0;
+}
+
+static bool lzss_parse_header(lzss_t *z)
+{
+    const uint8_t *h = z->header;
+
+    z->window_bits = h[2];
+    z->count_bits = h[3];
+    z->size = (uint32_t)h[4] | ((uint32_t)h[5] << 8) | ((uint32_t)h[6] << 16) | ((uint32_t)h[7] << 24);
+
+    if (h[0] != 'L' || h[1] != 'Z' ||
+        z->window_bits == 0 || z->window_bits > LZSS_WINDOW_BITS ||
+        z->count_bits == 0 || z->count_bits > 8U)
+    {
+        z->status = LZSS_ERR_HEADER;
+        return false;
+    }
+
+    z->state = z->size ? LZSS_ST_TAG : LZSS_ST_DONE;
+    return true;
+}
+
+// 把 [flushed, head) 交给 sink
+static bool lzss_flush(lzss_t *z)
+{
+    if (z->head != z->flushed && !z->sink(z->arg, &z->window[z->flushed], z->head - z->flushed))
+    {
+        z->status = LZSS_ERR_SINK;
+        return false;
+    }
+
+    z->flushed = z->head;
+    return true;
+}
+
+static inline bool lzss_put(lzss_t *z, uint8_t b)
+{
+    z->window[z->head++] = b;
+    z->out++;
+
+    // 回绕前交出整段窗口，之后才会覆盖这些字节
+    if (z->head == LZSS_WINDOW_SIZE)
+    {
+        if (!lzss_flush(z))
+            return false;
+        z->head = 0;
+        z->flushed = 0;
+    }
+
+    return true;
+}
+
+lzss_status_t lzss_write(lzss_t *z, const void *data, uint32_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    const uint8_t *end = p + len;
+    uint32_t need, v, n;
+
+    if (z->status != LZSS_OK)
+        return z->status;
+
+    while (z->state == LZSS_ST_HEADER)
+    {
+        if (p == end)
+            return LZSS_OK;
+        z->header[z->index++] = *p++;
+        if (z->index == LZSS_HEADER_SIZE && !lzss_parse_header(z))
+            return z->status;
+    }
+
+    while (z->state != LZSS_ST_DONE)
+    {
+        switch (z->state)
+        {
+        case LZSS_ST_TAG:
+            need = 1;
+            break;
+        case LZSS_ST_LITERAL:
+            need = 8;
+            break;
+        case LZSS_ST_INDEX:
+            need = z->window_bits;
+            break;
+        default:
+            need = z->count_bits;
+            break;
+        }
+
+        // 字段最长 LZSS_WINDOW_BITS 位，位缓冲不会超过 32 位
+        while (z->nbits < need)
+        {
+            if (p == end)
+                goto out;
+            z->bits = (z->bits << 8) | *p++;
+            z->nbits += 8;
+        }
+        z->nbits -= need;
+        v = (z->bits >> z->nbits) & ((1UL << need) - 1U);
+
+        switch (z->state)
+        {
+        case LZSS_ST_TAG:
+            z->state = v ? LZSS_ST_LITERAL : LZSS_ST_INDEX;
+            break;
+
+        case LZSS_ST_LITERAL:
+            if (!lzss_put(z, (uint8_t)v))
+                return z->status;
+            z->state = LZSS_ST_TAG;
+            break;
+
+        case LZSS_ST_INDEX:
+            z->index = v + 1U;
+            if (z->index > z->out)
+            {
+                z->status = LZSS_ERR_DATA;
+                return z->status;
+            }
+            z->state = LZSS_ST_COUNT;
+            break;
+
+        default:
+            // 源和目的可以重叠，逐字节复制即可得到重复模式
+            n = v + 1U;
+            if (n > z->size - z->out)
+                n = z->size - z->out;
+            while (n--)
+            {
+                if (!lzss_put(z, z->window[(z->head - z->index) & LZSS_WINDOW_MASK]))
+                    return z->status;
+            }
+            z->state = LZSS_ST_TAG;
+            break;
+        }
+
+        if (z->out == z->size)
+            z->state = LZSS_ST_DONE;
+    }
+
+out:
+    lzss_flush(z);
+    return z->status;
+}
+
+lzss_status_t lzss_finish(lzss_t *z)
+{
+    if (z->status == LZSS_OK && z->state != LZSS_ST_DONE)
+        z->status = LZSS_ERR_DATA;
+
+    return z->status;
+}
@@ -0,0 +1,69 @@
+#ifndef __BL_LZSS_H
+#define __BL_LZSS_H
+
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/*
+ * 流式 LZSS 解压，输入可以按任意长度分块送入，不分配内存。
+ *
+ * 数据流由 tools/image_tool.py compress 生成（格式见 tools/lzss.py）：
+ *   "LZ" | 窗口位数 W | 长度位数 C | 原始长度 (u32 小端) | 位流
+ * 位流高位在前：1 + 8 位为字面字节；0 + W 位 + C 位为从 (index + 1) 字节前复制 (count + 1) 字节。
+ *
+ * 解压结果写入大小为 2^LZSS_WINDOW_BITS 的环形窗口，窗口写满回绕时以及每次
+ * lzss_write 返回前，把新产生的数据直接从窗口交给 sink，不再另设输出缓冲。
+ * 流中的 W 不能超过 LZSS_WINDOW_BITS，C 为 1..8。
+ */
+
+#ifndef LZSS_WINDOW_BITS
+#define LZSS_WINDOW_BITS        12U
+#endif
+
+#define LZSS_WINDOW_SIZE        (1UL << LZSS_WINDOW_BITS)
+#define LZSS_HEADER_SIZE        8U
+
+
+typedef enum
+{
+    LZSS_OK = 0,
+    LZSS_ERR_HEADER,            /* 魔数或参数不符 */
+    LZSS_ERR_DATA,              /* 引用了输出起点之前的数据，或数据不完整 */
+    LZSS_ERR_SINK,              /* sink 返回 false */
+} lzss_status_t;
+
+/* 接收解压结果；返回 false 时解压中止 */
+typedef bool (*lzss_sink_t)(void *arg, const uint8_t *data, uint32_t len);
+
+typedef struct
+{
+    lzss_sink_t sink;
+    void *arg;
+    lzss_status_t status;       /* 出错后保持 */
+    uint32_t state;             /* 位流解析所处的字段 */
+    uint32_t bits;              /* 尚未使用的位，低 nbits 位有效 */
+    uint32_t nbits;
+    uint32_t window_bits;
+    uint32_t count_bits;
+    uint32_t index;             /* 当前复制的回溯距离 */
+    uint32_t size;              /* 原始长度，头部收齐后有效 */
+    uint32_t out;               /* 已解压的字节数 */
+    uint32_t head;              /* 下一个字节在窗口中的位置 */
+    uint32_t flushed;           /* [flushed, head) 尚未交给 sink */
+    uint8_t header[LZSS_HEADER_SIZE];
+    uint8_t window[LZSS_WINDOW_SIZE];
+} lzss_t;
+
+
+void lzss_init(lzss_t *z, lzss_sink_t sink, void *arg);
+
+/* 解压下一块输入；达到原始长度后多余的输入（末尾补齐位）被忽略 */
+lzss_status_t lzss_write(lzss_t *z, const void *data, uint32_t len);
+
+/* 输入结束；输出不足原始长度时返回 LZSS_ERR_DATA */
+lzss_status_t lzss_finish(lzss_t *z);
+
+
+#endif /* __BL_LZSS_H */
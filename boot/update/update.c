@@ -0,0 +1,267 @@
+#include <string.h>
+#include "log.h"
+#include "update.h"
+
+
+update_status_t update_begin(update_t *up, uint32_t base, uint32_t size)
+{
+    uint32_t start;
+
+    up->base = base;
+    up->size = size;
+    up->offset = 0;
+    up->erased = base;
+    up->status = UPDATE_OK;
+    up->key = NULL;
+    up->key_len = 0;
+    up->iv_len = 0;
+    up->compressed = false;
+    up->delta = false;
+    verify_ctx_init(&up->digest);
+
+    if (!bl_flash_sector(base, NULL, &start, NULL) || start != base ||
+        size == 0 || size > BL_FLASH_BASE + BL_FLASH_SIZE - base)
+    {
+        up->status = UPDATE_ERR_ARG;
+    }
+
+    return up->status;
+}
+
+update_status_t update_begin_encrypted(update_t *up, uint32_t base, uint32_t size,
+                                       const uint8_t *key, uint32_t key_len)
+{
+    if (update_begin(up, base, size) != UPDATE_OK)
+        return up->status;
+
+    if (key == NULL || (key_len != 16U && key_len != 24U && key_len != 32U))
+    {
+        up->status = UPDATE_ERR_ARG;
+        return up->status;
+    }
+
+    up->key = key;
+    up->key_len = key_len;
+    return UPDATE_OK;
+}
+
+// 保证 [base, end) 已擦除
+static update_status_t update_erase_to(update_t *up, uint32_t end)
+{
+    uint32_t start, size;
+
+    while (up->erased < end)
+    {
+        if (!bl_flash_sector(up->erased, NULL, &start, &size))
+            return UPDATE_ERR_ARG;
+        if (bl_flash_erase(start) != BL_FLASH_OK)
+        {
+            LOG_E("update: erase 0x%08x failed", (unsigned)start);
+            return UPDATE_ERR_ERASE;
+        }
+        up->erased = start + size;
+    }
+
+    return UPDATE_OK;
+}
+
+// 明文写入当前位置
+static update_status_t update_program(update_t *up, const void *data, uint32_t len)
+{
+    uint32_t addr = up->base + up->offset;
+    update_status_t status;
+    bl_flash_status_t ret;
+
+    if (len > up->size - up->offset)
+        return UPDATE_ERR_ARG;
+
+    status = update_erase_to(up, addr + len);
+    if (status != UPDATE_OK)
+        return status;
+
+    ret = bl_flash_program(addr, data, len);
+    if (ret != BL_FLASH_OK)
+    {
+        LOG_E("update: program 0x%08x+%u failed (%d)", (unsigned)addr, (unsigned)len, (int)ret);
+        return ret == BL_FLASH_ERR_VERIFY ? UPDATE_ERR_VERIFY : UPDATE_ERR_PROGRAM;
+    }
+
+    // 读回比较已确认 flash 与 data 一致，直接从 RAM 中的 data 计算更快
+    verify_ctx_update(&up->digest, data, len);
+    up->offset += len;
+
+    return UPDATE_OK;
+}
+
+static bool update_sink(void *arg, const uint8_t *data, uint32_t len)
+{
+    update_t *up = (update_t *)arg;
+
+    up->status = update_program(up, data, len);
+    return up->status == UPDATE_OK;
+}
+
+// 解压后的数据：差分补丁先还原，还原结果经 update_sink 编程
+static update_status_t update_patch(update_t *up, const void *data, uint32_t len)
+{
+    if (!up->delta)
+        return update_program(up, data, len);
+
+    switch (delta_write(&up->patch, data, len))
+    {
+    case DELTA_OK:
+        return UPDATE_OK;
+    case DELTA_ERR_SINK:
+        return up->status;
+    case DELTA_ERR_BASE:
+        LOG_E("update: patch does not match the installed image");
+        return UPDATE_ERR_BASE;
+    default:
+        LOG_E("update: bad patch data at %u", (unsigned)up->offset);
+        return UPDATE_ERR_DATA;
+    }
+}
+
+static bool update_unpack_sink(void *arg, const uint8_t *data, uint32_t len)
+{
+    update_t *up = (update_t *)arg;
+
+    up->status = update_patch(up, data, len);
+    return up->status == UPDATE_OK;
+}
+
+update_status_t update_set_compressed(update_t *up)
+{
+    if (up->status != UPDATE_OK)
+        return up->status;
+
+    if (up->offset || up->iv_len)
+    {
+        up->status = UPDATE_ERR_ARG;
+        return up->status;
+    }
+
+    lzss_init(&up->lzss, update_unpack_sink, up);
+    up->compressed = true;
+    return UPDATE_OK;
+}
+
+update_status_t update_set_delta(update_t *up, uint32_t old_base, uint32_t old_max)
+{
+    if (up->status != UPDATE_OK)
+        return up->status;
+
+    // 还原时边读旧镜像边写目标区域，两者不能重叠
+    if (up->offset || up->iv_len ||
+        old_base < BL_FLASH_BASE || old_max > BL_FLASH_BASE + BL_FLASH_SIZE - old_base ||
+        (old_base < up->base + up->size && up->base < old_base + old_max))
+    {
+        up->status = UPDATE_ERR_ARG;
+        return up->status;
+    }
+
+    delta_init(&up->patch, (const void *)old_base, old_max, update_sink, up);
+    up->delta = true;
+    return UPDATE_OK;
+}
+
+// 明文（已解密）数据：压缩流先解压，解压结果经 update_unpack_sink 继续处理
+static update_status_t update_feed(update_t *up, const void *data, uint32_t len)
+{
+    if (!up->compressed)
+        return update_patch(up, data, len);
+
+    switch (lzss_write(&up->lzss, data, len))
+    {
+    case LZSS_OK:
+        return UPDATE_OK;
+    case LZSS_ERR_SINK:
+        return up->status;
+    default:
+        LOG_E("update: bad compressed data at %u", (unsigned)up->offset);
+        return UPDATE_ERR_DATA;
+    }
+}
+
+update_status_t update_write(update_t *up, const void *data, uint32_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    uint8_t buf[UPDATE_CRYPT_CHUNK];
+    uint32_t n;
+
+    if (up->status != UPDATE_OK)
+        return up->status;
+
+    if (up->key == NULL && up->iv_len == 0)
+    {
+        up->status = update_feed(up, data, len);
+        return up->status;
+    }
+
+    // 先收齐 IV
+    if (up->iv_len < AES_BLOCK_SIZE)
+    {
+        n = AES_BLOCK_SIZE - up->iv_len;
+        if (n > len)
+            n = len;
+        memcpy(&up->iv[up->iv_len], p, n);
+        up->iv_len += n;
+        p += n;
+        len -= n;
+        if (up->iv_len < AES_BLOCK_SIZE)
+            return UPDATE_OK;
+
+        aes_ctr_init(&up->aes, up->key, up->key_len, up->iv);
+        up->key = NULL;
+    }
+
+    // 解密一段、编程一段，密文不落地，也不需要整块缓冲
+    while (len && up->status == UPDATE_OK)
+    {
+        n = len > sizeof(buf) ? sizeof(buf) : len;
+        aes_ctr_crypt(&up->aes, buf, p, n);
+        up->status = update_feed(up, buf, n);
+        p += n;
+        len -= n;
+    }
+
+    return up->status;
+}
+
+update_status_t update_finish(update_t *up, uint32_t *crc)
+{
+    uint32_t digest;
+
+    if (up->iv_len == AES_BLOCK_SIZE)
+        aes_ctr_end(&up->aes);
+    up->key = NULL;
+
+    if (up->status != UPDATE_OK)
+        return up->status;
+
+    if (up->compressed && lzss_finish(&up->lzss) != LZSS_OK)
+    {
+        LOG_E("update: compressed stream truncated, %u bytes", (unsigned)up->offset);
+        up->status = UPDATE_ERR_DATA;
+        return up->status;
+    }
+
+    if (up->delta && delta_finish(&up->patch) != DELTA_OK)
+    {
+        LOG_E("update: patch truncated, %u bytes", (unsigned)up->offset);
+        up->status = UPDATE_ERR_DATA;
+        return up->status;
+    }
+
+    digest = verify_ctx_final(&up->digest);
+    if (crc)
+        *crc = digest;
+
+    if (digest != CRC32_RESIDUE)
+    {
+        LOG_E("update: image crc mismatch, %u bytes", (unsigned)up->offset);
+        up->status = UPDATE_ERR_CRC;
+    }
+
+    return up->status;
+}
@@ -0,0 +1,90 @@
+#ifndef __BL_UPDATE_H
+#define __BL_UPDATE_H
+
+
+#include <stdint.h>
+#include "flash.h"
+#include "verify.h"
+#include "aes.h"
+#include "lzss.h"
+#include "delta.h"
+
+
+/*
+ * 升级写入引擎：接收到的数据按块交给 update_write，
+ * 按需擦除扇区、编程、读回比较，并把已确认写入的数据送入增量校验上下文。
+ * 最后一块写完时镜像摘要已经算好，update_finish 不再整体读一遍 flash。
+ *
+ * 镜像格式同 verify_image：末尾带 tools/image_tool.py 追加的 CRC。
+ *
+ * 加密镜像 (image_tool.py encrypt) 以 16 字节 IV 开头，其后为 AES-CTR 密文。
+ * 收齐 IV 后每块先解密到栈上的缓冲区再编程，flash 中和摘要里都是明文，
+ * size/offset 只计明文。
+ *
+ * 压缩镜像 (image_tool.py compress) 在 update_begin 之后调用 update_set_compressed，
+ * 解密后的数据先经 lzss 解压再编程，可与加密同时使用 (先压缩后加密)。
+ * 解压窗口在 update_t 中，不压缩时不使用。
+ *
+ * 差分补丁 (image_tool.py diff) 在 update_begin 之后调用 update_set_delta 指定旧镜像，
+ * 解密、解压后的数据经 delta 还原后再编程。旧镜像在原位读取，不能与目标区域重叠。
+ * 三者顺序为 diff -> compress -> encrypt，写入时逆序处理。
+ */
+
+/* 解密缓冲区大小，位于 update_write 的栈上 */
+#ifndef UPDATE_CRYPT_CHUNK
+#define UPDATE_CRYPT_CHUNK      256U
+#endif
+
+typedef enum
+{
+    UPDATE_OK = 0,
+    UPDATE_ERR_ARG,             /* 起始地址不是扇区起点，或写入超出区域 */
+    UPDATE_ERR_ERASE,
+    UPDATE_ERR_PROGRAM,
+    UPDATE_ERR_VERIFY,          /* 读回比较失败 */
+    UPDATE_ERR_CRC,             /* 镜像 CRC 不符 */
+    UPDATE_ERR_DATA,            /* 压缩数据或差分补丁格式错误 */
+    UPDATE_ERR_BASE,            /* 差分补丁与当前旧镜像不符 */
+} update_status_t;
+
+typedef struct
+{
+    uint32_t base;
+    uint32_t size;
+    uint32_t offset;            /* 已写入的字节数 */
+    uint32_t erased;            /* [base, erased) 已擦除 */
+    update_status_t status;     /* 出错后保持，后续写入直接返回 */
+    verify_ctx_t digest;
+    const uint8_t *key;         /* 非 NULL 时为加密镜像，收齐 IV 前保存密钥 */
+    uint32_t key_len;
+    uint32_t iv_len;            /* 已收到的 IV 字节数 */
+    uint8_t iv[AES_BLOCK_SIZE];
+    aes_ctr_ctx_t aes;
+    bool compressed;
+    lzss_t lzss;
+    bool delta;
+    delta_t patch;
+} update_t;
+
+
+/* 目标区域 [base, base + size)，base 必须是扇区起点 */
+update_status_t update_begin(update_t *up, uint32_t base, uint32_t size);
+
+/* 同 update_begin，数据流为加密镜像；key 须保持有效直到 IV 收齐 */
+update_status_t update_begin_encrypted(update_t *up, uint32_t base, uint32_t size,
+                                       const uint8_t *key, uint32_t key_len);
+
+/* 在 begin 之后、第一次写入之前调用：数据流为压缩镜像 */
+update_status_t update_set_compressed(update_t *up);
+
+/* 在 begin 之后、第一次写入之前调用：数据流为针对 [old_base, old_base + old_max) 中旧镜像的差分补丁 */
+update_status_t update_set_delta(update_t *up, uint32_t old_base, uint32_t old_max);
+
+/* 顺序写入下一块 */
+update_status_t update_write(update_t *up, const void *data, uint32_t len);
+
+/* 结束写入并清除密钥，crc 返回摘要（可为 NULL），并按末尾 CRC 校验整个镜像 */
+update_status_t update_finish(update_t *up, uint32_t *crc);
+
+
+#endif /* __BL_UPDATE_H */
@@ -0,0 +1,62 @@
+#ifndef __BL_AES_H
+#define __BL_AES_H
+
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/*
+ * AES-CTR 流式加解密（CTR 模式加密与解密相同），用于加密升级镜像边收边解。
+ *
+ * 计数器块为 16 字节大端数，每块只递增最低 32 位，与 CRYP 外设的 CTR 模式一致；
+ * tools/image_tool.py encrypt 生成的 IV 低 32 位为 0，镜像不超过 64 GiB 就不会回绕。
+ *
+ * 软件实现为查表法：T 表和 S 盒在 RAM 中运行时生成，其余三张 T 表用循环移位代替，
+ * M4 的桶形移位器使移位不占额外周期。
+ *
+ * AES_USE_CRYP 置 1 时使用 CRYP 外设（F415/F417/F437/F439 才有），整块数据由
+ * DMA2 Stream6/Stream5 送入取出。F407 没有 CRYP，原因同 SHA256_USE_HASH，默认关闭。
+ * 外设同一时间只服务一个上下文，其余上下文自动用软件计算，结果相同。
+ */
+
+#ifndef AES_USE_CRYP
+#define AES_USE_CRYP            0
+#endif
+
+#define AES_BLOCK_SIZE          16U
+
+
+typedef struct
+{
+    uint32_t rk[60];            /* 加密轮密钥 */
+    uint32_t rounds;
+    uint8_t ctr[AES_BLOCK_SIZE];    /* 下一个计数器块 */
+    uint8_t ks[AES_BLOCK_SIZE];     /* 当前密钥流块 */
+    uint32_t used;              /* ks 中已用掉的字节数 */
+#if AES_USE_CRYP
+    bool hw;                    /* 该上下文占用 CRYP 外设 */
+#endif
+} aes_ctr_ctx_t;
+
+
+/* 生成查找表；aes_ctr_init 首次调用时会自动生成 */
+void aes_init(void);
+
+/* key_len 为 16、24 或 32 字节，否则返回 false */
+bool aes_ctr_init(aes_ctr_ctx_t *ctx, const uint8_t *key, uint32_t key_len, const uint8_t iv[AES_BLOCK_SIZE]);
+
+/* 处理任意长度，可以原地进行 (out == in) */
+void aes_ctr_crypt(aes_ctr_ctx_t *ctx, void *out, const void *in, uint32_t len);
+
+/* 释放外设并清除密钥 */
+void aes_ctr_end(aes_ctr_ctx_t *ctx);
+
+/* NIST SP 800-38A F.5.1/F.5.5 (CTR-AES128/256)，并按不规则长度分段重算 */
+bool aes_selftest(void);
+
+/* 按 256 字节一段解密 [addr, addr + len) 计时，通过 LOG_I 报告每字节周期数 */
+void aes_bench(const void *addr, uint32_t len);
+
+
+#endif /* __BL_AES_H */
@@ -0,0 +1,76 @@
+#include <stdbool.h>
+#include <string.h>
+#include "crc32.h"
+
+
+#define CRC32_POLY      0x04C11DB7U
+
+
+// crc32_table[n][b]：字节 b 后面再跟 n 个零字节时对 CRC 的贡献
+// 放在 RAM 中运行时生成：flash 上随机查表会频繁错过 ART 的 8 行数据缓存
+static uint32_t crc32_table[8][256];
+static bool crc32_ready;
+
+
+void crc32_sw_init(void)
+{
+    uint32_t b, n, c;
+
+    for (b = 0; b < 256U; b++)
+    {
+        c = b << 24;
+        for (n = 0; n < 8U; n++)
+            c = (c & 0x80000000U) ? (c << 1) ^ CRC32_POLY : (c << 1);
+        crc32_table[0][b] = c;
+    }
+
+    for (n = 1; n < 8U; n++)
+    {
+        for (b = 0; b < 256U; b++)
+        {
+            c = crc32_table[n - 1][b];
+            crc32_table[n][b] = (c << 8) ^ crc32_table[0][c >> 24];
+        }
+    }
+
+    crc32_ready = true;
+}
+
+static inline uint32_t crc32_load(const uint8_t *p)
+{
+    uint32_t w;
+
+    memcpy(&w, p, sizeof(w));   // 小端目标上即一条 LDR
+    return w;
+}
+
+uint32_t crc32_sw_update(uint32_t crc, const void *data, uint32_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    uint32_t x, y;
+
+    if (!crc32_ready)
+        crc32_sw_init();
+
+    len >>= 2;
+
+    // 每次 8 字节：第一个字的最高字节后面还有 7 个字节，依此类推
+    for (; len >= 2U; len -= 2U, p += 8)
+    {
+        x = crc ^ crc32_load(p);
+        y = crc32_load(p + 4);
+        crc = crc32_table[7][x >> 24] ^ crc32_table[6][(x >> 16) & 0xFFU] ^
+              crc32_table[5][(x >> 8) & 0xFFU] ^ crc32_table[4][x & 0xFFU] ^
+              crc32_table[3][y >> 24] ^ crc32_table[2][(y >> 16) & 0xFFU] ^
+              crc32_table[1][(y >> 8) & 0xFFU] ^ crc32_table[0][y & 0xFFU];
+    }
+
+    if (len)
+    {
+        x = crc ^ crc32_load(p);
+        crc = crc32_table[3][x >> 24] ^ crc32_table[2][(x >> 16) & 0xFFU] ^
+              crc32_table[1][(x >> 8) & 0xFFU] ^ crc32_table[0][x & 0xFFU];
+    }
+
+    return crc;
+}
@@ -0,0 +1,36 @@
+#ifndef __BL_CRC32_H
+#define __BL_CRC32_H
+
+
+#include <stdint.h>
+
+
+/*
+ * 与 STM32F4 CRC 外设一致的 CRC-32：
+ *   多项式 0x04C11DB7 (IEEE 802.3)，初值 0xFFFFFFFF，不反射，无结果异或；
+ *   数据按小端读出的 32 位字送入，每个字从最高位开始计算。
+ * 这与 zlib 的 crc32() 不同（那是反射版本），主机端请使用 tools/image_tool.py。
+ *
+ * 长度以字节计，必须是 4 的倍数，镜像由主机工具补 0xFF 对齐。
+ * 镜像末尾追加自身 CRC（小端字）后，对整个镜像再算一次 CRC 结果为 0。
+ *
+ * 本文件不依赖外设，可直接在主机上编译。
+ */
+
+#define CRC32_INIT      0xFFFFFFFFU
+#define CRC32_RESIDUE   0x00000000U
+
+
+/* 生成查找表；crc32_sw_update 首次调用时会自动生成 */
+void crc32_sw_init(void);
+
+/* 在 crc 的基础上继续计算 len 字节（slicing-by-8），返回新的 crc */
+uint32_t crc32_sw_update(uint32_t crc, const void *data, uint32_t len);
+
+static inline uint32_t crc32_sw(const void *data, uint32_t len)
+{
+    return crc32_sw_update(CRC32_INIT, data, len);
+}
+
+
+#endif /* __BL_CRC32_H */
@@ -0,0 +1,740 @@
+#include <string.h>
+#include "stm32f4xx.h"
+#include "log.h"
+#include "sha512.h"
+#include "ed25519.h"
+
+
+// 域元素，小端 32 位字，取值在 [0, 2^256) 内，不一定完全约简
+typedef uint32_t fe_t[8];
+
+typedef struct
+{
+    fe_t X, Y, Z;
+} ge_p2_t;
+
+typedef struct
+{
+    fe_t X, Y, Z, T;
+} ge_p3_t;
+
+typedef struct
+{
+    fe_t X, Y, Z, T;
+} ge_p1p1_t;
+
+typedef struct
+{
+    fe_t YplusX, YminusX, Z, T2d;
+} ge_cached_t;
+
+typedef struct
+{
+    fe_t yplusx, yminusx, xy2d;
+} ge_precomp_t;
+
+#include "ed25519_table.h"
+
+
+static const fe_t fe_p = { 0xffffffed, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0x7fffffff };
+static const fe_t fe_d = { 0x135978a3, 0x75eb4dca, 0x4141d8ab, 0x00700a4d, 0x7779e898, 0x8cc74079, 0x2b6ffe73, 0x52036cee };
+static const fe_t fe_d2 = { 0x26b2f159, 0xebd69b94, 0x8283b156, 0x00e0149a, 0xeef3d130, 0x198e80f2, 0x56dffce7, 0x2406d9dc };
+static const fe_t fe_sqrtm1 = { 0x4a0ea0b0, 0xc4ee1b27, 0xad2fe478, 0x2f431806, 0x3dfbd7a7, 0x2b4d0099, 0x4fc1df0b, 0x2b832480 };
+static const uint32_t sc_l[8] = { 0x5cf5d3ed, 0x5812631a, 0xa2f79cd6, 0x14def9de, 0x00000000, 0x00000000, 0x00000000, 0x10000000 };
+
+
+// {*hi, *lo} = a * b + *lo + *hi，结果不会超过 64 位
+static inline void umaal(uint32_t *lo, uint32_t *hi, uint32_t a, uint32_t b)
+{
+#if defined(__ARM_ARCH_7EM__)
+    __asm__ ("umaal %0, %1, %2, %3" : "+r" (*lo), "+r" (*hi) : "r" (a), "r" (b));
+#else
+    uint64_t t = (uint64_t)a * b + *lo + *hi;
+    *lo = (uint32_t)t;
+    *hi = (uint32_t)(t >> 32);
+#endif
+}
+
+
+static void fe_0(fe_t r)
+{
+    memset(r, 0, sizeof(fe_t));
+}
+
+static void fe_1(fe_t r)
+{
+    memset(r, 0, sizeof(fe_t));
+    r[0] = 1;
+}
+
+// r += c * 2^256，2^256 ≡ 38 (mod p)
+static void fe_fold(fe_t r, uint32_t c)
+{
+    uint64_t s;
+    uint32_t i;
+
+    c *= 38U;
+    for (i = 0; i < 8U && c; i++)
+    {
+        s = (uint64_t)r[i] + c;
+        r[i] = (uint32_t)s;
+        c = (uint32_t)(s >> 32);
+    }
+    // 再次越过 2^256 时剩下的值必然很小，再加 38 不会进位
+    if (c)
+        r[0] += 38U;
+}
+
+// 512 位乘积 t 约简到 r：低 256 位 + 38 * 高 256 位
+static void fe_reduce(fe_t r, uint32_t t[16])
+{
+    uint32_t c = 0, i;
+
+    for (i = 0; i < 8U; i++)
+        umaal(&t[i], &c, t[i + 8], 38U);
+
+    memcpy(r, t, sizeof(fe_t));
+    fe_fold(r, c);
+}
+
+static void fe_add(fe_t r, const fe_t a, const fe_t b)
+{
+    uint64_t s = 0;
+    uint32_t i;
+
+    for (i = 0; i < 8U; i++)
+    {
+        s += (uint64_t)a[i] + b[i];
+        r[i] = (uint32_t)s;
+        s >>= 32;
+    }
+    fe_fold(r, (uint32_t)s);
+}
+
+static void fe_sub(fe_t r, const fe_t a, const fe_t b)
+{
+    int64_t s = 0;
+    uint32_t i;
+
+    for (i = 0; i < 8U; i++)
+    {
+        s += (int64_t)a[i] - b[i];
+        r[i] = (uint32_t)s;
+        s >>= 32;
+    }
+
+    // 借位相当于多加了 2^256 ≡ 38，减掉；结果很小时可能再借位一次
+    while (s)
+    {
+        s = -38;
+        for (i = 0; i < 8U; i++)
+        {
+            s += r[i];
+            r[i] = (uint32_t)s;
+            s >>= 32;
+        }
+    }
+}
+
+static void fe_neg(fe_t r, const fe_t a)
+{
+    fe_t zero;
+
+    fe_0(zero);
+    fe_sub(r, zero, a);
+}
+
+static void fe_mul(fe_t r, const fe_t a, const fe_t b)
+{
+    uint32_t t[16], c, i, j;
+
+    memset(t, 0, 8U * sizeof(uint32_t));
+    for (i = 0; i < 8U; i++)
+    {
+        c = 0;
+        for (j = 0; j < 8U; j++)
+            umaal(&t[i + j], &c, a[j], b[i]);
+        t[i + 8] = c;
+    }
+
+    fe_reduce(r, t);
+}
+
+// 交叉项只算一次再加倍，比 fe_mul 少 28 次乘法
+static void fe_sq(fe_t r, const fe_t a)
+{
+    uint32_t t[16], c, i, j;
+    uint64_t s;
+
+    memset(t, 0, 8U * sizeof(uint32_t));
+    for (i = 0; i < 7U; i++)
+    {
+        c = 0;
+        for (j = i + 1U; j < 8U; j++)
+            umaal(&t[i + j], &c, a[i], a[j]);
+        t[i + 8] = c;
+    }
+    t[15] = 0;
+
+    for (i = 15; i > 0; i--)
+        t[i] = (t[i] << 1) | (t[i - 1] >> 31);
+    t[0] <<= 1;
+
+    c = 0;
+    for (i = 0; i < 8U; i++)
+    {
+        umaal(&t[2 * i], &c, a[i], a[i]);
+        s = (uint64_t)t[2 * i + 1] + c;
+        t[2 * i + 1] = (uint32_t)s;
+        c = (uint32_t)(s >> 32);
+    }
+
+    fe_reduce(r, t);
+}
+
+// r = a^(2^n)，n >= 1
+static void fe_sqn(fe_t r, const fe_t a, uint32_t n)
+{
+    fe_sq(r, a);
+    while (--n)
+        fe_sq(r, r);
+}
+
+// r = z^(2^250 - 1)，z11 = z^11
+static void fe_pow2250m1(fe_t r, fe_t z11, const fe_t z)
+{
+    fe_t t0, t1, t2;
+
+    fe_sq(t0, z);
+    fe_sqn(t1, t0, 2);
+    fe_mul(t1, z, t1);
+    fe_mul(z11, t0, t1);
+    fe_sq(t0, z11);
+    fe_mul(t1, t1, t0);         // 2^5 - 1
+    fe_sqn(t0, t1, 5);
+    fe_mul(t1, t0, t1);         // 2^10 - 1
+    fe_sqn(t0, t1, 10);
+    fe_mul(t0, t0, t1);         // 2^20 - 1
+    fe_sqn(t2, t0, 20);
+    fe_mul(t0, t2, t0);         // 2^40 - 1
+    fe_sqn(t0, t0, 10);
+    fe_mul(t1, t0, t1);         // 2^50 - 1
+    fe_sqn(t0, t1, 50);
+    fe_mul(t0, t0, t1);         // 2^100 - 1
+    fe_sqn(t2, t0, 100);
+    fe_mul(t0, t2, t0);         // 2^200 - 1
+    fe_sqn(t0, t0, 50);
+    fe_mul(r, t0, t1);          // 2^250 - 1
+}
+
+// r = z^(p - 2) = z^(2^255 - 21)
+static void fe_invert(fe_t r, const fe_t z)
+{
+    fe_t t, z11;
+
+    fe_pow2250m1(t, z11, z);
+    fe_sqn(t, t, 5);
+    fe_mul(r, t, z11);
+}
+
+// r = z^((p - 5) / 8) = z^(2^252 - 3)
+static void fe_pow22523(fe_t r, const fe_t z)
+{
+    fe_t t, z11;
+
+    fe_pow2250m1(t, z11, z);
+    fe_sqn(t, t, 2);
+    fe_mul(r, t, z);
+}
+
+// 完全约简到 [0, p)；输入小于 2^256 = 2p + 38，最多减两次
+static void fe_freeze(fe_t r, const fe_t a)
+{
+    fe_t t;
+    int64_t s;
+    uint32_t i, k;
+
+    memcpy(r, a, sizeof(fe_t));
+    for (k = 0; k < 2U; k++)
+    {
+        s = 0;
+        for (i = 0; i < 8U; i++)
+        {
+            s += (int64_t)r[i] - fe_p[i];
+            t[i] = (uint32_t)s;
+            s >>= 32;
+        }
+        if (s == 0)
+            memcpy(r, t, sizeof(fe_t));
+    }
+}
+
+static bool fe_iszero(const fe_t a)
+{
+    fe_t t;
+    uint32_t i, acc = 0;
+
+    fe_freeze(t, a);
+    for (i = 0; i < 8U; i++)
+        acc |= t[i];
+    return acc == 0;
+}
+
+static uint32_t fe_isnegative(const fe_t a)
+{
+    fe_t t;
+
+    fe_freeze(t, a);
+    return t[0] & 1U;
+}
+
+// 忽略最高位；y >= p 的非规范编码按 RFC 8032 拒绝
+static bool fe_frombytes(fe_t r, const uint8_t s[32])
+{
+    uint32_t i;
+
+    memcpy(r, s, sizeof(fe_t));
+    r[7] &= 0x7FFFFFFFU;
+
+    for (i = 7; i > 0; i--)
+    {
+        if (r[i] != fe_p[i])
+            return r[i] < fe_p[i];
+    }
+    return r[0] < fe_p[0];
+}
+
+static void fe_tobytes(uint8_t s[32], const fe_t a)
+{
+    fe_t t;
+
+    fe_freeze(t, a);
+    memcpy(s, t, sizeof(fe_t));
+}
+
+
+static void ge_p1p1_to_p2(ge_p2_t *r, const ge_p1p1_t *p)
+{
+    fe_mul(r->X, p->X, p->T);
+    fe_mul(r->Y, p->Y, p->Z);
+    fe_mul(r->Z, p->Z, p->T);
+}
+
+static void ge_p1p1_to_p3(ge_p3_t *r, const ge_p1p1_t *p)
+{
+    fe_mul(r->X, p->X, p->T);
+    fe_mul(r->Y, p->Y, p->Z);
+    fe_mul(r->Z, p->Z, p->T);
+    fe_mul(r->T, p->X, p->Y);
+}
+
+static void ge_p3_to_cached(ge_cached_t *r, const ge_p3_t *p)
+{
+    fe_add(r->YplusX, p->Y, p->X);
+    fe_sub(r->YminusX, p->Y, p->X);
+    memcpy(r->Z, p->Z, sizeof(fe_t));
+    fe_mul(r->T2d, p->T, fe_d2);
+}
+
+static void ge_p2_dbl(ge_p1p1_t *r, const ge_p2_t *p)
+{
+    fe_t t0;
+
+    fe_sq(r->X, p->X);
+    fe_sq(r->Z, p->Y);
+    fe_sq(r->T, p->Z);
+    fe_add(r->T, r->T, r->T);
+    fe_add(r->Y, p->X, p->Y);
+    fe_sq(t0, r->Y);
+    fe_add(r->Y, r->Z, r->X);
+    fe_sub(r->Z, r->Z, r->X);
+    fe_sub(r->X, t0, r->Y);
+    fe_sub(r->T, r->T, r->Z);
+}
+
+// r = p + q；neg 为真时 r = p - q
+static void ge_add(ge_p1p1_t *r, const ge_p3_t *p, const ge_cached_t *q, bool neg)
+{
+    fe_t t0;
+
+    fe_add(r->X, p->Y, p->X);
+    fe_sub(r->Y, p->Y, p->X);
+    fe_mul(r->Z, r->X, neg ? q->YminusX : q->YplusX);
+    fe_mul(r->Y, r->Y, neg ? q->YplusX : q->YminusX);
+    fe_mul(r->T, q->T2d, p->T);
+    fe_mul(r->X, p->Z, q->Z);
+    fe_add(t0, r->X, r->X);
+    fe_sub(r->X, r->Z, r->Y);
+    fe_add(r->Y, r->Z, r->Y);
+    if (neg)
+    {
+        fe_sub(r->Z, t0, r->T);
+        fe_add(r->T, t0, r->T);
+    }
+    else
+    {
+        fe_add(r->Z, t0, r->T);
+        fe_sub(r->T, t0, r->T);
+    }
+}
+
+// q 为仿射预计算点 (Z = 1)，比 ge_add 少一次乘法
+static void ge_madd(ge_p1p1_t *r, const ge_p3_t *p, const ge_precomp_t *q, bool neg)
+{
+    fe_t t0;
+
+    fe_add(r->X, p->Y, p->X);
+    fe_sub(r->Y, p->Y, p->X);
+    fe_mul(r->Z, r->X, neg ? q->yminusx : q->yplusx);
+    fe_mul(r->Y, r->Y, neg ? q->yplusx : q->yminusx);
+    fe_mul(r->T, q->xy2d, p->T);
+    fe_add(t0, p->Z, p->Z);
+    fe_sub(r->X, r->Z, r->Y);
+    fe_add(r->Y, r->Z, r->Y);
+    if (neg)
+    {
+        fe_sub(r->Z, t0, r->T);
+        fe_add(r->T, t0, r->T);
+    }
+    else
+    {
+        fe_add(r->Z, t0, r->T);
+        fe_sub(r->T, t0, r->T);
+    }
+}
+
+// 解码公钥并取负，得到 -A
+static bool ge_frombytes_negate(ge_p3_t *h, const uint8_t s[32])
+{
+    fe_t u, v, v3, vxx, check;
+    uint32_t sign = s[31] >> 7;
+
+    if (!fe_frombytes(h->Y, s))
+        return false;
+
+    fe_1(h->Z);
+    fe_sq(u, h->Y);
+    fe_mul(v, u, fe_d);
+    fe_sub(u, u, h->Z);         // u = y^2 - 1
+    fe_add(v, v, h->Z);         // v = dy^2 + 1
+
+    // x = uv^3 (uv^7)^((p - 5) / 8)
+    fe_sq(v3, v);
+    fe_mul(v3, v3, v);
+    fe_sq(h->X, v3);
+    fe_mul(h->X, h->X, v);
+    fe_mul(h->X, h->X, u);
+    fe_pow22523(h->X, h->X);
+    fe_mul(h->X, h->X, v3);
+    fe_mul(h->X, h->X, u);
+
+    fe_sq(vxx, h->X);
+    fe_mul(vxx, vxx, v);
+    fe_sub(check, vxx, u);
+    if (!fe_iszero(check))
+    {
+        fe_add(check, vxx, u);
+        if (!fe_iszero(check))
+            return false;       // 不在曲线上
+        fe_mul(h->X, h->X, fe_sqrtm1);
+    }
+
+    if (sign && fe_iszero(h->X))
+        return false;
+    if (fe_isnegative(h->X) == sign)
+        fe_neg(h->X, h->X);
+
+    fe_mul(h->T, h->X, h->Y);
+    return true;
+}
+
+static void ge_tobytes(uint8_t s[32], const ge_p2_t *h)
+{
+    fe_t recip, x, y;
+
+    fe_invert(recip, h->Z);
+    fe_mul(x, h->X, recip);
+    fe_mul(y, h->Y, recip);
+    fe_tobytes(s, y);
+    s[31] ^= (uint8_t)(fe_isnegative(x) << 7);
+}
+
+
+// 512 位 h 模 L，逐位移入并减去 L；每次验签只做一次
+static void sc_reduce(uint8_t out[32], const uint8_t h[64])
+{
+    uint32_t r[8], t[8], i;
+    int64_t s;
+    int k;
+
+    memset(r, 0, sizeof(r));
+    for (k = 511; k >= 0; k--)
+    {
+        for (i = 7; i > 0; i--)
+            r[i] = (r[i] << 1) | (r[i - 1] >> 31);
+        r[0] = (r[0] << 1) | ((h[k >> 3] >> (k & 7)) & 1U);
+
+        s = 0;
+        for (i = 0; i < 8U; i++)
+        {
+            s += (int64_t)r[i] - sc_l[i];
+            t[i] = (uint32_t)s;
+            s >>= 32;
+        }
+        if (s == 0)
+            memcpy(r, t, sizeof(r));
+    }
+
+    memcpy(out, r, sizeof(r));
+}
+
+static bool sc_is_canonical(const uint8_t s[32])
+{
+    uint32_t w[8], i;
+
+    memcpy(w, s, sizeof(w));
+    for (i = 7; i > 0; i--)
+    {
+        if (w[i] != sc_l[i])
+            return w[i] < sc_l[i];
+    }
+    return w[0] < sc_l[0];
+}
+
+// 转为带符号奇数位 (|digit| <= max)，非零位之间至少隔开 log2(max + 1) 个零
+static void sc_slide(int8_t r[256], const uint8_t a[32], int max)
+{
+    int i, b, k;
+
+    for (i = 0; i < 256; i++)
+        r[i] = (int8_t)(1 & (a[i >> 3] >> (i & 7)));
+
+    for (i = 0; i < 256; i++)
+    {
+        if (!r[i])
+            continue;
+
+        for (b = 1; b <= 6 && i + b < 256; b++)
+        {
+            if (!r[i + b])
+                continue;
+
+            if (r[i] + (r[i + b] << b) <= max)
+            {
+                r[i] = (int8_t)(r[i] + (r[i + b] << b));
+                r[i + b] = 0;
+            }
+            else if (r[i] - (r[i + b] << b) >= -max)
+            {
+                r[i] = (int8_t)(r[i] - (r[i + b] << b));
+                for (k = i + b; k < 256; k++)
+                {
+                    if (!r[k])
+                    {
+                        r[k] = 1;
+                        break;
+                    }
+                    r[k] = 0;
+                }
+            }
+            else
+            {
+                break;
+            }
+        }
+    }
+}
+
+// r = [a]A + [b]B
+static void ge_double_scalarmult(ge_p2_t *r, const uint8_t a[32], const ge_p3_t *A, const uint8_t b[32])
+{
+    int8_t aslide[256], bslide[256];
+    ge_cached_t Ai[8];          // A, 3A, ..., 15A
+    ge_p1p1_t t;
+    ge_p3_t u, A2;
+    ge_p2_t p2;
+    int i;
+
+    sc_slide(aslide, a, 15);
+    sc_slide(bslide, b, 2 * (int)ED25519_BASE_TABLE - 1);
+
+    ge_p3_to_cached(&Ai[0], A);
+    memcpy(p2.X, A->X, sizeof(fe_t));
+    memcpy(p2.Y, A->Y, sizeof(fe_t));
+    memcpy(p2.Z, A->Z, sizeof(fe_t));
+    ge_p2_dbl(&t, &p2);
+    ge_p1p1_to_p3(&A2, &t);
+    for (i = 0; i < 7; i++)
+    {
+        ge_add(&t, &A2, &Ai[i], false);
+        ge_p1p1_to_p3(&u, &t);
+        ge_p3_to_cached(&Ai[i + 1], &u);
+    }
+
+    fe_0(r->X);
+    fe_1(r->Y);
+    fe_1(r->Z);
+
+    for (i = 255; i >= 0; i--)
+    {
+        if (aslide[i] || bslide[i])
+            break;
+    }
+
+    for (; i >= 0; i--)
+    {
+        ge_p2_dbl(&t, r);
+
+        if (aslide[i])
+        {
+            ge_p1p1_to_p3(&u, &t);
+            ge_add(&t, &u, &Ai[(aslide[i] > 0 ? aslide[i] : -aslide[i]) / 2], aslide[i] < 0);
+        }
+
+        if (bslide[i])
+        {
+            ge_p1p1_to_p3(&u, &t);
+            ge_madd(&t, &u, &ed25519_base_odd[(bslide[i] > 0 ? bslide[i] : -bslide[i]) / 2], bslide[i] < 0);
+        }
+
+        ge_p1p1_to_p2(r, &t);
+    }
+}
+
+
+bool ed25519_verify(const uint8_t sig[ED25519_SIG_SIZE], const void *msg, uint32_t len,
+                    const uint8_t pk[ED25519_PUBKEY_SIZE])
+{
+    sha512_ctx_t ctx;
+    uint8_t h[SHA512_DIGEST_SIZE], k[32], check[32];
+    ge_p3_t A;
+    ge_p2_t R;
+
+    if (!sc_is_canonical(sig + 32))
+        return false;
+    if (!ge_frombytes_negate(&A, pk))
+        return false;
+
+    // k = SHA-512(R || A || M) mod L
+    sha512_init(&ctx);
+    sha512_update(&ctx, sig, 32);
+    sha512_update(&ctx, pk, ED25519_PUBKEY_SIZE);
+    sha512_update(&ctx, msg, len);
+    sha512_final(&ctx, h);
+    sc_reduce(k, h);
+
+    // [S]B - [k]A 应当等于 R
+    ge_double_scalarmult(&R, k, &A, sig + 32);
+    ge_tobytes(check, &R);
+
+    return memcmp(check, sig, 32) == 0;
+}
+
+
+static const struct
+{
+    uint8_t pk[ED25519_PUBKEY_SIZE];
+    uint8_t sig[ED25519_SIG_SIZE];
+    uint32_t len;
+    uint8_t msg[2];
+} ed25519_vectors[] =
+{
+    // RFC 8032 7.1 TEST 1
+    {
+        { 0xd7, 0x5a, 0x98, 0x01, 0x82, 0xb1, 0x0a, 0xb7, 0xd5, 0x4b, 0xfe, 0xd3, 0xc9, 0x64, 0x07, 0x3a,
+          0x0e, 0xe1, 0x72, 0xf3, 0xda, 0xa6, 0x23, 0x25, 0xaf, 0x02, 0x1a, 0x68, 0xf7, 0x07, 0x51, 0x1a },
+        { 0xe5, 0x56, 0x43, 0x00, 0xc3, 0x60, 0xac, 0x72, 0x90, 0x86, 0xe2, 0xcc, 0x80, 0x6e, 0x82, 0x8a,
+          0x84, 0x87, 0x7f, 0x1e, 0xb8, 0xe5, 0xd9, 0x74, 0xd8, 0x73, 0xe0, 0x65, 0x22, 0x49, 0x01, 0x55,
+          0x5f, 0xb8, 0x82, 0x15, 0x90, 0xa3, 0x3b, 0xac, 0xc6, 0x1e, 0x39, 0x70, 0x1c, 0xf9, 0xb4, 0x6b,
+          0xd2, 0x5b, 0xf5, 0xf0, 0x59, 0x5b, 0xbe, 0x24, 0x65, 0x51, 0x41, 0x43, 0x8e, 0x7a, 0x10, 0x0b },
+        0, { 0 }
+    },
+    // TEST 2
+    {
+        { 0x3d, 0x40, 0x17, 0xc3, 0xe8, 0x43, 0x89, 0x5a, 0x92, 0xb7, 0x0a, 0xa7, 0x4d, 0x1b, 0x7e, 0xbc,
+          0x9c, 0x98, 0x2c, 0xcf, 0x2e, 0xc4, 0x96, 0x8c, 0xc0, 0xcd, 0x55, 0xf1, 0x2a, 0xf4, 0x66, 0x0c },
+        { 0x92, 0xa0, 0x09, 0xa9, 0xf0, 0xd4, 0xca, 0xb8, 0x72, 0x0e, 0x82, 0x0b, 0x5f, 0x64, 0x25, 0x40,
+          0xa2, 0xb2, 0x7b, 0x54, 0x16, 0x50, 0x3f, 0x8f, 0xb3, 0x76, 0x22, 0x23, 0xeb, 0xdb, 0x69, 0xda,
+          0x08, 0x5a, 0xc1, 0xe4, 0x3e, 0x15, 0x99, 0x6e, 0x45, 0x8f, 0x36, 0x13, 0xd0, 0xf1, 0x1d, 0x8c,
+          0x38, 0x7b, 0x2e, 0xae, 0xb4, 0x30, 0x2a, 0xee, 0xb0, 0x0d, 0x29, 0x16, 0x12, 0xbb, 0x0c, 0x00 },
+        1, { 0x72 }
+    },
+    // TEST 3
+    {
+        { 0xfc, 0x51, 0xcd, 0x8e, 0x62, 0x18, 0xa1, 0xa3, 0x8d, 0xa4, 0x7e, 0xd0, 0x02, 0x30, 0xf0, 0x58,
+          0x08, 0x16, 0xed, 0x13, 0xba, 0x33, 0x03, 0xac, 0x5d, 0xeb, 0x91, 0x15, 0x48, 0x90, 0x80, 0x25 },
+        { 0x62, 0x91, 0xd6, 0x57, 0xde, 0xec, 0x24, 0x02, 0x48, 0x27, 0xe6, 0x9c, 0x3a, 0xbe, 0x01, 0xa3,
+          0x0c, 0xe5, 0x48, 0xa2, 0x84, 0x74, 0x3a, 0x44, 0x5e, 0x36, 0x80, 0xd7, 0xdb, 0x5a, 0xc3, 0xac,
+          0x18, 0xff, 0x9b, 0x53, 0x8d, 0x16, 0xf2, 0x90, 0xae, 0x67, 0xf7, 0x60, 0x98, 0x4d, 0xc6, 0x59,
+          0x4a, 0x7c, 0x15, 0xe9, 0x71, 0x6e, 0xd2, 0x8d, 0xc0, 0x27, 0xbe, 0xce, 0xea, 0x1e, 0xc4, 0x0a },
+        2, { 0xaf, 0x82 }
+    },
+};
+
+bool ed25519_selftest(void)
+{
+    uint8_t sig[ED25519_SIG_SIZE], msg[2];
+    uint32_t i;
+
+    for (i = 0; i < sizeof(ed25519_vectors) / sizeof(ed25519_vectors[0]); i++)
+    {
+        if (!ed25519_verify(ed25519_vectors[i].sig, ed25519_vectors[i].msg, ed25519_vectors[i].len,
+                            ed25519_vectors[i].pk))
+        {
+            LOG_E("ed25519: test vector %u rejected", (unsigned)i);
+            return false;
+        }
+    }
+
+    // 以下都必须被拒绝
+    memcpy(sig, ed25519_vectors[2].sig, sizeof(sig));
+    sig[5] ^= 0x01;             // 篡改 R
+    if (ed25519_verify(sig, ed25519_vectors[2].msg, 2, ed25519_vectors[2].pk))
+        return false;
+
+    memcpy(sig, ed25519_vectors[2].sig, sizeof(sig));
+    sig[40] ^= 0x01;            // 篡改 S
+    if (ed25519_verify(sig, ed25519_vectors[2].msg, 2, ed25519_vectors[2].pk))
+        return false;
+
+    memcpy(msg, ed25519_vectors[2].msg, sizeof(msg));
+    msg[1] ^= 0x80;             // 篡改消息
+    if (ed25519_verify(ed25519_vectors[2].sig, msg, 2, ed25519_vectors[2].pk))
+        return false;
+
+    // S + L 与 S 同余，但 S >= L 必须拒绝
+    memcpy(sig, ed25519_vectors[0].sig, sizeof(sig));
+    {
+        uint32_t s[8];
+        uint64_t c = 0;
+
+        memcpy(s, sig + 32, sizeof(s));
+        for (i = 0; i < 8U; i++)
+        {
+            c += (uint64_t)s[i] + sc_l[i];
+            s[i] = (uint32_t)c;
+            c >>= 32;
+        }
+        memcpy(sig + 32, s, sizeof(s));
+    }
+    if (ed25519_verify(sig, NULL, 0, ed25519_vectors[0].pk))
+        return false;
+
+    return true;
+}
+
+void ed25519_bench(void)
+{
+    uint32_t t0, cycles;
+    bool ok;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    t0 = DWT->CYCCNT;
+    ok = ed25519_verify(ed25519_vectors[2].sig, ed25519_vectors[2].msg, 2, ed25519_vectors[2].pk);
+    cycles = DWT->CYCCNT - t0;
+
+    LOG_I("ed25519 verify: %u cycles, %u us, %s", (unsigned)cycles,
+          (unsigned)((uint64_t)cycles * 1000000U / SystemCoreClock), ok ? "ok" : "FAILED");
+}
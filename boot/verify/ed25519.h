@@ -0,0 +1,32 @@
+#ifndef __BL_ED25519_H
+#define __BL_ED25519_H
+
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/*
+ * Ed25519 验签 (RFC 8032)，只有验证，没有签名。
+ *
+ * 域元素为 8 个 32 位字，乘法和平方用 UMAAL 做乘加，模 2^255-19 时把高 256 位乘 38 折回。
+ * 双标量乘 [h](-A) + [S]B 采用滑动窗口：基点 B 的奇数倍 (1B..63B) 预先算好放在 flash
+ * (ed25519_table.h，由 tools/image_tool.py 生成)，公钥 A 的奇数倍 (1A..15A) 运行时计算。
+ * 验签只处理公开数据，不需要常数时间。
+ */
+
+#define ED25519_PUBKEY_SIZE     32U
+#define ED25519_SIG_SIZE        64U
+
+
+bool ed25519_verify(const uint8_t sig[ED25519_SIG_SIZE], const void *msg, uint32_t len,
+                    const uint8_t pk[ED25519_PUBKEY_SIZE]);
+
+/* RFC 8032 7.1 测试向量，以及篡改签名、篡改消息、S >= L 的反例 */
+bool ed25519_selftest(void);
+
+/* 对测试向量验签计时，通过 LOG_I 报告周期数和微秒 */
+void ed25519_bench(void);
+
+
+#endif /* __BL_ED25519_H */
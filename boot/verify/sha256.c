@@ -0,0 +1,374 @@
+#include <string.h>
+#include "stm32f4xx.h"
+#include "log.h"
+#include "sha256.h"
+
+#if SHA256_USE_HASH
+#if !defined(STM32F40_41xxx) && !defined(STM32F427_437xx) && !defined(STM32F429_439xx)
+#error "SHA256_USE_HASH: this device family has no HASH peripheral"
+#endif
+#include "stm32f4xx_hash.h"
+#include "stm32f4xx_rcc.h"
+#include "os.h"
+#endif
+
+
+#define ROR(x, n)           __ROR((x), (n))
+#define BSIG0(x)            (ROR(x, 2) ^ ROR(x, 13) ^ ROR(x, 22))
+#define BSIG1(x)            (ROR(x, 6) ^ ROR(x, 11) ^ ROR(x, 25))
+#define SSIG0(x)            (ROR(x, 7) ^ ROR(x, 18) ^ ((x) >> 3))
+#define SSIG1(x)            (ROR(x, 17) ^ ROR(x, 19) ^ ((x) >> 10))
+#define CH(x, y, z)         ((z) ^ ((x) & ((y) ^ (z))))
+#define MAJ(x, y, z)        (((x) & (y)) | ((z) & ((x) | (y))))
+
+// 第 0-15 轮直接使用消息字，之后在 16 字环形缓冲区中原地扩展
+#define SHA256_MSG(i)       (w[i])
+#define SHA256_EXPAND(i)    (w[(i) & 15] += SSIG1(w[((i) - 2) & 15]) + w[((i) - 7) & 15] + SSIG0(w[((i) - 15) & 15]))
+
+// 只更新 d 和 h，下一轮通过宏参数轮换变量名，不搬移数据
+#define SHA256_ROUND(a, b, c, d, e, f, g, h, k, x) \
+    do { \
+        h += BSIG1(e) + CH(e, f, g) + (k) + (x); \
+        d += h; \
+        h += BSIG0(a) + MAJ(a, b, c); \
+    } while (0)
+
+#define SHA256_16ROUNDS(r, X) \
+    do { \
+        SHA256_ROUND(a, b, c, d, e, f, g, h, sha256_k[(r) + 0], X(0)); \
+        SHA256_ROUND(h, a, b, c, d, e, f, g, sha256_k[(r) + 1], X(1)); \
+        SHA256_ROUND(g, h, a, b, c, d, e, f, sha256_k[(r) + 2], X(2)); \
+        SHA256_ROUND(f, g, h, a, b, c, d, e, sha256_k[(r) + 3], X(3)); \
+        SHA256_ROUND(e, f, g, h, a, b, c, d, sha256_k[(r) + 4], X(4)); \
+        SHA256_ROUND(d, e, f, g, h, a, b, c, sha256_k[(r) + 5], X(5)); \
+        SHA256_ROUND(c, d, e, f, g, h, a, b, sha256_k[(r) + 6], X(6)); \
+        SHA256_ROUND(b, c, d, e, f, g, h, a, sha256_k[(r) + 7], X(7)); \
+        SHA256_ROUND(a, b, c, d, e, f, g, h, sha256_k[(r) + 8], X(8)); \
+        SHA256_ROUND(h, a, b, c, d, e, f, g, sha256_k[(r) + 9], X(9)); \
+        SHA256_ROUND(g, h, a, b, c, d, e, f, sha256_k[(r) + 10], X(10)); \
+        SHA256_ROUND(f, g, h, a, b, c, d, e, sha256_k[(r) + 11], X(11)); \
+        SHA256_ROUND(e, f, g, h, a, b, c, d, sha256_k[(r) + 12], X(12)); \
+        SHA256_ROUND(d, e, f, g, h, a, b, c, sha256_k[(r) + 13], X(13)); \
+        SHA256_ROUND(c, d, e, f, g, h, a, b, sha256_k[(r) + 14], X(14)); \
+        SHA256_ROUND(b, c, d, e, f, g, h, a, sha256_k[(r) + 15], X(15)); \
+    } while (0)
+
+
+static const uint32_t sha256_k[64] =
+{
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static const uint32_t sha256_iv[8] =
+{
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+};
+
+
+static void sha256_compress(uint32_t state[8], const uint8_t *p, uint32_t blocks)
+{
+    uint32_t a, b, c, d, e, f, g, h, r, i;
+    uint32_t w[16];
+
+    for (; blocks; blocks--, p += SHA256_BLOCK_SIZE)
+    {
+        for (i = 0; i < 16U; i++)
+        {
+            memcpy(&w[i], p + i * 4U, sizeof(w[i]));
+            w[i] = __REV(w[i]);     // 消息按大端解释
+        }
+
+        a = state[0];
+        b = state[1];
+        c = state[2];
+        d = state[3];
+        e = state[4];
+        f = state[5];
+        g = state[6];
+        h = state[7];
+
+        SHA256_16ROUNDS(0, SHA256_MSG);
+        for (r = 16; r < 64U; r += 16U)
+            SHA256_16ROUNDS(r, SHA256_EXPAND);
+
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+    }
+}
+
+static void sha256_store_be(uint8_t *out, const uint32_t *words, uint32_t n)
+{
+    uint32_t i, v;
+
+    for (i = 0; i < n; i++)
+    {
+        v = __REV(words[i]);
+        memcpy(out + i * 4U, &v, sizeof(v));
+    }
+}
+
+
+#if SHA256_USE_HASH
+
+static sha256_ctx_t *sha256_hw_owner;
+
+
+static void sha256_hw_init(sha256_ctx_t *ctx)
+{
+    HASH_InitTypeDef HASH_InitStructure;
+    uint32_t state;
+
+    state = os_enter_critical();
+    ctx->hw = (sha256_hw_owner == NULL || sha256_hw_owner == ctx);
+    if (ctx->hw)
+        sha256_hw_owner = ctx;
+    os_exit_critical(state);
+
+    if (!ctx->hw)
+        return;
+
+    RCC_AHB2PeriphClockCmd(RCC_AHB2Periph_HASH, ENABLE);
+
+    // 8 位数据类型：外设自行交换字节序，小端读出的字即按消息顺序送入
+    HASH_InitStructure.HASH_AlgoSelection = HASH_AlgoSelection_SHA256;
+    HASH_InitStructure.HASH_AlgoMode = HASH_AlgoMode_HASH;
+    HASH_InitStructure.HASH_DataType = HASH_DataType_8b;
+    HASH_InitStructure.HASH_HMACKeyType = HASH_HMACKeyType_ShortKey;
+    HASH_Init(&HASH_InitStructure);
+}
+
+static void sha256_hw_update(sha256_ctx_t *ctx, const uint8_t *p, uint32_t len)
+{
+    uint32_t have = ctx->len & 3U, n, w;
+
+    ctx->len += len;
+
+    // buf 只暂存不足一个字的部分
+    if (have)
+    {
+        n = 4U - have;
+        if (n > len)
+            n = len;
+        memcpy(&ctx->buf[have], p, n);
+        p += n;
+        len -= n;
+        if (have + n < 4U)
+            return;
+        memcpy(&w, ctx->buf, sizeof(w));
+        HASH_DataIn(w);
+    }
+
+    // FIFO 满时写 DIN 会暂停总线直到外设取走数据
+    for (; len >= 4U; len -= 4U, p += 4)
+    {
+        memcpy(&w, p, sizeof(w));
+        HASH_DataIn(w);
+    }
+
+    memcpy(ctx->buf, p, len);
+}
+
+static void sha256_hw_final(sha256_ctx_t *ctx, uint8_t digest[SHA256_DIGEST_SIZE])
+{
+    HASH_MsgDigest md;
+    uint32_t have = ctx->len & 3U, w = 0;
+
+    HASH_SetLastWordValidBitsNbr((uint16_t)(have * 8U));
+    if (have)
+    {
+        memcpy(&w, ctx->buf, have);
+        HASH_DataIn(w);
+    }
+    HASH_StartDigest();
+    while (HASH_GetFlagStatus(HASH_FLAG_BUSY) != RESET)
+        ;
+
+    HASH_GetDigest(&md);
+    sha256_store_be(digest, md.Data, 8U);
+
+    ctx->hw = false;
+    sha256_hw_owner = NULL;
+}
+
+#endif /* SHA256_USE_HASH */
+
+
+void sha256_init(sha256_ctx_t *ctx)
+{
+    memcpy(ctx->state, sha256_iv, sizeof(ctx->state));
+    ctx->len = 0;
+#if SHA256_USE_HASH
+    sha256_hw_init(ctx);
+#endif
+}
+
+void sha256_update(sha256_ctx_t *ctx, const void *data, uint32_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    uint32_t have, n;
+
+#if SHA256_USE_HASH
+    if (ctx->hw)
+    {
+        sha256_hw_update(ctx, p, len);
+        return;
+    }
+#endif
+
+    have = ctx->len & (SHA256_BLOCK_SIZE - 1U);
+    ctx->len += len;
+
+    if (have)
+    {
+        n = SHA256_BLOCK_SIZE - have;
+        if (n > len)
+            n = len;
+        memcpy(&ctx->buf[have], p, n);
+        p += n;
+        len -= n;
+        if (have + n < SHA256_BLOCK_SIZE)
+            return;
+        sha256_compress(ctx->state, ctx->buf, 1);
+    }
+
+    // 整块直接从源数据计算，不经过 buf
+    n = len / SHA256_BLOCK_SIZE;
+    if (n)
+    {
+        sha256_compress(ctx->state, p, n);
+        p += n * SHA256_BLOCK_SIZE;
+        len -= n * SHA256_BLOCK_SIZE;
+    }
+
+    memcpy(ctx->buf, p, len);
+}
+
+void sha256_final(sha256_ctx_t *ctx, uint8_t digest[SHA256_DIGEST_SIZE])
+{
+    uint32_t have, bits[2];
+
+#if SHA256_USE_HASH
+    if (ctx->hw)
+    {
+        sha256_hw_final(ctx, digest);
+        return;
+    }
+#endif
+
+    have = ctx->len & (SHA256_BLOCK_SIZE - 1U);
+    ctx->buf[have++] = 0x80;
+
+    if (have > SHA256_BLOCK_SIZE - 8U)
+    {
+        memset(&ctx->buf[have], 0, SHA256_BLOCK_SIZE - have);
+        sha256_compress(ctx->state, ctx->buf, 1);
+        have = 0;
+    }
+    memset(&ctx->buf[have], 0, SHA256_BLOCK_SIZE - 8U - have);
+
+    // 末尾 64 位大端消息位数
+    bits[0] = ctx->len >> 29;
+    bits[1] = ctx->len << 3;
+    sha256_store_be(&ctx->buf[SHA256_BLOCK_SIZE - 8U], bits, 2U);
+    sha256_compress(ctx->state, ctx->buf, 1);
+
+    sha256_store_be(digest, ctx->state, 8U);
+}
+
+void sha256(const void *data, uint32_t len, uint8_t digest[SHA256_DIGEST_SIZE])
+{
+    sha256_ctx_t ctx;
+
+    sha256_init(&ctx);
+    sha256_update(&ctx, data, len);
+    sha256_final(&ctx, digest);
+}
+
+
+bool sha256_selftest(void)
+{
+    static const struct
+    {
+        const char *msg;
+        uint32_t repeat;
+        uint8_t digest[SHA256_DIGEST_SIZE];
+    } vectors[] =
+    {
+        {
+            "abc", 1,
+            { 0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea, 0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+              0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c, 0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad }
+        },
+        {
+            "", 1,
+            { 0xe3, 0xb0, 0xc4, 0x42, 0x98, 0xfc, 0x1c, 0x14, 0x9a, 0xfb, 0xf4, 0xc8, 0x99, 0x6f, 0xb9, 0x24,
+              0x27, 0xae, 0x41, 0xe4, 0x64, 0x9b, 0x93, 0x4c, 0xa4, 0x95, 0x99, 0x1b, 0x78, 0x52, 0xb8, 0x55 }
+        },
+        {
+            "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", 1,
+            { 0x24, 0x8d, 0x6a, 0x61, 0xd2, 0x06, 0x38, 0xb8, 0xe5, 0xc0, 0x26, 0x93, 0x0c, 0x3e, 0x60, 0x39,
+              0xa3, 0x3c, 0xe4, 0x59, 0x64, 0xff, 0x21, 0x67, 0xf6, 0xec, 0xed, 0xd4, 0x19, 0xdb, 0x06, 0xc1 }
+        },
+        {
+            "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu", 1,
+            { 0xcf, 0x5b, 0x16, 0xa7, 0x78, 0xaf, 0x83, 0x80, 0x03, 0x6c, 0xe5, 0x9e, 0x7b, 0x04, 0x92, 0x37,
+              0x0b, 0x24, 0x9b, 0x11, 0xe8, 0xf0, 0x7a, 0x51, 0xaf, 0xac, 0x45, 0x03, 0x7a, 0xfe, 0xe9, 0xd1 }
+        },
+        {
+            // 一百万个 'a'，按 25 字节分块送入，覆盖跨块缓冲
+            "aaaaaaaaaaaaaaaaaaaaaaaaa", 40000,
+            { 0xcd, 0xc7, 0x6e, 0x5c, 0x99, 0x14, 0xfb, 0x92, 0x81, 0xa1, 0xc7, 0xe2, 0x84, 0xd7, 0x3e, 0x67,
+              0xf1, 0x80, 0x9a, 0x48, 0xa4, 0x97, 0x20, 0x0e, 0x04, 0x6d, 0x39, 0xcc, 0xc7, 0x11, 0x2c, 0xd0 }
+        },
+    };
+    sha256_ctx_t ctx;
+    uint8_t digest[SHA256_DIGEST_SIZE];
+    uint32_t i, n;
+
+    for (i = 0; i < sizeof(vectors) / sizeof(vectors[0]); i++)
+    {
+        sha256_init(&ctx);
+        for (n = 0; n < vectors[i].repeat; n++)
+            sha256_update(&ctx, vectors[i].msg, (uint32_t)strlen(vectors[i].msg));
+        sha256_final(&ctx, digest);
+
+        if (memcmp(digest, vectors[i].digest, SHA256_DIGEST_SIZE) != 0)
+        {
+            LOG_E("sha256: test vector %u failed", (unsigned)i);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void sha256_bench(const void *addr, uint32_t len)
+{
+    uint8_t digest[SHA256_DIGEST_SIZE];
+    uint32_t t0, cycles, cpb;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    t0 = DWT->CYCCNT;
+    sha256(addr, len, digest);
+    cycles = DWT->CYCCNT - t0;
+
+    // 以 0.01 周期/字节为单位
+    cpb = len ? (uint32_t)((uint64_t)cycles * 100U / len) : 0;
+    LOG_I("sha256 %u bytes: %u.%02u cycles/byte, %u cycles", (unsigned)len,
+          (unsigned)(cpb / 100U), (unsigned)(cpb % 100U), (unsigned)cycles);
+}
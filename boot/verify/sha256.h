@@ -0,0 +1,53 @@
+#ifndef __BL_SHA256_H
+#define __BL_SHA256_H
+
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/*
+ * SHA-256 (FIPS 180-4)，流式 init/update/final。
+ *
+ * 软件实现针对 Cortex-M4：每 16 轮完全展开，8 个工作变量通过宏参数轮换
+ * 而不是逐轮搬移，留在寄存器中；消息扩展只用 16 字的环形缓冲区；循环移位用 __ROR。
+ *
+ * SHA256_USE_HASH 置 1 时使用 HASH 外设（F415/F417/F437/F439 才有）。
+ * F407 以及 F429 没有 HASH 外设，而 CMakeLists.txt 中的 STM32F429_439xx 同时覆盖
+ * F429/F439，无法据此判断，所以默认关闭，需要在确有 HASH 的器件上显式打开。
+ * 外设同一时间只服务一个上下文，其余上下文自动用软件计算，结果相同。
+ */
+
+#ifndef SHA256_USE_HASH
+#define SHA256_USE_HASH         0
+#endif
+
+#define SHA256_BLOCK_SIZE       64U
+#define SHA256_DIGEST_SIZE      32U
+
+
+typedef struct
+{
+    uint32_t state[8];
+    uint32_t len;               /* 已送入的总字节数 */
+    uint8_t buf[SHA256_BLOCK_SIZE];
+#if SHA256_USE_HASH
+    bool hw;                    /* 该上下文占用 HASH 外设 */
+#endif
+} sha256_ctx_t;
+
+
+void sha256_init(sha256_ctx_t *ctx);
+void sha256_update(sha256_ctx_t *ctx, const void *data, uint32_t len);
+void sha256_final(sha256_ctx_t *ctx, uint8_t digest[SHA256_DIGEST_SIZE]);
+
+void sha256(const void *data, uint32_t len, uint8_t digest[SHA256_DIGEST_SIZE]);
+
+/* 用 NIST FIPS 180-2 附录中的测试向量自检 */
+bool sha256_selftest(void);
+
+/* 对 [addr, addr + len) 计时，通过 LOG_I 报告每字节周期数 */
+void sha256_bench(const void *addr, uint32_t len);
+
+
+#endif /* __BL_SHA256_H */
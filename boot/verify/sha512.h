@@ -0,0 +1,30 @@
+#ifndef __BL_SHA512_H
+#define __BL_SHA512_H
+
+
+#include <stdint.h>
+
+
+/*
+ * SHA-512 (FIPS 180-4)，供 Ed25519 使用。
+ * 验签时只对 R || A || 镜像摘要共 96 字节计算，不追求速度，按最直接的方式实现。
+ */
+
+#define SHA512_BLOCK_SIZE       128U
+#define SHA512_DIGEST_SIZE      64U
+
+
+typedef struct
+{
+    uint64_t state[8];
+    uint32_t len;               /* 已送入的总字节数 */
+    uint8_t buf[SHA512_BLOCK_SIZE];
+} sha512_ctx_t;
+
+
+void sha512_init(sha512_ctx_t *ctx);
+void sha512_update(sha512_ctx_t *ctx, const void *data, uint32_t len);
+void sha512_final(sha512_ctx_t *ctx, uint8_t digest[SHA512_DIGEST_SIZE]);
+
+
+#endif /* __BL_SHA512_H */
@@ -0,0 +1,275 @@
+#include "stm32f4xx.h"
+#include "stm32f4xx_crc.h"
+#include "stm32f4xx_dma.h"
+#include "stm32f4xx_rcc.h"
+#include "os.h"
+#include "log.h"
+#include "verify.h"
+#include "verify_key.h"
+
+
+#define VERIFY_DMA_STREAM       DMA2_Stream0
+#define VERIFY_DMA_CHANNEL      DMA_Channel_0
+#define VERIFY_DMA_IRQn         DMA2_Stream0_IRQn
+#define VERIFY_DMA_FLAGS        (DMA_FLAG_TCIF0 | DMA_FLAG_HTIF0 | DMA_FLAG_TEIF0 | DMA_FLAG_DMEIF0 | DMA_FLAG_FEIF0)
+
+#if (VERIFY_DMA_CHUNK_WORDS == 0) || (VERIFY_DMA_CHUNK_WORDS > 65535U)
+#error "VERIFY_DMA_CHUNK_WORDS must be 1..65535"
+#endif
+
+
+// [verify_src, verify_src + verify_left * 4) 还没有交给 DMA
+static volatile uint32_t verify_src;
+static volatile uint32_t verify_left;
+static volatile uint32_t verify_result;
+static volatile verify_status_t verify_status;
+static volatile bool verify_running;
+static os_sem_t verify_done;
+static bool verify_ready;
+
+
+// 启动下一段传输；在中断或 verify_crc_start 中调用
+static void verify_dma_kick(void)
+{
+    uint32_t n = verify_left;
+
+    if (n > VERIFY_DMA_CHUNK_WORDS)
+        n = VERIFY_DMA_CHUNK_WORDS;
+
+    DMA_ClearFlag(VERIFY_DMA_STREAM, VERIFY_DMA_FLAGS);
+    VERIFY_DMA_STREAM->PAR = verify_src;
+    VERIFY_DMA_STREAM->NDTR = n;
+    verify_src += n * 4U;
+    verify_left -= n;
+
+    DMA_Cmd(VERIFY_DMA_STREAM, ENABLE);
+}
+
+void verify_init(void)
+{
+#if VERIFY_USE_HW
+    DMA_InitTypeDef DMA_InitStructure;
+    NVIC_InitTypeDef NVIC_InitStruct;
+
+    RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_CRC | RCC_AHB1Periph_DMA2, ENABLE);
+
+    DMA_DeInit(VERIFY_DMA_STREAM);
+    while (DMA_GetCmdStatus(VERIFY_DMA_STREAM) != DISABLE)
+        ;
+
+    // 只有 DMA2 支持存储器到存储器：外设端口为源 (flash)，存储器端口为目的 (CRC->DR)
+    DMA_InitStructure.DMA_Channel = VERIFY_DMA_CHANNEL;
+    DMA_InitStructure.DMA_PeripheralBaseAddr = 0;
+    DMA_InitStructure.DMA_Memory0BaseAddr = (uint32_t)&CRC->DR;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_MemoryToMemory;
+    DMA_InitStructure.DMA_BufferSize = 1;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Enable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Disable;
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Word;
+    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Word;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
+    // 低于控制台的 USART DMA，避免长时间校验挤占串口
+    DMA_InitStructure.DMA_Priority = DMA_Priority_Low;
+    // 存储器到存储器模式不允许直接模式，必须打开 FIFO
+    DMA_InitStructure.DMA_FIFOMode = DMA_FIFOMode_Enable;
+    DMA_InitStructure.DMA_FIFOThreshold = DMA_FIFOThreshold_Full;
+    DMA_InitStructure.DMA_MemoryBurst = DMA_MemoryBurst_Single;
+    DMA_InitStructure.DMA_PeripheralBurst = DMA_PeripheralBurst_Single;
+
+    DMA_Init(VERIFY_DMA_STREAM, &DMA_InitStructure);
+    DMA_ITConfig(VERIFY_DMA_STREAM, DMA_IT_TC | DMA_IT_TE, ENABLE);
+
+    NVIC_InitStruct.NVIC_IRQChannel = VERIFY_DMA_IRQn;
+    NVIC_InitStruct.NVIC_IRQChannelPreemptionPriority = VERIFY_DMA_IRQ_PRIORITY;
+    NVIC_InitStruct.NVIC_IRQChannelSubPriority = 0;
+    NVIC_InitStruct.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStruct);
+
+    os_sem_init(&verify_done, 0, 1);
+    verify_ready = true;
+#endif
+
+    crc32_sw_init();
+}
+
+verify_status_t verify_crc_start(const void *addr, uint32_t len)
+{
+    uint32_t state;
+
+    if (len == 0 || (len & 3U) || ((uint32_t)addr & 3U))
+        return VERIFY_ERR_ARG;
+    if (!verify_ready)
+        return VERIFY_ERR_BUSY;
+
+    state = os_enter_critical();
+    if (verify_running)
+    {
+        os_exit_critical(state);
+        return VERIFY_ERR_BUSY;
+    }
+    verify_running = true;
+    os_exit_critical(state);
+
+    verify_src = (uint32_t)addr;
+    verify_left = len >> 2;
+    verify_status = VERIFY_OK;
+
+    CRC_ResetDR();
+    verify_dma_kick();
+
+    return VERIFY_OK;
+}
+
+// 中止正在进行的传输；超时后调用，之后可以重新 start
+static void verify_dma_abort(void)
+{
+    uint32_t state = os_enter_critical();
+
+    // 在临界区内停下数据流并清掉标志，中断不会再续传或给出结果
+    DMA_Cmd(VERIFY_DMA_STREAM, DISABLE);
+    while (DMA_GetCmdStatus(VERIFY_DMA_STREAM) != DISABLE)
+        ;
+    DMA_ClearFlag(VERIFY_DMA_STREAM, VERIFY_DMA_FLAGS);
+    NVIC_ClearPendingIRQ(VERIFY_DMA_IRQn);
+    verify_left = 0;
+    os_exit_critical(state);
+
+    // 超时和完成同时发生时信号量已经给出，丢掉，下一次 wait 才不会拿到这次的结果
+    while (os_sem_take(&verify_done, 0))
+        ;
+    verify_running = false;
+}
+
+verify_status_t verify_crc_wait(uint32_t *crc, uint32_t timeout)
+{
+    verify_status_t status;
+
+    if (!os_sem_take(&verify_done, timeout))
+    {
+        verify_dma_abort();
+        return VERIFY_ERR_TIMEOUT;
+    }
+
+    status = verify_status;
+    if (crc)
+        *crc = verify_result;
+    verify_running = false;
+
+    return status;
+}
+
+bool verify_crc_busy(void)
+{
+    return verify_running && (verify_left != 0 || DMA_GetCmdStatus(VERIFY_DMA_STREAM) != DISABLE);
+}
+
+void verify_dma_irq(void)
+{
+    if (DMA_GetITStatus(VERIFY_DMA_STREAM, DMA_IT_TEIF0) != RESET)
+    {
+        DMA_Cmd(VERIFY_DMA_STREAM, DISABLE);
+        DMA_ClearFlag(VERIFY_DMA_STREAM, VERIFY_DMA_FLAGS);
+        verify_left = 0;
+        verify_status = VERIFY_ERR_DMA;
+        os_sem_give(&verify_done);
+        return;
+    }
+
+    if (DMA_GetITStatus(VERIFY_DMA_STREAM, DMA_IT_TCIF0) != RESET)
+    {
+        DMA_ClearITPendingBit(VERIFY_DMA_STREAM, DMA_IT_TCIF0);
+
+        if (verify_left)
+        {
+            verify_dma_kick();
+            return;
+        }
+
+        // 读 DR 会等待最后一个字算完
+        verify_result = CRC_GetCRC();
+        os_sem_give(&verify_done);
+    }
+}
+
+uint32_t verify_crc(const void *addr, uint32_t len)
+{
+    uint32_t crc;
+
+    if (!os_in_isr() && verify_crc_start(addr, len) == VERIFY_OK)
+    {
+        if (verify_crc_wait(&crc, OS_WAIT_FOREVER) == VERIFY_OK)
+            return crc;
+    }
+
+    return crc32_sw(addr, len);
+}
+
+verify_status_t verify_image(const void *image, uint32_t len)
+{
+    if (len < 8U || (len & 3U))
+        return VERIFY_ERR_ARG;
+
+    return verify_crc(image, len) == CRC32_RESIDUE ? VERIFY_OK : VERIFY_ERR_CRC;
+}
+
+verify_status_t verify_image_signed(const void *image, uint32_t len)
+{
+    const uint8_t *sig;
+    uint8_t digest[SHA256_DIGEST_SIZE];
+    verify_status_t status;
+
+    if (len < ED25519_SIG_SIZE + 8U)
+        return VERIFY_ERR_ARG;
+
+    // CRC 先排除传输和烧写错误，签名只负责来源
+    status = verify_image(image, len);
+    if (status != VERIFY_OK)
+        return status;
+
+    len -= ED25519_SIG_SIZE + 4U;
+    sig = (const uint8_t *)image + len;
+    sha256(image, len, digest);
+
+    return ed25519_verify(sig, digest, sizeof(digest), verify_pubkey) ? VERIFY_OK : VERIFY_ERR_SIG;
+}
+
+// 以 0.01 MB/s 为单位
+static uint32_t verify_rate(uint32_t len, uint32_t cycles)
+{
+    return cycles ? (uint32_t)((uint64_t)len * (SystemCoreClock / 10000U) / cycles) : 0;
+}
+
+void verify_bench(const void *addr, uint32_t len)
+{
+    uint32_t t0, hw_cycles = 0, sw_cycles, hw_crc = 0, sw_crc, hw_rate, sw_rate;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    crc32_sw_init();
+
+    // 忙等而不是 verify_crc_wait：WFI 期间内核时钟停止，CYCCNT 不计数
+    t0 = DWT->CYCCNT;
+    if (verify_crc_start(addr, len) == VERIFY_OK)
+    {
+        while (verify_crc_busy())
+            ;
+        hw_cycles = DWT->CYCCNT - t0;
+        verify_crc_wait(&hw_crc, OS_WAIT_FOREVER);
+    }
+
+    t0 = DWT->CYCCNT;
+    sw_crc = crc32_sw(addr, len);
+    sw_cycles = DWT->CYCCNT - t0;
+
+    hw_rate = verify_rate(len, hw_cycles);
+    sw_rate = verify_rate(len, sw_cycles);
+    LOG_I("crc %u KiB: dma %u.%02u MB/s, sw %u.%02u MB/s, %s", (unsigned)(len >> 10),
+          (unsigned)(hw_rate / 100U), (unsigned)(hw_rate % 100U),
+          (unsigned)(sw_rate / 100U), (unsigned)(sw_rate % 100U),
+          (hw_cycles && hw_crc == sw_crc) ? "match" : "mismatch");
+    (void)hw_rate;
+    (void)sw_rate;
+    (void)hw_crc;
+    (void)sw_crc;
+}
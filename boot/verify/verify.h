@@ -0,0 +1,101 @@
+#ifndef __BL_VERIFY_H
+#define __BL_VERIFY_H
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "crc32.h"
+#include "sha256.h"
+#include "ed25519.h"
+
+
+/*
+ * 镜像校验服务：由 DMA2 Stream0 以存储器到存储器方式把 flash 内容
+ * 逐字写入 CRC 外设的 DR，CPU 在等待期间可以调度其他任务或 WFI 睡眠。
+ * 外设忙、在中断中调用、地址未按字对齐或 DMA 出错时，退回 crc32_sw_update()，
+ * 两者结果完全一致。
+ *
+ * 镜像格式：数据补齐到 4 字节，末尾追加 CRC（小端字），由 tools/image_tool.py 生成。
+ * 校验时对整个镜像（含末尾 CRC）计算，结果为 CRC32_RESIDUE 即通过。
+ *
+ * 签名镜像在 CRC 之前多一段 Ed25519 签名：数据 | 签名 (64) | CRC (4)。
+ * 签名的对象是补齐后数据的 SHA-256，公钥在 verify_key.h，由 image_tool.py pubkey 生成。
+ */
+
+/* 置 0 时只用软件计算 */
+#ifndef VERIFY_USE_HW
+#define VERIFY_USE_HW               1
+#endif
+
+/* 单次 DMA 传输的字数，NDTR 最大 65535 */
+#ifndef VERIFY_DMA_CHUNK_WORDS
+#define VERIFY_DMA_CHUNK_WORDS      16384U
+#endif
+
+/* 增量校验上下文同时计算 SHA-256 */
+#ifndef VERIFY_SHA256
+#define VERIFY_SHA256               1
+#endif
+
+#ifndef VERIFY_DMA_IRQ_PRIORITY
+#define VERIFY_DMA_IRQ_PRIORITY     4U
+#endif
+
+
+/*
+ * 增量校验上下文：数据可以按任意长度分块送入，不足一个字的部分暂存，
+ * final 时按 tools/image_tool.py 的规则补 0xFF。
+ * F4 的 CRC 外设不能装载初值，无法在多次使用之间保存进度，因此上下文用软件计算。
+ * VERIFY_SHA256 打开时同时计算原始数据（不补齐）的 SHA-256，final 后存于 sha256[]。
+ */
+typedef struct
+{
+    uint32_t crc;
+    uint32_t len;               /* 已送入的总字节数 */
+    uint8_t tail[4];            /* 尚未凑满一个字的字节，共 len & 3 个 */
+#if VERIFY_SHA256
+    sha256_ctx_t sha;
+    uint8_t sha256[SHA256_DIGEST_SIZE];
+#endif
+} verify_ctx_t;
+
+typedef enum
+{
+    VERIFY_OK = 0,
+    VERIFY_ERR_CRC,             /* 校验值不符 */
+    VERIFY_ERR_ARG,             /* 长度不是 4 的倍数或镜像太短 */
+    VERIFY_ERR_BUSY,            /* CRC 外设正被占用 */
+    VERIFY_ERR_DMA,             /* DMA 传输错误 */
+    VERIFY_ERR_TIMEOUT,
+    VERIFY_ERR_SIG,             /* 签名无效 */
+} verify_status_t;
+
+
+void verify_init(void);
+
+/* 异步接口：start 成功后由 wait 取结果，期间不能再次 start；wait 超时会中止传输，之后可以重新 start */
+verify_status_t verify_crc_start(const void *addr, uint32_t len);
+verify_status_t verify_crc_wait(uint32_t *crc, uint32_t timeout);
+bool verify_crc_busy(void);
+
+/* 同步计算 CRC，自动选择硬件或软件 */
+uint32_t verify_crc(const void *addr, uint32_t len);
+
+/* 校验末尾带 CRC 的镜像，len 含末尾 4 字节 */
+verify_status_t verify_image(const void *image, uint32_t len);
+
+/* 先校验 CRC，再验证签名；len 含签名和末尾 CRC */
+verify_status_t verify_image_signed(const void *image, uint32_t len);
+
+void verify_ctx_init(verify_ctx_t *ctx);
+void verify_ctx_update(verify_ctx_t *ctx, const void *data, uint32_t len);
+uint32_t verify_ctx_final(verify_ctx_t *ctx);
+
+/* 分别用 DMA 和软件计算 [addr, addr + len)，通过 LOG_I 报告 MB/s */
+void verify_bench(const void *addr, uint32_t len);
+
+/* 由 DMA2_Stream0_IRQHandler 调用 */
+void verify_dma_irq(void);
+
+
+#endif /* __BL_VERIFY_H */
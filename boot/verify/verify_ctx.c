@@ -0,0 +1,60 @@
+#include <string.h>
+#include "verify.h"
+
+
+// 增量校验上下文只用软件计算，不依赖外设，tools/test 在主机上直接编译本文件
+
+void verify_ctx_init(verify_ctx_t *ctx)
+{
+    ctx->crc = CRC32_INIT;
+    ctx->len = 0;
+#if VERIFY_SHA256
+    sha256_init(&ctx->sha);
+#endif
+}
+
+void verify_ctx_update(verify_ctx_t *ctx, const void *data, uint32_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    uint32_t have = ctx->len & 3U, n;
+
+#if VERIFY_SHA256
+    sha256_update(&ctx->sha, data, len);
+#endif
+    ctx->len += len;
+
+    // 先凑满上次留下的半个字
+    if (have)
+    {
+        n = 4U - have;
+        if (n > len)
+            n = len;
+        memcpy(&ctx->tail[have], p, n);
+        p += n;
+        len -= n;
+        if (have + n < 4U)
+            return;
+        ctx->crc = crc32_sw_update(ctx->crc, ctx->tail, 4U);
+    }
+
+    n = len & ~3U;
+    ctx->crc = crc32_sw_update(ctx->crc, p, n);
+    memcpy(ctx->tail, p + n, len - n);
+}
+
+uint32_t verify_ctx_final(verify_ctx_t *ctx)
+{
+    uint32_t have = ctx->len & 3U;
+
+#if VERIFY_SHA256
+    sha256_final(&ctx->sha, ctx->sha256);
+#endif
+    if (have)
+    {
+        memset(&ctx->tail[have], 0xFF, 4U - have);
+        ctx->crc = crc32_sw_update(ctx->crc, ctx->tail, 4U);
+        ctx->len += 4U - have;
+    }
+
+    return ctx->crc;
+}
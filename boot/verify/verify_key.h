@@ -0,0 +1,18 @@
+#ifndef __BL_VERIFY_KEY_H
+#define __BL_VERIFY_KEY_H
+
+
+/*
+ * 仓库默认的开发公钥。对应的私钥曾经提交在仓库中，任何人都能用它签出被接受的镜像，
+ * 只能用于调试：CMake 检测到这个公钥时发出警告，打开 SLOT_VERIFY_SIGNED 时直接报错。
+ * 用 tools/image_tool.py devkey 在本地生成密钥（不提交）并改写本文件，
+ * 产品用 image_tool.py pubkey 写入正式公钥。
+ */
+static const uint8_t verify_pubkey[32] =
+{
+    0xbf, 0xd0, 0x97, 0x06, 0x6b, 0x3e, 0x2d, 0x67, 0x0b, 0x5c, 0xb8, 0x8c, 0xf5, 0x3c, 0x49, 0xf0,
+    0x3e, 0xa9, 0xa8, 0xcf, 0x88, 0xcf, 0x2e, 0xc1, 0x31, 0xea, 0xe6, 0x52, 0x0a, 0x3f, 0xd4, 0xd1,
+};
+
+
+#endif /* __BL_VERIFY_KEY_H */
@@ -308,6 +308,8 @@
   */
 
 #include "stm32f4xx.h"
+#include "flash_layout.h"
+#include "handoff.h"
 
 /**
   * @}
@@ -354,7 +356,8 @@
 /*!< Uncomment the following line if you need to relocate your vector Table in
      Internal SRAM. */
 /* #define VECT_TAB_SRAM */
-#define VECT_TAB_OFFSET  0x00 /*!< Vector Table base offset field.
+/* 向量表随链接位置：链接到 A/B 槽的应用不在 flash 起点 */
+#define VECT_TAB_OFFSET  (LAYOUT_IMAGE_ORIGIN - FLASH_BASE) /*!< Vector Table base offset field.
                                    This value must be a multiple of 0x200. */
 /******************************************************************************/
 
@@ -479,6 +482,14 @@ void SystemInit(void)
   #if (__FPU_PRESENT == 1) && (__FPU_USED == 1)
     SCB->CPACR |= ((3UL << 10*2)|(3UL << 11*2));  /* set CP10 and CP11 Full Access */
   #endif
+#if LAYOUT_IMAGE != LAYOUT_IMAGE_BOOT
+  /* bootloader 已配好 PLL 并通过交接块交给应用时沿用，跳过 HSE 起振和 PLL 锁定 */
+  if (handoff_clock_adopt())
+  {
+    SCB->VTOR = FLASH_BASE | VECT_TAB_OFFSET;
+    return;
+  }
+#endif
   /* Reset the RCC clock configuration to the default reset state ------------*/
   /* Set HSION bit */
   RCC->CR |= (uint32_t)0x00000001;
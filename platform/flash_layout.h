@@ -0,0 +1,66 @@
+#ifndef __FLASH_LAYOUT_H
+#define __FLASH_LAYOUT_H
+
+
+/*
+ * 存储分区，bootloader 代码与链接脚本共用。
+ * 链接脚本经 C 预处理器生成（见 CMakeLists.txt），因此这里只能出现宏定义，
+ * 数值不能带 U 等后缀。
+ *
+ *   0x08000000  BOOT     扇区 0-2    48 KiB  bootloader
+ *   0x0800C000  BOOTSEL  扇区 3      16 KiB  启动选择记录，只追加写
+ *   0x08010000  SLOT_A   扇区 4-5   192 KiB
+ *   0x08040000  SLOT_B   扇区 6-7   192 KiB（扇区 7 末尾 64 KiB 不用）
+ *
+ * 两个槽等长且不共用扇区，应用按所在槽分别链接 (BUILD_IMAGE=SLOT_A/SLOT_B)，
+ * bootloader 在原地启动，从不在槽之间搬移镜像。
+ */
+
+#define LAYOUT_IMAGE_BOOT       0
+#define LAYOUT_IMAGE_SLOT_A     1
+#define LAYOUT_IMAGE_SLOT_B     2
+
+/* 当前构建的链接位置，由 CMake 的 BUILD_IMAGE 传入 */
+#ifndef LAYOUT_IMAGE
+#define LAYOUT_IMAGE            LAYOUT_IMAGE_BOOT
+#endif
+
+#define LAYOUT_BOOT_ORIGIN      0x08000000
+#define LAYOUT_BOOT_SIZE        (48 * 1024)
+
+#define LAYOUT_BOOTSEL_ORIGIN   0x0800C000
+#define LAYOUT_BOOTSEL_SIZE     (16 * 1024)
+
+#define LAYOUT_SLOT_A_ORIGIN    0x08010000
+#define LAYOUT_SLOT_B_ORIGIN    0x08040000
+#define LAYOUT_SLOT_SIZE        (192 * 1024)
+
+/* RAM 起点的 NOINIT 区两边链接在同一地址，启动代码不初始化，用于 bootloader 向应用交接 */
+#define LAYOUT_NOINIT_ORIGIN    0x20000000
+#define LAYOUT_NOINIT_SIZE      256
+
+#define LAYOUT_RAM_ORIGIN       (LAYOUT_NOINIT_ORIGIN + LAYOUT_NOINIT_SIZE)
+#define LAYOUT_RAM_SIZE         (128 * 1024 - LAYOUT_NOINIT_SIZE)
+
+#define LAYOUT_CCMRAM_ORIGIN    0x10000000
+#define LAYOUT_CCMRAM_SIZE      (64 * 1024)
+
+/* 备份 SRAM：复位后内容仍在，接 VBAT 时掉电也在。bootloader 与应用按固定地址共用 */
+#define LAYOUT_BKPSRAM_ORIGIN   0x40024000
+#define LAYOUT_BKPSRAM_SIZE     (4 * 1024)
+#define LAYOUT_BKP_FLASH_COUNT  (LAYOUT_BKPSRAM_ORIGIN + 0)      /* flash 擦写计数，8 字节 */
+#define LAYOUT_BKP_SLOT_CACHE   (LAYOUT_BKPSRAM_ORIGIN + 16)     /* 已校验镜像缓存，每槽 32 字节 */
+
+#if LAYOUT_IMAGE == LAYOUT_IMAGE_SLOT_A
+#define LAYOUT_IMAGE_ORIGIN     LAYOUT_SLOT_A_ORIGIN
+#define LAYOUT_IMAGE_SIZE       LAYOUT_SLOT_SIZE
+#elif LAYOUT_IMAGE == LAYOUT_IMAGE_SLOT_B
+#define LAYOUT_IMAGE_ORIGIN     LAYOUT_SLOT_B_ORIGIN
+#define LAYOUT_IMAGE_SIZE       LAYOUT_SLOT_SIZE
+#else
+#define LAYOUT_IMAGE_ORIGIN     LAYOUT_BOOT_ORIGIN
+#define LAYOUT_IMAGE_SIZE       LAYOUT_BOOT_SIZE
+#endif
+
+
+#endif /* __FLASH_LAYOUT_H */
@@ -10,8 +10,8 @@
 
 struct ringbuffer8
 {
-    uint32_t tail;
-    uint32_t head;
+    volatile uint32_t tail;   // 单生产者/单消费者可分别在任务和中断中使用
+    volatile uint32_t head;
     uint32_t length;
 
     uint8_t buffer[];
@@ -22,6 +22,8 @@ ringbuffer8_t rb8_new(uint8_t *buff, uint32_t length)
 {
     ringbuffer8_t rb = (ringbuffer8_t)buff;
     rb->length = length - sizeof(struct ringbuffer8);
+    rb->head = 0;
+    rb->tail = 0;
 
     return rb;
 }
@@ -0,0 +1,87 @@
+"""Pure-Python AES-CTR for the host-side image tools.
+
+Matches boot/verify/aes.c: the counter block is a 16-byte big-endian number
+of which only the low 32 bits are incremented, like the STM32 CRYP unit.
+Slow (a few hundred KB/s) but dependency free, which is plenty for images.
+"""
+
+import struct
+
+
+def _sbox():
+    sbox = [0] * 256
+    p = q = 1
+    while True:
+        p ^= ((p << 1) ^ (0x1B if p & 0x80 else 0)) & 0xFF
+        q ^= q << 1
+        q ^= q << 2
+        q ^= q << 4
+        q &= 0xFF
+        if q & 0x80:
+            q ^= 0x09
+        x = q
+        for r in range(1, 5):
+            x ^= ((q << r) | (q >> (8 - r))) & 0xFF
+        sbox[p] = x ^ 0x63
+        if p == 1:
+            break
+    sbox[0] = 0x63
+    return sbox
+
+
+SBOX = _sbox()
+
+
+def _xtime(x):
+    return ((x << 1) ^ (0x1B if x & 0x80 else 0)) & 0xFF
+
+
+def expand_key(key):
+    nk = len(key) // 4
+    if len(key) not in (16, 24, 32):
+        raise ValueError("AES key must be 16, 24 or 32 bytes")
+    rounds = nk + 6
+    w = [list(key[4 * i:4 * i + 4]) for i in range(nk)]
+    rcon = 1
+    for i in range(nk, 4 * (rounds + 1)):
+        t = list(w[i - 1])
+        if i % nk == 0:
+            t = [SBOX[b] for b in t[1:] + t[:1]]
+            t[0] ^= rcon
+            rcon = _xtime(rcon)
+        elif nk == 8 and i % nk == 4:
+            t = [SBOX[b] for b in t]
+        w.append([a ^ b for a, b in zip(w[i - nk], t)])
+    return [sum(w[4 * r:4 * r + 4], []) for r in range(rounds + 1)]
+
+
+def encrypt_block(rk, block):
+    s = [a ^ b for a, b in zip(block, rk[0])]
+    for r in range(1, len(rk)):
+        s = [SBOX[b] for b in s]
+        # ShiftRows: byte (row, col) = s[4 * col + row]
+        s = [s[(4 * (c + row) + row) % 16] for c in range(4) for row in range(4)]
+        if r != len(rk) - 1:
+            m = []
+            for c in range(4):
+                a = s[4 * c:4 * c + 4]
+                t = a[0] ^ a[1] ^ a[2] ^ a[3]
+                m += [a[i] ^ t ^ _xtime(a[i] ^ a[(i + 1) % 4]) for i in range(4)]
+            s = m
+        s = [a ^ b for a, b in zip(s, rk[r])]
+    return bytes(s)
+
+
+def ctr(key, iv, data):
+    """Encrypt or decrypt data (the same operation in CTR mode)."""
+    if len(iv) != 16:
+        raise ValueError("AES-CTR IV must be 16 bytes")
+    rk = expand_key(key)
+    prefix, counter = iv[:12], struct.unpack(">I", iv[12:])[0]
+    out = bytearray(data)
+    for off in range(0, len(out), 16):
+        ks = encrypt_block(rk, prefix + struct.pack(">I", counter))
+        counter = (counter + 1) & 0xFFFFFFFF
+        for i, k in enumerate(ks[:len(out) - off]):
+            out[off + i] ^= k
+    return bytes(out)
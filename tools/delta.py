@@ -0,0 +1,215 @@
+"""Binary delta patches for update images, matching boot/update/delta.c.
+
+Patch:  "DP" | version (1) | 0 | old size | old CRC-32 | new size  (u32 LE each)
+followed by records until the new image is complete:
+  varint diff_len | varint extra_len | zigzag varint seek
+  diff              diff_len bytes of new = old[pos] + d (mod 256), pos advances;
+                    coded as runs  varint zeros | varint n | n bytes of d
+                    until diff_len is covered (zeros are bytes equal to old)
+  extra_len bytes   copied to the output as is
+  seek              added to pos after the record
+The old CRC is the STM32 CRC-32 of the old image as installed, so a patch is
+never applied on top of the wrong base.
+
+The differ follows bsdiff: exact matches (found here through a hash index of
+the old image instead of a suffix array) seed alignments, which are then
+extended forwards and backwards while at least half the bytes agree. Code
+that only moved produces diff bytes that are mostly zero, so compress the
+patch with lzss before sending it.
+"""
+
+import struct
+
+MAGIC = b"DP"
+VERSION = 1
+HEADER_SIZE = 16
+KEY = 6
+CANDIDATES = 16
+
+
+def _varint(n):
+    out = bytearray()
+    while True:
+        b = n & 0x7F
+        n >>= 7
+        if n:
+            out.append(b | 0x80)
+        else:
+            out.append(b)
+            return bytes(out)
+
+
+def _zigzag(n):
+    return (n << 1) if n >= 0 else ((-n << 1) - 1)
+
+
+def _match_len(a, i, b, j, limit):
+    """Length of the common prefix of a[i:] and b[j:], at most limit."""
+    n = 0
+    step = 64
+    while n < limit:
+        k = min(step, limit - n)
+        if a[i + n:i + n + k] == b[j + n:j + n + k]:
+            n += k
+            continue
+        while n < limit and a[i + n] == b[j + n]:
+            n += 1
+        break
+    return n
+
+
+class _Index:
+    def __init__(self, old):
+        self.old = old
+        self.table = {}
+        for j in range(len(old) - KEY + 1):
+            lst = self.table.setdefault(old[j:j + KEY], [])
+            if len(lst) < CANDIDATES:
+                lst.append(j)
+
+    def search(self, new, scan):
+        """Longest exact match of new[scan:] in old, as (pos, length)."""
+        best_pos, best_len = 0, 0
+        for j in self.table.get(new[scan:scan + KEY], ()):
+            n = _match_len(self.old, j, new, scan, min(len(self.old) - j, len(new) - scan))
+            if n > best_len:
+                best_pos, best_len = j, n
+        return best_pos, best_len
+
+
+def diff(old, new, crc):
+    """Patch turning old into new; crc(old) is stored in the header."""
+    if len(old) % 4:
+        raise ValueError("old image length must be a multiple of 4")
+    index = _Index(old)
+    out = bytearray(MAGIC + bytes([VERSION, 0]))
+    out += struct.pack("<III", len(old), crc(old), len(new))
+
+    oldsize, newsize = len(old), len(new)
+    scan = length = lastscan = lastpos = lastoffset = pos = 0
+    while scan < newsize:
+        oldscore = 0
+        scan += length
+        scsc = scan
+        while scan < newsize:
+            pos, length = index.search(new, scan)
+            while scsc < scan + length:
+                if scsc + lastoffset < oldsize and old[scsc + lastoffset] == new[scsc]:
+                    oldscore += 1
+                scsc += 1
+            if (length == oldscore and length != 0) or length > oldscore + 8:
+                break
+            if scan + lastoffset < oldsize and old[scan + lastoffset] == new[scan]:
+                oldscore -= 1
+            scan += 1
+
+        if length == oldscore and scan != newsize:
+            continue
+
+        # extend the previous alignment forwards ...
+        s = sf = lenf = i = 0
+        while lastscan + i < scan and lastpos + i < oldsize:
+            if old[lastpos + i] == new[lastscan + i]:
+                s += 1
+            i += 1
+            if s * 2 - i > sf * 2 - lenf:
+                sf, lenf = s, i
+
+        # ... and the new one backwards
+        lenb = 0
+        if scan < newsize:
+            s = sb = 0
+            i = 1
+            while scan >= lastscan + i and pos >= i:
+                if old[pos - i] == new[scan - i]:
+                    s += 1
+                if s * 2 - i > sb * 2 - lenb:
+                    sb, lenb = s, i
+                i += 1
+
+        if lastscan + lenf > scan - lenb:
+            overlap = (lastscan + lenf) - (scan - lenb)
+            s = ss = lens = 0
+            for i in range(overlap):
+                if new[lastscan + lenf - overlap + i] == old[lastpos + lenf - overlap + i]:
+                    s += 1
+                if new[scan - lenb + i] == old[pos - lenb + i]:
+                    s -= 1
+                if s > ss:
+                    ss, lens = s, i + 1
+            lenf += lens - overlap
+            lenb -= lens
+
+        extra = new[lastscan + lenf:scan - lenb]
+        seek = (pos - lenb) - (lastpos + lenf)
+        out += _varint(lenf) + _varint(len(extra)) + _varint(_zigzag(seek))
+        out += _runs(bytes((new[lastscan + k] - old[lastpos + k]) & 0xFF for k in range(lenf)))
+        out += extra
+
+        lastscan = scan - lenb
+        lastpos = pos - lenb
+        lastoffset = pos - scan
+
+    return bytes(out)
+
+
+def _runs(d):
+    """Code diff bytes as (zero run, literal run) pairs."""
+    out = bytearray()
+    i, n = 0, len(d)
+    while i < n:
+        j = i
+        while j < n and d[j] == 0:
+            j += 1
+        k = j
+        # a literal run ends at the next stretch of zeros worth a new pair
+        while k < n and (d[k] != 0 or d[k:k + 4] != bytes(min(4, n - k))):
+            k += 1
+        out += _varint(j - i) + _varint(k - j) + d[j:k]
+        i = k
+    return bytes(out)
+
+
+def _read_varint(patch, p):
+    n = shift = 0
+    while True:
+        b = patch[p]
+        p += 1
+        n |= (b & 0x7F) << shift
+        shift += 7
+        if not b & 0x80:
+            return n, p
+
+
+def apply(old, patch, crc):
+    if len(patch) < HEADER_SIZE or patch[:2] != MAGIC or patch[2] != VERSION:
+        raise ValueError("not a delta patch")
+    old_size, old_crc, new_size = struct.unpack_from("<III", patch, 4)
+    if old_size > len(old) or crc(old[:old_size]) != old_crc:
+        raise ValueError("patch is for a different old image")
+    out = bytearray()
+    p, pos = HEADER_SIZE, 0
+    while len(out) < new_size:
+        lenf, p = _read_varint(patch, p)
+        lenx, p = _read_varint(patch, p)
+        z, p = _read_varint(patch, p)
+        seek = (z >> 1) if not z & 1 else -((z + 1) >> 1)
+        if pos + lenf > old_size:
+            raise ValueError("diff past end of old image")
+        end = pos + lenf
+        while pos < end:
+            zeros, p = _read_varint(patch, p)
+            n, p = _read_varint(patch, p)
+            if pos + zeros + n > end:
+                raise ValueError("diff run past end of record")
+            out += old[pos:pos + zeros]
+            pos += zeros
+            out += bytes((old[pos + k] + patch[p + k]) & 0xFF for k in range(n))
+            p += n
+            pos += n
+        out += patch[p:p + lenx]
+        p += lenx
+        pos += seek
+    if len(out) != new_size:
+        raise ValueError("patch overruns the new image")
+    return bytes(out)
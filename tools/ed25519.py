@@ -0,0 +1,129 @@
+"""Pure-Python Ed25519 (RFC 8032) for the host-side image tools.
+
+Slow but dependency free; signing an image digest takes a few milliseconds.
+Only what image_tool.py needs: key derivation, sign, verify, and the point
+helpers used to generate the precomputed table in boot/verify/ed25519_table.h.
+"""
+
+import hashlib
+
+P = 2 ** 255 - 19
+L = 2 ** 252 + 27742317777372353535851937790883648493
+D = -121665 * pow(121666, P - 2, P) % P
+SQRT_M1 = pow(2, (P - 1) // 4, P)
+
+# base point in extended coordinates (X, Y, Z, T)
+_BY = 4 * pow(5, P - 2, P) % P
+_BX = None
+
+
+def _recover_x(y, sign):
+    if y >= P:
+        return None
+    x2 = (y * y - 1) * pow(D * y * y + 1, P - 2, P) % P
+    if x2 == 0:
+        return None if sign else 0
+    x = pow(x2, (P + 3) // 8, P)
+    if (x * x - x2) % P != 0:
+        x = x * SQRT_M1 % P
+    if (x * x - x2) % P != 0:
+        return None
+    if (x & 1) != sign:
+        x = P - x
+    return x
+
+
+_BX = _recover_x(_BY, 0)
+B = (_BX, _BY, 1, _BX * _BY % P)
+IDENTITY = (0, 1, 1, 0)
+
+
+def point_add(p, q):
+    a = (p[1] - p[0]) * (q[1] - q[0]) % P
+    b = (p[1] + p[0]) * (q[1] + q[0]) % P
+    c = 2 * p[3] * q[3] * D % P
+    d = 2 * p[2] * q[2] % P
+    e, f, g, h = b - a, d - c, d + c, b + a
+    return (e * f % P, g * h % P, f * g % P, e * h % P)
+
+
+def point_mul(s, p):
+    q = IDENTITY
+    while s > 0:
+        if s & 1:
+            q = point_add(q, p)
+        p = point_add(p, p)
+        s >>= 1
+    return q
+
+
+def point_equal(p, q):
+    return (p[0] * q[2] - q[0] * p[2]) % P == 0 and (p[1] * q[2] - q[1] * p[2]) % P == 0
+
+
+def point_affine(p):
+    zi = pow(p[2], P - 2, P)
+    return p[0] * zi % P, p[1] * zi % P
+
+
+def point_compress(p):
+    x, y = point_affine(p)
+    return int.to_bytes(y | ((x & 1) << 255), 32, "little")
+
+
+def point_decompress(s):
+    if len(s) != 32:
+        return None
+    y = int.from_bytes(s, "little")
+    sign = y >> 255
+    y &= (1 << 255) - 1
+    x = _recover_x(y, sign)
+    if x is None:
+        return None
+    return (x, y, 1, x * y % P)
+
+
+def _sha512_int(*parts):
+    h = hashlib.sha512()
+    for part in parts:
+        h.update(part)
+    return int.from_bytes(h.digest(), "little")
+
+
+def _expand(seed):
+    if len(seed) != 32:
+        raise ValueError("Ed25519 seed must be 32 bytes")
+    h = hashlib.sha512(seed).digest()
+    a = int.from_bytes(h[:32], "little")
+    a &= (1 << 254) - 8
+    a |= 1 << 254
+    return a, h[32:]
+
+
+def public_key(seed):
+    a, _ = _expand(seed)
+    return point_compress(point_mul(a, B))
+
+
+def sign(seed, msg):
+    a, prefix = _expand(seed)
+    pk = point_compress(point_mul(a, B))
+    r = _sha512_int(prefix, msg) % L
+    rs = point_compress(point_mul(r, B))
+    h = _sha512_int(rs, pk, msg) % L
+    s = (r + h * a) % L
+    return rs + int.to_bytes(s, 32, "little")
+
+
+def verify(pk, msg, sig):
+    if len(pk) != 32 or len(sig) != 64:
+        return False
+    a = point_decompress(pk)
+    r = point_decompress(sig[:32])
+    if a is None or r is None:
+        return False
+    s = int.from_bytes(sig[32:], "little")
+    if s >= L:
+        return False
+    h = _sha512_int(sig[:32], pk, msg) % L
+    return point_equal(point_mul(s, B), point_add(r, point_mul(h, a)))
@@ -0,0 +1,347 @@
+#!/usr/bin/env python3
+"""Host-side image tooling for the bootloader.
+
+crc            pad an image to 4 bytes with 0xFF and append its CRC-32 trailer
+sign           pad, append an Ed25519 signature and the CRC-32 trailer
+diff           delta patch from the installed image to a new one for update_set_delta()
+compress       LZSS compress a finished image for update_set_compressed()
+encrypt        AES-256-CTR encrypt a finished image for update_begin_encrypted()
+check          verify the CRC-32 trailer (and the signature with --key)
+keygen         create a key file (32 bytes, hex): Ed25519 seed or AES-256 key
+pubkey         write the public key as a C header for boot/verify
+devkey         create the local development key (not committed) and its header
+vectors        print random Ed25519 test vectors, one 'pk msg sig' hex line each
+ed25519-table  regenerate boot/verify/ed25519_table.h
+
+The CRC is the one computed by the STM32F4 CRC unit and by boot/verify/crc32.c:
+polynomial 0x04C11DB7, init 0xFFFFFFFF, no reflection, no final xor, fed with
+little-endian 32-bit words MSB first. It is NOT zlib.crc32. Because there is
+no final xor, the CRC over an image plus its trailer is 0.
+
+A signed image is  payload (padded to 4) | signature (64) | CRC-32 (4).
+The signature is Ed25519 over SHA-256(padded payload), checked on the device
+by verify_image_signed().
+
+An encrypted update is  IV (16) | AES-256-CTR(image). The image inside is a
+finished crc/sign output, so the device checks the plaintext as usual. The IV
+is a random 12-byte nonce followed by a zero 32-bit block counter.
+
+A compressed update is the LZSS stream of a finished image (see lzss.py).
+Compress before encrypting; the device decrypts, then decompresses.
+
+A delta update is a patch (see delta.py) from the finished image installed
+on the device to the new finished image. It carries the CRC of the old image,
+so it only applies on top of exactly that image. Order: diff, compress,
+encrypt; the device undoes them in reverse while programming.
+
+usage: image_tool.py crc demo.bin -o demo_crc.bin
+       image_tool.py check demo_crc.bin
+       image_tool.py keygen -o my.key
+       image_tool.py pubkey my.key -o boot/verify/verify_key.h
+       image_tool.py devkey
+       image_tool.py sign my.key demo.bin -o demo_signed.bin
+       image_tool.py check demo_signed.bin --key my.key
+       image_tool.py compress demo_signed.bin -o demo_lz.bin
+       image_tool.py diff old_signed.bin demo_signed.bin -o demo.patch
+       image_tool.py encrypt aes.key demo_lz.bin -o demo_update.bin
+"""
+
+import argparse
+import hashlib
+import os
+import struct
+import sys
+
+import aes
+import delta
+import ed25519
+import lzss
+
+TOOLS_DIR = os.path.dirname(os.path.abspath(__file__))
+DEV_KEY = os.path.join(TOOLS_DIR, "keys", "dev_ed25519.key")
+
+CRC32_POLY = 0x04C11DB7
+CRC32_INIT = 0xFFFFFFFF
+CRC32_RESIDUE = 0x00000000
+SIG_SIZE = 64
+IV_SIZE = 16
+BASE_TABLE_SIZE = 32
+
+
+def _crc32_table():
+    table = []
+    for b in range(256):
+        c = b << 24
+        for _ in range(8):
+            c = ((c << 1) ^ CRC32_POLY) if c & 0x80000000 else (c << 1)
+        table.append(c & 0xFFFFFFFF)
+    return table
+
+
+CRC32_TABLE = _crc32_table()
+
+
+def crc32(data, crc=CRC32_INIT):
+    """CRC over len(data) // 4 words; data must be padded to 4 bytes."""
+    if len(data) % 4:
+        raise ValueError("length must be a multiple of 4")
+    t = CRC32_TABLE
+    for (w,) in struct.iter_unpack("<I", data):
+        crc ^= w
+        for _ in range(4):
+            crc = ((crc << 8) & 0xFFFFFFFF) ^ t[crc >> 24]
+    return crc
+
+
+def pad4(data):
+    return data + b"\xff" * (-len(data) % 4)
+
+
+def cmd_crc(args):
+    with open(args.image, "rb") as f:
+        data = pad4(f.read())
+    crc = crc32(data)
+    out = args.output or args.image
+    with open(out, "wb") as f:
+        f.write(data + struct.pack("<I", crc))
+    print("%s: %u bytes, crc 0x%08X" % (out, len(data) + 4, crc))
+    return 0
+
+
+def load_key(path):
+    with open(path) as f:
+        seed = bytes.fromhex(f.read().strip())
+    if len(seed) != 32:
+        raise ValueError("%s: expected a 32-byte hex seed" % path)
+    return seed
+
+
+def c_bytes(data, indent="    "):
+    lines = []
+    for i in range(0, len(data), 16):
+        lines.append(indent + " ".join("0x%02x," % b for b in data[i:i + 16]))
+    return "\n".join(lines)
+
+
+def cmd_sign(args):
+    seed = load_key(args.key)
+    with open(args.image, "rb") as f:
+        data = pad4(f.read())
+    sig = ed25519.sign(seed, hashlib.sha256(data).digest())
+    data += sig
+    crc = crc32(data)
+    out = args.output or args.image
+    with open(out, "wb") as f:
+        f.write(data + struct.pack("<I", crc))
+    print("%s: %u bytes payload, signed, crc 0x%08X" % (out, len(data) - SIG_SIZE, crc))
+    return 0
+
+
+def cmd_diff(args):
+    with open(args.old, "rb") as f:
+        old = f.read()
+    with open(args.image, "rb") as f:
+        new = f.read()
+    if len(old) % 4:
+        print("%s: not a finished image (length %% 4 != 0)" % args.old, file=sys.stderr)
+        return 1
+    patch = delta.diff(old, new, crc32)
+    # same as compress: a differ bug must never reach a device
+    if delta.apply(old, patch, crc32) != new:
+        print("%s: round trip failed" % args.image, file=sys.stderr)
+        return 1
+    with open(args.output, "wb") as f:
+        f.write(patch)
+    print("%s: %u -> %u bytes (%.1f%%), base crc 0x%08X"
+          % (args.output, len(new), len(patch), 100.0 * len(patch) / max(len(new), 1), crc32(old)))
+    return 0
+
+
+def cmd_compress(args):
+    with open(args.image, "rb") as f:
+        data = f.read()
+    blob = lzss.compress(data, args.window_bits, args.count_bits)
+    # always round-trip so a compressor bug never reaches a device
+    if lzss.decompress(blob) != data:
+        print("%s: round trip failed" % args.image, file=sys.stderr)
+        return 1
+    out = args.output or args.image
+    with open(out, "wb") as f:
+        f.write(blob)
+    print("%s: %u -> %u bytes (%.1f%%)" % (out, len(data), len(blob), 100.0 * len(blob) / max(len(data), 1)))
+    return 0
+
+
+def cmd_encrypt(args):
+    key = load_key(args.key)
+    with open(args.image, "rb") as f:
+        data = f.read()
+    iv = os.urandom(IV_SIZE - 4) + bytes(4)
+    out = args.output or args.image
+    with open(out, "wb") as f:
+        f.write(iv + aes.ctr(key, iv, data))
+    print("%s: %u bytes, iv %s" % (out, IV_SIZE + len(data), iv.hex()))
+    return 0
+
+
+def cmd_check(args):
+    with open(args.image, "rb") as f:
+        data = f.read()
+    if len(data) < 8 or len(data) % 4:
+        print("%s: bad length %u" % (args.image, len(data)), file=sys.stderr)
+        return 1
+    ok = crc32(data) == CRC32_RESIDUE
+    what = "ok" if ok else "crc mismatch"
+    if ok and args.key:
+        payload = data[:-(SIG_SIZE + 4)]
+        sig = data[-(SIG_SIZE + 4):-4]
+        pk = ed25519.public_key(load_key(args.key))
+        ok = len(data) >= SIG_SIZE + 8 and ed25519.verify(pk, hashlib.sha256(payload).digest(), sig)
+        what = "ok, signature valid" if ok else "bad signature"
+    print("%s: %s" % (args.image, what))
+    return 0 if ok else 1
+
+
+def write_key(path):
+    seed = os.urandom(32)
+    # the key never leaves this machine: owner read/write only
+    fd = os.open(path, os.O_WRONLY | os.O_CREAT | os.O_EXCL, 0o600)
+    with os.fdopen(fd, "w") as f:
+        f.write(seed.hex() + "\n")
+    print("%s: public key %s" % (path, ed25519.public_key(seed).hex()))
+
+
+def cmd_keygen(args):
+    if os.path.exists(args.output):
+        print("%s: exists, not overwriting" % args.output, file=sys.stderr)
+        return 1
+    write_key(args.output)
+    return 0
+
+
+def cmd_pubkey(args):
+    pk = ed25519.public_key(load_key(args.key))
+    text = ("#ifndef __BL_VERIFY_KEY_H\n#define __BL_VERIFY_KEY_H\n\n\n"
+            "/* 由 tools/image_tool.py pubkey %s 生成 */\n"
+            "static const uint8_t verify_pubkey[32] =\n{\n%s\n};\n\n\n"
+            "#endif /* __BL_VERIFY_KEY_H */\n") % (os.path.basename(args.key), c_bytes(pk))
+    with open(args.output, "w") as f:
+        f.write(text)
+    print("%s: %s" % (args.output, pk.hex()))
+    return 0
+
+
+def cmd_devkey(args):
+    # tools/keys/ is in .gitignore; each developer has their own key
+    if not os.path.exists(DEV_KEY):
+        os.makedirs(os.path.dirname(DEV_KEY), exist_ok=True)
+        write_key(DEV_KEY)
+    args.key = DEV_KEY
+    return cmd_pubkey(args)
+
+
+def cmd_vectors(args):
+    for _ in range(args.count):
+        seed = os.urandom(32)
+        msg = os.urandom(args.length)
+        pk = ed25519.public_key(seed)
+        sig = ed25519.sign(seed, msg)
+        print(pk.hex(), msg.hex() or "-", sig.hex())
+    return 0
+
+
+def fe_words(x):
+    return "{ " + ", ".join("0x%08x" % ((x >> (32 * i)) & 0xFFFFFFFF) for i in range(8)) + " }"
+
+
+def cmd_table(args):
+    P = ed25519.P
+    entries = []
+    b2 = ed25519.point_add(ed25519.B, ed25519.B)
+    pt = ed25519.B
+    for _ in range(BASE_TABLE_SIZE):
+        x, y = ed25519.point_affine(pt)
+        entries.append("    {\n        %s,\n        %s,\n        %s,\n    },"
+                       % (fe_words((y + x) % P), fe_words((y - x) % P), fe_words(2 * ed25519.D * x * y % P)))
+        pt = ed25519.point_add(pt, b2)
+    text = ("#ifndef __BL_ED25519_TABLE_H\n#define __BL_ED25519_TABLE_H\n\n\n"
+            "/*\n * 由 tools/image_tool.py ed25519-table 生成，勿手工修改。\n"
+            " * ed25519_base_odd[i] = (2i + 1)B，预计算形式 (y + x, y - x, 2dxy)，\n"
+            " * 仿射坐标，完全约简，小端 32 位字。\n */\n\n"
+            "#define ED25519_BASE_TABLE  %uU\n\n"
+            "static const ge_precomp_t ed25519_base_odd[ED25519_BASE_TABLE] =\n{\n%s\n};\n\n\n"
+            "#endif /* __BL_ED25519_TABLE_H */\n") % (BASE_TABLE_SIZE, "\n".join(entries))
+    with open(args.output, "w") as f:
+        f.write(text)
+    print("%s: %u entries" % (args.output, BASE_TABLE_SIZE))
+    return 0
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    sub = ap.add_subparsers(dest="cmd", required=True)
+
+    p = sub.add_parser("crc", help="pad and append the CRC-32 trailer")
+    p.add_argument("image")
+    p.add_argument("-o", "--output", help="output file (default: in place)")
+    p.set_defaults(fn=cmd_crc)
+
+    p = sub.add_parser("sign", help="pad, sign and append the CRC-32 trailer")
+    p.add_argument("key")
+    p.add_argument("image")
+    p.add_argument("-o", "--output", help="output file (default: in place)")
+    p.set_defaults(fn=cmd_sign)
+
+    p = sub.add_parser("diff", help="delta patch against the installed image")
+    p.add_argument("old", help="image currently installed on the device")
+    p.add_argument("image")
+    p.add_argument("-o", "--output", required=True)
+    p.set_defaults(fn=cmd_diff)
+
+    p = sub.add_parser("compress", help="LZSS compress an image for update")
+    p.add_argument("image")
+    p.add_argument("-o", "--output", help="output file (default: in place)")
+    p.add_argument("-w", "--window-bits", type=int, default=lzss.WINDOW_BITS,
+                   help="window size, at most LZSS_WINDOW_BITS on the device")
+    p.add_argument("-c", "--count-bits", type=int, default=lzss.COUNT_BITS, choices=range(1, 9))
+    p.set_defaults(fn=cmd_compress)
+
+    p = sub.add_parser("encrypt", help="AES-256-CTR encrypt an image for update")
+    p.add_argument("key")
+    p.add_argument("image")
+    p.add_argument("-o", "--output", help="output file (default: in place)")
+    p.set_defaults(fn=cmd_encrypt)
+
+    p = sub.add_parser("check", help="verify the CRC-32 trailer")
+    p.add_argument("image")
+    p.add_argument("--key", help="also verify the signature against this key")
+    p.set_defaults(fn=cmd_check)
+
+    p = sub.add_parser("keygen", help="create an Ed25519 or AES-256 key")
+    p.add_argument("-o", "--output", required=True)
+    p.set_defaults(fn=cmd_keygen)
+
+    p = sub.add_parser("pubkey", help="write the public key as a C header")
+    p.add_argument("key")
+    p.add_argument("-o", "--output", default="boot/verify/verify_key.h")
+    p.set_defaults(fn=cmd_pubkey)
+
+    p = sub.add_parser("devkey", help="create tools/keys/dev_ed25519.key if missing, write its header")
+    p.add_argument("-o", "--output", default="boot/verify/verify_key.h")
+    p.set_defaults(fn=cmd_devkey)
+
+    p = sub.add_parser("vectors", help="print random Ed25519 test vectors")
+    p.add_argument("-n", "--count", type=int, default=4)
+    p.add_argument("-l", "--length", type=int, default=32, help="message length")
+    p.set_defaults(fn=cmd_vectors)
+
+    p = sub.add_parser("ed25519-table", help="regenerate the base point table")
+    p.add_argument("-o", "--output", default="boot/verify/ed25519_table.h")
+    p.set_defaults(fn=cmd_table)
+
+    args = ap.parse_args()
+    return args.fn(args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,188 @@
+#!/usr/bin/env python3
+"""Decode the binary log ring (LOG_BACKEND_BINARY) using the firmware ELF.
+
+The dump is the raw memory of the `log_ring` symbol, e.g. from gdb:
+    dump binary memory log.bin &log_ring ((char *)&log_ring) + sizeof(log_ring)
+or a larger RAM dump together with --base <dump start address>.
+
+usage: log_decode.py demo.elf log.bin [--base 0x20000000]
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+LOG_RING_MAGIC = 0x474F4C42
+LOG_RING_PAD = 0xFFFFFFFF
+LEVELS = "?EWID"
+
+SHT_SYMTAB = 2
+SHF_ALLOC = 0x2
+
+CONV_RE = re.compile(r"%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d+))?(hh|h|ll|l|j|z|t)?([diuxXobcspfFeEgG%])")
+
+
+class Elf:
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            self.data = f.read()
+        if self.data[:4] != b"\x7fELF" or self.data[4] != 1:
+            raise ValueError("not an ELF32 file")
+        shoff, = struct.unpack_from("<I", self.data, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from("<HHH", self.data, 0x2E)
+        raw = [struct.unpack_from("<10I", self.data, shoff + i * shentsize) for i in range(shnum)]
+        names = raw[shstrndx]
+        self.sections = []
+        for sh in raw:
+            name = self._cstr(names[4] + sh[0])
+            self.sections.append({"name": name, "type": sh[1], "flags": sh[2], "addr": sh[3],
+                                  "offset": sh[4], "size": sh[5], "link": sh[6]})
+
+    def _cstr(self, off):
+        end = self.data.index(b"\0", off)
+        return self.data[off:end].decode("latin-1")
+
+    def section(self, name):
+        for s in self.sections:
+            if s["name"] == name:
+                return s
+        return None
+
+    def symbol(self, wanted):
+        for s in self.sections:
+            if s["type"] != SHT_SYMTAB:
+                continue
+            strtab = self.sections[s["link"]]
+            for off in range(s["offset"], s["offset"] + s["size"], 16):
+                name, value, size, _, _, _ = struct.unpack_from("<IIIBBH", self.data, off)
+                if self._cstr(strtab["offset"] + name) == wanted:
+                    return value, size
+        raise KeyError(wanted)
+
+    def string_at(self, addr, section=None):
+        """Read a NUL terminated string at a run-time address (or offset into `section`)."""
+        candidates = [section] if section else [s for s in self.sections if s["flags"] & SHF_ALLOC]
+        for s in candidates:
+            if s and s["addr"] <= addr < s["addr"] + s["size"]:
+                return self._cstr(s["offset"] + addr - s["addr"])
+        return None
+
+
+def render(elf, fmt, words):
+    out = []
+    pos = 0
+    args = iter(words)
+
+    def word():
+        return next(args, 0)
+
+    for m in CONV_RE.finditer(fmt):
+        out.append(fmt[pos:m.start()])
+        pos = m.end()
+        flags, width, prec, length, conv = m.groups()
+        if conv == "%":
+            out.append("%")
+            continue
+        if width == "*":
+            width = str(struct.unpack("<i", struct.pack("<I", word()))[0])
+        if prec == "*":
+            prec = str(word())
+        spec = "%" + flags + (width or "") + ("." + prec if prec is not None else "")
+
+        if conv in "fFeEgG":
+            value = struct.unpack("<f", struct.pack("<I", word()))[0]
+            out.append((spec + conv) % value)
+            continue
+
+        if length == "ll":
+            lo, hi = word(), word()
+            value = lo | (hi << 32)
+            bits = 64
+        else:
+            value = word()
+            bits = 32
+        if length == "hh":
+            value &= 0xFF
+            bits = 8
+        elif length == "h":
+            value &= 0xFFFF
+            bits = 16
+
+        if conv in "di":
+            if value >> (bits - 1):
+                value -= 1 << bits
+            out.append((spec + "d") % value)
+        elif conv == "u":
+            out.append((spec + "d") % value)
+        elif conv in "xXo":
+            out.append((spec + conv) % value)
+        elif conv == "b":
+            text = format(value, "b")
+            if "#" in flags:
+                text = "0b" + text
+            out.append(text.rjust(int(width or 0), "0" if "0" in flags else " "))
+        elif conv == "c":
+            out.append((spec + "c") % chr(value & 0xFF))
+        elif conv == "p":
+            out.append("0x%08X" % value)
+        elif conv == "s":
+            text = elf.string_at(value)
+            out.append((spec + "s") % (text if text is not None else "<str@0x%08X>" % value))
+    out.append(fmt[pos:])
+    return "".join(out)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("elf")
+    ap.add_argument("dump")
+    ap.add_argument("--base", type=lambda v: int(v, 0), default=None,
+                    help="address of the first byte of the dump (default: dump starts at log_ring)")
+    args = ap.parse_args()
+
+    elf = Elf(args.elf)
+    logstr = elf.section(".logstr")
+    if logstr is None:
+        sys.exit("no .logstr section in %s" % args.elf)
+
+    with open(args.dump, "rb") as f:
+        dump = f.read()
+    offset = 0
+    if args.base is not None:
+        ring_addr, _ = elf.symbol("log_ring")
+        offset = ring_addr - args.base
+
+    magic, size, clock_hz, head, tail, used, dropped = struct.unpack_from("<7I", dump, offset)
+    if magic != LOG_RING_MAGIC:
+        sys.exit("bad log ring magic 0x%08X" % magic)
+    data = struct.unpack_from("<%dI" % size, dump, offset + 28)
+
+    if dropped:
+        print("# %d older records were overwritten" % dropped)
+
+    pos, left = tail, used
+    while left > 0:
+        hdr = data[pos]
+        if hdr == LOG_RING_PAD:
+            left -= size - pos
+            pos = 0
+            continue
+        nwords = (hdr >> 23) & 0x1F
+        level = (hdr >> 28) & 0x0F
+        fmt = elf.string_at(hdr & 0x7FFFFF, logstr)
+        stamp = data[pos + 1]
+        words = data[pos + 2:pos + 2 + nwords]
+        text = render(elf, fmt, words) if fmt is not None else "<unknown format 0x%06X>" % (hdr & 0x7FFFFF)
+        if clock_hz:
+            print("[%12.6f] %s: %s" % (stamp / clock_hz, LEVELS[level] if level < len(LEVELS) else "?", text))
+        else:
+            print("[%10u] %s: %s" % (stamp, LEVELS[level] if level < len(LEVELS) else "?", text))
+        pos += 2 + nwords
+        left -= 2 + nwords
+        if pos >= size:
+            pos = 0
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,136 @@
+"""LZSS compressor for update images, matching boot/update/lzss.c.
+
+Stream:  "LZ" | window bits | count bits | original length (u32 LE) | bits
+The bits are packed MSB first:
+  1 + 8 bits                  literal byte
+  0 + W bits + C bits         copy (count - 1) + 1 bytes from (index + 1) back
+The last byte is padded with zero bits. The decoder stops at the original
+length, so the padding is never decoded.
+
+The parse is optimal for these fixed code lengths: the longest match at every
+position is found through hash chains, then a backward pass picks the cheapest
+mix of literals and (possibly shortened) copies.
+"""
+
+import struct
+
+MAGIC = b"LZ"
+HEADER_SIZE = 8
+WINDOW_BITS = 12
+COUNT_BITS = 5
+CHAIN_DEPTH = 64
+
+
+class _BitWriter:
+    def __init__(self):
+        self.out = bytearray()
+        self.acc = 0
+        self.n = 0
+
+    def put(self, value, bits):
+        self.acc = (self.acc << bits) | value
+        self.n += bits
+        while self.n >= 8:
+            self.n -= 8
+            self.out.append((self.acc >> self.n) & 0xFF)
+        self.acc &= (1 << self.n) - 1
+
+    def flush(self):
+        if self.n:
+            self.out.append((self.acc << (8 - self.n)) & 0xFF)
+            self.n = 0
+        return bytes(self.out)
+
+
+def _longest_matches(data, window, max_len):
+    """(offset, length) of the longest match ending the window at every position."""
+    n = len(data)
+    head = {}
+    prev = [-1] * n
+    best = [(0, 0)] * n
+    for i in range(n):
+        if i + 2 > n:
+            break
+        key = data[i:i + 2]
+        j = head.get(key, -1)
+        prev[i] = j
+        head[key] = i
+        limit = min(max_len, n - i)
+        blen, boff, depth = 0, 0, CHAIN_DEPTH
+        while j >= 0 and i - j <= window and depth:
+            if data[j + blen:j + blen + 1] == data[i + blen:i + blen + 1]:
+                k = 2
+                while k < limit and data[j + k] == data[i + k]:
+                    k += 1
+                if k > blen:
+                    blen, boff = k, i - j
+                    if k == limit:
+                        break
+            j = prev[j]
+            depth -= 1
+        best[i] = (boff, blen)
+    return best
+
+
+def compress(data, window_bits=WINDOW_BITS, count_bits=COUNT_BITS):
+    window = 1 << window_bits
+    max_len = 1 << count_bits
+    lit_cost = 9
+    copy_cost = 1 + window_bits + count_bits
+    n = len(data)
+    matches = _longest_matches(data, window, max_len)
+
+    # cost[i]: fewest bits to code data[i:]; choice[i]: 0 = literal, else copy length
+    cost = [0] * (n + 1)
+    choice = [0] * n
+    for i in range(n - 1, -1, -1):
+        cost[i] = lit_cost + cost[i + 1]
+        off, length = matches[i]
+        for k in range(2, length + 1):
+            c = copy_cost + cost[i + k]
+            if c < cost[i]:
+                cost[i] = c
+                choice[i] = k
+
+    w = _BitWriter()
+    i = 0
+    while i < n:
+        k = choice[i]
+        if k:
+            w.put(0, 1)
+            w.put(matches[i][0] - 1, window_bits)
+            w.put(k - 1, count_bits)
+            i += k
+        else:
+            w.put(0x100 | data[i], 9)
+            i += 1
+    return MAGIC + bytes([window_bits, count_bits]) + struct.pack("<I", n) + w.flush()
+
+
+def decompress(blob):
+    if len(blob) < HEADER_SIZE or blob[:2] != MAGIC:
+        raise ValueError("not an LZSS stream")
+    window_bits, count_bits = blob[2], blob[3]
+    (n,) = struct.unpack_from("<I", blob, 4)
+    bits = int.from_bytes(blob[HEADER_SIZE:], "big")
+    left = 8 * (len(blob) - HEADER_SIZE)
+    out = bytearray()
+
+    def take(k):
+        nonlocal left
+        if k > left:
+            raise ValueError("truncated LZSS stream")
+        left -= k
+        return (bits >> left) & ((1 << k) - 1)
+
+    while len(out) < n:
+        if take(1):
+            out.append(take(8))
+        else:
+            back = take(window_bits) + 1
+            count = take(count_bits) + 1
+            if back > len(out):
+                raise ValueError("LZSS copy before start of data")
+            for _ in range(count):
+                out.append(out[-back])
+    return bytes(out[:n])
@@ -0,0 +1,290 @@
+#!/usr/bin/env python3
+"""Memory footprint report from the GNU ld map file (demo.map).
+
+Every input section in the map is charged to the object it came from and to
+the memory region (FLASH, RAM, CCMRAM, NOINIT from the linker script) that
+holds it. Sections with a load address in another region (.data, .ccmram)
+are charged to both: RAM for the run-time copy, FLASH for the initial values.
+Alignment padding is charged to "*fill* (<output section>)", so the heap and
+stack reservation shows up as "*fill* (._user_heap_stack)".
+
+The report lists per-object (or, with --modules, per-directory) sizes and the
+use of each region. With --baseline it also prints what changed since the
+stored baseline; --update writes the current numbers as the new baseline.
+
+The exit status is 1 if a region is over its length in the linker script, over
+a --budget, or grew more than --max-growth bytes since the baseline. A missing
+baseline file is reported on stderr; with --max-growth it is also a failure.
+
+usage: map_report.py demo.map
+       map_report.py demo.map --modules --top 20
+       map_report.py demo.map --baseline tools/memory_BOOT.json --budget FLASH=40K --max-growth 512
+       map_report.py demo.map --baseline tools/memory_BOOT.json --update
+"""
+
+import argparse
+import json
+import os
+import re
+import sys
+
+MEMORY_RE = re.compile(r"^(\S+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)")
+OUTPUT_RE = re.compile(r"^(\S+)(?:\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)(?:\s+load address 0x([0-9a-fA-F]+))?)?\s*$")
+CONT_RE = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)(?:\s+load address 0x([0-9a-fA-F]+))?\s*(.*)$")
+INPUT_RE = re.compile(r"^ (\S+)(?:\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s*(.*))?$")
+FILL_RE = re.compile(r"^ \*fill\*\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)")
+OBJ_DIR_RE = re.compile(r"^.*CMakeFiles/[^/]+\.dir/")
+ARCHIVE_RE = re.compile(r"^(.*\.a)\((.*)\)$")
+
+# sections that take no space on the target
+SKIP_SECTIONS = ("/DISCARD/", ".comment", ".ARM.attributes", ".debug")
+
+
+def parse_size(text):
+    """'48K', '1M', '0x400' or '1024' -> bytes."""
+    text = text.strip().upper()
+    scale = 1
+    if text.endswith("K"):
+        scale, text = 1024, text[:-1]
+    elif text.endswith("M"):
+        scale, text = 1024 * 1024, text[:-1]
+    return int(text, 0) * scale
+
+
+def object_name(path):
+    """Short, build-directory independent name for an input file."""
+    path = path.strip()
+    m = ARCHIVE_RE.match(path)
+    if m:
+        return "%s(%s)" % (os.path.basename(m.group(1)), m.group(2))
+    if OBJ_DIR_RE.match(path):
+        path = OBJ_DIR_RE.sub("", path)
+        return path[:-4] if path.endswith(".obj") else path[:-2] if path.endswith(".o") else path
+    if path.startswith("/"):
+        return os.path.basename(path)
+    return path
+
+
+def module_name(obj):
+    """Directory of a source file, the archive of an archive member."""
+    m = ARCHIVE_RE.match(obj)
+    if m:
+        return m.group(1)
+    if obj.startswith("*fill*"):
+        return "*fill*"
+    return os.path.dirname(obj) or obj
+
+
+class MapFile:
+    def __init__(self, path):
+        with open(path, "r", errors="replace") as f:
+            self.lines = f.read().splitlines()
+        self.regions = []       # (name, origin, length)
+        self.usage = {}         # object -> {region: bytes}
+        self._parse_memory()
+        self._parse_sections()
+
+    def _parse_memory(self):
+        start = self.lines.index("Memory Configuration")
+        for line in self.lines[start + 1:]:
+            if line.startswith("Linker script and memory map"):
+                break
+            m = MEMORY_RE.match(line)
+            if m and m.group(1) not in ("Name", "*default*"):
+                self.regions.append((m.group(1), int(m.group(2), 16), int(m.group(3), 16)))
+
+    def region_of(self, addr):
+        for name, origin, length in self.regions:
+            if origin <= addr < origin + length:
+                return name
+        return None
+
+    def _charge(self, obj, vma, size, lma_offset):
+        if size == 0:
+            return
+        regions = [self.region_of(vma)]
+        if lma_offset:
+            regions.append(self.region_of(vma + lma_offset))
+        use = self.usage.setdefault(obj, {})
+        for region in regions:
+            if region is not None:
+                use[region] = use.get(region, 0) + size
+
+    def _parse_sections(self):
+        start = self.lines.index("Linker script and memory map")
+        out_name, lma_offset, skip = None, 0, True
+        pending = None          # long names put address and size on the next line
+        for line in self.lines[start + 1:]:
+            if not line.strip():
+                pending = None
+                continue
+
+            if pending is not None:
+                m = CONT_RE.match(line)
+                kind, name = pending
+                pending = None
+                if m:
+                    vma, size = int(m.group(1), 16), int(m.group(2), 16)
+                    if kind == "out":
+                        lma = int(m.group(3), 16) if m.group(3) else vma
+                        out_name, lma_offset = name, lma - vma
+                        skip = name.startswith(SKIP_SECTIONS)
+                    elif not skip:
+                        self._charge(object_name(m.group(4)), vma, size, lma_offset)
+                    continue
+
+            if not line[0].isspace():
+                m = OUTPUT_RE.match(line)
+                if not m or line.startswith(("LOAD ", "OUTPUT(", "START GROUP", "END GROUP")):
+                    continue
+                if m.group(2) is None:
+                    pending = ("out", m.group(1))
+                    out_name, skip = m.group(1), True
+                    continue
+                vma = int(m.group(2), 16)
+                lma = int(m.group(4), 16) if m.group(4) else vma
+                out_name, lma_offset = m.group(1), lma - vma
+                skip = out_name.startswith(SKIP_SECTIONS)
+                continue
+
+            if skip:
+                continue
+
+            m = FILL_RE.match(line)
+            if m:
+                self._charge("*fill* (%s)" % out_name, int(m.group(1), 16), int(m.group(2), 16), lma_offset)
+                continue
+
+            m = INPUT_RE.match(line)
+            if not m or m.group(1).startswith("*"):
+                continue
+            if m.group(2) is None:
+                pending = ("in", m.group(1))
+                continue
+            if m.group(4):
+                self._charge(object_name(m.group(4)), int(m.group(2), 16), int(m.group(3), 16), lma_offset)
+
+    def totals(self):
+        total = {name: 0 for name, _, _ in self.regions}
+        for use in self.usage.values():
+            for region, size in use.items():
+                total[region] += size
+        return total
+
+    def grouped(self, modules):
+        if not modules:
+            return self.usage
+        groups = {}
+        for obj, use in self.usage.items():
+            g = groups.setdefault(module_name(obj), {})
+            for region, size in use.items():
+                g[region] = g.get(region, 0) + size
+        return groups
+
+
+def print_table(rows, columns, top, title):
+    width = max([len(title)] + [len(name) for name in rows]) + 2
+    print("%-*s" % (width, title) + "".join("%10s" % c for c in columns))
+    order = sorted(rows.items(), key=lambda kv: (-sum(kv[1].values()), kv[0]))
+    for name, use in order[:top] if top else order:
+        print("%-*s" % (width, name) + "".join("%10d" % use.get(c, 0) for c in columns))
+    if top and len(order) > top:
+        print("... %d more" % (len(order) - top))
+
+
+def print_diff(rows, base_rows, columns):
+    changed = []
+    for name in sorted(set(rows) | set(base_rows)):
+        new, old = rows.get(name, {}), base_rows.get(name, {})
+        delta = [new.get(c, 0) - old.get(c, 0) for c in columns]
+        if any(delta):
+            tag = "new" if name not in base_rows else "gone" if name not in rows else ""
+            changed.append((name, delta, tag))
+    if not changed:
+        print("no change since baseline")
+        return
+    changed.sort(key=lambda x: (-sum(abs(d) for d in x[1]), x[0]))
+    width = max(len(x[0]) for x in changed) + 2
+    print("%-*s" % (width, "changed since baseline") + "".join("%10s" % c for c in columns))
+    for name, delta, tag in changed:
+        print("%-*s" % (width, name) + "".join("%+10d" % d if d else "%10s" % "." for d in delta)
+              + ("  " + tag if tag else ""))
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("map", help="GNU ld map file")
+    ap.add_argument("--modules", action="store_true", help="group by source directory / archive")
+    ap.add_argument("--top", type=int, default=0, help="only list the N largest entries")
+    ap.add_argument("--baseline", help="JSON baseline to diff against (and to write with --update)")
+    ap.add_argument("--update", action="store_true", help="write the current numbers to --baseline")
+    ap.add_argument("--budget", action="append", default=[], metavar="REGION=SIZE",
+                    help="fail if REGION uses more than SIZE (e.g. FLASH=40K); may repeat")
+    ap.add_argument("--max-growth", type=parse_size, metavar="BYTES",
+                    help="fail if any region grew more than BYTES since the baseline")
+    args = ap.parse_args()
+
+    mf = MapFile(args.map)
+    columns = [name for name, _, _ in mf.regions]
+    rows = mf.grouped(args.modules)
+    totals = mf.totals()
+
+    print_table(rows, columns, args.top, "module" if args.modules else "object")
+    print()
+
+    budgets = {}
+    for item in args.budget:
+        region, _, size = item.partition("=")
+        if region not in totals:
+            sys.exit("unknown region %s (have %s)" % (region, ", ".join(columns)))
+        budgets[region] = parse_size(size)
+
+    base = None
+    if args.baseline and not args.update:
+        if os.path.exists(args.baseline):
+            with open(args.baseline) as f:
+                base = json.load(f)
+        else:
+            # say so loudly: a missing baseline must not look like "no change"
+            print("WARNING: no baseline at %s, nothing to diff against; build the memory_baseline "
+                  "target (--update) and commit the file" % args.baseline, file=sys.stderr)
+
+    failed = []
+    if args.max_growth is not None and base is None and not args.update:
+        failed.append("--max-growth %d given but there is no baseline to compare with" % args.max_growth)
+    print("%-10s%10s%10s%8s%10s%10s" % ("region", "used", "size", "use", "budget", "delta"))
+    for name, _, length in mf.regions:
+        used = totals[name]
+        budget = budgets.get(name)
+        delta = used - base["regions"].get(name, 0) if base else None
+        print("%-10s%10d%10d%7.1f%%%10s%10s" % (name, used, length, 100.0 * used / length if length else 0,
+                                                budget if budget is not None else "-",
+                                                "%+d" % delta if delta is not None else "-"))
+        if used > length:
+            failed.append("%s: %d bytes over the region" % (name, used - length))
+        if budget is not None and used > budget:
+            failed.append("%s: %d bytes over the %d byte budget" % (name, used - budget, budget))
+        if delta is not None and args.max_growth is not None and delta > args.max_growth:
+            failed.append("%s: grew %d bytes, more than %d" % (name, delta, args.max_growth))
+
+    if base:
+        print()
+        print_diff(mf.grouped(False) if not args.modules else rows,
+                   base["objects"] if not args.modules else base.get("modules", {}), columns)
+
+    if args.update:
+        if not args.baseline:
+            sys.exit("--update needs --baseline")
+        with open(args.baseline, "w") as f:
+            json.dump({"regions": totals, "objects": mf.usage, "modules": mf.grouped(True)},
+                      f, indent=1, sort_keys=True)
+            f.write("\n")
+        print("baseline written to %s" % args.baseline)
+
+    for msg in failed:
+        print("FAIL " + msg, file=sys.stderr)
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,87 @@
+/*
+ * user-038：boot/verify/aes.c 的主机入口，供 test_aes.py 调用。
+ *   aes_crypt <密钥> <IV> <输入> <输出> <最大分块> [种子]
+ * 密钥和 IV 为十六进制。先跑 aes_selftest()，再把输入按 1..最大分块 的随机长度送入
+ * aes_ctr_crypt，分块一般不落在 16 字节边界上；种子为奇数时原地计算。
+ * 退出码：0 成功，1 自检失败或结束后上下文未清除，2 aes_ctr_init 拒绝了密钥，100 参数或文件错误。
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "aes.h"
+#include "test_util.h"
+
+
+static long unhex(const char *s, uint8_t *out, size_t max)
+{
+    size_t n = 0;
+
+    for (; s[0] && s[1]; s += 2)
+    {
+        unsigned int b;
+
+        if (n >= max || sscanf(s, "%2x", &b) != 1)
+            return -1;
+        out[n++] = (uint8_t)b;
+    }
+    return *s ? -1 : (long)n;
+}
+
+static aes_ctr_ctx_t ctx;
+
+int main(int argc, char **argv)
+{
+    uint8_t key[40], iv[AES_BLOCK_SIZE], *in, *out;
+    long key_len;
+    uint32_t len, done, n, max_chunk;
+    bool in_place;
+    FILE *f;
+
+    if (argc < 6)
+    {
+        fprintf(stderr, "usage: %s <key> <iv> <in> <out> <max chunk> [seed]\n", argv[0]);
+        return 100;
+    }
+    key_len = unhex(argv[1], key, sizeof(key));
+    max_chunk = (uint32_t)strtoul(argv[5], NULL, 0);
+    if (argc > 6)
+        test_rand_state = strtoull(argv[6], NULL, 0) | 1U;
+    in_place = argc > 6 && (strtoull(argv[6], NULL, 0) & 1U);
+    if (key_len < 0 || unhex(argv[2], iv, sizeof(iv)) != (long)sizeof(iv) || max_chunk == 0)
+        return 100;
+
+    TEST_CHECK(aes_selftest());
+
+    f = fopen(argv[3], "rb");
+    if (f == NULL)
+        return 100;
+    fseek(f, 0, SEEK_END);
+    len = (uint32_t)ftell(f);
+    fseek(f, 0, SEEK_SET);
+    in = malloc(len + 1U);
+    out = in_place ? in : malloc(len + 1U);
+    if (in == NULL || out == NULL || fread(in, 1, len, f) != len)
+        return 100;
+    fclose(f);
+
+    if (!aes_ctr_init(&ctx, key, (uint32_t)key_len, iv))
+        return 2;
+    for (done = 0; done < len; done += n)
+    {
+        n = 1U + (uint32_t)(test_rand() % max_chunk);
+        if (n > len - done)
+            n = len - done;
+        aes_ctr_crypt(&ctx, out + done, in + done, n);
+    }
+    // 空的调用不改变密钥流位置
+    aes_ctr_crypt(&ctx, out + len, in + len, 0);
+    aes_ctr_end(&ctx);
+    for (uint32_t i = 0; i < sizeof(ctx.rk) / sizeof(ctx.rk[0]); i++)
+        TEST_CHECK(ctx.rk[i] == 0);
+
+    f = fopen(argv[4], "wb");
+    if (f == NULL || fwrite(out, 1, len, f) != len)
+        return 100;
+    fclose(f);
+
+    return test_failed != 0;
+}
@@ -0,0 +1,46 @@
+/*
+ * user-034：512 KiB 镜像的软件 CRC 吞吐，slicing-by-8 与逐位计算对比 (MB/s)。
+ * 主机上的数字只用于比较两种算法；目标板上 DMA 与软件的对比由 verify_bench() 输出。
+ */
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "crc32.h"
+#include "test_util.h"
+
+
+#define IMAGE_SIZE  (512U * 1024U)
+
+static uint32_t crc32_ref(const uint8_t *p, uint32_t len)
+{
+    uint32_t crc = CRC32_INIT, w;
+
+    for (uint32_t i = 0; i < len; i += 4)
+    {
+        memcpy(&w, p + i, 4);
+        crc ^= w;
+        for (int b = 0; b < 32; b++)
+            crc = (crc & 0x80000000U) ? (crc << 1) ^ 0x04C11DB7U : (crc << 1);
+    }
+    return crc;
+}
+
+static uint8_t image[IMAGE_SIZE];
+
+int main(int argc, char **argv)
+{
+    volatile uint32_t sink;
+    double t_sw, t_ref;
+
+    for (uint32_t i = 0; i < IMAGE_SIZE; i++)
+        image[i] = (uint8_t)test_rand();
+    crc32_sw_init();
+
+    TEST_BENCH(t_sw, i, 1, sink = crc32_sw(image, IMAGE_SIZE));
+    TEST_BENCH(t_ref, i, 1, sink = crc32_ref(image, IMAGE_SIZE));
+    (void)sink;
+
+    printf("crc 512 KiB: bitwise %8.1f MB/s, slicing-8 %8.1f MB/s\n",
+           IMAGE_SIZE / t_ref * 1e3, IMAGE_SIZE / t_sw * 1e3);
+    return 0;
+}
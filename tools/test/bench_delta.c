@@ -0,0 +1,74 @@
+/*
+ * user-040：delta_write 的主机还原耗时（每个镜像的 ms 和 MB/s，按新镜像字节数计）。
+ *   bench_delta <旧镜像> <补丁> [分块]
+ * 补丁由 tools/image_tool.py diff 生成，分块默认 256 字节。
+ */
+#include <stdint.h>
+#include <stdlib.h>
+#include "delta.h"
+#include "test_util.h"
+
+
+static uint32_t restored;
+
+static bool bench_sink(void *arg, const uint8_t *data, uint32_t len)
+{
+    restored += len;
+    return true;
+}
+
+static uint8_t *load(const char *path, uint32_t *len)
+{
+    FILE *f = fopen(path, "rb");
+    uint8_t *buf;
+
+    if (f == NULL)
+        return NULL;
+    fseek(f, 0, SEEK_END);
+    *len = (uint32_t)ftell(f);
+    fseek(f, 0, SEEK_SET);
+    buf = malloc(*len + 1U);
+    if (buf != NULL && fread(buf, 1, *len, f) != *len)
+    {
+        free(buf);
+        buf = NULL;
+    }
+    fclose(f);
+    return buf;
+}
+
+static delta_t d;
+
+int main(int argc, char **argv)
+{
+    uint8_t *old, *patch;
+    uint32_t old_len, len, chunk, size = 0;
+    double t;
+
+    if (argc < 3)
+    {
+        fprintf(stderr, "usage: %s <old image> <patch> [chunk]\n", argv[0]);
+        return 1;
+    }
+    chunk = argc > 3 ? (uint32_t)strtoul(argv[3], NULL, 0) : 256U;
+    old = load(argv[1], &old_len);
+    patch = load(argv[2], &len);
+    if (old == NULL || patch == NULL || chunk == 0)
+        return 1;
+
+    TEST_BENCH(t, i, 1, {
+        delta_init(&d, old, old_len, bench_sink, NULL);
+        restored = 0;
+        for (uint32_t done = 0; done < len; done += chunk)
+            delta_write(&d, patch + done, len - done < chunk ? len - done : chunk);
+        if (delta_finish(&d) != DELTA_OK)
+            return 1;
+        size = restored;
+    });
+
+    printf("delta %u -> %u bytes, chunk %u: %.3f ms, %8.1f MB/s\n", (unsigned)len, (unsigned)size,
+           (unsigned)chunk, t * 1e-6, size / t * 1e3);
+    free(old);
+    free(patch);
+    return 0;
+}
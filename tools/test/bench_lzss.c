@@ -0,0 +1,61 @@
+/*
+ * user-039：lzss_write 的主机解压速度 (MB/s，按解压后的字节数计)。
+ *   bench_lzss <压缩文件> [分块]
+ * 压缩文件由 tools/image_tool.py compress 生成，分块默认 256 字节（串口接收的典型块长）。
+ */
+#include <stdint.h>
+#include <stdlib.h>
+#include "lzss.h"
+#include "test_util.h"
+
+
+static uint32_t unpacked;
+
+static bool bench_sink(void *arg, const uint8_t *data, uint32_t len)
+{
+    unpacked += len;
+    return true;
+}
+
+static lzss_t z;
+
+int main(int argc, char **argv)
+{
+    FILE *f;
+    uint8_t *buf;
+    uint32_t len, chunk, size = 0;
+    double t;
+
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s <compressed image> [chunk]\n", argv[0]);
+        return 1;
+    }
+    chunk = argc > 2 ? (uint32_t)strtoul(argv[2], NULL, 0) : 256U;
+
+    f = fopen(argv[1], "rb");
+    if (f == NULL || chunk == 0)
+        return 1;
+    fseek(f, 0, SEEK_END);
+    len = (uint32_t)ftell(f);
+    fseek(f, 0, SEEK_SET);
+    buf = malloc(len);
+    if (buf == NULL || fread(buf, 1, len, f) != len)
+        return 1;
+    fclose(f);
+
+    TEST_BENCH(t, i, 1, {
+        lzss_init(&z, bench_sink, NULL);
+        unpacked = 0;
+        for (uint32_t done = 0; done < len; done += chunk)
+            lzss_write(&z, buf + done, len - done < chunk ? len - done : chunk);
+        if (lzss_finish(&z) != LZSS_OK)
+            return 1;
+        size = unpacked;
+    });
+
+    printf("lzss %u -> %u bytes, chunk %u: %8.1f MB/s\n", (unsigned)len, (unsigned)size,
+           (unsigned)chunk, size / t * 1e3);
+    free(buf);
+    return 0;
+}
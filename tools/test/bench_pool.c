@@ -0,0 +1,51 @@
+/*
+ * user-049：pool_alloc/pool_free 与 glibc malloc/free 的主机耗时对比。
+ * 后进先出，深度 1..16，请求大小在三个等级之间轮换；每次分配或释放的 ns。
+ * 主机上的临界区是空操作，目标板上 pool 还要加上 PRIMASK 的开关。
+ */
+#include <stdint.h>
+#include <stdlib.h>
+#include "pool.h"
+#include "test_util.h"
+
+
+POOL_BUFFER(small_buf, 32, 16, POOL_SRAM);
+POOL_BUFFER(mid_buf, 128, 16, POOL_SRAM);
+POOL_BUFFER(large_buf, 512, 16, POOL_SRAM);
+
+static const uint32_t sizes[] = { 20, 100, 32, 400, 8, 128, 512, 60 };
+
+#define SIZE_OF(k)  sizes[(k) & 7U]
+
+int main(int argc, char **argv)
+{
+    static pool_class_t classes[3];
+    static pool_t pool;
+    void *volatile held[16];
+    long n = argc > 1 ? atol(argv[1]) : 200000;
+    double t_pool, t_malloc;
+
+    pool_class_init(&classes[0], small_buf, 32, 16);
+    pool_class_init(&classes[1], mid_buf, 128, 16);
+    pool_class_init(&classes[2], large_buf, 512, 16);
+    pool_init(&pool, classes, 3);
+
+    printf("depth      pool    malloc  (ns per alloc or free)\n");
+    for (int depth = 1; depth <= 16; depth *= 2)
+    {
+        TEST_BENCH(t_pool, i, n, {
+            for (int k = 0; k < depth; k++)
+                held[k] = pool_alloc(&pool, SIZE_OF(i + k));
+            for (int k = depth - 1; k >= 0; k--)
+                pool_free(&pool, held[k]);
+        });
+        TEST_BENCH(t_malloc, i, n, {
+            for (int k = 0; k < depth; k++)
+                held[k] = malloc(SIZE_OF(i + k));
+            for (int k = depth - 1; k >= 0; k--)
+                free(held[k]);
+        });
+        printf("%5d  %8.2f  %8.2f\n", depth, t_pool / (2 * depth), t_malloc / (2 * depth));
+    }
+    return 0;
+}
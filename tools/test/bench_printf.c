@@ -0,0 +1,61 @@
+/*
+ * printf 耗时，当前实现与原实现对比（每次调用的 ns）：
+ *   printf_   典型的升级日志行，输出经 _putchars 成段交出（原实现逐字符调用 _putchar）
+ *   snprintf_ 同一行写入 RAM，以及 64 位整数、十六进制
+ * 输出端什么也不做，只计格式化本身的开销。
+ */
+#include <stdint.h>
+#include <stdlib.h>
+#include "_printf_.h"
+#include "ref/printf_ref.h"
+#include "test_util.h"
+
+
+static volatile size_t sink;
+
+void _putchar(char character)
+{
+    sink += (unsigned char)character;
+}
+
+void _putchars(const char* data, size_t len)
+{
+    sink += len + (unsigned char)data[0];
+}
+
+void ref_putchar(char character)
+{
+    sink += (unsigned char)character;
+}
+
+#define LOG_LINE    "[%8u] update: block %u/%u at 0x%08x, %u bytes, crc %08x\n"
+#define LOG_ARGS(i) (unsigned)(i), (unsigned)((i) & 511), 512U, 0x08040000U + (unsigned)(i) * 256U, 256U, (unsigned)(i) * 2654435761U
+
+int main(int argc, char **argv)
+{
+    long n = argc > 1 ? atol(argv[1]) : 200000;
+    char buf[128];
+    double t_new, t_ref;
+
+    TEST_BENCH(t_new, i, n, printf_(LOG_LINE, LOG_ARGS(i)));
+    TEST_BENCH(t_ref, i, n, ref_printf_(LOG_LINE, LOG_ARGS(i)));
+    printf("%-28s %8.1f -> %8.1f ns\n", "printf_ log line", t_ref, t_new);
+
+    TEST_BENCH(t_new, i, n, snprintf_(buf, sizeof(buf), LOG_LINE, LOG_ARGS(i)));
+    TEST_BENCH(t_ref, i, n, ref_snprintf_(buf, sizeof(buf), LOG_LINE, LOG_ARGS(i)));
+    printf("%-28s %8.1f -> %8.1f ns\n", "snprintf_ log line", t_ref, t_new);
+
+    TEST_BENCH(t_new, i, n, snprintf_(buf, sizeof(buf), "%llu %lld", (unsigned long long)i * 0x9E3779B97F4A7C15ULL, -(long long)i * 1000003LL));
+    TEST_BENCH(t_ref, i, n, ref_snprintf_(buf, sizeof(buf), "%llu %lld", (unsigned long long)i * 0x9E3779B97F4A7C15ULL, -(long long)i * 1000003LL));
+    printf("%-28s %8.1f -> %8.1f ns\n", "snprintf_ 64-bit decimal", t_ref, t_new);
+
+    TEST_BENCH(t_new, i, n, snprintf_(buf, sizeof(buf), "%08x %#llx", (unsigned)i * 2654435761U, (unsigned long long)i << 20));
+    TEST_BENCH(t_ref, i, n, ref_snprintf_(buf, sizeof(buf), "%08x %#llx", (unsigned)i * 2654435761U, (unsigned long long)i << 20));
+    printf("%-28s %8.1f -> %8.1f ns\n", "snprintf_ hex", t_ref, t_new);
+
+    TEST_BENCH(t_new, i, n, snprintf_(buf, sizeof(buf), "%-20s|%20s|", "left", "right"));
+    TEST_BENCH(t_ref, i, n, ref_snprintf_(buf, sizeof(buf), "%-20s|%20s|", "left", "right"));
+    printf("%-28s %8.1f -> %8.1f ns\n", "snprintf_ padded strings", t_ref, t_new);
+
+    return 0;
+}
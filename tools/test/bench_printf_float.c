@@ -0,0 +1,45 @@
+/*
+ * user-032：浮点转换耗时，原实现（double 乘法和 10 的幂表，近似）与当前的精确整数转换对比，
+ * 每次 snprintf_ 调用的 ns。float 参数走 24 位尾数的快速路径，double 参数走大数路径。
+ * 主机有硬件 double，原实现在这里没有软件浮点的开销；目标上原实现的每次 double 运算都是库调用。
+ */
+#include <stdint.h>
+#include <stdlib.h>
+#include "_printf_.h"
+#include "ref/printf_ref.h"
+#include "test_util.h"
+
+
+void _putchar(char character)
+{
+    (void)character;
+}
+
+void ref_putchar(char character)
+{
+    (void)character;
+}
+
+#define F_ARG(i)    ((double)((float)(i) * 0.37f - 1000.0f))
+#define D_ARG(i)    ((double)(i) * 12345.678901 + 0.1)
+
+int main(int argc, char **argv)
+{
+    static const char *const fmt[] = {"%.3f", "%f", "%e", "%g"};
+    long n = argc > 1 ? atol(argv[1]) : 200000;
+    char buf[128];
+
+    printf("%-6s %24s %24s\n", "", "float argument", "double argument");
+    for (size_t k = 0; k < sizeof(fmt) / sizeof(fmt[0]); k++)
+    {
+        double f_new, f_ref, d_new, d_ref;
+
+        TEST_BENCH(f_new, i, n, snprintf_(buf, sizeof(buf), fmt[k], F_ARG(i)));
+        TEST_BENCH(f_ref, i, n, ref_snprintf_(buf, sizeof(buf), fmt[k], F_ARG(i)));
+        TEST_BENCH(d_new, i, n, snprintf_(buf, sizeof(buf), fmt[k], D_ARG(i)));
+        TEST_BENCH(d_ref, i, n, ref_snprintf_(buf, sizeof(buf), fmt[k], D_ARG(i)));
+        printf("%-6s %8.1f -> %8.1f ns     %8.1f -> %8.1f ns\n", fmt[k], f_ref, f_new, d_ref, d_new);
+    }
+
+    return 0;
+}
@@ -0,0 +1,48 @@
+/*
+ * user-031：整数转换耗时，原实现（每位一次除法）与当前实现（十进制两位一步、/1e9 倒数乘法、
+ * 十六进制/八进制/二进制移位）对比，每次 snprintf_ 调用的 ns。
+ */
+#include <stdint.h>
+#include <stdlib.h>
+#include "_printf_.h"
+#include "ref/printf_ref.h"
+#include "test_util.h"
+
+
+void _putchar(char character)
+{
+    (void)character;
+}
+
+void ref_putchar(char character)
+{
+    (void)character;
+}
+
+#define V32(i)  ((uint32_t)(i) * 2654435761U)
+#define V64(i)  ((unsigned long long)(i) * 0x9E3779B97F4A7C15ULL)
+
+#define BENCH_PAIR(name, n, fmt, value) \
+    do { \
+        double t_new_, t_ref_; \
+        TEST_BENCH(t_new_, i, n, snprintf_(buf, sizeof(buf), fmt, value)); \
+        TEST_BENCH(t_ref_, i, n, ref_snprintf_(buf, sizeof(buf), fmt, value)); \
+        printf("%-16s %8.1f -> %8.1f ns\n", name, t_ref_, t_new_); \
+    } while (0)
+
+int main(int argc, char **argv)
+{
+    long n = argc > 1 ? atol(argv[1]) : 500000;
+    char buf[80];
+
+    BENCH_PAIR("%u", n, "%u", V32(i));
+    BENCH_PAIR("%d small", n, "%d", (int)(i & 1023) - 512);
+    BENCH_PAIR("%llu", n, "%llu", V64(i));
+    BENCH_PAIR("%lld", n, "%lld", -(long long)(V64(i) >> 1));
+    BENCH_PAIR("%08x", n, "%08x", V32(i));
+    BENCH_PAIR("%llx", n, "%llx", V64(i));
+    BENCH_PAIR("%o", n, "%o", V32(i));
+    BENCH_PAIR("%b", n, "%b", V32(i));
+
+    return 0;
+}
@@ -0,0 +1,36 @@
+#!/usr/bin/env python3
+"""Check digests computed by a host test against Python hashlib.
+
+Usage: check_digest.py <algorithm> <data file> <digest file>
+
+Each line of the digest file is "<offset> <length> <hex digest>" for
+data[offset:offset + length].
+"""
+
+import hashlib
+import sys
+
+
+def main():
+    algo, data_path, digest_path = sys.argv[1:4]
+    with open(data_path, "rb") as f:
+        data = f.read()
+
+    checked = bad = 0
+    with open(digest_path) as f:
+        for line in f:
+            off, length, digest = line.split()
+            off, length = int(off), int(length)
+            expect = hashlib.new(algo, data[off:off + length]).hexdigest()
+            checked += 1
+            if digest != expect:
+                bad += 1
+                if bad <= 20:
+                    print("%s %u+%u: %s, expected %s" % (algo, off, length, digest, expect))
+
+    print("%s: %u digests, %u mismatches" % (algo, checked, bad))
+    return 1 if bad or not checked else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,179 @@
+"""Test inputs shared by the host tool tests.
+
+firmware() returns the .text and .rodata sections of the ARM objects
+checked in under build/, so tests see real Thumb-2 code and constant data
+rather than only synthetic patterns.
+
+link() places those sections at a flash address and applies their
+R_ARM_ABS32 and R_ARM_THM_CALL relocations, which is all these objects use.
+Linking the same objects in another layout therefore changes branch offsets
+and literal pool addresses the way a real relink does.
+"""
+
+import glob
+import os
+import random
+import struct
+import zlib
+
+REPO_DIR = os.path.normpath(os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", ".."))
+
+SHT_PROGBITS = 1
+SHT_SYMTAB = 2
+SHT_REL = 9
+SHF_ALLOC = 0x2
+SHN_UNDEF = 0
+SHN_LORESERVE = 0xFF00
+STT_FUNC = 2
+R_ARM_ABS32 = 2
+R_ARM_THM_CALL = 10
+
+FLASH_BASE = 0x08010000
+RAM_BASE = 0x20000000
+
+
+def _elf_sections(blob):
+    """Yield (name, data) for the PROGBITS sections of an ELF32 LE object."""
+    if blob[:4] != b"\x7fELF" or blob[4] != 1 or blob[5] != 1:
+        return
+    (shoff,) = struct.unpack_from("<I", blob, 0x20)
+    shentsize, shnum, shstrndx = struct.unpack_from("<HHH", blob, 0x2E)
+    secs = [struct.unpack_from("<10I", blob, shoff + i * shentsize) for i in range(shnum)]
+    strtab = secs[shstrndx][4]
+    for name_off, sh_type, _, _, offset, size, _, _, _, _ in secs:
+        if sh_type != SHT_PROGBITS:
+            continue
+        end = blob.index(b"\0", strtab + name_off)
+        yield blob[strtab + name_off:end].decode(), blob[offset:offset + size]
+
+
+def firmware_objects():
+    """.text + .rodata of each checked-in object, in path order."""
+    objects = []
+    pattern = os.path.join(REPO_DIR, "build", "**", "*.obj")
+    for path in sorted(glob.glob(pattern, recursive=True)):
+        with open(path, "rb") as f:
+            blob = f.read()
+        code = b"".join(data for name, data in _elf_sections(blob)
+                        if name.startswith(".text") or name.startswith(".rodata"))
+        if code:
+            objects.append(code)
+    return objects
+
+
+def firmware():
+    return b"".join(firmware_objects())
+
+
+class _Object:
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            self.blob = blob = f.read()
+        (shoff,) = struct.unpack_from("<I", blob, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from("<HHH", blob, 0x2E)
+        self.secs = [struct.unpack_from("<10I", blob, shoff + i * shentsize) for i in range(shnum)]
+        strtab = self.secs[shstrndx][4]
+        self.names = [self._str(strtab, sec[0]) for sec in self.secs]
+        # sections linked into flash, in file order
+        self.code = [i for i, sec in enumerate(self.secs)
+                     if sec[1] == SHT_PROGBITS and sec[2] & SHF_ALLOC and sec[5] and
+                     (self.names[i].startswith(".text") or self.names[i].startswith(".rodata"))]
+        self.symbols = []
+        for sec in self.secs:
+            if sec[1] == SHT_SYMTAB:
+                names = self.secs[sec[6]][4]
+                for k in range(sec[5] // 16):
+                    name, value, _, info, _, shndx = struct.unpack_from("<IIIBBH", blob, sec[4] + k * 16)
+                    self.symbols.append((self._str(names, name), value, info, shndx))
+
+    def _str(self, table, off):
+        return self.blob[table + off:self.blob.index(b"\0", table + off)].decode()
+
+
+def _thumb_bl(hw1, hw2, offset):
+    """Re-encode a Thumb-2 BL/B.W for a byte offset from the instruction + 4."""
+    imm = (offset >> 1) & 0xFFFFFF
+    s = imm >> 23
+    j1 = ((imm >> 22) & 1 ^ 1) ^ s
+    j2 = ((imm >> 21) & 1 ^ 1) ^ s
+    hw1 = (hw1 & 0xF800) | (s << 10) | ((imm >> 11) & 0x3FF)
+    hw2 = (hw2 & 0xD000) | (j1 << 13) | (j2 << 11) | (imm & 0x7FF)
+    return hw1, hw2
+
+
+def link(skip=(), insert=None):
+    """Link the checked-in objects into one flash image at FLASH_BASE.
+
+    skip:   indices (into firmware_objects() order) of objects left out
+    insert: (index, data) places raw data before that object, moving
+            everything after it
+    """
+    paths = sorted(glob.glob(os.path.join(REPO_DIR, "build", "**", "*.obj"), recursive=True))
+    objects = [_Object(p) for p in paths]
+    objects = [o for o in objects if o.code]
+
+    # layout: code sections in flash, everything else at stable RAM addresses
+    image = bytearray()
+    addr = {}
+    ram = RAM_BASE
+    for n, obj in enumerate(objects):
+        if insert is not None and insert[0] == n:
+            image += insert[1]
+        for i, sec in enumerate(obj.secs):
+            if sec[2] & SHF_ALLOC and i not in obj.code:
+                addr[n, i] = ram
+                ram += (sec[5] + 7) & ~7
+        if n in skip:
+            continue
+        for i in obj.code:
+            align = max(obj.secs[i][8], 1)
+            image += bytes(-len(image) % align)
+            addr[n, i] = FLASH_BASE + len(image)
+            image += obj.blob[obj.secs[i][4]:obj.secs[i][4] + obj.secs[i][5]]
+
+    def sym_addr(n, sym):
+        name, value, info, shndx = sym
+        if SHN_UNDEF < shndx < SHN_LORESERVE:
+            base = addr.get((n, shndx))
+            if base is not None:
+                return base + value, info & 0xF
+        return None
+
+    globals_ = {}
+    for n, obj in enumerate(objects):
+        for sym in obj.symbols:
+            if sym[0] and sym[2] >> 4 in (1, 2):
+                found = sym_addr(n, sym)
+                if found is not None:
+                    globals_.setdefault(sym[0], found)
+
+    for n, obj in enumerate(objects):
+        if n in skip:
+            continue
+        for sec in obj.secs:
+            target = sec[7]
+            if sec[1] != SHT_REL or target not in obj.code:
+                continue
+            place = addr[n, target]
+            for k in range(sec[5] // 8):
+                offset, info = struct.unpack_from("<II", obj.blob, sec[4] + k * 8)
+                sym = obj.symbols[info >> 8]
+                found = sym_addr(n, sym) or globals_.get(sym[0])
+                if found is None:
+                    # library code that is not checked in: a fixed address per name
+                    found = (FLASH_BASE - 0x8000 + (zlib.crc32(sym[0].encode()) & 0x7FFC), STT_FUNC)
+                s, kind = found
+                p = place - FLASH_BASE + offset
+                if info & 0xFF == R_ARM_ABS32:
+                    (a,) = struct.unpack_from("<I", image, p)
+                    value = s + a + (1 if kind == STT_FUNC else 0)
+                    struct.pack_into("<I", image, p, value & 0xFFFFFFFF)
+                elif info & 0xFF == R_ARM_THM_CALL:
+                    hw1, hw2 = struct.unpack_from("<HH", image, p)
+                    struct.pack_into("<HH", image, p, *_thumb_bl(hw1, hw2, s - (place + offset + 4)))
+    return bytes(image)
+
+
+def random_bytes(n, seed):
+    rng = random.Random(seed)
+    return bytes(rng.getrandbits(8) for _ in range(n))
@@ -0,0 +1,77 @@
+/*
+ * user-040：boot/update/delta.c 的主机入口，供 test_delta.py 调用。
+ *   delta_unpack <旧镜像> <补丁> <输出> <最大分块> [种子]
+ * 旧镜像读入内存代替 flash，补丁按 1..最大分块 的随机长度送入 delta_write，
+ * 退出码为 delta_status_t。
+ */
+#include <stdint.h>
+#include <stdlib.h>
+#include "delta.h"
+#include "test_util.h"
+
+
+static bool unpack_sink(void *arg, const uint8_t *data, uint32_t len)
+{
+    return fwrite(data, 1, len, (FILE *)arg) == len;
+}
+
+static uint8_t *load(const char *path, uint32_t *len)
+{
+    FILE *f = fopen(path, "rb");
+    uint8_t *buf;
+
+    if (f == NULL)
+        return NULL;
+    fseek(f, 0, SEEK_END);
+    *len = (uint32_t)ftell(f);
+    fseek(f, 0, SEEK_SET);
+    buf = malloc(*len + 1U);
+    if (buf != NULL && fread(buf, 1, *len, f) != *len)
+    {
+        free(buf);
+        buf = NULL;
+    }
+    fclose(f);
+    return buf;
+}
+
+static delta_t d;
+
+int main(int argc, char **argv)
+{
+    FILE *out;
+    uint8_t *old, *patch;
+    uint32_t old_len, len, done, n, max_chunk;
+    delta_status_t status = DELTA_OK;
+
+    if (argc < 5)
+    {
+        fprintf(stderr, "usage: %s <old> <patch> <out> <max chunk> [seed]\n", argv[0]);
+        return 100;
+    }
+    max_chunk = (uint32_t)strtoul(argv[4], NULL, 0);
+    if (argc > 5)
+        test_rand_state = strtoull(argv[5], NULL, 0) | 1U;
+
+    old = load(argv[1], &old_len);
+    patch = load(argv[2], &len);
+    out = fopen(argv[3], "wb");
+    if (old == NULL || patch == NULL || out == NULL || max_chunk == 0)
+        return 100;
+
+    delta_init(&d, old, old_len, unpack_sink, out);
+    for (done = 0; done < len && status == DELTA_OK; done += n)
+    {
+        n = (uint32_t)(test_rand() % max_chunk) + 1U;
+        if (n > len - done)
+            n = len - done;
+        status = delta_write(&d, patch + done, n);
+    }
+    if (status == DELTA_OK)
+        status = delta_finish(&d);
+
+    fclose(out);
+    free(old);
+    free(patch);
+    return (int)status;
+}
@@ -0,0 +1,86 @@
+/*
+ * user-037：boot/verify/ed25519.c 的主机入口，供 test_ed25519.py 调用。
+ *   ed25519_check <向量文件>
+ * 先跑 ed25519_selftest()，再逐行验签：每行为 "<期望 0/1> <公钥> <签名> <消息>"，十六进制，
+ * 空消息写 "-"。退出码非 0 表示自检失败或有结果与期望不同。
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "ed25519.h"
+#include "test_util.h"
+
+
+#define MSG_MAX     4096U
+
+static uint8_t msg[MSG_MAX];
+
+/* 解析十六进制串，返回字节数，出错返回 -1 */
+static long unhex(const char *s, uint8_t *out, size_t max)
+{
+    size_t n = 0;
+
+    if (strcmp(s, "-") == 0)
+        return 0;
+    for (; s[0] && s[1]; s += 2)
+    {
+        unsigned int b;
+
+        if (n >= max || sscanf(s, "%2x", &b) != 1)
+            return -1;
+        out[n++] = (uint8_t)b;
+    }
+    return *s ? -1 : (long)n;
+}
+
+int main(int argc, char **argv)
+{
+    static char line[2 * MSG_MAX + 512];
+    char pk_hex[80], sig_hex[144], *msg_hex;
+    uint8_t pk[ED25519_PUBKEY_SIZE], sig[ED25519_SIG_SIZE];
+    unsigned long checked = 0, accepted = 0;
+    int expect, off;
+    long len;
+    FILE *f;
+
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s <vectors>\n", argv[0]);
+        return 100;
+    }
+
+    TEST_CHECK(ed25519_selftest());
+
+    f = fopen(argv[1], "r");
+    if (f == NULL)
+        return 100;
+    while (fgets(line, sizeof(line), f) != NULL)
+    {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (sscanf(line, "%d %79s %143s %n", &expect, pk_hex, sig_hex, &off) != 3)
+            continue;
+        msg_hex = line + off;
+        len = unhex(msg_hex, msg, sizeof(msg));
+        if (unhex(pk_hex, pk, sizeof(pk)) != (long)sizeof(pk) || unhex(sig_hex, sig, sizeof(sig)) != (long)sizeof(sig) ||
+            len < 0)
+        {
+            test_failed++;
+            printf("bad vector line %lu\n", checked + 1U);
+            continue;
+        }
+
+        bool ok = ed25519_verify(sig, msg, (uint32_t)len, pk);
+        if (ok != (expect != 0))
+        {
+            test_failed++;
+            printf("vector %lu: %s, expected %s\n  pk %s\n  sig %s\n  msg %s\n", checked + 1U,
+                   ok ? "accepted" : "rejected", expect ? "accept" : "reject", pk_hex, sig_hex, msg_hex);
+        }
+        accepted += ok;
+        checked++;
+    }
+    fclose(f);
+
+    printf("%lu vectors, %lu accepted\n", checked, accepted);
+    TEST_CHECK(checked > 0);
+    return test_result("ed25519_check");
+}
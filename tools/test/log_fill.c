@@ -0,0 +1,196 @@
+/*
+ * user-030：boot/log/log.c 二进制后端的主机入口，供 test_log_decode.py 调用。
+ *   log_fill <输出目录> <记录数> [种子]
+ * 按种子随机写入各类记录（0..16 个参数字、long long、float/double、%s），
+ * 环形缓冲区只有 LOG_RING_WORDS 字，记录多时反复回绕并淘汰旧记录。输出：
+ *   log_ring.bin  log_ring 的原始内容，与 gdb dump 相同
+ *   logstr.bin    记录用到的格式串所在的 .logstr 区间，names.bin 为 %s 引用的常量串
+ *   layout.txt    两段在记录中的地址（格式串地址只保留低 23 位，指针截为 32 位）
+ *   expected.txt  主机 vsnprintf 对仍在缓冲区中的记录的输出，不含时间戳
+ * 退出码非 0 表示环形缓冲区本身的检查失败。
+ */
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include "log.h"
+#include "test_util.h"
+
+
+#define FILL_KINDS      9
+#define FILL_TEXT       192
+
+/* 与 LOG_EMIT 的格式串同段，用来补回主机指针被 LOG_HDR 截掉的高位 */
+static const char fill_mark[] __attribute__((section(".logstr"), used)) = "";
+
+/* %s 引用的常量串，主机从 names.bin 还原 */
+static const char fill_names[] = "slot_a\0slot_b\0recovery\0";
+static const char *const fill_name_ptr[] = { &fill_names[0], &fill_names[7], &fill_names[14] };
+
+static char (*fill_text)[FILL_TEXT];
+static uint32_t fill_count;
+
+static void __attribute__((format(printf, 2, 3))) fill_expect(char level, const char *fmt, ...)
+{
+    va_list ap;
+    int n;
+
+    n = snprintf(fill_text[fill_count], FILL_TEXT, "%c: ", level);
+    va_start(ap, fmt);
+    vsnprintf(fill_text[fill_count] + n, FILL_TEXT - (size_t)n, fmt, ap);
+    va_end(ap);
+    fill_count++;
+}
+
+/* 同一组参数既写入日志，也交给 vsnprintf 生成期望输出；参数会求值两次，不能有副作用 */
+#define FILL(level, fmt, ...) \
+    do { \
+        LOG_EMIT(level, fmt, ##__VA_ARGS__); \
+        fill_expect("?EWID"[level], fmt, ##__VA_ARGS__); \
+    } while (0)
+
+// float 只有 24 位有效位，取能精确表示的值；double 按 float 存储，只用位数少的格式输出
+static float fill_float(void)
+{
+    return (float)((int32_t)(test_rand() % 2000001U) - 1000000) / 64.0f;
+}
+
+static void fill_record(uint32_t kind)
+{
+    const uint32_t u = (uint32_t)test_rand();
+    const int32_t i = (int32_t)test_rand();
+    const unsigned long long ull = test_rand();
+    const long long ll = (long long)test_rand();
+    const char *name = fill_name_ptr[test_rand() % 3U];
+    const float f = fill_float();
+    const float g = fill_float();
+
+    switch (kind)
+    {
+    case 0:
+        FILL(LOG_LEVEL_INFO, "boot");
+        break;
+    case 1:
+        FILL(LOG_LEVEL_WARN, "slot %c: %s v%u", (char)('A' + u % 2U), name, u);
+        break;
+    case 2:
+        FILL(LOG_LEVEL_ERROR, "err %d at 0x%08X", i, u);
+        break;
+    case 3:
+        FILL(LOG_LEVEL_DEBUG, "bytes %llu offset %lld mask %llx", ull, ll, ull ^ (unsigned long long)ll);
+        break;
+    case 4:
+        FILL(LOG_LEVEL_INFO, "temp %.2f ratio %e load %g%%", f, g, (float)(u % 1000U) / 8.0f);
+        break;
+    case 5:
+        FILL(LOG_LEVEL_INFO, "8 args %d %u %x %X %c %5d %-4u| %+d",
+             i, u, u >> 3, u >> 5, (char)('a' + u % 26U), (int)(i % 1000), u % 100U, -(i / 2));
+        break;
+    case 6:
+        FILL(LOG_LEVEL_WARN, "wide %llu %llu %llu %llu %llu %llu %llu %llu",
+             ull, ull >> 1, ull >> 7, ull >> 13, ull >> 21, ull >> 33, ull >> 47, ull >> 60);
+        break;
+    case 7:
+        FILL(LOG_LEVEL_INFO, "mixed %lld %.3f %s", ll, (double)f, name);
+        break;
+    default:
+    {
+        // 指向栈上的串：ELF 里找不到，主机输出指针值
+        char lost[8] = "stack";
+        LOG_E("lost %s", lost);
+        snprintf(fill_text[fill_count++], FILL_TEXT, "E: lost <str@0x%08X>", (uint32_t)(uintptr_t)lost);
+        break;
+    }
+    }
+}
+
+static int fill_write(const char *dir, const char *file, const void *data, size_t len)
+{
+    char path[1024];
+    FILE *f;
+    int ok;
+
+    snprintf(path, sizeof(path), "%s/%s", dir, file);
+    f = fopen(path, "wb");
+    if (f == NULL)
+        return 0;
+    ok = fwrite(data, 1, len, f) == len;
+    return (fclose(f) == 0) && ok;
+}
+
+int main(int argc, char **argv)
+{
+    uintptr_t lo = UINTPTR_MAX, hi = 0;
+    uint32_t count, kept;
+    char path[1024];
+    FILE *f;
+
+    if (argc < 3)
+    {
+        fprintf(stderr, "usage: %s <dir> <count> [seed]\n", argv[0]);
+        return 100;
+    }
+    count = (uint32_t)strtoul(argv[2], NULL, 0);
+    if (argc > 3)
+        test_rand_state = strtoull(argv[3], NULL, 0) | 1U;
+    fill_text = calloc(count + FILL_KINDS, FILL_TEXT);
+    if (fill_text == NULL)
+        return 100;
+
+    // 先逐类写一条，从记录头取格式串地址，得到要导出的 .logstr 区间
+    for (uint32_t kind = 0; kind < FILL_KINDS; kind++)
+    {
+        uintptr_t fmt;
+
+        log_init();
+        fill_record(kind);
+        fmt = ((uintptr_t)fill_mark & ~(uintptr_t)0x7FFFFF) | (log_ring.data[0] & 0x7FFFFFU);
+        TEST_CHECK(LOG_HDR_WORDS(log_ring.data[0]) == log_ring.used - 2U);
+        TEST_CHECK("?EWID"[(log_ring.data[0] >> 28) & 0x7U] == fill_text[kind][0]);
+        if (fmt < lo)
+            lo = fmt;
+        if (fmt + strlen((const char *)fmt) + 1U > hi)
+            hi = fmt + strlen((const char *)fmt) + 1U;
+    }
+    // 格式串跨过 8 MiB 边界时低 23 位不连续，主机无法还原
+    if ((lo >> 23) != ((hi - 1U) >> 23))
+    {
+        fprintf(stderr, ".logstr crosses an 8 MiB boundary\n");
+        return 100;
+    }
+
+    fill_count = 0;
+    log_init();
+    for (uint32_t n = 0; n < count; n++)
+    {
+        fill_record((uint32_t)(test_rand() % FILL_KINDS));
+        TEST_CHECK(log_ring.used <= log_ring.size);
+    }
+    TEST_CHECK(log_ring.magic == LOG_RING_MAGIC && log_ring.size == LOG_RING_WORDS);
+    TEST_CHECK(log_ring.dropped <= count);
+    kept = count - log_ring.dropped;
+
+    if (!fill_write(argv[1], "log_ring.bin", &log_ring, sizeof(log_ring)) ||
+        !fill_write(argv[1], "logstr.bin", (const void *)lo, hi - lo) ||
+        !fill_write(argv[1], "names.bin", fill_names, sizeof(fill_names)))
+        return 100;
+
+    snprintf(path, sizeof(path), "%s/layout.txt", argv[1]);
+    f = fopen(path, "w");
+    if (f == NULL)
+        return 100;
+    fprintf(f, "logstr 0x%08X\nnames 0x%08X\n", (uint32_t)(lo & 0x7FFFFF), (uint32_t)(uintptr_t)fill_names);
+    fclose(f);
+
+    snprintf(path, sizeof(path), "%s/expected.txt", argv[1]);
+    f = fopen(path, "w");
+    if (f == NULL)
+        return 100;
+    if (log_ring.dropped)
+        fprintf(f, "# %u older records were overwritten\n", log_ring.dropped);
+    for (uint32_t n = count - kept; n < count; n++)
+        fprintf(f, "%s\n", fill_text[n]);
+    fclose(f);
+
+    free(fill_text);
+    return test_failed != 0;
+}
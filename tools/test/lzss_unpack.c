@@ -0,0 +1,61 @@
+/*
+ * user-039：boot/update/lzss.c 的主机入口，供 test_lzss.py 调用。
+ *   lzss_unpack <输入> <输出> <最大分块> [种子]
+ * 输入按 1..最大分块 的随机长度送入 lzss_write，退出码为 lzss_status_t。
+ */
+#include <stdint.h>
+#include <stdlib.h>
+#include "lzss.h"
+#include "test_util.h"
+
+
+static bool unpack_sink(void *arg, const uint8_t *data, uint32_t len)
+{
+    return fwrite(data, 1, len, (FILE *)arg) == len;
+}
+
+static lzss_t z;
+
+int main(int argc, char **argv)
+{
+    FILE *in, *out;
+    uint8_t *buf;
+    uint32_t len, done, n, max_chunk;
+    lzss_status_t status = LZSS_OK;
+
+    if (argc < 4)
+    {
+        fprintf(stderr, "usage: %s <in> <out> <max chunk> [seed]\n", argv[0]);
+        return 100;
+    }
+    max_chunk = (uint32_t)strtoul(argv[3], NULL, 0);
+    if (argc > 4)
+        test_rand_state = strtoull(argv[4], NULL, 0) | 1U;
+
+    in = fopen(argv[1], "rb");
+    out = fopen(argv[2], "wb");
+    if (in == NULL || out == NULL || max_chunk == 0)
+        return 100;
+    fseek(in, 0, SEEK_END);
+    len = (uint32_t)ftell(in);
+    fseek(in, 0, SEEK_SET);
+    buf = malloc(len + 1U);
+    if (buf == NULL || fread(buf, 1, len, in) != len)
+        return 100;
+    fclose(in);
+
+    lzss_init(&z, unpack_sink, out);
+    for (done = 0; done < len && status == LZSS_OK; done += n)
+    {
+        n = (uint32_t)(test_rand() % max_chunk) + 1U;
+        if (n > len - done)
+            n = len - done;
+        status = lzss_write(&z, buf + done, n);
+    }
+    if (status == LZSS_OK)
+        status = lzss_finish(&z);
+
+    fclose(out);
+    free(buf);
+    return (int)status;
+}
@@ -0,0 +1,36 @@
+#ifndef __BL_PRINTF_REF_H
+#define __BL_PRINTF_REF_H
+
+
+/*
+ * 对照用的原始 printf（仓库最初的 boot/app/override/_printf_.c，逐字符输出、除法转换数字、
+ * 近似的浮点转换），对外符号加 ref_ 前缀，和当前实现链接进同一个测试程序。
+ * 编译 ref/_printf_.c 时定义 PRINTF_REF_BUILD 并 -include 本文件，测试程序直接包含本文件。
+ */
+
+#ifdef PRINTF_REF_BUILD
+
+#define _putchar    ref_putchar
+#define printf_     ref_printf_
+#define sprintf_    ref_sprintf_
+#define snprintf_   ref_snprintf_
+#define vsnprintf_  ref_vsnprintf_
+#define vprintf_    ref_vprintf_
+#define fctprintf   ref_fctprintf
+
+#else
+
+#include <stdarg.h>
+#include <stddef.h>
+
+/* 由测试程序提供 */
+void ref_putchar(char character);
+
+int ref_printf_(const char* format, ...);
+int ref_snprintf_(char* buffer, size_t count, const char* format, ...);
+int ref_vsnprintf_(char* buffer, size_t count, const char* format, va_list va);
+
+#endif
+
+
+#endif /* __BL_PRINTF_REF_H */
@@ -0,0 +1,15 @@
+#ifndef __BL_TEST_LOG_H
+#define __BL_TEST_LOG_H
+
+
+/* 主机测试用的替身：LOG_E/LOG_W 打印到 stderr，其余丢弃，但和固件一样检查格式并引用参数 */
+#include <stdio.h>
+
+
+#define LOG_E(fmt, ...)     fprintf(stderr, "E: " fmt "\n", ##__VA_ARGS__)
+#define LOG_W(fmt, ...)     fprintf(stderr, "W: " fmt "\n", ##__VA_ARGS__)
+#define LOG_I(fmt, ...)     do { if (0) fprintf(stderr, fmt, ##__VA_ARGS__); } while (0)
+#define LOG_D(fmt, ...)     do { if (0) fprintf(stderr, fmt, ##__VA_ARGS__); } while (0)
+
+
+#endif /* __BL_TEST_LOG_H */
@@ -0,0 +1,26 @@
+#ifndef __BL_TEST_OS_H
+#define __BL_TEST_OS_H
+
+
+/* 主机测试用的替身：单线程，临界区只记录嵌套深度，供测试检查进出成对 */
+#include <stdint.h>
+
+
+static uint32_t test_critical_depth __attribute__((unused));
+
+static inline uint32_t os_enter_critical(void)
+{
+    return test_critical_depth++;
+}
+
+static inline void os_exit_critical(uint32_t state)
+{
+    test_critical_depth = state;
+}
+
+/* 主栈用量，由使用它的测试提供（见 slot_env.c） */
+uint32_t os_stack_size(void);
+uint32_t os_stack_peak(void);
+
+
+#endif /* __BL_TEST_OS_H */
@@ -0,0 +1,203 @@
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include "verify.h"
+#include "handoff.h"
+#include "os.h"
+#include "slot_env.h"
+#include "test_util.h"
+
+
+// 与 flash.c 相同的擦写计数
+typedef struct
+{
+    uint32_t count;
+    uint32_t check;             /* ~count */
+} slot_env_counter_t;
+
+#define SLOT_ENV_COUNTER        ((volatile slot_env_counter_t *)SLOT_ENV_BKPSRAM)
+
+uint32_t slot_env_reset_flags;
+uint32_t slot_env_verify_calls;
+uint32_t slot_env_erases;
+uint32_t slot_env_programs;
+uint32_t slot_env_torn_at = SLOT_ENV_NEVER;
+jmp_buf slot_env_jump;
+uint32_t slot_env_jump_base;
+
+static bool slot_env_map(uint8_t *addr, size_t size)
+{
+    void *p = mmap(addr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+
+    if (p == MAP_FAILED || p != addr)
+    {
+        perror("slot_env: mmap");
+        return false;
+    }
+
+    return true;
+}
+
+bool slot_env_init(void)
+{
+    static bool mapped;
+
+    if (!mapped)
+    {
+        if (!slot_env_map(SLOT_ENV_FLASH, BL_FLASH_SIZE) || !slot_env_map(SLOT_ENV_BKPSRAM, LAYOUT_BKPSRAM_SIZE))
+            return false;
+        mapped = true;
+    }
+
+    memset(SLOT_ENV_FLASH, 0xFF, BL_FLASH_SIZE);
+    memset(SLOT_ENV_BKPSRAM, 0, LAYOUT_BKPSRAM_SIZE);
+    slot_env_reset_flags = 0;
+    slot_env_verify_calls = 0;
+    slot_env_erases = 0;
+    slot_env_programs = 0;
+    slot_env_torn_at = SLOT_ENV_NEVER;
+    return true;
+}
+
+void slot_env_image(uint32_t slot, uint32_t size)
+{
+    uint32_t base = slot_base(slot), crc, i;
+    uint8_t *p = SLOT_ENV_FLASH + (base - BL_FLASH_BASE);
+    uint32_t vector[2] = { LAYOUT_RAM_ORIGIN + LAYOUT_RAM_SIZE, base + 0x201U };
+
+    for (i = 0; i < size - 4U; i++)
+        p[i] = (uint8_t)test_rand();
+    memcpy(p, vector, sizeof(vector));
+    crc = crc32_sw(p, size - 4U);
+    memcpy(p + size - 4U, &crc, 4);
+}
+
+bool bl_flash_write_count(uint32_t *count)
+{
+    volatile slot_env_counter_t *c = SLOT_ENV_COUNTER;
+
+    *count = c->count;
+    return c->check == ~c->count;
+}
+
+static void slot_env_count(void)
+{
+    volatile slot_env_counter_t *c = SLOT_ENV_COUNTER;
+    uint32_t n;
+
+    if (!bl_flash_write_count(&n))
+        n = 0;
+    n++;
+    c->count = n;
+    c->check = ~n;
+}
+
+// F407 扇区：4 x 16K, 64K, 7 x 128K
+bool bl_flash_sector(uint32_t addr, uint32_t *index, uint32_t *start, uint32_t *size)
+{
+    uint32_t off = addr - BL_FLASH_BASE, i, s, n;
+
+    if (addr < BL_FLASH_BASE || off >= BL_FLASH_SIZE)
+        return false;
+
+    if (off < 0x10000U)
+    {
+        i = off >> 14;
+        s = i << 14;
+        n = 0x4000U;
+    }
+    else if (off < 0x20000U)
+    {
+        i = 4;
+        s = 0x10000U;
+        n = 0x10000U;
+    }
+    else
+    {
+        i = 4U + (off >> 17);
+        s = off & ~0x1FFFFU;
+        n = 0x20000U;
+    }
+
+    if (index)
+        *index = i;
+    if (start)
+        *start = BL_FLASH_BASE + s;
+    if (size)
+        *size = n;
+    return true;
+}
+
+bl_flash_status_t bl_flash_erase(uint32_t addr)
+{
+    uint32_t start, size;
+
+    if (!bl_flash_sector(addr, NULL, &start, &size))
+        return BL_FLASH_ERR_ADDR;
+    slot_env_count();
+    memset(SLOT_ENV_FLASH + (start - BL_FLASH_BASE), 0xFF, size);
+    slot_env_erases++;
+    return BL_FLASH_OK;
+}
+
+bl_flash_status_t bl_flash_program(uint32_t addr, const void *data, uint32_t len)
+{
+    uint8_t *p = SLOT_ENV_FLASH + (addr - BL_FLASH_BASE);
+    uint32_t n = len;
+
+    if (addr < BL_FLASH_BASE || addr - BL_FLASH_BASE + len > BL_FLASH_SIZE)
+        return BL_FLASH_ERR_ADDR;
+    slot_env_count();
+    slot_env_programs++;
+    if (slot_env_torn_at != SLOT_ENV_NEVER && slot_env_torn_at < len)
+        n = slot_env_torn_at;
+
+    // 和硬件一样只能把 1 写成 0，没擦除的位置读回时会不一致
+    for (uint32_t i = 0; i < n; i++)
+        p[i] &= ((const uint8_t *)data)[i];
+    if (slot_env_torn_at != SLOT_ENV_NEVER)
+    {
+        slot_env_torn_at = SLOT_ENV_NEVER;
+        return BL_FLASH_ERR_PROGRAM;
+    }
+    return memcmp(p, data, len) == 0 ? BL_FLASH_OK : BL_FLASH_ERR_VERIFY;
+}
+
+verify_status_t verify_image(const void *image, uint32_t len)
+{
+    slot_env_verify_calls++;
+    if (len < 8U || (len & 3U))
+        return VERIFY_ERR_ARG;
+
+    return crc32_sw(image, len) == CRC32_RESIDUE ? VERIFY_OK : VERIFY_ERR_CRC;
+}
+
+verify_status_t verify_image_signed(const void *image, uint32_t len)
+{
+    return verify_image(image, len);
+}
+
+uint32_t handoff_reset_flags(void)
+{
+    return slot_env_reset_flags;
+}
+
+void handoff_set_image(uint32_t slot, uint32_t base, uint32_t size, uint32_t verify_cycles)
+{
+}
+
+void bl_jump_to_app(uint32_t base)
+{
+    slot_env_jump_base = base;
+    longjmp(slot_env_jump, 1);
+}
+
+uint32_t os_stack_size(void)
+{
+    return 0;
+}
+
+uint32_t os_stack_peak(void)
+{
+    return 0;
+}
@@ -0,0 +1,47 @@
+#ifndef __BL_TEST_SLOT_ENV_H
+#define __BL_TEST_SLOT_ENV_H
+
+
+/*
+ * 主机上运行 boot/slot/slot.c 的环境：flash 和备份 SRAM 用 mmap 映射到固件中的实际地址，
+ * slot.c 照常按地址读取。bl_flash_erase/bl_flash_program 按硬件规则修改映射的 flash
+ * （只能把 1 写成 0），并像 flash.c 一样维护备份 SRAM 中的擦写计数。
+ * handoff_reset_flags、verify_image 等由测试通过下面的变量控制和观察。
+ */
+#include <setjmp.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "flash_layout.h"
+#include "flash.h"
+#include "slot.h"
+
+
+#define SLOT_ENV_FLASH          ((uint8_t *)(uintptr_t)BL_FLASH_BASE)
+#define SLOT_ENV_BKPSRAM        ((uint8_t *)(uintptr_t)LAYOUT_BKPSRAM_ORIGIN)
+
+#define SLOT_ENV_NEVER          0xFFFFFFFFU
+
+/* handoff_reset_flags() 的返回值，即本次复位的 RCC->CSR 标志 */
+extern uint32_t slot_env_reset_flags;
+/* verify_image() 被调用的次数，即做了几次完整校验 */
+extern uint32_t slot_env_verify_calls;
+/* bl_flash_erase / bl_flash_program 的次数 */
+extern uint32_t slot_env_erases;
+extern uint32_t slot_env_programs;
+/*
+ * 不为 SLOT_ENV_NEVER 时，下一次编程只写入前这么多字节就返回 BL_FLASH_ERR_PROGRAM，
+ * 模拟写到一半掉电；之后恢复为 SLOT_ENV_NEVER
+ */
+extern uint32_t slot_env_torn_at;
+/* bl_jump_to_app 记下地址后 longjmp 到这里，值为 1 */
+extern jmp_buf slot_env_jump;
+extern uint32_t slot_env_jump_base;
+
+/* 映射 flash（全部擦除）和备份 SRAM（清零，计数无效），失败返回 false */
+bool slot_env_init(void);
+
+/* 不经过 bl_flash_* 在槽中放一个 size 字节的镜像：有效向量表、随机内容、末尾 CRC */
+void slot_env_image(uint32_t slot, uint32_t size);
+
+
+#endif /* __BL_TEST_SLOT_ENV_H */
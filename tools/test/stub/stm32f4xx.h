@@ -0,0 +1,48 @@
+#ifndef __BL_TEST_STM32F4XX_H
+#define __BL_TEST_STM32F4XX_H
+
+
+/*
+ * 主机测试用的替身：只提供 boot/verify、boot/update、boot/slot 中可移植部分用到的内核定义。
+ * DWT 周期计数恒为 0，*_bench() 在主机上没有意义，由 tools/test/bench_* 代替。
+ */
+#include <stdint.h>
+
+
+static inline uint32_t __ROR(uint32_t value, uint32_t n)
+{
+    n &= 31U;
+    return n ? (value >> n) | (value << (32U - n)) : value;
+}
+
+#define __REV(x)    __builtin_bswap32(x)
+
+typedef struct
+{
+    volatile uint32_t DEMCR;
+} CoreDebug_Type;
+
+typedef struct
+{
+    volatile uint32_t CTRL;
+    volatile uint32_t CYCCNT;
+} DWT_Type;
+
+static CoreDebug_Type test_core_debug __attribute__((unused));
+static DWT_Type test_dwt __attribute__((unused));
+static uint32_t SystemCoreClock __attribute__((unused)) = 168000000U;
+
+#define CoreDebug                       (&test_core_debug)
+#define DWT                             (&test_dwt)
+#define CoreDebug_DEMCR_TRCENA_Msk      (1UL << 24)
+#define DWT_CTRL_CYCCNTENA_Msk          (1UL << 0)
+
+/* RCC->CSR 复位标志，boot/slot 用来区分冷、热复位 */
+#define RCC_CSR_BORRSTF                 ((uint32_t)0x02000000)
+#define RCC_CSR_PADRSTF                 ((uint32_t)0x04000000)
+#define RCC_CSR_PORRSTF                 ((uint32_t)0x08000000)
+#define RCC_CSR_SFTRSTF                 ((uint32_t)0x10000000)
+#define RCC_CSR_WDGRSTF                 ((uint32_t)0x20000000)
+
+
+#endif /* __BL_TEST_STM32F4XX_H */
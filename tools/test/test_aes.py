@@ -0,0 +1,123 @@
+#!/usr/bin/env python3
+"""user-038: check boot/verify/aes.c AES-CTR against SP 800-38A and tools/aes.py.
+
+Usage: test_aes.py <aes_crypt>
+
+tools/aes.py is first checked against the NIST SP 800-38A F.5.1/F.5.3/F.5.5
+CTR vectors (AES-128/192/256). The C code then encrypts the same vectors and
+random data of every key size and many lengths. Its input is split into
+random chunks that mostly end off a block boundary, both in place and
+out of place. Every result must equal the Python output byte for byte,
+including IVs whose low 32-bit counter wraps. Decrypting must give the
+plaintext back, and a key of the wrong size must be refused.
+"""
+
+import os
+import random
+import subprocess
+import sys
+import tempfile
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."))
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+import aes  # noqa: E402
+import corpus  # noqa: E402
+
+# aes_crypt exit codes
+OK = 0
+ERR_KEY = 2
+
+SP800_38A_IV = bytes.fromhex("f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff")
+SP800_38A_PLAIN = bytes.fromhex(
+    "6bc1bee22e409f96e93d7e117393172a" "ae2d8a571e03ac9c9eb76fac45af8e51"
+    "30c81c46a35ce411e5fbc1191a0a52ef" "f69f2445df4f9b17ad2b417be66c3710")
+SP800_38A = [
+    ("F.5.1 CTR-AES128", "2b7e151628aed2a6abf7158809cf4f3c",
+     "874d6191b620e3261bef6864990db6ce" "9806f66b7970fdff8617187bb9fffdff"
+     "5ae4df3edbd5d35e5b4f09020db03eab" "1e031dda2fbe03d1792170a0f3009cee"),
+    ("F.5.3 CTR-AES192", "8e73b0f7da0e6452c810f32b809079e562f8ead2522c6b7b",
+     "1abc932417521ca24f2b0459fe7e6e0b" "090339ec0aa6faefd5ccc2c6f4ce8e94"
+     "1e36b26bd1ebc670d1bd1d665620abf7" "4f78a7f6d29809585a97daec58c6b050"),
+    ("F.5.5 CTR-AES256", "603deb1015ca71be2b73aef0857d77811f352c073b6108d72d9810a30914dff4",
+     "601ec313775789a5b7a7f504bbf3d228" "f443e3ca4d62b59aca84e990cacaf5c5"
+     "2b0930daa23de94ce87017ba2d84988d" "dfc9c58db67aada613c2dd08457941a6"),
+]
+
+failed = 0
+runs = 0
+
+
+def check(cond, what):
+    global failed
+    if not cond:
+        failed += 1
+        print("FAILED: %s" % what)
+
+
+def crypt(tool, key, iv, data, max_chunk, seed):
+    global runs
+    runs += 1
+    with tempfile.TemporaryDirectory() as tmp:
+        src = os.path.join(tmp, "in.bin")
+        dst = os.path.join(tmp, "out.bin")
+        with open(src, "wb") as f:
+            f.write(data)
+        status = subprocess.run([tool, key.hex(), iv.hex(), src, dst, str(max_chunk), str(seed)]).returncode
+        if status != OK:
+            return status, None
+        with open(dst, "rb") as f:
+            return status, f.read()
+
+
+def compare(tool, what, key, iv, data, chunks, seed):
+    expect = aes.ctr(key, iv, data)
+    for max_chunk in chunks:
+        for in_place in (0, 1):
+            s = seed * 2 + in_place
+            status, out = crypt(tool, key, iv, data, max_chunk, s)
+            name = "%s (%u bytes, AES-%u) chunk <= %u%s" % (
+                what, len(data), 8 * len(key), max_chunk, " in place" if in_place else "")
+            check(status == OK, "%s: status %d" % (name, status))
+            check(out == expect, "%s: output differs from aes.py" % name)
+    return expect
+
+
+def main():
+    tool = sys.argv[1]
+    rng = random.Random(38)
+
+    for name, key, cipher in SP800_38A:
+        key, cipher = bytes.fromhex(key), bytes.fromhex(cipher)
+        check(aes.ctr(key, SP800_38A_IV, SP800_38A_PLAIN) == cipher, "aes.py %s" % name)
+        compare(tool, name, key, SP800_38A_IV, SP800_38A_PLAIN, (1, 5, 15, 16, 17, 31, 33, 64), len(key))
+        status, out = crypt(tool, key, SP800_38A_IV, cipher, 7, 3)
+        check(status == OK and out == SP800_38A_PLAIN, "%s: decrypt" % name)
+
+    firmware = corpus.firmware()[:40000]
+    for n in range(36):
+        key = bytes(rng.getrandbits(8) for _ in range((16, 24, 32)[n % 3]))
+        iv = bytearray(rng.getrandbits(8) for _ in range(16))
+        if n % 4 == 0:
+            # the counter wraps inside the data; only the low 32 bits take part
+            iv[12:] = (0xFFFFFFFF - rng.randrange(8)).to_bytes(4, "big")
+        iv = bytes(iv)
+        length = rng.choice((0, 1, 15, 16, 17, 255, 256, 1000, rng.randrange(5000)))
+        data = bytes(rng.getrandbits(8) for _ in range(length))
+        chunks = (1 + rng.randrange(15), 17 + rng.randrange(48), 4096)
+        expect = compare(tool, "random %u" % n, key, iv, data, chunks, n)
+        status, out = crypt(tool, key, iv, expect, 1 + rng.randrange(40), n)
+        check(status == OK and out == data, "random %u: decrypt" % n)
+
+    compare(tool, "firmware", bytes(range(32)), bytes(16), firmware, (13, 4096), 99)
+
+    for bad in (0, 8, 20, 31, 33):
+        status, _ = crypt(tool, bytes(bad), bytes(16), b"data", 4, 1)
+        check(status == ERR_KEY, "%u byte key: status %d" % (bad, status))
+
+    print("test_aes: %u runs, %s" % (runs, "FAILED" if failed else "ok"))
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
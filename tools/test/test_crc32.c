@@ -0,0 +1,79 @@
+/*
+ * user-034：crc32_sw_update (slicing-by-8) 与逐位计算的参考实现比较。
+ *   - CRC(0x12345678) 等于 STM32 CRC 外设的已知结果 0xDF8A8A2B
+ *   - 随机长度、随机起始偏移（含未按字对齐）、随机分段续算
+ *   - 追加 CRC 后对整个镜像再算一次，结果为 CRC32_RESIDUE
+ * 最后写出 crc32_image.bin（由 C 补齐并追加 CRC），test_crc32_tool 用 image_tool.py check 校验。
+ */
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "crc32.h"
+#include "test_util.h"
+
+
+#define BUF_SIZE    (64U * 1024U)
+
+// 与外设相同：小端字，从最高位开始逐位移出
+static uint32_t crc32_ref(const uint8_t *p, uint32_t len)
+{
+    uint32_t crc = CRC32_INIT, w;
+
+    for (uint32_t i = 0; i < len; i += 4)
+    {
+        memcpy(&w, p + i, 4);
+        crc ^= w;
+        for (int b = 0; b < 32; b++)
+            crc = (crc & 0x80000000U) ? (crc << 1) ^ 0x04C11DB7U : (crc << 1);
+    }
+    return crc;
+}
+
+static uint8_t buf[BUF_SIZE + 64];
+
+int main(int argc, char **argv)
+{
+    uint32_t w = 0x12345678U, crc, len, off, split;
+    FILE *f;
+
+    for (uint32_t i = 0; i < sizeof(buf); i++)
+        buf[i] = (uint8_t)test_rand();
+
+    TEST_CHECK(crc32_sw(&w, 4) == 0xDF8A8A2BU);
+    TEST_CHECK(crc32_sw(buf, 0) == CRC32_INIT);
+
+    for (int t = 0; t < 20000; t++)
+    {
+        off = (uint32_t)(test_rand() % 61U);
+        len = (uint32_t)(test_rand() % 600U) * 4U;
+        split = (uint32_t)(test_rand() % (len / 4U + 1U)) * 4U;
+
+        crc = crc32_ref(buf + off, len);
+        TEST_CHECK(crc32_sw(buf + off, len) == crc);
+        TEST_CHECK(crc32_sw_update(crc32_sw(buf + off, split), buf + off + split, len - split) == crc);
+        if (test_failed > 20)
+            break;
+    }
+
+    // 镜像末尾追加自身 CRC（小端字）
+    crc = crc32_sw(buf, BUF_SIZE - 4U);
+    memcpy(buf + BUF_SIZE - 4U, &crc, 4);
+    TEST_CHECK(crc32_ref(buf, BUF_SIZE) == CRC32_RESIDUE);
+    TEST_CHECK(crc32_sw(buf, BUF_SIZE) == CRC32_RESIDUE);
+
+    // 长度不是 4 的倍数时按 image_tool.py 的规则补 0xFF
+    len = BUF_SIZE - 4099U;
+    memset(buf + len, 0xFF, (uint32_t)(-len & 3U));
+    len = (len + 3U) & ~3U;
+    crc = crc32_sw(buf, len);
+    memcpy(buf + len, &crc, 4);
+    f = fopen("crc32_image.bin", "wb");
+    TEST_CHECK(f != NULL);
+    if (f != NULL)
+    {
+        TEST_CHECK(fwrite(buf, 1, len + 4U, f) == len + 4U);
+        fclose(f);
+    }
+
+    return test_result("test_crc32");
+}
@@ -0,0 +1,148 @@
+#!/usr/bin/env python3
+"""user-040: delta patch matrix, tools/delta.py diff through boot/update/delta.c.
+
+Usage: test_delta.py <delta_unpack> <lzss_unpack>
+
+The image pairs are the ARM objects checked in under build/, linked at
+0x08010000 by corpus.link() and finished with image_tool.py's CRC trailer:
+
+  identical   the same image
+  small       one constant and one instruction changed
+  relocated   relinked with a 1 KiB function inserted a third of the way in
+              and one object left out further on, so the code after them
+              moves and BL offsets and literal pool addresses change
+  unrelated   random data of the same length
+
+Every patch is applied by the C code with its input split into random
+chunks, both raw and after an lzss round trip, and the result must equal the
+new image byte for byte. A patch for another base, a truncated patch and a
+bad header must be rejected. The size matrix is printed.
+"""
+
+import os
+import subprocess
+import sys
+import tempfile
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."))
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+import corpus  # noqa: E402
+import delta  # noqa: E402
+import image_tool  # noqa: E402
+import lzss  # noqa: E402
+
+# delta_status_t
+DELTA_OK = 0
+DELTA_ERR_HEADER = 1
+DELTA_ERR_BASE = 2
+DELTA_ERR_DATA = 3
+
+crc32 = image_tool.crc32
+failed = 0
+
+
+def check(cond, what):
+    global failed
+    if not cond:
+        failed += 1
+        print("FAILED: %s" % what)
+
+
+def finish(data):
+    """Pad and append the CRC trailer, as image_tool.py crc does."""
+    data = image_tool.pad4(data)
+    return data + crc32(data).to_bytes(4, "little")
+
+
+def run(tool, *args):
+    return subprocess.run([tool] + [str(a) for a in args]).returncode
+
+
+def apply_c(tools, tmp, old, patch, max_chunk, compressed=False):
+    paths = {n: os.path.join(tmp, n) for n in ("old", "patch", "lz", "out")}
+    with open(paths["old"], "wb") as f:
+        f.write(old)
+    if compressed:
+        with open(paths["lz"], "wb") as f:
+            f.write(lzss.compress(patch))
+        status = run(tools["lzss"], paths["lz"], paths["patch"], max_chunk, 2)
+        if status:
+            return -1, b""
+    else:
+        with open(paths["patch"], "wb") as f:
+            f.write(patch)
+    status = run(tools["delta"], paths["old"], paths["patch"], paths["out"], max_chunk, len(patch) + max_chunk)
+    with open(paths["out"], "rb") as f:
+        return status, f.read()
+
+
+def pairs():
+    objects = corpus.firmware_objects()
+    base = corpus.link()
+
+    small = bytearray(base)
+    at = len(small) * 2 // 5 & ~3
+    small[at:at + 4] = (int.from_bytes(small[at:at + 4], "little") ^ 0x00010000).to_bytes(4, "little")
+    at = len(small) * 3 // 4 & ~1
+    small[at] ^= 0x04
+
+    third = len(objects) // 3
+    moved = corpus.link(skip=(2 * third,), insert=(third, objects[2][:1024]))
+
+    return [
+        ("identical", base, base),
+        ("small", base, bytes(small)),
+        ("relocated", base, moved),
+        ("unrelated", base, corpus.random_bytes(len(base), seed=40)),
+    ]
+
+
+def main():
+    tools = {"delta": sys.argv[1], "lzss": sys.argv[2]}
+
+    print("%-10s %8s %8s %8s %9s" % ("pair", "new", "lz(new)", "patch", "lz(patch)"))
+    with tempfile.TemporaryDirectory() as tmp:
+        for name, old, new in pairs():
+            old, new = finish(old), finish(new)
+            patch = delta.diff(old, new, crc32)
+            check(delta.apply(old, patch, crc32) == new, "%s: python apply" % name)
+            for max_chunk in (1, 13, 4096, 1 << 24):
+                status, out = apply_c(tools, tmp, old, patch, max_chunk)
+                check(status == DELTA_OK, "%s chunk <= %u: status %d" % (name, max_chunk, status))
+                check(out == new, "%s chunk <= %u: output differs from the new image" % (name, max_chunk))
+            status, out = apply_c(tools, tmp, old, patch, 900, compressed=True)
+            check(status == DELTA_OK and out == new, "%s via lzss: status %d" % (name, status))
+
+            lz_new, lz_patch = len(lzss.compress(new)), len(lzss.compress(patch))
+            print("%-10s %8u %8u %8u %9u" % (name, len(new), lz_new, len(patch), lz_patch))
+            if name == "identical":
+                check(len(patch) <= 32, "identical: %u byte patch" % len(patch))
+            elif name == "small":
+                check(len(patch) <= 128, "small: %u byte patch" % len(patch))
+            elif name == "relocated":
+                check(lz_patch * 8 < lz_new, "relocated: lz(patch) %u vs lz(new) %u" % (lz_patch, lz_new))
+            else:
+                check(len(patch) <= len(new) + len(new) // 32 + 64, "unrelated: %u byte patch" % len(patch))
+
+        name, old, new = pairs()[1]
+        old, new = finish(old), finish(new)
+        patch = delta.diff(old, new, crc32)
+
+        other = bytearray(old)
+        other[100] ^= 0xFF
+        status, _ = apply_c(tools, tmp, bytes(other), patch, 64)
+        check(status == DELTA_ERR_BASE, "wrong base: status %d" % status)
+
+        status, _ = apply_c(tools, tmp, old, patch[:len(patch) - 5], 64)
+        check(status == DELTA_ERR_DATA, "truncated: status %d" % status)
+
+        status, _ = apply_c(tools, tmp, old, b"DX" + patch[2:], 64)
+        check(status == DELTA_ERR_HEADER, "bad magic: status %d" % status)
+
+    print("test_delta: %s" % ("FAILED" if failed else "ok"))
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
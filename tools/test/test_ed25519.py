@@ -0,0 +1,132 @@
+#!/usr/bin/env python3
+"""user-037: check boot/verify/ed25519.c against tools/ed25519.py.
+
+Usage: test_ed25519.py <ed25519_check>
+
+Keys and signatures come from the Python reference. Messages run from
+empty through several SHA-512 blocks. For every key the C verifier gets:
+
+  valid       the signature as made, which must be accepted
+  R / S       one bit flipped in R or in S
+  message     one bit flipped in the message, or one byte appended
+  other key   a valid signature checked against another public key
+  S + L       S replaced by S + L, the same value mod L but not canonical
+  S >= 2^253  S with a high bit set
+
+The tampered cases must be rejected. The identity public key accepts a
+forged signature R = [S]B for any message, which is valid per RFC 8032.
+Its non-canonical encodings must not decode, so the same forgery under
+them must be rejected. Those encodings are y >= p and x = 0 with the sign
+bit set. Public keys with y >= p or with no x on the curve must also be
+rejected. Every expected result is confirmed with ed25519.verify() before
+the C code sees it.
+"""
+
+import os
+import random
+import subprocess
+import sys
+import tempfile
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."))
+
+import ed25519  # noqa: E402
+
+KEYS = 90
+
+failed = 0
+
+
+def check(cond, what):
+    global failed
+    if not cond:
+        failed += 1
+        print("FAILED: %s" % what)
+
+
+def flip(data, bit):
+    data = bytearray(data)
+    data[bit >> 3] ^= 1 << (bit & 7)
+    return bytes(data)
+
+
+def with_s(sig, s):
+    return sig[:32] + s.to_bytes(32, "little")
+
+
+def main():
+    tool = sys.argv[1]
+    rng = random.Random(37)
+    vectors = []
+
+    def add(expect, pk, sig, msg, what):
+        check(ed25519.verify(pk, msg, sig) == expect, "reference disagrees on %s" % what)
+        vectors.append((expect, pk, sig, msg))
+
+    keys = []
+    for k in range(KEYS):
+        seed = bytes(rng.getrandbits(8) for _ in range(32))
+        pk = ed25519.public_key(seed)
+        length = rng.choice((0, 1, 32, 64, 111, 112, 128, 200, 239, 240, 256, rng.randrange(1000)))
+        msg = bytes(rng.getrandbits(8) for _ in range(length))
+        sig = ed25519.sign(seed, msg)
+        keys.append((pk, sig, msg))
+
+        add(True, pk, sig, msg, "key %u valid" % k)
+        add(False, pk, flip(sig, rng.randrange(255)), msg, "key %u R flipped" % k)
+        add(False, pk, flip(sig, 256 + rng.randrange(252)), msg, "key %u S flipped" % k)
+        if msg:
+            add(False, pk, sig, flip(msg, rng.randrange(8 * len(msg))), "key %u message flipped" % k)
+        add(False, pk, sig, msg + b"\0", "key %u message extended" % k)
+        s = int.from_bytes(sig[32:], "little")
+        add(False, pk, with_s(sig, s + ed25519.L), msg, "key %u S + L" % k)
+        add(False, pk, with_s(sig, s | (1 << (253 + rng.randrange(3)))), msg, "key %u S high bit" % k)
+
+    # a valid signature is not valid under any other key
+    for k in range(KEYS):
+        pk = keys[(k + 1) % KEYS][0]
+        _, sig, msg = keys[k]
+        add(False, pk, sig, msg, "key %u checked with key %u" % (k, (k + 1) % KEYS))
+
+    # the identity is a valid public key: [k]A vanishes, so R = [S]B verifies any message.
+    # Its non-canonical encodings (y = p + 1, or x = 0 with the sign bit set) must not
+    # decode, or a lax decoder would accept the same forgery
+    r = rng.randrange(ed25519.L)
+    forged = ed25519.point_compress(ed25519.point_mul(r, ed25519.B)) + r.to_bytes(32, "little")
+    msg = b"any message"
+    add(True, ed25519.point_compress(ed25519.IDENTITY), forged, msg, "identity public key")
+    for y, sign in ((ed25519.P + 1, 0), (ed25519.P + 1, 1), (1, 1)):
+        pk = (y | (sign << 255)).to_bytes(32, "little")
+        add(False, pk, forged, msg, "identity encoded as y = %x, sign %u" % (y, sign))
+
+    # other public keys that must not decode
+    _, sig, msg = keys[0]
+    for y in range(19):
+        # y + p < 2^255 encodes the same field element as y, with either sign bit
+        for sign in (0, 1):
+            pk = (y + ed25519.P + (sign << 255)).to_bytes(32, "little")
+            add(False, pk, sig, msg, "non-canonical public key y = p + %u, sign %u" % (y, sign))
+    # (0, -1) has x = 0 too: only the positive encoding is valid
+    pk = ((ed25519.P - 1) | (1 << 255)).to_bytes(32, "little")
+    add(False, pk, sig, msg, "public key (0, -1) with sign bit")
+    off_curve = 0
+    while off_curve < 40:
+        y = rng.randrange(ed25519.P)
+        if ed25519.point_decompress(y.to_bytes(32, "little")) is None:
+            add(False, y.to_bytes(32, "little"), sig, msg, "public key y = %x not on the curve" % y)
+            off_curve += 1
+
+    with tempfile.TemporaryDirectory() as tmp:
+        path = os.path.join(tmp, "ed25519_vectors.txt")
+        with open(path, "w") as f:
+            for expect, pk, sig, msg in vectors:
+                f.write("%d %s %s %s\n" % (expect, pk.hex(), sig.hex(), msg.hex() or "-"))
+        status = subprocess.run([tool, path]).returncode
+        check(status == 0, "ed25519_check status %d" % status)
+
+    print("test_ed25519: %u vectors, %s" % (len(vectors), "FAILED" if failed else "ok"))
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
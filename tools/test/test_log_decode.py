@@ -0,0 +1,148 @@
+#!/usr/bin/env python3
+"""user-030: decode the binary log ring written by boot/log/log.c with tools/log_decode.py.
+
+Usage: test_log_decode.py <log_fill>
+
+log_fill runs the real LOG_EMIT/log_bin_begin code on the host with a small
+ring and writes the raw log_ring, the .logstr strings it used, the constant
+strings referenced by %s and the text the host printf expects. This test wraps
+those in a synthetic ELF32 (.logstr at the low 23 bits of the host address,
+.rodata at the truncated pointer, a log_ring symbol) and checks that
+log_decode.py prints the same records, with and without --base.
+
+Record counts go from an empty ring through the first wrap to thousands of
+records, so LOG_RING_PAD at every position and eviction of every record size
+are covered, together with LOG_HDR packing, 64-bit and float arguments.
+"""
+
+import os
+import struct
+import subprocess
+import sys
+import tempfile
+
+TOOLS_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..")
+
+SHT_PROGBITS = 1
+SHT_SYMTAB = 2
+SHT_STRTAB = 3
+SHF_ALLOC = 0x2
+
+# RAM address of log_ring in the synthetic ELF and the start of the --base dump
+RING_ADDR = 0x20000100
+DUMP_BASE = 0x20000000
+
+failed = 0
+runs = 0
+
+
+def check(cond, what):
+    global failed
+    if not cond:
+        failed += 1
+        print("FAILED: %s" % what)
+
+
+def elf32(sections, symbols):
+    """Minimal ELF32 with the given (name, type, flags, addr, data) sections and (name, value, size) symbols."""
+    strtab = b"\0"
+    symtab = bytes(16)
+    for name, value, size in symbols:
+        symtab += struct.pack("<IIIBBH", len(strtab), value, size, 0x11, 0, 1)
+        strtab += name.encode() + b"\0"
+    nsec = len(sections)
+    sections = sections + [(".symtab", SHT_SYMTAB, 0, 0, symtab), (".strtab", SHT_STRTAB, 0, 0, strtab)]
+    shstrtab = b"\0"
+    names = []
+    for s in sections + [(".shstrtab",)]:
+        names.append(len(shstrtab))
+        shstrtab += s[0].encode() + b"\0"
+    sections.append((".shstrtab", SHT_STRTAB, 0, 0, shstrtab))
+
+    body = b""
+    headers = [bytes(40)]
+    offset = 52
+    for i, (_, sh_type, flags, addr, data) in enumerate(sections):
+        link = nsec + 2 if sh_type == SHT_SYMTAB else 0
+        entsize = 16 if sh_type == SHT_SYMTAB else 0
+        headers.append(struct.pack("<10I", names[i], sh_type, flags, addr, offset + len(body), len(data),
+                                   link, 1 if sh_type == SHT_SYMTAB else 0, 1, entsize))
+        body += data
+    shoff = 52 + len(body)
+    ehdr = (b"\x7fELF\x01\x01\x01" + bytes(9)
+            + struct.pack("<HHIIIIIHHHHHH", 2, 40, 1, 0, 0, shoff, 0, 52, 0, 0, 40, len(headers), len(headers) - 1))
+    return ehdr + body + b"".join(headers)
+
+
+def decode(elf, dump, base=None):
+    args = [sys.executable, os.path.join(TOOLS_DIR, "log_decode.py"), elf, dump]
+    if base is not None:
+        args += ["--base", hex(base)]
+    out = subprocess.run(args, stdout=subprocess.PIPE, universal_newlines=True)
+    return out.returncode, out.stdout.splitlines()
+
+
+def strip_stamp(line):
+    """'[    0.000000] I: text' -> 'I: text'; comment lines are kept."""
+    if line.startswith("["):
+        return line[line.index("] ") + 2:]
+    return line
+
+
+def run(tool, count, seed):
+    global runs
+    runs += 1
+    what = "%u records, seed %u" % (count, seed)
+    with tempfile.TemporaryDirectory() as tmp:
+        status = subprocess.run([tool, tmp, str(count), str(seed)]).returncode
+        check(status == 0, "%s: log_fill status %d" % (what, status))
+        if status != 0:
+            return
+
+        def read(name, mode="rb"):
+            with open(os.path.join(tmp, name), mode) as f:
+                return f.read()
+
+        ring = read("log_ring.bin")
+        layout = dict(line.split() for line in read("layout.txt", "r").splitlines())
+        expected = read("expected.txt", "r").splitlines()
+
+        elf = os.path.join(tmp, "log.elf")
+        with open(elf, "wb") as f:
+            f.write(elf32([(".logstr", SHT_PROGBITS, 0, int(layout["logstr"], 16), read("logstr.bin")),
+                           (".rodata", SHT_PROGBITS, SHF_ALLOC, int(layout["names"], 16), read("names.bin"))],
+                          [("log_ring", RING_ADDR, len(ring))]))
+
+        status, lines = decode(elf, os.path.join(tmp, "log_ring.bin"))
+        check(status == 0, "%s: log_decode status %d" % (what, status))
+        check(all(line.startswith("[") for line in lines if not line.startswith("#")),
+              "%s: record without timestamp" % what)
+        got = [strip_stamp(line) for line in lines]
+        check(got == expected, "%s: %u lines decoded, %u expected%s" % (
+            what, len(got), len(expected),
+            "".join("\n  got  %r\n  want %r" % (g, e) for g, e in zip(got, expected) if g != e)[:600]))
+
+        # the same ring inside a larger RAM dump, located through the log_ring symbol
+        dump = os.path.join(tmp, "ram.bin")
+        with open(dump, "wb") as f:
+            f.write(b"\xa5" * (RING_ADDR - DUMP_BASE) + ring + b"\x5a" * 64)
+        status, lines = decode(elf, dump, DUMP_BASE)
+        check(status == 0 and [strip_stamp(line) for line in lines] == expected, "%s: --base" % what)
+
+
+def main():
+    tool = sys.argv[1]
+    # empty, a few records without wrapping, around the first wraps, then long runs
+    for count in (0, 1, 3, 6, 8, 12, 20):
+        run(tool, count, seed=count + 1)
+    for seed in range(1, 41):
+        run(tool, 30 + seed * 7, seed)
+    for seed in (101, 102, 103):
+        run(tool, 5000, seed)
+
+    print("test_log_decode: %u rings decoded, %s" % (runs, "FAILED" if failed else "ok"))
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
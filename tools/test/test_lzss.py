@@ -0,0 +1,126 @@
+#!/usr/bin/env python3
+"""user-039: round trip tools/lzss.py compress through boot/update/lzss.c.
+
+Usage: test_lzss.py <lzss_unpack>
+
+Every input is compressed by the Python encoder, decoded by the C decoder
+(lzss_unpack) with its input split into random chunks, and compared byte by
+byte. Inputs cover empty, one byte, short, repetitive, incompressible random
+and firmware data, over several window and count widths. Corrupt streams
+must be rejected with the right status.
+"""
+
+import os
+import subprocess
+import sys
+import tempfile
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."))
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+import corpus  # noqa: E402
+import lzss  # noqa: E402
+
+# lzss_status_t
+LZSS_OK = 0
+LZSS_ERR_HEADER = 1
+LZSS_ERR_DATA = 2
+
+DEVICE_WINDOW_BITS = 12
+
+failed = 0
+runs = 0
+
+
+def check(cond, what):
+    global failed
+    if not cond:
+        failed += 1
+        print("FAILED: %s" % what)
+
+
+def unpack(tool, blob, max_chunk, seed=1):
+    global runs
+    runs += 1
+    with tempfile.TemporaryDirectory() as tmp:
+        src = os.path.join(tmp, "in.lz")
+        dst = os.path.join(tmp, "out.bin")
+        with open(src, "wb") as f:
+            f.write(blob)
+        status = subprocess.run([tool, src, dst, str(max_chunk), str(seed)]).returncode
+        with open(dst, "rb") as f:
+            return status, f.read()
+
+
+def round_trip(tool, name, data, window_bits, count_bits, chunks):
+    blob = lzss.compress(data, window_bits, count_bits)
+    check(lzss.decompress(blob) == data, "%s W%u C%u: python decompress" % (name, window_bits, count_bits))
+    for max_chunk in chunks:
+        status, out = unpack(tool, blob, max_chunk, seed=len(data) + max_chunk)
+        what = "%s (%u bytes) W%u C%u chunk <= %u" % (name, len(data), window_bits, count_bits, max_chunk)
+        check(status == LZSS_OK, "%s: status %d" % (what, status))
+        check(out == data, "%s: output differs" % what)
+    return blob
+
+
+def main():
+    tool = sys.argv[1]
+    firmware = corpus.firmware()
+    check(len(firmware) > 0, "no firmware objects under build/")
+    rand = corpus.random_bytes(65536, seed=39)
+
+    inputs = [
+        ("empty", b""),
+        ("one byte", b"\xa5"),
+        ("short", b"LZSS"),
+        ("zeros", bytes(5000)),
+        ("erased flash", b"\xff" * 20000),
+        ("period 3", b"abc" * 3000),
+        ("text", open(os.path.join(corpus.REPO_DIR, "tools", "lzss.py"), "rb").read()),
+        ("random", rand),
+        ("firmware", firmware),
+    ]
+
+    # the device build uses W=12/C=5 (image_tool.py default) and accepts W <= 12
+    for name, data in inputs:
+        round_trip(tool, name, data, lzss.WINDOW_BITS, lzss.COUNT_BITS, (1, 7, 4096, 1 << 24))
+    small = firmware[:6000]
+    for window_bits in (4, 8, DEVICE_WINDOW_BITS):
+        for count_bits in (1, 4, 8):
+            round_trip(tool, "firmware head", small, window_bits, count_bits, (5, 1 << 24))
+            round_trip(tool, "period 3", b"abc" * 700, window_bits, count_bits, (1 << 24,))
+
+    # incompressible input grows by at most one flag bit per byte plus the header
+    blob = lzss.compress(rand)
+    check(len(blob) <= lzss.HEADER_SIZE + (9 * len(rand) + 7) // 8,
+          "random: %u bytes compressed to %u" % (len(rand), len(blob)))
+
+    good = lzss.compress(firmware[:3000])
+
+    # truncated stream: the decoder must not report success
+    status, _ = unpack(tool, good[:len(good) // 2], 64)
+    check(status == LZSS_ERR_DATA, "truncated: status %d" % status)
+
+    # bad magic, window wider than the device window, count width out of range
+    for bad, what in ((b"LX" + good[2:], "magic"),
+                      (good[:2] + bytes([DEVICE_WINDOW_BITS + 1]) + good[3:], "window bits"),
+                      (good[:3] + b"\x00" + good[4:], "count bits 0"),
+                      (good[:3] + b"\x09" + good[4:], "count bits 9")):
+        status, _ = unpack(tool, bad, 64)
+        check(status == LZSS_ERR_HEADER, "%s: status %d" % (what, status))
+
+    # a copy as the first code reaches before the start of the output
+    w = lzss._BitWriter()
+    w.put(0, 1)
+    w.put(0, lzss.WINDOW_BITS)
+    w.put(0, lzss.COUNT_BITS)
+    bad = lzss.MAGIC + bytes([lzss.WINDOW_BITS, lzss.COUNT_BITS]) + (1).to_bytes(4, "little") + w.flush()
+    status, _ = unpack(tool, bad, 64)
+    check(status == LZSS_ERR_DATA, "copy before start: status %d" % status)
+
+    print("test_lzss: %u decoder runs, %s" % (runs, "FAILED" if failed else "ok"))
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
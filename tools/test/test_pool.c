@@ -0,0 +1,222 @@
+/*
+ * user-049：固定块内存池
+ *   - pool_init 的等级检查，按大小选等级，0 字节和超过最大等级
+ *   - 等级用完时借用更大的等级 (borrows)，全部用完时返回 NULL (fails)
+ *   - 释放不属于本池、不在块起点的指针被拒绝
+ *   - 重复释放：只有该等级 used == 0 时能发现，等级中还有别的块在用时发现不了，
+ *     同一块会在空闲链表中出现两次，下面的用例记录这一限制
+ *   - 随机分配释放与影子记录比较：块不重叠、8 字节对齐、used/peak 正确
+ */
+#include <stdint.h>
+#include <string.h>
+#include "os.h"
+#include "pool.h"
+#include "test_util.h"
+
+
+POOL_BUFFER(small_buf, 24, 8, POOL_SRAM);
+POOL_BUFFER(mid_buf, 64, 4, POOL_SRAM);
+POOL_BUFFER(large_buf, 256, 2, POOL_SRAM);
+
+static pool_class_t classes[3];
+static pool_t pool;
+
+static void setup(void)
+{
+    pool_class_init(&classes[0], small_buf, 24, 8);
+    pool_class_init(&classes[1], mid_buf, 64, 4);
+    pool_class_init(&classes[2], large_buf, 256, 2);
+    TEST_CHECK(pool_init(&pool, classes, 3));
+}
+
+static void test_init(void)
+{
+    pool_class_t bad[2];
+
+    pool_class_init(&bad[0], mid_buf, 64, 4);
+    pool_class_init(&bad[1], small_buf, 24, 8);
+    TEST_CHECK(!pool_init(&pool, bad, 2));
+    pool_class_init(&bad[1], large_buf, 64, 2);
+    TEST_CHECK(!pool_init(&pool, bad, 2));
+    TEST_CHECK(!pool_init(&pool, bad, 0));
+    TEST_CHECK(!pool_init(&pool, bad, POOL_MAX_CLASSES + 1U));
+
+    // 块大小向上取整到 POOL_ALIGN
+    setup();
+    TEST_CHECK(classes[0].block_size == 24U);
+    pool_class_init(&bad[0], small_buf, 20, 8);
+    TEST_CHECK(bad[0].block_size == 24U);
+}
+
+static void test_select(void)
+{
+    void *p;
+
+    setup();
+    p = pool_alloc(&pool, 0);
+    TEST_CHECK(pool_block_size(&pool, p) == 24U);
+    TEST_CHECK(pool_free(&pool, p));
+    p = pool_alloc(&pool, 24);
+    TEST_CHECK(pool_block_size(&pool, p) == 24U);
+    TEST_CHECK(pool_free(&pool, p));
+    p = pool_alloc(&pool, 25);
+    TEST_CHECK(pool_block_size(&pool, p) == 64U);
+    TEST_CHECK(pool_free(&pool, p));
+    p = pool_alloc(&pool, 256);
+    TEST_CHECK(pool_block_size(&pool, p) == 256U);
+    TEST_CHECK(pool_free(&pool, p));
+
+    TEST_CHECK(pool_alloc(&pool, 257) == NULL);
+    TEST_CHECK(pool.fails == 1U);
+    TEST_CHECK(pool.borrows == 0U);
+    TEST_CHECK(pool_free(&pool, NULL));
+}
+
+static void test_borrow(void)
+{
+    void *small[8], *mid[4], *p, *q;
+
+    setup();
+    for (int i = 0; i < 8; i++)
+        small[i] = pool_alloc(&pool, 16);
+    TEST_CHECK(classes[0].used == 8U && classes[0].free == NULL);
+
+    // 最小等级用完，依次借用更大的等级
+    for (int i = 0; i < 4; i++)
+    {
+        mid[i] = pool_alloc(&pool, 16);
+        TEST_CHECK(pool_block_size(&pool, mid[i]) == 64U);
+    }
+    TEST_CHECK(pool.borrows == 4U);
+    p = pool_alloc(&pool, 16);
+    q = pool_alloc(&pool, 16);
+    TEST_CHECK(pool_block_size(&pool, p) == 256U && pool_block_size(&pool, q) == 256U);
+    TEST_CHECK(pool.borrows == 6U);
+
+    // 全部用完
+    TEST_CHECK(pool_alloc(&pool, 16) == NULL);
+    TEST_CHECK(pool_alloc(&pool, 100) == NULL);
+    TEST_CHECK(pool.fails == 2U);
+
+    // 释放借来的块回到它所属的等级，之后小请求又先用小等级
+    TEST_CHECK(pool_free(&pool, p));
+    TEST_CHECK(classes[2].used == 1U);
+    TEST_CHECK(pool_free(&pool, small[3]));
+    TEST_CHECK(pool_alloc(&pool, 16) == small[3]);
+    TEST_CHECK(classes[0].peak == 8U && classes[1].peak == 4U && classes[2].peak == 2U);
+    (void)q;
+}
+
+static void test_foreign(void)
+{
+    static uint8_t other[64] POOL_SRAM;
+    uint8_t local[32];
+    uint8_t *p;
+
+    setup();
+    p = pool_alloc(&pool, 64);
+    TEST_CHECK(p != NULL);
+
+    TEST_CHECK(!pool_free(&pool, local));
+    TEST_CHECK(!pool_free(&pool, other));
+    TEST_CHECK(!pool_free(&pool, p + 8));
+    TEST_CHECK(!pool_free(&pool, p + 1));
+    TEST_CHECK(pool_block_size(&pool, local) == 0U);
+    TEST_CHECK(pool_block_size(&pool, p + 8) == 0U);
+    TEST_CHECK(classes[1].used == 1U);
+
+    TEST_CHECK(pool_free(&pool, p));
+    TEST_CHECK(classes[1].used == 0U);
+}
+
+static void test_double_free(void)
+{
+    void *a, *b, *c, *d;
+
+    // 等级中没有块在用：可以发现
+    setup();
+    a = pool_alloc(&pool, 8);
+    TEST_CHECK(pool_free(&pool, a));
+    TEST_CHECK(!pool_free(&pool, a));
+    TEST_CHECK(classes[0].used == 0U);
+
+    // 等级中还有 b 在用：第二次释放 a 被接受，计数被扣成 0
+    setup();
+    a = pool_alloc(&pool, 8);
+    b = pool_alloc(&pool, 8);
+    TEST_CHECK(pool_free(&pool, a));
+    TEST_CHECK(pool_free(&pool, a));            // 未发现
+    TEST_CHECK(classes[0].used == 0U);
+    // 于是 b 的正常释放反而被拒绝
+    TEST_CHECK(!pool_free(&pool, b));
+    // a 在空闲链表中出现两次，接下来两次分配拿到同一块
+    c = pool_alloc(&pool, 8);
+    d = pool_alloc(&pool, 8);
+    TEST_CHECK(c == a && d == a);
+}
+
+static void test_random(void)
+{
+    enum { SLOTS = 32 };
+    uint8_t *held[SLOTS] = { 0 };
+    uint32_t size[SLOTS] = { 0 };
+    uint32_t used[3], peak[3] = { 0 };
+
+    setup();
+    for (int t = 0; t < 200000 && test_failed < 20; t++)
+    {
+        int i = (int)(test_rand() % SLOTS);
+
+        if (held[i] == NULL)
+        {
+            size[i] = (uint32_t)(test_rand() % 260U);
+            held[i] = pool_alloc(&pool, size[i]);
+            if (held[i] == NULL)
+                continue;
+            TEST_CHECK(((uintptr_t)held[i] & (POOL_ALIGN - 1U)) == 0);
+            TEST_CHECK(pool_block_size(&pool, held[i]) >= size[i]);
+            // 写满整块，重叠的块会破坏别人的内容
+            memset(held[i], i, pool_block_size(&pool, held[i]));
+        }
+        else
+        {
+            for (uint32_t k = 0; k < pool_block_size(&pool, held[i]); k++)
+            {
+                if (held[i][k] != (uint8_t)i)
+                {
+                    TEST_CHECK(held[i][k] == (uint8_t)i);
+                    break;
+                }
+            }
+            TEST_CHECK(pool_free(&pool, held[i]));
+            held[i] = NULL;
+        }
+
+        memset(used, 0, sizeof(used));
+        for (int k = 0; k < SLOTS; k++)
+        {
+            if (held[k] != NULL)
+                used[pool_block_size(&pool, held[k]) == 24U ? 0 : pool_block_size(&pool, held[k]) == 64U ? 1 : 2]++;
+        }
+        for (int c = 0; c < 3; c++)
+        {
+            if (used[c] > peak[c])
+                peak[c] = used[c];
+            TEST_CHECK(classes[c].used == used[c]);
+            TEST_CHECK(classes[c].peak == peak[c]);
+        }
+    }
+    TEST_CHECK(test_critical_depth == 0U);
+}
+
+int main(int argc, char **argv)
+{
+    test_init();
+    test_select();
+    test_borrow();
+    test_foreign();
+    test_double_free();
+    test_random();
+
+    return test_result("test_pool");
+}
@@ -0,0 +1,308 @@
+/*
+ * user-033：预解析格式 (printf_compiled / snprintf_compiled / spanprintf_compiled) 与同一格式串的
+ * snprintf_ / printf_ / spanprintf 逐字节比较。
+ * 格式由 test_printf_span 的标志、长度修饰和文字片段随机拼出 1..16 个转换，
+ * 超过 PRINTF_COMPILED_MAX_OPS 个片段的格式必须退回普通解析；每个描述符调用两次，
+ * 第一次解析，第二次走 op[]；输出长度随机截断，也包括 NULL 缓冲区。
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "_printf_.h"
+#include "test_util.h"
+
+
+#define OUT_SIZE    4096
+#define FMT_SIZE    512
+#define SLOTS       20
+
+/* printf_fmt_t.state，与 _printf_.c 中的定义相同 */
+#define FMT_COMPILED    1U
+#define FMT_PLAIN       2U
+
+static char out_put[OUT_SIZE];
+static size_t out_put_len;
+
+void _putchar(char character)
+{
+    if (out_put_len < OUT_SIZE)
+        out_put[out_put_len++] = character;
+}
+
+static void span_out(const char* data, size_t len, void* arg)
+{
+    (void)arg;
+    while (len--)
+        _putchar(*data++);
+}
+
+static const char *const flag_set[] = {"", "-", "+", " ", "0", "#", "-+", "0#", "+ ", "-#0"};
+static const char *const int_len_set[] = {"", "h", "hh"};
+static const char int_conv[] = "diuxXobc";
+static const char float_conv[] = "feEgG";
+static const char *const literal_set[] = {"", "x", "value=", "[", "] done\n", "%%", "ab%%cd", " "};
+static const char *const str_set[] = {"", "a", "hello", "update block 17 of 512", "\t\n"};
+
+static const char *pick(const char *const *set, size_t n)
+{
+    return set[test_rand() % n];
+}
+
+#define PICK(set)   pick(set, sizeof(set) / sizeof(set[0]))
+
+/* 参数按槽位轮换类型 int, long long, const char *, double；全整数格式的参数都是 int */
+typedef struct
+{
+    int i[SLOTS];
+    long long ll[SLOTS];
+    const char *s[SLOTS];
+    double d[SLOTS];
+} args_t;
+
+#define MIXED_ARGS(a) \
+    a.i[0], a.ll[0], a.s[0], a.d[0], a.i[1], a.ll[1], a.s[1], a.d[1], a.i[2], a.ll[2], a.s[2], a.d[2], \
+    a.i[3], a.ll[3], a.s[3], a.d[3], a.i[4], a.ll[4], a.s[4], a.d[4]
+
+#define INT_ARGS(a) \
+    a.i[0], a.i[1], a.i[2], a.i[3], a.i[4], a.i[5], a.i[6], a.i[7], a.i[8], a.i[9], \
+    a.i[10], a.i[11], a.i[12], a.i[13], a.i[14], a.i[15], a.i[16], a.i[17], a.i[18], a.i[19]
+
+/* 取 * 宽度/精度的参数位置，这些参数取小值 */
+static uint32_t star_mask;
+
+/* 追加一个转换的标志、宽度和精度；slots 非空时可用 * 从参数取，每个 * 多占一个 int 参数 */
+static char *put_spec(char *p, unsigned int *slots)
+{
+    // 最多 16 个转换，* 最多 SLOTS - 16 个
+    const bool stars = slots != NULL && __builtin_popcount(star_mask) + 2 <= SLOTS - 16;
+
+    p += sprintf(p, "%%%s", PICK(flag_set));
+    if (test_rand() % 3 == 0)
+    {
+        if (stars && test_rand() % 3 == 0)
+        {
+            *p++ = '*';
+            star_mask |= 1U << (*slots)++;
+        }
+        else
+        {
+            p += sprintf(p, "%d", (int)(test_rand() % 24));
+        }
+    }
+    if (test_rand() % 3 == 0)
+    {
+        if (stars && test_rand() % 3 == 0)
+        {
+            p += sprintf(p, ".*");
+            star_mask |= 1U << (*slots)++;
+        }
+        else
+        {
+            p += sprintf(p, ".%d", (int)(test_rand() % 20));
+        }
+    }
+    return p;
+}
+
+/*
+ * 生成格式串，返回预解析所需的片段数（连续文字算一段，每个转换含 %% 一段）；
+ * mixed 时第 k 个转换按槽位 k 的类型取参数，否则全部是 int 转换，可带 *，参数总数不超过 SLOTS
+ */
+static unsigned int make_format(char *fmt, bool mixed, unsigned int conversions, unsigned int *slots)
+{
+    unsigned int ops = 0;
+    bool literal = false;
+    char *p = fmt;
+
+    *slots = 0;
+    star_mask = 0;
+    for (unsigned int k = 0; k < conversions; k++)
+    {
+        const char *text = PICK(literal_set);
+
+        // 文字片段中的 %% 各是一段，前后的普通文字各自成段
+        for (const char *t = text; *t; )
+        {
+            if (*t == '%')
+            {
+                ops++;
+                literal = false;
+                t += 2;
+                continue;
+            }
+            if (!literal)
+                ops++;
+            literal = true;
+            t++;
+        }
+        p += sprintf(p, "%s", text);
+
+        if (!mixed)
+        {
+            p = put_spec(p, slots);
+            p += sprintf(p, "%s%c", PICK(int_len_set), int_conv[test_rand() % (sizeof(int_conv) - 1U)]);
+        }
+        else
+        {
+            switch (k % 4U)
+            {
+            case 0:
+                p = put_spec(p, NULL);
+                p += sprintf(p, "%s%c", PICK(int_len_set), int_conv[test_rand() % (sizeof(int_conv) - 1U)]);
+                break;
+            case 1:
+                p = put_spec(p, NULL);
+                p += sprintf(p, "ll%c", int_conv[test_rand() % (sizeof(int_conv) - 2U)]);
+                break;
+            case 2:
+                p = put_spec(p, NULL);
+                *p++ = 's';
+                break;
+            default:
+                p = put_spec(p, NULL);
+                *p++ = float_conv[test_rand() % (sizeof(float_conv) - 1U)];
+                break;
+            }
+        }
+        *p = '\0';
+        ops++;
+        literal = false;
+        (*slots)++;
+    }
+    if (test_rand() % 2)
+    {
+        strcpy(p, " end");
+        ops++;
+    }
+    return ops;
+}
+
+static void fill_args(args_t *a)
+{
+    for (unsigned int k = 0; k < SLOTS; k++)
+    {
+        uint64_t r = test_rand() >> (test_rand() % 64);
+
+        a->i[k] = test_rand() % 4 && !(star_mask & (1U << k)) ? (int)r : (int)(test_rand() % 40) - 10;
+        a->ll[k] = (long long)r;
+        a->s[k] = PICK(str_set);
+        a->d[k] = (double)(int64_t)test_rand() / (double)(1ULL << (test_rand() % 60));
+    }
+}
+
+static long checked, plain;
+
+static void check_one(bool mixed)
+{
+    char fmt[FMT_SIZE], buf_c[OUT_SIZE], buf_p[OUT_SIZE], put_c[OUT_SIZE];
+    // 多数格式能放进 op[]，四分之一可能超出
+    unsigned int conversions = 1U + (unsigned int)(test_rand() % (test_rand() % 4 ? 6U : 16U));
+    unsigned int slots, ops = make_format(fmt, mixed, conversions, &slots);
+    printf_fmt_t desc = PRINTF_FMT_INIT(fmt);
+    size_t count = test_rand() % 3 == 0 ? (size_t)(test_rand() % 60) : sizeof(buf_c);
+    size_t put_c_len;
+    args_t a;
+    int n_c, n_p;
+
+    fill_args(&a);
+
+    for (int call = 0; call < 2; call++)
+    {
+        memset(buf_c, 0x55, sizeof(buf_c));
+        memset(buf_p, 0x55, sizeof(buf_p));
+        out_put_len = 0;
+
+        if (mixed)
+        {
+            n_c = snprintf_compiled(buf_c, count, &desc, MIXED_ARGS(a));
+            n_p = snprintf_(buf_p, count, fmt, MIXED_ARGS(a));
+            printf_compiled(&desc, MIXED_ARGS(a));
+            spanprintf_compiled(span_out, NULL, &desc, MIXED_ARGS(a));
+        }
+        else
+        {
+            n_c = snprintf_compiled(buf_c, count, &desc, INT_ARGS(a));
+            n_p = snprintf_(buf_p, count, fmt, INT_ARGS(a));
+            printf_compiled(&desc, INT_ARGS(a));
+            spanprintf_compiled(span_out, NULL, &desc, INT_ARGS(a));
+        }
+        put_c_len = out_put_len;
+        memcpy(put_c, out_put, out_put_len);
+        out_put_len = 0;
+        if (mixed)
+            printf_(fmt, MIXED_ARGS(a));
+        else
+            printf_(fmt, INT_ARGS(a));
+
+        // printf_compiled 和 spanprintf_compiled 的输出都追加在 put_c 中
+        if (n_c != n_p || memcmp(buf_c, buf_p, sizeof(buf_c)) != 0 ||
+            put_c_len != 2U * out_put_len ||
+            memcmp(put_c, out_put, out_put_len) != 0 || memcmp(put_c + out_put_len, out_put, out_put_len) != 0)
+        {
+            test_failed++;
+            printf("format \"%s\" count %u call %d: snprintf %d/%d \"%.*s\" vs \"%.*s\"\n", fmt, (unsigned)count,
+                   call, n_c, n_p, (int)(count ? count : 1) - 1, buf_c, (int)(count ? count : 1) - 1, buf_p);
+        }
+
+        // NULL 缓冲区只计算长度；printf 不输出 %c 的 '\0'，长度以 snprintf_ 为准
+        n_c = mixed ? snprintf_compiled(NULL, 0, &desc, MIXED_ARGS(a)) : snprintf_compiled(NULL, 0, &desc, INT_ARGS(a));
+        TEST_CHECK(n_c == n_p);
+    }
+
+    TEST_CHECK(desc.state == (ops > PRINTF_COMPILED_MAX_OPS ? FMT_PLAIN : FMT_COMPILED));
+    if (desc.state == FMT_COMPILED)
+        TEST_CHECK(desc.count == ops);
+    plain += desc.state == FMT_PLAIN;
+    checked++;
+}
+
+/* 固定的边界：正好 PRINTF_COMPILED_MAX_OPS 段、多一段、空格式、末尾单独的 % */
+_Static_assert(PRINTF_COMPILED_MAX_OPS == 12U, "the fixed cases below are written for the default");
+
+static void check_fixed(void)
+{
+    static const struct
+    {
+        const char *fmt;
+        uint8_t state;
+    } cases[] = {
+        {"%d%d%d%d%d%d%d%d%d%d%d%d", FMT_COMPILED},
+        {"%d%d%d%d%d%d%d%d%d%d%d%d%d", FMT_PLAIN},
+        {"a%db%dc%dd%de%df%d", FMT_COMPILED},
+        {"a%db%dc%dd%de%df%dg", FMT_PLAIN},
+        {"", FMT_COMPILED},
+        {"100%%", FMT_COMPILED},
+        {"tail %", FMT_COMPILED},
+    };
+    char buf_c[64], buf_p[64];
+
+    for (size_t k = 0; k < sizeof(cases) / sizeof(cases[0]); k++)
+    {
+        printf_fmt_t desc = PRINTF_FMT_INIT(cases[k].fmt);
+
+        for (size_t count = 0; count <= sizeof(buf_c); count += 7)
+        {
+            int n_c, n_p;
+
+            memset(buf_c, 0x55, sizeof(buf_c));
+            memset(buf_p, 0x55, sizeof(buf_p));
+            n_c = snprintf_compiled(buf_c, count, &desc, 1, -2, 3, -4, 5, -6, 7, -8, 9, -10, 11, -12, 13);
+            n_p = snprintf_(buf_p, count, cases[k].fmt, 1, -2, 3, -4, 5, -6, 7, -8, 9, -10, 11, -12, 13);
+            TEST_CHECK(n_c == n_p && memcmp(buf_c, buf_p, sizeof(buf_c)) == 0);
+        }
+        TEST_CHECK(desc.state == cases[k].state);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    long n = argc > 1 ? atol(argv[1]) : 100000;
+
+    check_fixed();
+    for (long i = 0; i < n && test_failed < 20; i++)
+        check_one(i % 2 == 0);
+    printf("%ld formats, %ld fell back to the plain parser\n", checked, plain);
+
+    return test_result("test_printf_compiled");
+}
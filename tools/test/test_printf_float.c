@@ -0,0 +1,188 @@
+/*
+ * user-032：%f/%e/%g 与 glibc snprintf 逐字节比较，%r/%hr 检查最短往返。
+ *
+ * 唯一允许的差别：%#g 在舍入进位后改用指数形式时（如 999999.5 -> "1.00000e+06"），
+ * 本实现按 C 标准保留 prec 位有效数字，glibc 输出 "1.e+06"。这类结果只要数值相同、
+ * 本实现的有效数字位数等于精度，就计为已知差别而不是失败。
+ */
+#include <ctype.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "_printf_.h"
+#include "test_util.h"
+
+
+void _putchar(char character)
+{
+    (void)character;
+}
+
+static const char *const formats[] = {
+    "%f", "%.0f", "%.1f", "%.3f", "%10.4f", "%-10.2f|", "%+f", "% f", "%e", "%.3e", "%g", "%.4g",
+    "%G", "%E", "%012.3f", "%.9f", "%.12f", "%.3g", "%#g", "%#.0f", "%#.0e", "%.20f", "%.17g",
+    "%.30e", "%-+12.5e|", "%015.4e", "%.0e", "%.0g", "%#.3g", "%.40f", "%.1g", "%+.2G", "%F",
+    "%010f", "%-8g|", "%.15g", "%.16e",
+};
+
+static const double specials[] = {
+    0.0, -0.0, INFINITY, -INFINITY, NAN, -NAN, 0.5, 1.5, 2.5, 0.125, 9.5, 99.5, 999999.5, 1e300,
+    1.7976931348623157e308, 5e-324, 2.2250738585072014e-308, 0.1, 1e-5, 123456789012345678.0,
+    1e22, 1e23, 0.05, 0.15, 0.25, 0.35, 9.9999999, 0.00009999995,
+};
+
+static long compared, known_diffs, roundtrips;
+
+static double pick(void)
+{
+    uint64_t r = test_rand();
+    double d;
+
+    switch (test_rand() % 6)
+    {
+    case 0:     // 任意位模式
+        memcpy(&d, &r, sizeof(d));
+        return d;
+    case 1:
+        return (double)(int64_t)(r >> (test_rand() % 64)) / (double)(1ULL << (test_rand() % 50)) * ((r & 1) ? -1 : 1);
+    case 2:     // float 能表示的值
+        return (float)((double)(int32_t)r / (double)(1U << (test_rand() % 31)));
+    case 3:     // 短小数和恰好在中点的值
+    {
+        double b = (double)(test_rand() % 100000);
+        int s = (int)(test_rand() % 12);
+        for (int i = 0; i < s; i++)
+            b /= 10;
+        return b + (test_rand() % 2 ? 0.5 * pow(10, -(int)(test_rand() % 8)) : 0);
+    }
+    case 4:
+        return ldexp((double)(r >> 11), (int)(test_rand() % 2100) - 1100);
+    default:
+    {
+        float f;
+        uint32_t u = (uint32_t)r;
+        memcpy(&f, &u, sizeof(f));
+        return f;
+    }
+    }
+}
+
+/* 有效数字位数：第一个非零数字起到指数之前 */
+static int sig_digits(const char *s)
+{
+    int n = 0;
+
+    while (*s && !(*s >= '1' && *s <= '9') && *s != 'e' && *s != 'E')
+        s++;
+    while (*s && *s != 'e' && *s != 'E')
+        n += isdigit((unsigned char)*s++) != 0;
+    return n;
+}
+
+/* %#g 舍入进位后的已知差别，见文件开头 */
+static bool known_hash_g(const char *fmt, const char *got, const char *want)
+{
+    const char *dot = strchr(fmt, '.');
+    int prec = dot ? atoi(dot + 1) : 6;
+
+    if (!strstr(fmt, "#") || !strpbrk(fmt, "gG"))
+        return false;
+    return strtod(got, NULL) == strtod(want, NULL) && sig_digits(got) == (prec ? prec : 1);
+}
+
+static void check_value(double d, bool all_formats)
+{
+    char a[2048], b[2048];
+
+    for (size_t j = 0; j < sizeof(formats) / sizeof(formats[0]); j++)
+    {
+        if (!all_formats && test_rand() % 4)
+            continue;
+
+        int n1 = snprintf_(a, sizeof(a), formats[j], d);
+        int n2 = snprintf(b, sizeof(b), formats[j], d);
+
+        compared++;
+        if (n1 == n2 && strcmp(a, b) == 0)
+            continue;
+        if (known_hash_g(formats[j], a, b))
+        {
+            known_diffs++;
+            continue;
+        }
+        if (test_failed++ < 20)
+            printf("%s %.17g (%a): got '%s' (%d) want '%s' (%d)\n", formats[j], d, d, a, n1, b, n2);
+    }
+}
+
+/* 去掉首尾的 0 后尾数的位数 */
+static int mantissa_digits(const char *s)
+{
+    int n = sig_digits(s), zeros = 0;
+    const char *end = s + strcspn(s, "eE");
+
+    while (end > s && (end[-1] == '0' || end[-1] == '.'))
+        zeros += *--end == '0';
+    return n - zeros;
+}
+
+/* %r 的输出能还原出原值，且没有更短的 %.Ne 也能还原 */
+static void check_roundtrip(double d, bool shortest)
+{
+    char a[64], b[64];
+
+    if (!isfinite(d))
+        return;
+
+    snprintf_(a, sizeof(a), "%r", d);
+    roundtrips++;
+    if (strtod(a, NULL) != d)
+    {
+        if (test_failed++ < 20)
+            printf("%%r %a: '%s' does not round-trip\n", d, a);
+        return;
+    }
+
+    if (shortest && d != 0)
+    {
+        int n = mantissa_digits(a);
+        snprintf(b, sizeof(b), "%.*e", n - 2, d);
+        if (n >= 2 && strtod(b, NULL) == d)
+        {
+            if (test_failed++ < 20)
+                printf("%%r %a: '%s' is not the shortest, '%s' also round-trips\n", d, a, b);
+        }
+    }
+
+    if ((double)(float)d == d)
+    {
+        float f = (float)d;
+        snprintf_(a, sizeof(a), "%hr", d);
+        if (strtof(a, NULL) != f && test_failed++ < 20)
+            printf("%%hr %a: '%s' does not round-trip\n", d, a);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    long n = argc > 1 ? atol(argv[1]) : 100000;
+
+    for (size_t i = 0; i < sizeof(specials) / sizeof(specials[0]); i++)
+    {
+        check_value(specials[i], true);
+        check_roundtrip(specials[i], true);
+    }
+
+    for (long i = 0; i < n && test_failed < 20; i++)
+    {
+        double d = pick();
+        check_value(d, false);
+        check_roundtrip(d, (i & 7) == 0);
+    }
+
+    printf("%ld comparisons with glibc, %ld known %%#g differences, %ld round-trips\n",
+           compared, known_diffs, roundtrips);
+    return test_result("test_printf_float");
+}
@@ -0,0 +1,151 @@
+/*
+ * user-031：整数转换 (_ntoa_long/_ntoa_long_long) 与原实现逐字节比较。
+ *   - 32 位值：0..2^17、每个 10 的幂和 2 的幂附近、按步长扫过整个 2^32；
+ *     参数 --full 时逐个比较全部 2^32 个值（较慢，只手动运行）
+ *   - 64 位值：10^9 分组边界附近和随机值，检查 /1e9 的倒数乘法
+ * 每个值都经过十进制、有符号、十六进制、八进制、二进制以及宽度、精度、标志的组合。
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "_printf_.h"
+#include "ref/printf_ref.h"
+#include "test_util.h"
+
+
+void _putchar(char character)
+{
+    (void)character;
+}
+
+void ref_putchar(char character)
+{
+    (void)character;
+}
+
+static const char *const fmt32[] = {
+    "%u", "%d", "%x", "%X", "%o", "%b", "%#x", "%#o", "%12u", "%-12d|", "%+d", "% d",
+    "%012d", "%.12u", "%.0u", "%#.10x", "%08X", "%+.3d", "%lu", "%ld",
+};
+
+static const char *const fmt64[] = {
+    "%llu", "%lld", "%llx", "%llX", "%llo", "%llb", "%#llx", "%24llu", "%-24lld|", "%+lld",
+    "%024lld", "%.22llu", "%.0llu", "%#.20llo",
+};
+
+static long checked;
+
+static void compare(const char *fmt, int n_new, const char *new_buf, int n_ref, const char *ref_buf)
+{
+    checked++;
+    if (n_new != n_ref || strcmp(new_buf, ref_buf) != 0)
+    {
+        if (test_failed++ < 20)
+            printf("\"%s\": \"%s\" (%d) vs \"%s\" (%d)\n", fmt, new_buf, n_new, ref_buf, n_ref);
+    }
+}
+
+static void check32(uint32_t v)
+{
+    char a[80], b[80];
+
+    for (size_t i = 0; i < sizeof(fmt32) / sizeof(fmt32[0]); i++)
+    {
+        const char *fmt = fmt32[i];
+        int na, nb;
+
+        if (strchr(fmt, 'l'))
+        {
+            // long 参数：有符号的按 int32 符号扩展，和目标上 32 位 long 的值一致
+            long lv = strchr(fmt, 'd') ? (long)(int32_t)v : (long)v;
+            na = snprintf_(a, sizeof(a), fmt, lv);
+            nb = ref_snprintf_(b, sizeof(b), fmt, lv);
+        }
+        else
+        {
+            na = snprintf_(a, sizeof(a), fmt, v);
+            nb = ref_snprintf_(b, sizeof(b), fmt, v);
+        }
+        compare(fmt, na, a, nb, b);
+    }
+}
+
+static void check64(uint64_t v)
+{
+    char a[80], b[80];
+
+    for (size_t i = 0; i < sizeof(fmt64) / sizeof(fmt64[0]); i++)
+    {
+        int na = snprintf_(a, sizeof(a), fmt64[i], (unsigned long long)v);
+        int nb = ref_snprintf_(b, sizeof(b), fmt64[i], (unsigned long long)v);
+
+        compare(fmt64[i], na, a, nb, b);
+    }
+}
+
+/* 只比较 %u，用于 --full */
+static void check32_fast(uint32_t v)
+{
+    char a[16], b[16];
+    int na = snprintf_(a, sizeof(a), "%u", v);
+    int nb = ref_snprintf_(b, sizeof(b), "%u", v);
+
+    compare("%u", na, a, nb, b);
+}
+
+int main(int argc, char **argv)
+{
+    bool full = argc > 1 && strcmp(argv[1], "--full") == 0;
+    uint64_t p;
+    uint32_t v;
+
+    for (v = 0; v < (1U << 17); v++)
+        check32(v);
+
+    for (p = 1; p <= UINT32_MAX; p *= 10)
+    {
+        for (int64_t d = -300; d <= 300; d++)
+            check32((uint32_t)(p + (uint64_t)d));
+    }
+    for (int s = 0; s < 32; s++)
+    {
+        for (int64_t d = -3; d <= 3; d++)
+            check32((uint32_t)((1ULL << s) + (uint64_t)d));
+    }
+
+    // 步长取质数，扫过整个 32 位范围
+    for (uint64_t x = 0; x <= UINT32_MAX; x += 16411)
+        check32((uint32_t)x);
+
+    for (p = 1; p <= UINT64_MAX / 10; p *= 10)
+    {
+        for (int64_t d = -1000; d <= 1000; d++)
+        {
+            check64(p + (uint64_t)d);
+            check64(p * 7 + (uint64_t)d);
+        }
+    }
+    for (int s = 0; s < 64; s++)
+        check64(1ULL << s), check64((1ULL << s) - 1U), check64(~(1ULL << s));
+    check64(UINT64_MAX);
+    check64((uint64_t)INT64_MIN);
+
+    for (long i = 0; i < 500000; i++)
+    {
+        uint64_t r = test_rand();
+        check64(r >> (r & 63));
+    }
+
+    if (full)
+    {
+        v = 0;
+        do
+        {
+            check32_fast(v);
+        } while (++v != 0);
+    }
+
+    printf("%ld comparisons\n", checked);
+    return test_result("test_printf_int");
+}
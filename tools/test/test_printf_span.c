@@ -0,0 +1,172 @@
+/*
+ * user-029：按 (指针, 长度) 成段输出的 printf 与原实现逐字节比较。
+ * 覆盖 snprintf_（含截断）、printf_ 经 _putchars 的输出、spanprintf 的回调输出。
+ * 浮点格式在 user-032 中改为精确转换，与原实现不再相同，由 test_printf_float 对照 glibc。
+ */
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "_printf_.h"
+#include "ref/printf_ref.h"
+#include "test_util.h"
+
+
+#define OUT_SIZE    512
+
+static char out_new[OUT_SIZE];
+static size_t out_new_len;
+static char out_ref[OUT_SIZE];
+static size_t out_ref_len;
+
+void _putchar(char character)
+{
+    if (out_new_len < OUT_SIZE)
+        out_new[out_new_len++] = character;
+}
+
+void _putchars(const char* data, size_t len)
+{
+    while (len--)
+        _putchar(*data++);
+}
+
+void ref_putchar(char character)
+{
+    if (out_ref_len < OUT_SIZE)
+        out_ref[out_ref_len++] = character;
+}
+
+static void span_out(const char* data, size_t len, void* arg)
+{
+    (void)arg;
+    _putchars(data, len);
+}
+
+static const char *const flag_set[] = {"", "-", "+", " ", "0", "#", "-+", "0#", "+ ", "-#0"};
+static const char *const len_set[] = {"", "l", "ll", "h", "hh", "z", "j"};
+static const char int_conv[] = "diuxXob";
+static const char *const literal_set[] = {"", "x", "value=", "[", "] done\n", "%%", "ab%%cd"};
+
+static const char *pick(const char *const *set, size_t n)
+{
+    return set[test_rand() % n];
+}
+
+#define PICK(set)   pick(set, sizeof(set) / sizeof(set[0]))
+
+/* 生成 "<文字><转换><文字>"，返回转换字符 */
+static char make_format(char *fmt, size_t size, const char **lenmod)
+{
+    char conv, spec[32];
+    int width = (int)(test_rand() % 4) == 0 ? (int)(test_rand() % 24) : -1;
+    int prec = (int)(test_rand() % 4) == 0 ? (int)(test_rand() % 24) : -1;
+    uint32_t kind = (uint32_t)(test_rand() % 10);
+    char *p = spec;
+
+    *lenmod = "";
+    if (kind < 7)
+    {
+        conv = int_conv[test_rand() % (sizeof(int_conv) - 1U)];
+        *lenmod = PICK(len_set);
+    }
+    else
+    {
+        conv = kind == 7 ? 's' : kind == 8 ? 'c' : 'p';
+    }
+
+    p += sprintf(p, "%%%s", PICK(flag_set));
+    if (width >= 0)
+        p += sprintf(p, test_rand() % 8 ? "%d" : "*", width);
+    if (prec >= 0)
+        p += sprintf(p, test_rand() % 8 ? ".%d" : ".*", prec);
+    sprintf(p, "%s%c", *lenmod, conv);
+
+    snprintf(fmt, size, "%s%s%s", PICK(literal_set), spec, PICK(literal_set));
+    return conv;
+}
+
+/* 按格式中 * 的个数在参数前插入宽度/精度 */
+#define CALL_ARGS(f, ...) \
+    (stars == 0 ? f(__VA_ARGS__, value) : \
+     stars == 1 ? f(__VA_ARGS__, star1, value) : f(__VA_ARGS__, star1, star2, value))
+
+static const char *const str_set[] = {"", "a", "hello", "update block 17 of 512", "\t\n"};
+
+static void check_one(void)
+{
+    char fmt[96], buf_new[OUT_SIZE], buf_ref[OUT_SIZE];
+    const char *lenmod;
+    char conv = make_format(fmt, sizeof(fmt), &lenmod);
+    size_t count = test_rand() % 3 == 0 ? (size_t)(test_rand() % 40) : sizeof(buf_new);
+    int stars = 0, star1 = (int)(test_rand() % 30) - 10, star2 = (int)(test_rand() % 30) - 10;
+    int n_new = 0, n_ref = 0;
+    uint64_t r = test_rand() >> (test_rand() % 64);
+
+    for (const char *p = fmt; *p; p++)
+        stars += *p == '*';
+
+    memset(buf_new, 0x55, sizeof(buf_new));
+    memset(buf_ref, 0x55, sizeof(buf_ref));
+    out_new_len = out_ref_len = 0;
+
+#define RUN(value) \
+    do { \
+        n_new = CALL_ARGS(snprintf_, buf_new, count, fmt); \
+        n_ref = CALL_ARGS(ref_snprintf_, buf_ref, count, fmt); \
+        CALL_ARGS(printf_, fmt); \
+        CALL_ARGS(ref_printf_, fmt); \
+        CALL_ARGS(spanprintf, span_out, NULL, fmt); \
+    } while (0)
+
+    if (conv == 's')
+    {
+        const char *value = PICK(str_set);
+        RUN(value);
+    }
+    else if (conv == 'c')
+    {
+        int value = 'A' + (int)(r % 26);
+        RUN(value);
+    }
+    else if (conv == 'p')
+    {
+        void *value = (void *)(uintptr_t)r;
+        RUN(value);
+    }
+    else if (strcmp(lenmod, "ll") == 0 || strcmp(lenmod, "j") == 0)
+    {
+        long long value = (long long)r;
+        RUN(value);
+    }
+    else if (strcmp(lenmod, "l") == 0 || strcmp(lenmod, "z") == 0)
+    {
+        long value = (long)r;
+        RUN(value);
+    }
+    else
+    {
+        int value = (int)r;
+        RUN(value);
+    }
+
+    // printf_ 和 spanprintf 的输出都追加在 out_new 中，原实现的 printf_ 只输出一遍
+    if (n_new != n_ref || memcmp(buf_new, buf_ref, sizeof(buf_new)) != 0 ||
+        out_new_len != 2U * out_ref_len ||
+        memcmp(out_new, out_ref, out_ref_len) != 0 ||
+        memcmp(out_new + out_ref_len, out_ref, out_ref_len) != 0)
+    {
+        test_failed++;
+        printf("format \"%s\" count %u: snprintf %d/%d, printf \"%.*s\" vs \"%.*s\"\n",
+               fmt, (unsigned)count, n_new, n_ref, (int)out_new_len, out_new, (int)out_ref_len, out_ref);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    long n = argc > 1 ? atol(argv[1]) : 300000;
+
+    for (long i = 0; i < n && test_failed < 20; i++)
+        check_one();
+
+    return test_result("test_printf_span");
+}
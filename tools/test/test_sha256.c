@@ -0,0 +1,65 @@
+/*
+ * user-036：SHA-256
+ *   - sha256_selftest()：FIPS 180-2 向量，含分 25 字节送入的一百万个 'a'
+ *   - 随机长度、随机起始偏移、随机分块（1 字节到跨多个块），流式结果与一次性 sha256() 相同
+ * 数据和流式结果写入 sha256_data.bin、sha256_digest.txt，test_sha256_hashlib 用 Python hashlib 核对。
+ */
+#include <stdint.h>
+#include <string.h>
+#include "sha256.h"
+#include "test_util.h"
+
+
+#define DATA_SIZE   8192U
+
+static uint8_t data[DATA_SIZE];
+
+int main(int argc, char **argv)
+{
+    sha256_ctx_t ctx;
+    uint8_t digest[SHA256_DIGEST_SIZE], once[SHA256_DIGEST_SIZE];
+    uint32_t off, len, done, n, max_block;
+    FILE *f;
+
+    TEST_CHECK(sha256_selftest());
+
+    for (uint32_t i = 0; i < DATA_SIZE; i++)
+        data[i] = (uint8_t)test_rand();
+    f = fopen("sha256_data.bin", "wb");
+    TEST_CHECK(f != NULL && fwrite(data, 1, DATA_SIZE, f) == DATA_SIZE);
+    if (f != NULL)
+        fclose(f);
+
+    f = fopen("sha256_digest.txt", "w");
+    TEST_CHECK(f != NULL);
+    if (f == NULL)
+        return test_result("test_sha256");
+
+    for (int t = 0; t < 2000; t++)
+    {
+        off = (uint32_t)(test_rand() % 1000U);
+        len = t < 200 ? (uint32_t)t : (uint32_t)(test_rand() % (DATA_SIZE - off));
+        max_block = (t & 1) ? 100U : 3000U;
+
+        sha256_init(&ctx);
+        for (done = 0; done < len; done += n)
+        {
+            n = (uint32_t)(test_rand() % max_block) + 1U;
+            if (n > len - done)
+                n = len - done;
+            sha256_update(&ctx, data + off + done, n);
+        }
+        sha256_final(&ctx, digest);
+
+        sha256(data + off, len, once);
+        TEST_CHECK(memcmp(digest, once, sizeof(digest)) == 0);
+
+        fprintf(f, "%u %u ", (unsigned)off, (unsigned)len);
+        for (uint32_t i = 0; i < SHA256_DIGEST_SIZE; i++)
+            fprintf(f, "%02x", digest[i]);
+        fprintf(f, "\n");
+    }
+    fclose(f);
+
+    return test_result("test_sha256");
+}
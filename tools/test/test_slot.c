@@ -0,0 +1,234 @@
+/*
+ * user-041：A/B 槽启动选择记录，flash 和备份 SRAM 用 mmap 映射到实际地址（见 stub/slot_env.h）：
+ *   - 首次启动没有记录，提交 A 后启动 A，再提交 B 后切换到 B
+ *   - 最新的槽镜像损坏或向量表无效时回到另一个槽
+ *   - 写到一半的记录被忽略，新记录写在它之后
+ *   - 参数错误时返回 SLOT_ERR_ARG，不写 flash
+ *   - 连续提交 1100 次，记录区写满时整理为两条，每次都启动刚提交的槽
+ *   - 整理时擦除后掉电则没有可启动的槽，重新提交后恢复
+ * 复位标志保持为 0，每次选择都做完整校验。
+ */
+#include <string.h>
+#include "slot.h"
+#include "slot_env.h"
+#include "test_util.h"
+
+
+#define RECORDS         (LAYOUT_BOOTSEL_SIZE / sizeof(slot_record_t))
+#define SIZE_A          4000U
+#define SIZE_B          (LAYOUT_SLOT_SIZE - 64U)
+#define COMMITS         1100U
+
+static const slot_record_t *record(uint32_t i)
+{
+    return (const slot_record_t *)(SLOT_ENV_FLASH + (LAYOUT_BOOTSEL_ORIGIN - BL_FLASH_BASE)) + i;
+}
+
+static bool record_erased(uint32_t i)
+{
+    const uint8_t *p = (const uint8_t *)record(i);
+
+    for (uint32_t k = 0; k < sizeof(slot_record_t); k++)
+    {
+        if (p[k] != 0xFFU)
+            return false;
+    }
+    return true;
+}
+
+// 第一条全 1 记录的位置
+static uint32_t record_next(void)
+{
+    uint32_t i = RECORDS;
+
+    while (i > 0 && record_erased(i - 1U))
+        i--;
+    return i;
+}
+
+static uint8_t *image_at(uint32_t slot, uint32_t offset)
+{
+    return SLOT_ENV_FLASH + (slot_base(slot) - BL_FLASH_BASE) + offset;
+}
+
+static void test_first_boot(void)
+{
+    TEST_CHECK(slot_select() == SLOT_NONE);
+    TEST_CHECK(slot_active() == SLOT_NONE);
+    TEST_CHECK(slot_inactive() == SLOT_A);
+    TEST_CHECK(slot_size(SLOT_A) == 0 && slot_size(SLOT_B) == 0);
+    TEST_CHECK(slot_env_verify_calls == 0);
+
+    // 镜像已写入但没有提交，不启动
+    slot_env_image(SLOT_A, SIZE_A);
+    slot_env_image(SLOT_B, SIZE_B);
+    TEST_CHECK(slot_select() == SLOT_NONE);
+
+    TEST_CHECK(slot_commit(SLOT_A, SIZE_A) == SLOT_OK);
+    TEST_CHECK(record(0)->seq == 1 && record(0)->slot == SLOT_A && record(0)->size == SIZE_A);
+    TEST_CHECK(record(0)->reserved[0] == 0xFFFFFFFFU && record_next() == 1);
+    TEST_CHECK(slot_select() == SLOT_A);
+    TEST_CHECK(slot_active() == SLOT_A && slot_inactive() == SLOT_B);
+    TEST_CHECK(slot_size(SLOT_A) == SIZE_A && slot_size(SLOT_B) == 0);
+    TEST_CHECK(slot_size(SLOT_COUNT) == 0);
+}
+
+static void test_switch(void)
+{
+    TEST_CHECK(slot_commit(SLOT_B, SIZE_B) == SLOT_OK);
+    TEST_CHECK(record(1)->seq == 2 && record(1)->slot == SLOT_B);
+    TEST_CHECK(slot_select() == SLOT_B);
+    TEST_CHECK(slot_active() == SLOT_B && slot_inactive() == SLOT_A);
+    TEST_CHECK(slot_size(SLOT_A) == SIZE_A && slot_size(SLOT_B) == SIZE_B);
+
+    // 启动时跳到所选槽
+    if (setjmp(slot_env_jump) == 0)
+    {
+        slot_env_jump_base = 0;
+        slot_boot();
+        TEST_CHECK(!"slot_boot returned");
+    }
+    TEST_CHECK(slot_env_jump_base == LAYOUT_SLOT_B_ORIGIN);
+}
+
+static void test_fallback(void)
+{
+    uint8_t *p = image_at(SLOT_B, SIZE_B / 2U);
+    uint32_t *vector = (uint32_t *)image_at(SLOT_B, 0), saved;
+
+    // 内容损坏：回到 A，B 的记录不变，修好后又启动 B
+    *p ^= 0x10U;
+    slot_env_verify_calls = 0;
+    TEST_CHECK(slot_select() == SLOT_A);
+    TEST_CHECK(slot_env_verify_calls == 2);
+    TEST_CHECK(slot_size(SLOT_B) == SIZE_B);
+    *p ^= 0x10U;
+    TEST_CHECK(slot_select() == SLOT_B);
+
+    // 向量表无效时不做完整校验就跳过：复位入口不是 Thumb、在镜像外，栈顶不在 RAM
+    const uint32_t bad[][2] = {
+        { vector[0], vector[1] & ~1U },
+        { vector[0], LAYOUT_SLOT_B_ORIGIN + SIZE_B + 1U },
+        { vector[0], LAYOUT_SLOT_A_ORIGIN + 0x201U },
+        { LAYOUT_RAM_ORIGIN + LAYOUT_RAM_SIZE + 4U, vector[1] },
+        { LAYOUT_RAM_ORIGIN + 0x1002U, vector[1] },
+        { 0xFFFFFFFFU, vector[1] },
+    };
+    for (uint32_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++)
+    {
+        uint32_t good[2] = { vector[0], vector[1] };
+
+        vector[0] = bad[i][0];
+        vector[1] = bad[i][1];
+        slot_env_verify_calls = 0;
+        TEST_CHECK(slot_select() == SLOT_A);
+        TEST_CHECK(slot_env_verify_calls == 1);
+        vector[0] = good[0];
+        vector[1] = good[1];
+    }
+    TEST_CHECK(slot_select() == SLOT_B);
+
+    // 两个槽都坏了：不启动
+    saved = *(uint32_t *)image_at(SLOT_A, 8);
+    *(uint32_t *)image_at(SLOT_A, 8) = ~saved;
+    *p ^= 0x10U;
+    TEST_CHECK(slot_select() == SLOT_NONE);
+    *p ^= 0x10U;
+    *(uint32_t *)image_at(SLOT_A, 8) = saved;
+    TEST_CHECK(slot_select() == SLOT_B);
+}
+
+static void test_torn(void)
+{
+    uint32_t next = record_next(), seq = record(next - 1U)->seq;
+
+    // 只写进前 16 字节（magic、seq、slot、size）时掉电：记录 CRC 不符，仍启动 B
+    slot_env_torn_at = 16;
+    TEST_CHECK(slot_commit(SLOT_A, SIZE_A) == SLOT_ERR_FLASH);
+    TEST_CHECK(record(next)->seq == seq + 1U && !record_erased(next));
+    TEST_CHECK(slot_select() == SLOT_B);
+    TEST_CHECK(slot_size(SLOT_A) == SIZE_A);
+
+    // 重新提交写在坏记录之后，序号不受坏记录影响
+    TEST_CHECK(slot_commit(SLOT_A, SIZE_A) == SLOT_OK);
+    TEST_CHECK(record(next + 1U)->seq == seq + 1U && record(next + 1U)->slot == SLOT_A);
+    TEST_CHECK(slot_select() == SLOT_A);
+
+    // 一个字节都没写进去：位置仍是空的，下一条记录用它
+    slot_env_torn_at = 0;
+    TEST_CHECK(slot_commit(SLOT_B, SIZE_B) == SLOT_ERR_FLASH);
+    TEST_CHECK(record_erased(next + 2U));
+    TEST_CHECK(slot_select() == SLOT_A);
+    TEST_CHECK(slot_commit(SLOT_B, SIZE_B) == SLOT_OK);
+    TEST_CHECK(record(next + 2U)->seq == seq + 2U && record_next() == next + 3U);
+    TEST_CHECK(slot_select() == SLOT_B);
+}
+
+static void test_args(void)
+{
+    uint32_t programs = slot_env_programs, next = record_next();
+
+    TEST_CHECK(slot_commit(SLOT_COUNT, SIZE_A) == SLOT_ERR_ARG);
+    TEST_CHECK(slot_commit(SLOT_NONE, SIZE_A) == SLOT_ERR_ARG);
+    TEST_CHECK(slot_commit(SLOT_A, 7) == SLOT_ERR_ARG);
+    TEST_CHECK(slot_commit(SLOT_A, 0) == SLOT_ERR_ARG);
+    TEST_CHECK(slot_commit(SLOT_B, LAYOUT_SLOT_SIZE + 1U) == SLOT_ERR_ARG);
+    TEST_CHECK(slot_env_programs == programs && record_next() == next);
+    TEST_CHECK(slot_select() == SLOT_B);
+}
+
+static void test_compaction(void)
+{
+    uint32_t seq = record(record_next() - 1U)->seq, erases = slot_env_erases, compactions = 0;
+
+    for (uint32_t n = 0; n < COMMITS; n++)
+    {
+        uint32_t slot = n & 1U, size = slot ? SIZE_B : SIZE_A;
+        bool full = record_next() == RECORDS;
+
+        TEST_CHECK(slot_commit(slot, size) == SLOT_OK);
+        seq++;
+        if (full)
+        {
+            // 整理后只剩另一个槽的最新记录和新记录
+            compactions++;
+            TEST_CHECK(slot_env_erases == erases + compactions);
+            TEST_CHECK(record_next() == 2);
+            TEST_CHECK(record(0)->slot == (slot ^ 1U) && record(0)->seq == seq - 1U);
+            TEST_CHECK(record(1)->slot == slot && record(1)->seq == seq);
+        }
+        TEST_CHECK(record(record_next() - 1U)->seq == seq);
+        TEST_CHECK(slot_select() == slot);
+        TEST_CHECK(slot_size(slot) == size && slot_size(slot ^ 1U) == (slot ? SIZE_A : SIZE_B));
+    }
+    TEST_CHECK(compactions == 2);
+    TEST_CHECK(slot_env_erases == erases + compactions);
+
+    // 整理中擦除之后、写回之前掉电：没有记录，不启动；重新提交后恢复
+    for (uint32_t n = 0; n < RECORDS && record_next() < RECORDS; n++)
+        TEST_CHECK(slot_commit(SLOT_A, SIZE_A) == SLOT_OK);
+    TEST_CHECK(record_next() == RECORDS);
+    slot_env_torn_at = 0;
+    TEST_CHECK(slot_commit(SLOT_B, SIZE_B) == SLOT_ERR_FLASH);
+    TEST_CHECK(record_next() == 0);
+    TEST_CHECK(slot_select() == SLOT_NONE);
+    TEST_CHECK(slot_commit(SLOT_B, SIZE_B) == SLOT_OK);
+    TEST_CHECK(record_next() == 1 && record(0)->seq == 1);
+    TEST_CHECK(slot_select() == SLOT_B);
+    TEST_CHECK(slot_size(SLOT_A) == 0);
+}
+
+int main(void)
+{
+    if (!slot_env_init())
+        return 1;
+
+    test_first_boot();
+    test_switch();
+    test_fallback();
+    test_torn();
+    test_args();
+    test_compaction();
+
+    return test_result("test_slot");
+}
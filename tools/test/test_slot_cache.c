@@ -0,0 +1,213 @@
+/*
+ * user-044：已校验镜像缓存 (SLOT_VERIFY_CACHE)，环境同 test_slot（见 stub/slot_env.h）：
+ *   - 热复位、缓存项与记录一致且 flash 擦写计数未变时跳过完整校验
+ *   - 上电、掉电复位或复位标志为 0 时总是完整校验
+ *   - 任何一次 bl_flash_* 擦写（计数变化）、计数丢失后都重新校验
+ *   - 缓存项任一字段或其 CRC 不符时重新校验；校验失败清除缓存项
+ *   - 镜像末尾 CRC 变化（绕过 bl_flash_* 改写）时重新校验
+ *   - 向量表无效时不看缓存，直接判为无效
+ */
+#include <string.h>
+#include "stm32f4xx.h"
+#include "verify.h"
+#include "slot.h"
+#include "slot_env.h"
+#include "test_util.h"
+
+
+#define SIZE_A          6000U
+#define SIZE_B          9000U
+#define WARM            RCC_CSR_SFTRSTF
+#define CACHE_WORDS     8U          /* magic, slot, size, image_crc, flash_count, reserved[2], crc */
+
+static uint32_t *cache(uint32_t slot)
+{
+    return (uint32_t *)(SLOT_ENV_BKPSRAM + (LAYOUT_BKP_SLOT_CACHE - LAYOUT_BKPSRAM_ORIGIN)) + slot * CACHE_WORDS;
+}
+
+static void cache_seal(uint32_t slot)
+{
+    uint32_t *c = cache(slot);
+
+    c[CACHE_WORDS - 1U] = crc32_sw(c, (CACHE_WORDS - 1U) * 4U);
+}
+
+static bool cache_empty(uint32_t slot)
+{
+    for (uint32_t i = 0; i < CACHE_WORDS; i++)
+    {
+        if (cache(slot)[i] != 0)
+            return false;
+    }
+    return true;
+}
+
+// 以 flags 复位后选择，返回完整校验的次数
+static uint32_t boot(uint32_t flags, uint32_t expect)
+{
+    slot_env_reset_flags = flags;
+    slot_env_verify_calls = 0;
+    TEST_CHECK(slot_select() == expect);
+    return slot_env_verify_calls;
+}
+
+static void flash_touch(void)
+{
+    static const uint8_t zero;
+
+    // 写在 A 镜像之后的空白处，不影响镜像内容
+    TEST_CHECK(bl_flash_program(slot_base(SLOT_A) + LAYOUT_SLOT_SIZE - 1U, &zero, 1) == BL_FLASH_OK);
+}
+
+static void test_reset_kind(void)
+{
+    uint32_t count;
+
+    TEST_CHECK(slot_commit(SLOT_A, SIZE_A) == SLOT_OK);
+
+    // 复位原因未知：校验并记录，下次仍然校验
+    TEST_CHECK(boot(0, SLOT_A) == 1);
+    TEST_CHECK(cache(SLOT_A)[0] == 0x48434C53U && cache(SLOT_A)[1] == SLOT_A && cache(SLOT_A)[2] == SIZE_A);
+    TEST_CHECK(bl_flash_write_count(&count) && cache(SLOT_A)[4] == count);
+    TEST_CHECK(boot(0, SLOT_A) == 1);
+
+    // 热复位（软件、看门狗、复位引脚）用上次的结果
+    TEST_CHECK(boot(WARM, SLOT_A) == 0);
+    TEST_CHECK(boot(RCC_CSR_WDGRSTF | RCC_CSR_PADRSTF, SLOT_A) == 0);
+    TEST_CHECK(boot(RCC_CSR_PADRSTF, SLOT_A) == 0);
+
+    // 上电、掉电复位不信任备份 SRAM 以外的状态，和其他标志一起出现也一样
+    TEST_CHECK(boot(RCC_CSR_PORRSTF | RCC_CSR_PADRSTF, SLOT_A) == 1);
+    TEST_CHECK(boot(RCC_CSR_BORRSTF, SLOT_A) == 1);
+    TEST_CHECK(boot(RCC_CSR_PORRSTF | RCC_CSR_BORRSTF | RCC_CSR_SFTRSTF, SLOT_A) == 1);
+    TEST_CHECK(boot(WARM, SLOT_A) == 0);
+}
+
+static void test_counter(void)
+{
+    uint32_t count;
+
+    // 经 bl_flash_* 的一次擦写就使缓存失效，重新校验后又可以用
+    flash_touch();
+    TEST_CHECK(boot(WARM, SLOT_A) == 1);
+    TEST_CHECK(boot(WARM, SLOT_A) == 0);
+    TEST_CHECK(bl_flash_erase(LAYOUT_SLOT_B_ORIGIN) == BL_FLASH_OK);
+    TEST_CHECK(boot(WARM, SLOT_A) == 1);
+    TEST_CHECK(boot(WARM, SLOT_A) == 0);
+
+    // 计数丢失（备份域掉电）：每次都校验，缓存项清空
+    ((volatile uint32_t *)SLOT_ENV_BKPSRAM)[1] ^= 1U;
+    TEST_CHECK(!bl_flash_write_count(&count));
+    TEST_CHECK(boot(WARM, SLOT_A) == 1);
+    TEST_CHECK(cache_empty(SLOT_A));
+    TEST_CHECK(boot(WARM, SLOT_A) == 1);
+
+    // 下一次擦写从 1 重新计数，之后缓存恢复
+    flash_touch();
+    TEST_CHECK(bl_flash_write_count(&count) && count == 1);
+    TEST_CHECK(boot(WARM, SLOT_A) == 1);
+    TEST_CHECK(boot(WARM, SLOT_A) == 0);
+}
+
+static void test_entry(void)
+{
+    uint32_t saved[CACHE_WORDS], i;
+
+    memcpy(saved, cache(SLOT_A), sizeof(saved));
+
+    // 任一字段被改（CRC 随之不符），或改了 magic、slot、size、image_crc、flash_count
+    // 之后重新计算了 CRC，都重新校验；之后缓存项重新写入
+    for (i = 0; i < CACHE_WORDS; i++)
+    {
+        for (uint32_t seal = 0; seal < 2; seal++)
+        {
+            if (seal && i >= 5U)
+                continue;
+            memcpy(cache(SLOT_A), saved, sizeof(saved));
+            cache(SLOT_A)[i] ^= 1U << (i * 3U);
+            if (seal)
+                cache_seal(SLOT_A);
+            TEST_CHECK(boot(WARM, SLOT_A) == 1);
+            TEST_CHECK(memcmp(cache(SLOT_A), saved, sizeof(saved)) == 0);
+            TEST_CHECK(boot(WARM, SLOT_A) == 0);
+        }
+    }
+
+    // 清零的缓存项
+    memset(cache(SLOT_A), 0, sizeof(saved));
+    TEST_CHECK(boot(WARM, SLOT_A) == 1);
+    TEST_CHECK(boot(WARM, SLOT_A) == 0);
+}
+
+static void test_image(void)
+{
+    uint8_t *p = SLOT_ENV_FLASH + (slot_base(SLOT_A) - BL_FLASH_BASE);
+    uint32_t *vector = (uint32_t *)p;
+
+    // 调试器直接烧录了新镜像（长度相同，末尾 CRC 不同）：重新校验
+    slot_env_image(SLOT_A, SIZE_A);
+    TEST_CHECK(boot(WARM, SLOT_A) == 1);
+    TEST_CHECK(boot(WARM, SLOT_A) == 0);
+
+    // 末尾 CRC 被改坏：重新校验失败，缓存项清空，修好后也要再校验一次
+    p[SIZE_A - 1U] ^= 0x80U;
+    TEST_CHECK(boot(WARM, SLOT_NONE) == 1);
+    TEST_CHECK(cache_empty(SLOT_A));
+    p[SIZE_A - 1U] ^= 0x80U;
+    TEST_CHECK(boot(WARM, SLOT_A) == 1);
+    TEST_CHECK(boot(WARM, SLOT_A) == 0);
+
+    // 向量表无效时缓存项再完整也不启动，不做完整校验；缓存项保留
+    vector[1] &= ~1U;
+    TEST_CHECK(boot(WARM, SLOT_NONE) == 0);
+    vector[1] |= 1U;
+    vector[0] = 0x20000000U;
+    TEST_CHECK(boot(WARM, SLOT_NONE) == 0);
+    vector[0] = LAYOUT_RAM_ORIGIN + LAYOUT_RAM_SIZE;
+    TEST_CHECK(boot(WARM, SLOT_A) == 0);
+
+    // 绕过 bl_flash_* 改了内容而末尾 CRC 不变时，热复位仍然命中（见 SLOT_VERIFY_CACHE）；
+    // 冷启动时完整校验发现
+    vector[0] = LAYOUT_CCMRAM_ORIGIN + LAYOUT_CCMRAM_SIZE;
+    TEST_CHECK(boot(WARM, SLOT_A) == 0);
+    TEST_CHECK(boot(RCC_CSR_PORRSTF, SLOT_NONE) == 1);
+    vector[0] = LAYOUT_RAM_ORIGIN + LAYOUT_RAM_SIZE;
+    TEST_CHECK(boot(RCC_CSR_PORRSTF, SLOT_A) == 1);
+    TEST_CHECK(boot(WARM, SLOT_A) == 0);
+}
+
+static void test_two_slots(void)
+{
+    // 提交 B 写了记录区：B 第一次校验，之后两个槽各自命中
+    slot_env_image(SLOT_B, SIZE_B);
+    TEST_CHECK(slot_commit(SLOT_B, SIZE_B) == SLOT_OK);
+    TEST_CHECK(boot(WARM, SLOT_B) == 1);
+    TEST_CHECK(cache(SLOT_B)[1] == SLOT_B && cache(SLOT_B)[2] == SIZE_B);
+    TEST_CHECK(boot(WARM, SLOT_B) == 0);
+
+    // B 损坏：冷启动两个槽都完整校验，回到 A；之后热复位 B 每次重新校验（缓存项已清空），A 命中
+    uint8_t *p = SLOT_ENV_FLASH + (slot_base(SLOT_B) - BL_FLASH_BASE) + 100U;
+    *p ^= 1U;
+    TEST_CHECK(boot(RCC_CSR_PORRSTF, SLOT_A) == 2);
+    TEST_CHECK(cache_empty(SLOT_B));
+    TEST_CHECK(boot(WARM, SLOT_A) == 1);
+    TEST_CHECK(boot(WARM, SLOT_A) == 1);
+    *p ^= 1U;
+    TEST_CHECK(boot(WARM, SLOT_B) == 1);
+    TEST_CHECK(boot(WARM, SLOT_B) == 0);
+}
+
+int main(void)
+{
+    if (!slot_env_init())
+        return 1;
+
+    slot_env_image(SLOT_A, SIZE_A);
+    test_reset_kind();
+    test_counter();
+    test_entry();
+    test_image();
+    test_two_slots();
+
+    return test_result("test_slot_cache");
+}
@@ -0,0 +1,144 @@
+/*
+ * user-035：升级写入引擎，flash 用 RAM 代替：
+ *   - 随机分块写入后 flash 内容与镜像相同，update_finish 返回的摘要为 CRC32_RESIDUE
+ *   - 扇区在写指针到达时才擦除，区域外的内容不动
+ *   - 镜像损坏时 update_finish 返回 UPDATE_ERR_CRC
+ *   - 读回比较失败时返回 UPDATE_ERR_VERIFY，之后的写入保持该错误
+ *   - 起始地址不是扇区起点、写入超出区域时返回 UPDATE_ERR_ARG
+ */
+#include <stdint.h>
+#include <string.h>
+#include "update.h"
+#include "test_util.h"
+
+
+// F407 扇区：4 x 16K, 64K, 7 x 128K
+static uint8_t flash[BL_FLASH_SIZE];
+static uint32_t erase_count;
+static uint32_t fail_at = UINT32_MAX;       // 编程到该地址时模拟读回不一致
+
+bool bl_flash_sector(uint32_t addr, uint32_t *index, uint32_t *start, uint32_t *size)
+{
+    uint32_t off = addr - BL_FLASH_BASE, i, s, n;
+
+    if (addr < BL_FLASH_BASE || off >= BL_FLASH_SIZE)
+        return false;
+
+    if (off < 0x10000U)
+    {
+        i = off >> 14;
+        s = i << 14;
+        n = 0x4000U;
+    }
+    else if (off < 0x20000U)
+    {
+        i = 4;
+        s = 0x10000U;
+        n = 0x10000U;
+    }
+    else
+    {
+        i = 4U + (off >> 17);
+        s = off & ~0x1FFFFU;
+        n = 0x20000U;
+    }
+
+    if (index)
+        *index = i;
+    if (start)
+        *start = BL_FLASH_BASE + s;
+    if (size)
+        *size = n;
+    return true;
+}
+
+bl_flash_status_t bl_flash_erase(uint32_t addr)
+{
+    uint32_t start, size;
+
+    if (!bl_flash_sector(addr, NULL, &start, &size) || start != addr)
+        return BL_FLASH_ERR_ADDR;
+    memset(&flash[start - BL_FLASH_BASE], 0xFF, size);
+    erase_count++;
+    return BL_FLASH_OK;
+}
+
+bl_flash_status_t bl_flash_program(uint32_t addr, const void *data, uint32_t len)
+{
+    uint8_t *p = &flash[addr - BL_FLASH_BASE];
+
+    // 和硬件一样只能把 1 写成 0，没擦除的位置读回时会不一致
+    for (uint32_t i = 0; i < len; i++)
+        p[i] &= ((const uint8_t *)data)[i];
+    if (fail_at >= addr && fail_at < addr + len)
+        p[fail_at - addr] ^= 0x01U;
+    return memcmp(p, data, len) == 0 ? BL_FLASH_OK : BL_FLASH_ERR_VERIFY;
+}
+
+#define BASE        (BL_FLASH_BASE + 0x20000U)
+#define SIZE        0x40000U
+#define IMAGE_SIZE  (SIZE - 1000U)
+
+static uint8_t image[IMAGE_SIZE];
+static update_t up;
+
+// 随机分块写入，返回 update_finish 的结果
+static update_status_t write_image(const uint8_t *p, uint32_t len, uint32_t *crc)
+{
+    uint32_t done = 0, n;
+
+    while (done < len)
+    {
+        n = (uint32_t)(test_rand() % 1500U) + 1U;
+        if (n > len - done)
+            n = len - done;
+        if (update_write(&up, p + done, n) != UPDATE_OK)
+            break;
+        done += n;
+    }
+    return update_finish(&up, crc);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t crc = 1, len = IMAGE_SIZE - 4U;
+
+    // 镜像末尾追加 CRC，同 image_tool.py crc
+    for (uint32_t i = 0; i < len; i++)
+        image[i] = (uint8_t)test_rand();
+    crc = crc32_sw(image, len);
+    memcpy(image + len, &crc, 4);
+
+    memset(flash, 0x5A, sizeof(flash));
+    TEST_CHECK(update_begin(&up, BASE, SIZE) == UPDATE_OK);
+    TEST_CHECK(write_image(image, IMAGE_SIZE, &crc) == UPDATE_OK);
+    TEST_CHECK(crc == CRC32_RESIDUE);
+    TEST_CHECK(up.offset == IMAGE_SIZE);
+    TEST_CHECK(memcmp(&flash[BASE - BL_FLASH_BASE], image, IMAGE_SIZE) == 0);
+    TEST_CHECK(erase_count == 2U);
+    TEST_CHECK(flash[BASE - BL_FLASH_BASE - 1U] == 0x5A);
+    TEST_CHECK(flash[BASE - BL_FLASH_BASE + SIZE] == 0x5A);
+
+    // 镜像损坏
+    image[12345] ^= 0x80U;
+    TEST_CHECK(update_begin(&up, BASE, SIZE) == UPDATE_OK);
+    TEST_CHECK(write_image(image, IMAGE_SIZE, NULL) == UPDATE_ERR_CRC);
+    image[12345] ^= 0x80U;
+
+    // 读回不一致，错误保持到 update_finish
+    fail_at = BASE + 70000U;
+    TEST_CHECK(update_begin(&up, BASE, SIZE) == UPDATE_OK);
+    TEST_CHECK(write_image(image, IMAGE_SIZE, NULL) == UPDATE_ERR_VERIFY);
+    TEST_CHECK(up.offset <= 70000U);
+    TEST_CHECK(update_write(&up, image, 4) == UPDATE_ERR_VERIFY);
+    fail_at = UINT32_MAX;
+
+    // 参数
+    TEST_CHECK(update_begin(&up, BASE + 0x1000U, SIZE) == UPDATE_ERR_ARG);
+    TEST_CHECK(update_begin(&up, BASE, 0) == UPDATE_ERR_ARG);
+    TEST_CHECK(update_begin(&up, BASE, BL_FLASH_SIZE) == UPDATE_ERR_ARG);
+    TEST_CHECK(update_begin(&up, BASE, 0x4000U) == UPDATE_OK);
+    TEST_CHECK(update_write(&up, image, 0x4001U) == UPDATE_ERR_ARG);
+
+    return test_result("test_update");
+}
@@ -0,0 +1,71 @@
+#ifndef __BL_TEST_UTIL_H
+#define __BL_TEST_UTIL_H
+
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+
+/* 失败时打印位置并计数，main 最后 return test_failed != 0 */
+static int test_failed __attribute__((unused));
+
+#define TEST_CHECK(cond) \
+    do { \
+        if (!(cond)) \
+        { \
+            test_failed++; \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        } \
+    } while (0)
+
+/* 测试结束时的汇总，返回 main 的退出码 */
+static inline int test_result(const char *name)
+{
+    printf("%s: %s\n", name, test_failed ? "FAILED" : "ok");
+    return test_failed != 0;
+}
+
+/* xorshift64，种子固定，每次运行结果相同 */
+static uint64_t test_rand_state __attribute__((unused)) = 88172645463325252ULL;
+
+static inline uint64_t test_rand(void)
+{
+    test_rand_state ^= test_rand_state << 13;
+    test_rand_state ^= test_rand_state >> 7;
+    test_rand_state ^= test_rand_state << 17;
+    return test_rand_state;
+}
+
+static inline double test_now_ns(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec * 1e9 + (double)t.tv_nsec;
+}
+
+/* 基准：body 执行 n 次为一轮（循环变量为 i），取 TEST_BENCH_ROUNDS 轮中最快一轮的每次耗时 (ns) */
+#ifndef TEST_BENCH_ROUNDS
+#define TEST_BENCH_ROUNDS   9
+#endif
+
+#define TEST_BENCH(result, i, n, body) \
+    do { \
+        double best_ = 1e300; \
+        for (int round_ = 0; round_ < TEST_BENCH_ROUNDS; round_++) \
+        { \
+            double t0_ = test_now_ns(); \
+            for (long i = 0; i < (long)(n); i++) \
+            { \
+                body; \
+            } \
+            double dt_ = (test_now_ns() - t0_) / (double)(n); \
+            if (dt_ < best_) \
+                best_ = dt_; \
+        } \
+        (result) = best_; \
+    } while (0)
+
+
+#endif /* __BL_TEST_UTIL_H */
@@ -0,0 +1,65 @@
+/*
+ * user-035：增量校验上下文按任意长度分块送入，结果与整体计算相同：
+ *   - CRC 等于按 image_tool.py 规则补 0xFF 后一次性 crc32_sw 的结果，len 计入补齐
+ *   - sha256[] 等于原始数据（不补齐）一次性 sha256 的结果
+ * 分块包括 1 字节、不足一个字、跨字和大块，起始地址不对齐。
+ */
+#include <stdint.h>
+#include <string.h>
+#include "verify.h"
+#include "test_util.h"
+
+
+#define DATA_SIZE   8192U
+
+static uint8_t data[DATA_SIZE + 8];
+static uint8_t padded[DATA_SIZE + 8];
+
+static void check(const uint8_t *p, uint32_t len, uint32_t max_block)
+{
+    verify_ctx_t ctx;
+    uint8_t digest[SHA256_DIGEST_SIZE];
+    uint32_t done = 0, n, plen = (len + 3U) & ~3U;
+
+    verify_ctx_init(&ctx);
+    while (done < len)
+    {
+        n = (uint32_t)(test_rand() % max_block) + 1U;
+        if (n > len - done)
+            n = len - done;
+        verify_ctx_update(&ctx, p + done, n);
+        done += n;
+    }
+
+    memcpy(padded, p, len);
+    memset(padded + len, 0xFF, plen - len);
+    TEST_CHECK(verify_ctx_final(&ctx) == crc32_sw(padded, plen));
+    TEST_CHECK(ctx.len == plen);
+#if VERIFY_SHA256
+    sha256(p, len, digest);
+    TEST_CHECK(memcmp(ctx.sha256, digest, sizeof(digest)) == 0);
+#else
+    (void)digest;
+#endif
+}
+
+int main(int argc, char **argv)
+{
+    static const uint32_t max_block[] = { 1, 3, 5, 64, 600, DATA_SIZE };
+
+    for (uint32_t i = 0; i < sizeof(data); i++)
+        data[i] = (uint8_t)test_rand();
+
+    for (uint32_t len = 0; len <= 16U; len++)
+        check(data, len, 3);
+
+    for (int t = 0; t < 3000 && test_failed < 20; t++)
+    {
+        uint32_t off = (uint32_t)(test_rand() % 8U);
+        uint32_t len = (uint32_t)(test_rand() % DATA_SIZE);
+
+        check(data + off, len, max_block[t % 6]);
+    }
+
+    return test_result("test_verify_ctx");
+}